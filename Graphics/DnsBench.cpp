@@ -0,0 +1,277 @@
+#include "DnsBench.h"
+#include "DnsMessage.h"
+#include "DnsPlatform.h"
+#include <string.h>
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define DELAYED_CAPACITY    128
+#define PACKET_SIZE         512
+#define IDLE_WAIT_US        5000
+
+struct BenchSlot {
+    bool used;
+    uint16_t id;
+    uint32_t sentAt;
+};
+
+struct DelayedAnswer {
+    uint32_t dueAt;
+    struct sockaddr_in to;
+    uint16_t length;
+    uint8_t packet[PACKET_SIZE];
+};
+
+// Log-linear buckets: exact below 32 us, then 16 per power of two.
+static uint32_t bucketOf(uint32_t us) {
+    if (us < 32) {
+        return us;
+    }
+    uint32_t octave = 31 - __builtin_clz(us);
+    uint32_t index = 32 + (octave - 5) * 16 + ((us >> (octave - 4)) & 15);
+    return index < DNS_BENCH_HISTOGRAM_BUCKETS ? index : DNS_BENCH_HISTOGRAM_BUCKETS - 1;
+}
+
+static uint32_t bucketValue(uint32_t index) {
+    if (index < 32) {
+        return index;
+    }
+    uint32_t octave = (index - 32) / 16 + 5;
+    uint32_t sub = (index - 32) % 16;
+    return (16 + sub) << (octave - 4);
+}
+
+static uint32_t percentile(const uint32_t *histogram, uint32_t total, uint32_t permille) {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)total * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < DNS_BENCH_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= rank) {
+            return bucketValue(i);
+        }
+    }
+    return bucketValue(DNS_BENCH_HISTOGRAM_BUCKETS - 1);
+}
+
+static int openSocket(uint32_t addr, uint16_t port) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = addr;
+    local.sin_port = htons(port);
+    if (bind(sock, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        close(sock);
+        return -1;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    return sock;
+}
+
+// Skewed name mix: hotPercent of queries hit the first tenth of the names.
+static uint32_t pickName(const DnsBenchConfig &config) {
+    uint32_t hot = config.distinctNames / 10;
+    if (hot > 0 && dnsRandom() % 100 < config.hotPercent) {
+        return dnsRandom() % hot;
+    }
+    return dnsRandom() % config.distinctNames;
+}
+
+// The stand-in upstream: same question back, one A record derived from the
+// name so answers are stable across retries.
+static uint16_t buildAnswer(const uint8_t *query, size_t length, uint32_t ttl, uint8_t *out) {
+    DnsMessageView view;
+    DnsQuestion question;
+    if (!view.parse(query, length) || !view.firstQuestion(question)) {
+        return 0;
+    }
+    DnsMessageWriter writer(out, PACKET_SIZE);
+    writer.beginResponse(view, DNS_RCODE_NOERROR);
+    if (question.type == DNS_TYPE_A) {
+        uint32_t hash = question.name.hash();
+        writer.addA(NULL, ttl, 10 | (hash & 0xFFFFFF00));
+    }
+    return (uint16_t)writer.finish();
+}
+
+void dnsBenchDefaults(DnsBenchConfig &config) {
+    config.serverAddr = htonl(INADDR_LOOPBACK);
+    config.serverPort = 53;
+    config.upstreamPort = 5300;
+    config.queries = 20000;
+    config.distinctNames = 2000;
+    config.hotPercent = 80;
+    config.outstanding = 16;
+    config.upstreamLossPercent = 1;
+    config.upstreamDelayMs = 20;
+    config.upstreamTtl = 300;
+    config.timeoutMs = 5000;
+}
+
+bool runDnsBenchmark(const DnsBenchConfig &config, DnsBenchResult &result) {
+    memset(&result, 0, sizeof(result));
+    uint32_t outstanding = config.outstanding;
+    if (outstanding == 0 || outstanding > DNS_BENCH_MAX_OUTSTANDING || config.distinctNames == 0) {
+        return false;
+    }
+
+    uint32_t *histogram = (uint32_t *)dnsAlloc(sizeof(uint32_t) * DNS_BENCH_HISTOGRAM_BUCKETS);
+    DelayedAnswer *delayed = (DelayedAnswer *)dnsAlloc(sizeof(DelayedAnswer) * DELAYED_CAPACITY);
+    int client = openSocket(htonl(INADDR_ANY), 0);
+    int upstream = openSocket(htonl(INADDR_LOOPBACK), config.upstreamPort);
+    bool ok = histogram && delayed && client >= 0 && upstream >= 0;
+    if (ok) {
+        memset(histogram, 0, sizeof(uint32_t) * DNS_BENCH_HISTOGRAM_BUCKETS);
+
+        struct sockaddr_in server;
+        memset(&server, 0, sizeof(server));
+        server.sin_family = AF_INET;
+        server.sin_addr.s_addr = config.serverAddr;
+        server.sin_port = htons(config.serverPort);
+
+        BenchSlot slots[DNS_BENCH_MAX_OUTSTANDING];
+        memset(slots, 0, sizeof(slots));
+        uint32_t inFlight = 0;
+        uint32_t delayedHead = 0;
+        uint32_t delayedCount = 0;
+        uint16_t generation = (uint16_t)dnsRandom();
+        uint8_t packet[PACKET_SIZE];
+        uint32_t startMs = dnsMillis();
+
+        for (;;) {
+            // Keep the window full. The ID's low byte is the slot.
+            for (uint32_t i = 0; i < outstanding && result.sent < config.queries; i++) {
+                if (slots[i].used) {
+                    continue;
+                }
+                char name[40];
+                snprintf(name, sizeof(name), "n%lu.bench.test", (unsigned long)pickName(config));
+                generation++;
+                uint16_t id = (uint16_t)((generation << 8) | i);
+                DnsMessageWriter writer(packet, sizeof(packet));
+                writer.begin(id, DNS_FLAG_RD);
+                writer.addQuestion(name, DNS_TYPE_A);
+                size_t length = writer.finish();
+                slots[i].used = true;
+                slots[i].id = id;
+                slots[i].sentAt = dnsMicros();
+                sendto(client, packet, length, 0, (struct sockaddr *)&server, sizeof(server));
+                result.sent++;
+                inFlight++;
+            }
+
+            uint32_t nowUs = dnsMicros();
+            uint32_t nowMs = dnsMillis();
+            for (uint32_t i = 0; i < outstanding; i++) {
+                if (slots[i].used && nowUs - slots[i].sentAt >= config.timeoutMs * 1000) {
+                    slots[i].used = false;
+                    inFlight--;
+                    result.dropped++;
+                }
+            }
+            while (delayedCount > 0 && dnsTimeReached(nowMs, delayed[delayedHead].dueAt)) {
+                DelayedAnswer &d = delayed[delayedHead];
+                sendto(upstream, d.packet, d.length, 0, (struct sockaddr *)&d.to, sizeof(d.to));
+                delayedHead = (delayedHead + 1) % DELAYED_CAPACITY;
+                delayedCount--;
+            }
+            if (result.sent >= config.queries && inFlight == 0) {
+                break;
+            }
+
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(client, &readable);
+            FD_SET(upstream, &readable);
+            struct timeval wait = {0, IDLE_WAIT_US};
+            select((client > upstream ? client : upstream) + 1, &readable, NULL, NULL, &wait);
+
+            int n;
+            while ((n = recv(client, packet, sizeof(packet), 0)) >= DNS_HEADER_LENGTH) {
+                uint16_t id = (uint16_t)((packet[0] << 8) | packet[1]);
+                BenchSlot &slot = slots[(id & 0xFF) % DNS_BENCH_MAX_OUTSTANDING];
+                if (!slot.used || slot.id != id) {
+                    continue;
+                }
+                histogram[bucketOf(dnsMicros() - slot.sentAt)]++;
+                slot.used = false;
+                inFlight--;
+                result.answered++;
+            }
+
+            struct sockaddr_in from;
+            socklen_t fromLength = sizeof(from);
+            while ((n = recvfrom(upstream, packet, sizeof(packet), 0, (struct sockaddr *)&from, &fromLength)) > 0) {
+                fromLength = sizeof(from);
+                result.upstreamQueries++;
+                if (dnsRandom() % 100 < config.upstreamLossPercent) {
+                    result.upstreamLost++;
+                    continue;
+                }
+                if (config.upstreamDelayMs == 0 || delayedCount == DELAYED_CAPACITY) {
+                    uint8_t answer[PACKET_SIZE];
+                    uint16_t length = buildAnswer(packet, n, config.upstreamTtl, answer);
+                    sendto(upstream, answer, length, 0, (struct sockaddr *)&from, sizeof(from));
+                    continue;
+                }
+                DelayedAnswer &d = delayed[(delayedHead + delayedCount) % DELAYED_CAPACITY];
+                d.length = buildAnswer(packet, n, config.upstreamTtl, d.packet);
+                if (d.length == 0) {
+                    continue;
+                }
+                d.dueAt = dnsMillis() + config.upstreamDelayMs;
+                d.to = from;
+                delayedCount++;
+            }
+        }
+
+        result.elapsedMs = dnsMillis() - startMs;
+        if (result.elapsedMs > 0) {
+            result.qps = (uint32_t)((uint64_t)result.answered * 1000 / result.elapsedMs);
+        }
+        result.p50Us = percentile(histogram, result.answered, 500);
+        result.p99Us = percentile(histogram, result.answered, 990);
+        result.p999Us = percentile(histogram, result.answered, 999);
+        if (result.sent > 0) {
+            uint32_t viaUpstream = result.upstreamQueries < result.sent ? result.upstreamQueries : result.sent;
+            result.hitPermille = (uint32_t)((uint64_t)(result.sent - viaUpstream) * 1000 / result.sent);
+        }
+    }
+
+    if (client >= 0) {
+        close(client);
+    }
+    if (upstream >= 0) {
+        close(upstream);
+    }
+    dnsFree(histogram);
+    dnsFree(delayed);
+    return ok;
+}
+
+int formatDnsBenchResult(const DnsBenchResult &result, char *out, size_t size) {
+    return snprintf(out, size,
+                    "sent %lu answered %lu dropped %lu in %lu ms: %lu qps, p50 %lu us, p99 %lu us, "
+                    "p99.9 %lu us, hit ratio %lu.%lu%%, upstream %lu queries (%lu lost)",
+                    (unsigned long)result.sent, (unsigned long)result.answered, (unsigned long)result.dropped,
+                    (unsigned long)result.elapsedMs, (unsigned long)result.qps, (unsigned long)result.p50Us,
+                    (unsigned long)result.p99Us, (unsigned long)result.p999Us,
+                    (unsigned long)(result.hitPermille / 10), (unsigned long)(result.hitPermille % 10),
+                    (unsigned long)result.upstreamQueries, (unsigned long)result.upstreamLost);
+}
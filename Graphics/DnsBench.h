@@ -0,0 +1,48 @@
+#ifndef DNSBENCH_H
+#define DNSBENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DNS_BENCH_MAX_OUTSTANDING   64
+#define DNS_BENCH_HISTOGRAM_BUCKETS 352     // 1 us .. ~16 s, 16 per octave
+
+struct DnsBenchConfig {
+    uint32_t serverAddr;        // network byte order
+    uint16_t serverPort;
+    uint16_t upstreamPort;      // stand-in upstream listens on loopback here
+    uint32_t queries;
+    uint32_t distinctNames;
+    uint8_t hotPercent;         // share of queries that go to the hottest 10% of names
+    uint8_t outstanding;        // queries kept in flight, at most DNS_BENCH_MAX_OUTSTANDING
+    uint8_t upstreamLossPercent;
+    uint16_t upstreamDelayMs;
+    uint32_t upstreamTtl;
+    uint32_t timeoutMs;
+};
+
+struct DnsBenchResult {
+    uint32_t sent;
+    uint32_t answered;
+    uint32_t dropped;           // never answered within timeoutMs
+    uint32_t upstreamQueries;   // seen by the stand-in, retries included
+    uint32_t upstreamLost;
+    uint32_t elapsedMs;
+    uint32_t qps;
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t p999Us;
+    uint32_t hitPermille;       // answers that never reached upstream
+};
+
+// Loopback load generator for the DNS server.
+// Keeps `outstanding` queries in flight against serverAddr:serverPort and, in
+// the same loop, plays the upstream resolver on 127.0.0.1:upstreamPort with a
+// fixed delay and random loss, so the server under test has to be pointed at
+// that port. Latencies go into a log-linear histogram. Blocks the caller
+// until every query is answered or has timed out.
+void dnsBenchDefaults(DnsBenchConfig &config);
+bool runDnsBenchmark(const DnsBenchConfig &config, DnsBenchResult &result);
+int formatDnsBenchResult(const DnsBenchResult &result, char *out, size_t size);
+
+#endif // DNSBENCH_H
@@ -0,0 +1,58 @@
+#include "DnsBufferPool.h"
+#include "DnsPlatform.h"
+
+DnsBufferPool::DnsBufferPool() : block(NULL), size(0), count(0), freeMask(0) {
+}
+
+DnsBufferPool::~DnsBufferPool() {
+    end();
+}
+
+bool DnsBufferPool::begin(uint32_t bufferCount, size_t bufferSize) {
+    end();
+    if (bufferCount == 0 || bufferCount > DNS_BUFFER_POOL_MAX || bufferSize == 0) {
+        return false;
+    }
+    // Word-aligned buffers keep memcpy on its fast path.
+    bufferSize = (bufferSize + 3) & ~(size_t)3;
+    block = (uint8_t *)dnsAlloc(bufferSize * bufferCount);
+    if (!block) {
+        return false;
+    }
+    size = bufferSize;
+    count = bufferCount;
+    freeMask.store(bufferCount == 32 ? 0xFFFFFFFFu : (1u << bufferCount) - 1);
+    return true;
+}
+
+void DnsBufferPool::end() {
+    dnsFree(block);
+    block = NULL;
+    size = 0;
+    count = 0;
+    freeMask.store(0);
+}
+
+uint8_t *DnsBufferPool::acquire() {
+    uint32_t mask = freeMask.load(std::memory_order_relaxed);
+    while (mask != 0) {
+        uint32_t bit = mask & (~mask + 1);
+        if (freeMask.compare_exchange_weak(mask, mask & ~bit, std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            return block + size * __builtin_ctz(bit);
+        }
+    }
+    return NULL;
+}
+
+void DnsBufferPool::release(uint8_t *buffer) {
+    if (buffer == NULL || buffer < block || buffer >= block + size * count) {
+        return;
+    }
+    uint32_t index = (uint32_t)((buffer - block) / size);
+    freeMask.fetch_or(1u << index, std::memory_order_release);
+}
+
+uint32_t DnsBufferPool::available() const {
+    return __builtin_popcount(freeMask.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,40 @@
+#ifndef DNSBUFFERPOOL_H
+#define DNSBUFFERPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define DNS_BUFFER_POOL_MAX     32
+
+// Fixed-size packet buffers carved out of one PSRAM block when the server
+// starts, so a 4 KB EDNS or TCP message never lands on a task stack and the
+// query path never touches the heap.
+//
+// Free buffers are tracked in a single atomic bitmap: acquire() and
+// release() are lock-free and may be called from any task.
+class DnsBufferPool {
+public:
+    DnsBufferPool();
+    ~DnsBufferPool();
+
+    // At most DNS_BUFFER_POOL_MAX buffers.
+    bool begin(uint32_t count, size_t bufferSize);
+    void end();
+
+    // NULL when every buffer is in use.
+    uint8_t *acquire();
+    void release(uint8_t *buffer);
+
+    size_t bufferSize() const { return size; }
+    uint32_t capacity() const { return count; }
+    uint32_t available() const;
+
+private:
+    uint8_t *block;
+    size_t size;
+    uint32_t count;
+    std::atomic<uint32_t> freeMask;
+};
+
+#endif // DNSBUFFERPOOL_H
@@ -0,0 +1,391 @@
+#include "DnsCache.h"
+#include "DnsPlatform.h"
+#include <string.h>
+
+static bool nameEquals(const char *stored, size_t storedLength, const char *name, size_t length) {
+    if (storedLength != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (stored[i] != dnsToLower(name[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DnsCache::DnsCache()
+    : entries(NULL), slots(NULL), entryCount(0), slotMask(0), count(0), nextUnused(0), hand(0), sweepAt(0),
+      inserts(0), evictions(0), sequence(0), hits(0), misses(0), expired(0), negativeHits(0),
+      staleHits(0), refreshes(0) {
+}
+
+DnsCache::~DnsCache() {
+    end();
+}
+
+bool DnsCache::begin(uint32_t capacity) {
+    end();
+    if (capacity == 0) {
+        return false;
+    }
+
+    // Keep the index at most half full so probe chains stay short.
+    uint32_t slotCount = 1;
+    while (slotCount < capacity * 2) {
+        slotCount <<= 1;
+    }
+
+    entries = (Entry *)dnsAlloc(sizeof(Entry) * capacity);
+    slots = (Slot *)dnsAlloc(sizeof(Slot) * slotCount);
+    if (!entries || !slots || !writeLock.begin()) {
+        end();
+        return false;
+    }
+    entryCount = capacity;
+    slotMask = slotCount - 1;
+    clear();
+    return true;
+}
+
+void DnsCache::end() {
+    dnsFree(entries);
+    dnsFree(slots);
+    entries = NULL;
+    slots = NULL;
+    entryCount = 0;
+    slotMask = 0;
+    count = 0;
+    writeLock.end();
+}
+
+void DnsCache::clear() {
+    if (!entries) {
+        return;
+    }
+    beginWrite();
+    memset(slots, 0, sizeof(Slot) * (slotMask + 1));
+    for (uint32_t i = 0; i < entryCount; i++) {
+        entries[i].used = 0;
+    }
+    count = 0;
+    nextUnused = 0;
+    hand = 0;
+    sweepAt = 0;
+    inserts = 0;
+    evictions = 0;
+    hits.store(0);
+    misses.store(0);
+    expired.store(0);
+    negativeHits.store(0);
+    staleHits.store(0);
+    refreshes.store(0);
+    endWrite();
+}
+
+int32_t DnsCache::findSlot(const char *name, size_t length, uint32_t hash) const {
+    uint32_t i = hash & slotMask;
+    while (slots[i].entry != 0) {
+        if (slots[i].hash == hash) {
+            const Entry &e = entries[slots[i].entry - 1];
+            if (nameEquals(e.name, e.nameLength, name, length)) {
+                return (int32_t)i;
+            }
+        }
+        i = (i + 1) & slotMask;
+    }
+    return -1;
+}
+
+bool DnsCache::read(const char *name, size_t length, uint32_t hash, Snapshot &snapshot) {
+    // May run against a half-finished write: every index is bounds-checked
+    // and the caller throws the result away unless the sequence held still.
+    uint32_t i = hash & slotMask;
+    for (uint32_t n = 0; n <= slotMask; n++) {
+        Slot slot = slots[i];
+        if (slot.entry == 0) {
+            return false;
+        }
+        if (slot.hash == hash && slot.entry <= entryCount) {
+            Entry &e = entries[slot.entry - 1];
+            if (nameEquals(e.name, e.nameLength, name, length)) {
+                snapshot.entry = &e;
+                snapshot.addr = e.addr;
+                snapshot.expiresAt = e.expiresAt;
+                snapshot.ttl = e.ttl;
+                snapshot.refreshAt = e.refreshAt;
+                snapshot.kind = e.kind;
+                snapshot.referenced = e.referenced;
+                e.referenced = 1;
+                return true;
+            }
+        }
+        i = (i + 1) & slotMask;
+    }
+    return false;
+}
+
+bool DnsCache::lookup(const char *name, uint32_t now, DnsCacheAnswer &answer) {
+    if (!entries) {
+        return false;
+    }
+    size_t length;
+    uint32_t hash = dnsNameHash(name, &length);
+
+    bool found = false;
+    Snapshot snapshot;
+    for (int attempt = 0;; attempt++) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            found = read(name, length, hash, snapshot);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        if (attempt >= 3) {
+            // The writer may be preempted mid-change on this very core;
+            // queue behind it instead of spinning.
+            writeLock.lock();
+            found = read(name, length, hash, snapshot);
+            writeLock.unlock();
+            break;
+        }
+    }
+
+    if (!found) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    answer.kind = (DnsCacheKind)snapshot.kind;
+    answer.addr = snapshot.addr;
+    answer.stale = false;
+    answer.refresh = false;
+    if (!dnsTimeReached(now, snapshot.expiresAt)) {
+        uint32_t left = snapshot.expiresAt - now;
+        answer.ttl = (left + 999) / 1000;
+        // Only names that were hit since they were stored are worth the
+        // upstream query.
+        answer.refresh = answer.kind == DNS_CACHE_ADDRESS && snapshot.referenced &&
+                         (uint64_t)left * 100 < (uint64_t)snapshot.ttl * 1000 * DNS_CACHE_PREFETCH_PERCENT;
+    } else if (answer.kind == DNS_CACHE_ADDRESS &&
+               !dnsTimeReached(now, snapshot.expiresAt + DNS_CACHE_STALE_WINDOW * 1000)) {
+        answer.ttl = DNS_CACHE_STALE_TTL;
+        answer.stale = true;
+        answer.refresh = true;
+        staleHits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        expired.fetch_add(1, std::memory_order_relaxed);
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (answer.refresh) {
+        // Racy by design, like `referenced`: at worst two workers both ask
+        // for the same refresh, and a stale pointer only hits another entry.
+        if (snapshot.refreshAt != 0 && !dnsTimeReached(now, snapshot.refreshAt + DNS_CACHE_REFRESH_HOLDOFF_MS)) {
+            answer.refresh = false;
+        } else {
+            snapshot.entry->refreshAt = now | 1;
+            refreshes.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (answer.kind != DNS_CACHE_ADDRESS) {
+        negativeHits.fetch_add(1, std::memory_order_relaxed);
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool DnsCache::insert(const char *name, uint32_t addr, uint32_t ttl, uint32_t now) {
+    if (ttl < DNS_CACHE_MIN_TTL) {
+        ttl = DNS_CACHE_MIN_TTL;
+    } else if (ttl > DNS_CACHE_MAX_TTL) {
+        ttl = DNS_CACHE_MAX_TTL;
+    }
+    return store(name, DNS_CACHE_ADDRESS, addr, ttl, now);
+}
+
+bool DnsCache::insertNegative(const char *name, DnsCacheKind kind, uint32_t ttl, uint32_t now) {
+    if (kind == DNS_CACHE_ADDRESS) {
+        return false;
+    }
+    if (ttl < DNS_CACHE_MIN_TTL) {
+        ttl = DNS_CACHE_MIN_TTL;
+    } else if (ttl > DNS_CACHE_MAX_NEGATIVE_TTL) {
+        ttl = DNS_CACHE_MAX_NEGATIVE_TTL;
+    }
+    return store(name, kind, 0, ttl, now);
+}
+
+bool DnsCache::store(const char *name, DnsCacheKind kind, uint32_t addr, uint32_t ttl, uint32_t now) {
+    if (!entries) {
+        return false;
+    }
+    size_t length;
+    uint32_t hash = dnsNameHash(name, &length);
+    if (length == 0 || length > DNS_NAME_MAX_LENGTH) {
+        return false;
+    }
+
+    beginWrite();
+    int32_t slot = findSlot(name, length, hash);
+    Entry *e;
+    if (slot >= 0) {
+        e = &entries[slots[slot].entry - 1];
+        if (kind == DNS_CACHE_SERVFAIL && e->kind == DNS_CACHE_ADDRESS &&
+            !dnsTimeReached(now, e->expiresAt + DNS_CACHE_STALE_WINDOW * 1000)) {
+            // Keep the address servable; the refresh hold-off spaces out
+            // further attempts.
+            endWrite();
+            return false;
+        }
+    } else {
+        uint32_t index = takeEntry(now);
+        e = &entries[index];
+        e->hash = hash;
+        e->nameLength = (uint8_t)length;
+        for (size_t i = 0; i < length; i++) {
+            e->name[i] = dnsToLower(name[i]);
+        }
+        e->name[length] = '\0';
+        e->used = 1;
+        count++;
+
+        uint32_t i = hash & slotMask;
+        while (slots[i].entry != 0) {
+            i = (i + 1) & slotMask;
+        }
+        slots[i].hash = hash;
+        slots[i].entry = index + 1;
+    }
+
+    e->kind = (uint8_t)kind;
+    e->addr = addr;
+    e->ttl = ttl;
+    e->expiresAt = now + ttl * 1000;
+    e->refreshAt = 0;
+    e->referenced = 0;
+    inserts++;
+    endWrite();
+    return true;
+}
+
+bool DnsCache::remove(const char *name) {
+    if (!entries) {
+        return false;
+    }
+    size_t length;
+    uint32_t hash = dnsNameHash(name, &length);
+    beginWrite();
+    int32_t slot = findSlot(name, length, hash);
+    if (slot >= 0) {
+        uint32_t index = slots[slot].entry - 1;
+        unlinkSlot(slot);
+        releaseEntry(index);
+    }
+    endWrite();
+    return slot >= 0;
+}
+
+uint32_t DnsCache::sweep(uint32_t now, uint32_t budget) {
+    if (!entries) {
+        return 0;
+    }
+    uint32_t dropped = 0;
+    beginWrite();
+    for (uint32_t n = 0; n < budget && n < entryCount; n++) {
+        uint32_t index = sweepAt;
+        sweepAt = (sweepAt + 1) % entryCount;
+        Entry &e = entries[index];
+        uint32_t window = e.kind == DNS_CACHE_ADDRESS ? DNS_CACHE_STALE_WINDOW * 1000 : 0;
+        if (e.used && dnsTimeReached(now, e.expiresAt + window)) {
+            unlinkSlot(findSlot(e.name, e.nameLength, e.hash));
+            releaseEntry(index);
+            dropped++;
+        }
+    }
+    endWrite();
+    return dropped;
+}
+
+DnsCacheStats DnsCache::stats() const {
+    DnsCacheStats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.expired = expired.load(std::memory_order_relaxed);
+    s.negativeHits = negativeHits.load(std::memory_order_relaxed);
+    s.staleHits = staleHits.load(std::memory_order_relaxed);
+    s.refreshes = refreshes.load(std::memory_order_relaxed);
+    s.inserts = inserts;
+    s.evictions = evictions;
+    return s;
+}
+
+void DnsCache::beginWrite() {
+    writeLock.lock();
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void DnsCache::endWrite() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    writeLock.unlock();
+}
+
+uint32_t DnsCache::takeEntry(uint32_t now) {
+    if (nextUnused < entryCount) {
+        return nextUnused++;
+    }
+
+    // CLOCK sweep: free or expired entries go first, referenced entries get
+    // a second chance. Readers set `referenced` without the lock, so two
+    // turns may still end on a live entry; it is evicted all the same.
+    uint32_t index = hand;
+    for (uint32_t n = 0; n < entryCount * 2; n++) {
+        index = hand;
+        hand = (hand + 1) % entryCount;
+        Entry &e = entries[index];
+        if (!e.used) {
+            return index;
+        }
+        if (e.referenced && !dnsTimeReached(now, e.expiresAt)) {
+            e.referenced = 0;
+            continue;
+        }
+        break;
+    }
+    Entry &e = entries[index];
+    if (e.used) {
+        unlinkSlot(findSlot(e.name, e.nameLength, e.hash));
+        releaseEntry(index);
+        evictions++;
+    }
+    return index;
+}
+
+void DnsCache::releaseEntry(uint32_t index) {
+    entries[index].used = 0;
+    count--;
+}
+
+void DnsCache::unlinkSlot(uint32_t slot) {
+    // Backward-shift deletion keeps linear probing free of tombstones.
+    uint32_t hole = slot;
+    uint32_t i = slot;
+    for (;;) {
+        i = (i + 1) & slotMask;
+        if (slots[i].entry == 0) {
+            break;
+        }
+        uint32_t home = slots[i].hash & slotMask;
+        bool inRange = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (inRange) {
+            continue;
+        }
+        slots[hole] = slots[i];
+        hole = i;
+    }
+    slots[hole].entry = 0;
+}
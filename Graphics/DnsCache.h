@@ -0,0 +1,153 @@
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "DnsPlatform.h"
+
+#ifndef DNS_CACHE_CAPACITY
+#define DNS_CACHE_CAPACITY      4096
+#endif
+
+#define DNS_NAME_MAX_LENGTH     253
+#define DNS_CACHE_MIN_TTL       5
+#define DNS_CACHE_MAX_TTL       86400
+// RFC 2308 section 5 suggests capping negative answers at a few hours.
+#define DNS_CACHE_MAX_NEGATIVE_TTL  3600
+// RFC 8767: how long past expiry an address may still be served, and the
+// TTL handed out with it.
+#define DNS_CACHE_STALE_WINDOW  86400
+#define DNS_CACHE_STALE_TTL     30
+// Refresh a name that keeps getting hits once this share of its TTL is left.
+#define DNS_CACHE_PREFETCH_PERCENT  10
+// One background refresh per name in this interval; covers the forwarder's
+// retries.
+#define DNS_CACHE_REFRESH_HOLDOFF_MS    5000
+// Entries sweep() looks at per call; the server sweeps every wheel tick.
+#define DNS_CACHE_SWEEP_BATCH   64
+
+enum DnsCacheKind {
+    DNS_CACHE_ADDRESS,
+    DNS_CACHE_NXDOMAIN,
+    DNS_CACHE_NODATA,
+    DNS_CACHE_SERVFAIL,
+};
+
+struct DnsCacheAnswer {
+    DnsCacheKind kind;
+    uint32_t addr;
+    uint32_t ttl;           // seconds left, DNS_CACHE_STALE_TTL when stale
+    bool stale;
+    bool refresh;           // caller should refresh the name in the background
+};
+
+struct DnsCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t expired;
+    uint32_t negativeHits;
+    uint32_t staleHits;
+    uint32_t refreshes;
+    uint32_t inserts;
+    uint32_t evictions;
+};
+
+// Fixed-capacity answer cache.
+// Entries live in one PSRAM arena and are found through an open-addressing
+// (linear probing) index keyed by the case-folded name hash. When the arena
+// is full a CLOCK hand picks the victim, preferring expired entries.
+//
+// Safe to share between DNS workers on both cores. Writers serialise on a
+// mutex and bump a sequence counter around each change; lookups take no lock
+// and retry if a change raced with them (a seqlock), so the common hit path
+// never stalls on the other core. Lookups leave expired entries for the
+// next writer or sweep() to reclaim.
+//
+// Besides addresses it holds negative answers (NXDOMAIN and NODATA for the
+// SOA-derived TTL, RFC 2308) and short-lived upstream failures. Addresses
+// stay servable for DNS_CACHE_STALE_WINDOW after expiry (RFC 8767); such
+// hits, and hits on hot names close to expiry, ask the caller to refresh.
+class DnsCache {
+public:
+    DnsCache();
+    ~DnsCache();
+
+    bool begin(uint32_t capacity = DNS_CACHE_CAPACITY);
+    void end();
+    void clear();
+
+    bool lookup(const char *name, uint32_t now, DnsCacheAnswer &answer);
+    bool insert(const char *name, uint32_t addr, uint32_t ttl, uint32_t now);
+    // A failure never displaces an address: stale data beats none.
+    bool insertNegative(const char *name, DnsCacheKind kind, uint32_t ttl, uint32_t now);
+    bool remove(const char *name);
+    // Drops what has expired for good among the next `budget` entries, in
+    // turn: negative answers at expiry, addresses past the stale window.
+    // Expiry times are 32-bit milliseconds and read as fresh again ~24.8
+    // days on, so every entry must come round well before then.
+    uint32_t sweep(uint32_t now, uint32_t budget = DNS_CACHE_SWEEP_BATCH);
+
+    uint32_t size() const { return count; }
+    uint32_t capacity() const { return entryCount; }
+    DnsCacheStats stats() const;
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t expiresAt;
+        uint32_t addr;
+        uint32_t ttl;
+        uint32_t refreshAt;     // 0 when no refresh was requested
+        uint8_t used;
+        uint8_t referenced;
+        uint8_t kind;
+        uint8_t nameLength;
+        char name[DNS_NAME_MAX_LENGTH + 1];
+    };
+
+    struct Slot {
+        uint32_t hash;
+        uint32_t entry;     // index + 1, 0 means empty
+    };
+
+    struct Snapshot {
+        Entry *entry;
+        uint32_t addr;
+        uint32_t expiresAt;
+        uint32_t ttl;
+        uint32_t refreshAt;
+        uint8_t kind;
+        uint8_t referenced;
+    };
+
+    int32_t findSlot(const char *name, size_t length, uint32_t hash) const;
+    bool read(const char *name, size_t length, uint32_t hash, Snapshot &snapshot);
+    bool store(const char *name, DnsCacheKind kind, uint32_t addr, uint32_t ttl, uint32_t now);
+    void beginWrite();
+    void endWrite();
+    uint32_t takeEntry(uint32_t now);
+    void releaseEntry(uint32_t index);
+    void unlinkSlot(uint32_t slot);
+
+    Entry *entries;
+    Slot *slots;
+    uint32_t entryCount;
+    uint32_t slotMask;
+    uint32_t count;
+    uint32_t nextUnused;
+    uint32_t hand;
+    uint32_t sweepAt;       // next entry sweep() looks at
+    uint32_t inserts;
+    uint32_t evictions;
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> hits;
+    std::atomic<uint32_t> misses;
+    std::atomic<uint32_t> expired;
+    std::atomic<uint32_t> negativeHits;
+    std::atomic<uint32_t> staleHits;
+    std::atomic<uint32_t> refreshes;
+    DnsLock writeLock;
+};
+
+#endif // DNSCACHE_H
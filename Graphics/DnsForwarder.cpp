@@ -0,0 +1,375 @@
+#include "DnsForwarder.h"
+#include "DnsPlatform.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define DNS_HEADER_SIZE 12
+
+// Offset just past the first question, or 0 if the query is malformed.
+// Queries never use compression, so a pointer here is rejected too.
+static uint16_t questionEndOffset(const uint8_t *packet, size_t length) {
+    size_t index = DNS_HEADER_SIZE;
+    while (index < length) {
+        uint8_t labelLength = packet[index];
+        if (labelLength == 0) {
+            index += 1 + 4;
+            return index <= length ? (uint16_t)index : 0;
+        }
+        if (labelLength & 0xC0) {
+            return 0;
+        }
+        index += labelLength + 1;
+    }
+    return 0;
+}
+
+static uint32_t questionHash(const uint8_t *packet, uint16_t end) {
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = DNS_HEADER_SIZE; i < end; i++) {
+        hash ^= (uint8_t)dnsToLower((char)packet[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Same query apart from the ID: the question compares case-insensitively,
+// flags and EDNS options (DO bit, payload size) exactly.
+static bool queryEquals(const uint8_t *a, const uint8_t *b, uint16_t questionEnd, size_t length) {
+    if (memcmp(a + 2, b + 2, DNS_HEADER_SIZE - 2) != 0 ||
+            memcmp(a + questionEnd, b + questionEnd, length - questionEnd) != 0) {
+        return false;
+    }
+    for (uint16_t i = DNS_HEADER_SIZE; i < questionEnd; i++) {
+        if (dnsToLower((char)a[i]) != dnsToLower((char)b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// DNS 0x20: the letters of the name are sent in random case, which the
+// answer must echo exactly, so a spoofed answer has a bit per letter more to
+// guess than the ID. Toggling with the same seed again restores the name.
+static void toggleCase(uint8_t *packet, uint16_t questionEnd, uint32_t seed) {
+    uint32_t bits = seed ? seed : 1;
+    uint8_t used = 0;
+    // Label lengths are at most 63, so never look like letters
+    for (uint16_t i = DNS_HEADER_SIZE; i + 4 < questionEnd; i++) {
+        uint8_t c = packet[i] | 0x20;
+        if (c < 'a' || c > 'z') {
+            continue;
+        }
+        if (used == 32) {
+            bits ^= bits << 13;
+            bits ^= bits >> 17;
+            bits ^= bits << 5;
+            used = 0;
+        }
+        if (bits & (1u << used++)) {
+            packet[i] ^= 0x20;
+        }
+    }
+}
+
+DnsForwarder::DnsForwarder()
+    : table(NULL), buffer(NULL), wheelTick(0), inFlight(0), sock(-1), upstreamAddr(0), upstreamPort(0),
+      callback(NULL), callbackArg(NULL) {
+    memset(wheel, -1, sizeof(wheel));
+    memset(&counters, 0, sizeof(counters));
+}
+
+DnsForwarder::~DnsForwarder() {
+    end();
+}
+
+bool DnsForwarder::begin(uint32_t addr, uint16_t port, DnsAnswerCallback cb, void *arg) {
+    end();
+
+    table = (Pending *)dnsAlloc(sizeof(Pending) * DNS_FORWARDER_MAX_PENDING);
+    buffer = (uint8_t *)dnsAlloc(DNS_FORWARDER_MAX_RESPONSE);
+    if (!table || !buffer) {
+        end();
+        return false;
+    }
+    for (int i = 0; i < DNS_FORWARDER_MAX_PENDING; i++) {
+        table[i].used = false;
+    }
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        end();
+        return false;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    upstreamAddr = addr;
+    upstreamPort = port;
+    callback = cb;
+    callbackArg = arg;
+    memset(wheel, -1, sizeof(wheel));
+    wheelTick = dnsMillis() / DNS_WHEEL_TICK_MS;
+    inFlight = 0;
+    memset(&counters, 0, sizeof(counters));
+    return true;
+}
+
+void DnsForwarder::end() {
+    if (sock >= 0) {
+        close(sock);
+        sock = -1;
+    }
+    if (table) {
+        // Nobody will answer these any more.
+        for (int i = 0; i < DNS_FORWARDER_MAX_PENDING; i++) {
+            if (table[i].used) {
+                fail(i);
+            }
+        }
+    }
+    dnsFree(table);
+    dnsFree(buffer);
+    table = NULL;
+    buffer = NULL;
+    inFlight = 0;
+}
+
+int DnsForwarder::findPending(const uint8_t *query, size_t length, uint16_t questionEnd, uint32_t hash) const {
+    for (int i = 0; i < DNS_FORWARDER_MAX_PENDING; i++) {
+        const Pending &p = table[i];
+        if (p.used && p.questionHash == hash && p.questionEnd == questionEnd && p.length == length &&
+                queryEquals(p.query, query, questionEnd, length)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int DnsForwarder::findUpstream(uint16_t id) const {
+    for (int i = 0; i < DNS_FORWARDER_MAX_PENDING; i++) {
+        if (table[i].used && table[i].upstreamId == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool DnsForwarder::forward(const DnsClient &client, const uint8_t *query, size_t length, uint32_t now) {
+    if (!table || length < DNS_HEADER_SIZE || length > DNS_FORWARDER_MAX_PACKET) {
+        return false;
+    }
+    uint16_t questionEnd = questionEndOffset(query, length);
+    if (questionEnd == 0) {
+        return false;
+    }
+    uint32_t hash = questionHash(query, questionEnd);
+
+    int index = findPending(query, length, questionEnd, hash);
+    if (index >= 0) {
+        Pending &p = table[index];
+        if (p.waiterCount >= DNS_FORWARDER_MAX_WAITERS) {
+            counters.dropped++;
+            return false;
+        }
+        p.waiters[p.waiterCount++] = client;
+        counters.coalesced++;
+        return true;
+    }
+
+    for (index = 0; index < DNS_FORWARDER_MAX_PENDING; index++) {
+        if (!table[index].used) {
+            break;
+        }
+    }
+    if (index == DNS_FORWARDER_MAX_PENDING) {
+        counters.dropped++;
+        return false;
+    }
+
+    Pending &p = table[index];
+    memcpy(p.query, query, length);
+    p.length = (uint16_t)length;
+    p.questionEnd = questionEnd;
+    p.questionHash = hash;
+    // Every bit of the ID random, and unique among the pending queries
+    do {
+        p.upstreamId = (uint16_t)dnsRandom();
+    } while (findUpstream(p.upstreamId) >= 0);
+    p.caseSeed = dnsRandom();
+    toggleCase(p.query, questionEnd, p.caseSeed);
+    p.query[0] = p.upstreamId >> 8;
+    p.query[1] = p.upstreamId & 0xFF;
+    p.waiters[0] = client;
+    p.waiterCount = 1;
+    p.attempts = 1;
+    p.used = true;
+    inFlight++;
+
+    sendUpstream(p);
+    counters.forwarded++;
+    schedule(index, now + DNS_FORWARDER_TIMEOUT_MS);
+    return true;
+}
+
+bool DnsForwarder::sendUpstream(Pending &p) {
+    struct sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons(upstreamPort);
+    to.sin_addr.s_addr = upstreamAddr;
+    // A full send buffer is handled like a lost packet: the timer retries.
+    return sendto(sock, p.query, p.length, 0, (struct sockaddr *)&to, sizeof(to)) == p.length;
+}
+
+void DnsForwarder::poll(uint32_t now) {
+    if (!table) {
+        return;
+    }
+
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        int n = recvfrom(sock, buffer, DNS_FORWARDER_MAX_RESPONSE, 0, (struct sockaddr *)&from, &fromLength);
+        if (n <= 0) {
+            break;
+        }
+        if (from.sin_addr.s_addr != upstreamAddr || from.sin_port != htons(upstreamPort)) {
+            continue;
+        }
+        handleResponse(buffer, (size_t)n);
+    }
+
+    // Walk every tick that elapsed since the last poll, at most one turn.
+    uint32_t tick = now / DNS_WHEEL_TICK_MS;
+    if ((int32_t)(tick - wheelTick) < 0) {
+        return;
+    }
+    uint32_t steps = tick - wheelTick + 1;
+    if (steps > DNS_WHEEL_SLOTS) {
+        steps = DNS_WHEEL_SLOTS;
+    }
+    for (uint32_t s = 0; s < steps; s++) {
+        int index = wheel[(wheelTick + s) % DNS_WHEEL_SLOTS];
+        while (index >= 0) {
+            int next = table[index].timerNext;
+            if (dnsTimeReached(now, table[index].deadline)) {
+                expire(index, now);
+            }
+            index = next;
+        }
+    }
+    wheelTick = tick + 1;
+}
+
+void DnsForwarder::handleResponse(uint8_t *packet, size_t length) {
+    if (length < DNS_HEADER_SIZE || !(packet[2] & 0x80)) {
+        return;
+    }
+    int index = findUpstream((packet[0] << 8) | packet[1]);
+    if (index < 0) {
+        return;
+    }
+    // The question must echo ours to the case of each letter, so a stale or
+    // spoofed answer is ignored. Clients get back the name they sent.
+    Pending &p = table[index];
+    if (length < p.questionEnd ||
+            memcmp(packet + DNS_HEADER_SIZE, p.query + DNS_HEADER_SIZE, p.questionEnd - DNS_HEADER_SIZE) != 0) {
+        return;
+    }
+    toggleCase(packet, p.questionEnd, p.caseSeed);
+    complete(index, packet, length);
+}
+
+void DnsForwarder::complete(int index, uint8_t *packet, size_t length) {
+    DnsClient waiters[DNS_FORWARDER_MAX_WAITERS];
+    uint8_t waiterCount = release(index, waiters);
+    counters.answered++;
+    for (uint8_t w = 0; w < waiterCount; w++) {
+        packet[0] = waiters[w].id >> 8;
+        packet[1] = waiters[w].id & 0xFF;
+        callback(waiters[w], packet, length, callbackArg);
+    }
+}
+
+uint8_t DnsForwarder::release(int index, DnsClient *waiters) {
+    // Waiters are copied out first so callbacks may forward new queries.
+    Pending &p = table[index];
+    unschedule(index);
+    memcpy(waiters, p.waiters, sizeof(DnsClient) * p.waiterCount);
+    p.used = false;
+    inFlight--;
+    return p.waiterCount;
+}
+
+void DnsForwarder::expire(int index, uint32_t now) {
+    Pending &p = table[index];
+    if (p.attempts <= DNS_FORWARDER_RETRIES) {
+        unschedule(index);
+        p.attempts++;
+        counters.retries++;
+        sendUpstream(p);
+        schedule(index, now + DNS_FORWARDER_TIMEOUT_MS);
+        return;
+    }
+
+    counters.timeouts++;
+    fail(index);
+}
+
+void DnsForwarder::fail(int index) {
+    // Header and first question of the query, turned into a SERVFAIL. Built
+    // before release() since a callback may reuse the slot.
+    Pending &p = table[index];
+    uint8_t *packet = buffer;
+    size_t length = p.questionEnd;
+    memcpy(packet, p.query, length);
+    toggleCase(packet, p.questionEnd, p.caseSeed);
+    packet[2] = (uint8_t)(0x80 | (packet[2] & 0x79));   // QR, keep opcode and RD
+    packet[3] = 0x80 | 2;                               // RA, SERVFAIL
+    packet[4] = 0;
+    packet[5] = 1;
+    memset(packet + 6, 0, 6);
+
+    DnsClient waiters[DNS_FORWARDER_MAX_WAITERS];
+    uint8_t waiterCount = release(index, waiters);
+    for (uint8_t w = 0; w < waiterCount; w++) {
+        packet[0] = waiters[w].id >> 8;
+        packet[1] = waiters[w].id & 0xFF;
+        callback(waiters[w], packet, length, callbackArg);
+    }
+}
+
+void DnsForwarder::schedule(int index, uint32_t deadline) {
+    // Round up so a slot is only visited once all of its deadlines passed.
+    uint32_t slot = ((deadline + DNS_WHEEL_TICK_MS - 1) / DNS_WHEEL_TICK_MS) % DNS_WHEEL_SLOTS;
+    Pending &p = table[index];
+    p.deadline = deadline;
+    p.timerSlot = (int8_t)slot;
+    p.timerPrev = -1;
+    p.timerNext = wheel[slot];
+    if (wheel[slot] >= 0) {
+        table[wheel[slot]].timerPrev = (int8_t)index;
+    }
+    wheel[slot] = (int8_t)index;
+}
+
+void DnsForwarder::unschedule(int index) {
+    Pending &p = table[index];
+    if (p.timerPrev >= 0) {
+        table[p.timerPrev].timerNext = p.timerNext;
+    } else {
+        wheel[p.timerSlot] = p.timerNext;
+    }
+    if (p.timerNext >= 0) {
+        table[p.timerNext].timerPrev = p.timerPrev;
+    }
+    p.timerPrev = -1;
+    p.timerNext = -1;
+}
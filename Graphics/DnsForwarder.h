@@ -0,0 +1,110 @@
+#ifndef DNSFORWARDER_H
+#define DNSFORWARDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DNS_FORWARDER_MAX_PENDING
+#define DNS_FORWARDER_MAX_PENDING   32      // at most 64
+#endif
+#define DNS_FORWARDER_MAX_WAITERS   8
+#define DNS_FORWARDER_MAX_PACKET    1232    // queries, with the OPT record added, over UDP or TCP
+#define DNS_FORWARDER_MAX_RESPONSE  4096    // at least the EDNS payload size sent upstream
+#define DNS_FORWARDER_TIMEOUT_MS    1500
+#define DNS_FORWARDER_RETRIES       2
+#define DNS_WHEEL_TICK_MS           100
+#define DNS_WHEEL_SLOTS             32      // must span DNS_FORWARDER_TIMEOUT_MS
+
+// A client waiting for an answer. `addr` is in network byte order, as
+// stored by IPAddress.
+struct DnsClient {
+    uint32_t addr;
+    uint16_t port;
+    uint16_t id;
+    uint16_t payloadSize;   // largest UDP answer it takes, 0 without EDNS
+    uint16_t connection;    // DnsTcpServer handle, 0 for UDP
+};
+
+struct DnsForwarderStats {
+    uint32_t forwarded;
+    uint32_t coalesced;
+    uint32_t answered;
+    uint32_t retries;
+    uint32_t timeouts;
+    uint32_t dropped;
+};
+
+// Called once per waiting client. `response` is already rewritten to the
+// client's transaction ID. If upstream never answered (or the forwarder is
+// shutting down) it is a SERVFAIL built from the original question, so the
+// callback always sees which name failed.
+typedef void (*DnsAnswerCallback)(const DnsClient &client, const uint8_t *response, size_t length, void *arg);
+
+// Non-blocking upstream forwarder.
+// Keeps one UDP socket open to the upstream resolver and multiplexes all
+// outstanding questions over it: each question goes out under a random
+// transaction ID with its name in random case, both of which the answer must
+// echo, identical queries share one upstream request, and retries/timeouts
+// run off a timer wheel from poll().
+// Uses BSD sockets, so the same code runs on lwIP and on POSIX hosts.
+class DnsForwarder {
+public:
+    DnsForwarder();
+    ~DnsForwarder();
+
+    bool begin(uint32_t upstreamAddr, uint16_t upstreamPort, DnsAnswerCallback cb, void *arg = NULL);
+    void end();
+
+    // Returns false if the query is malformed or the pending table is full.
+    bool forward(const DnsClient &client, const uint8_t *query, size_t length, uint32_t now);
+
+    // Drains upstream responses and fires expired timers. Never blocks.
+    void poll(uint32_t now);
+
+    int socketFd() const { return sock; }
+    uint32_t pending() const { return inFlight; }
+    const DnsForwarderStats &stats() const { return counters; }
+
+private:
+    struct Pending {
+        uint8_t query[DNS_FORWARDER_MAX_PACKET];
+        uint16_t length;
+        uint16_t questionEnd;
+        uint16_t upstreamId;
+        uint8_t attempts;
+        uint8_t waiterCount;
+        uint32_t questionHash;
+        uint32_t caseSeed;      // letters of the name toggled upstream, see toggleCase()
+        uint32_t deadline;
+        int8_t timerPrev;
+        int8_t timerNext;
+        int8_t timerSlot;
+        bool used;
+        DnsClient waiters[DNS_FORWARDER_MAX_WAITERS];
+    };
+
+    int findPending(const uint8_t *query, size_t length, uint16_t questionEnd, uint32_t hash) const;
+    int findUpstream(uint16_t id) const;
+    bool sendUpstream(Pending &p);
+    void handleResponse(uint8_t *packet, size_t length);
+    void complete(int index, uint8_t *packet, size_t length);
+    uint8_t release(int index, DnsClient *waiters);
+    void schedule(int index, uint32_t deadline);
+    void unschedule(int index);
+    void expire(int index, uint32_t now);
+    void fail(int index);
+
+    Pending *table;
+    uint8_t *buffer;        // responses as received, and synthesized failures
+    int8_t wheel[DNS_WHEEL_SLOTS];
+    uint32_t wheelTick;
+    uint32_t inFlight;
+    int sock;
+    uint32_t upstreamAddr;
+    uint16_t upstreamPort;
+    DnsAnswerCallback callback;
+    void *callbackArg;
+    DnsForwarderStats counters;
+};
+
+#endif // DNSFORWARDER_H
@@ -0,0 +1,585 @@
+#include "DnsHistory.h"
+#include "DnsPlatform.h"
+#include <string.h>
+#include <stdio.h>
+
+#define LOG_MAGIC           0x314C4844u     // "DHL1"
+#define INDEX_MAGIC         0x32494844u     // "DHI2"
+#define JOURNAL_MAGIC       0x324A4844u     // "DHJ2"
+#define LOG_HEADER_SIZE     8               // magic, stamp
+#define JOURNAL_CHUNK       32              // entries read or written at once
+
+// Second hash of a name, unrelated to dnsNameHash(), so that two names are
+// only taken for one when both 32-bit hashes match.
+static uint32_t nameCheck(const char *name, size_t length) {
+    uint32_t h = (uint32_t)length;
+    for (size_t i = 0; i < length; i++) {
+        h = (h ^ (uint8_t)dnsToLower(name[i])) * 0x5BD1E995u;
+        h ^= h >> 15;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static uint32_t journalSum(uint32_t sum, const void *data, size_t size) {
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        sum = (sum ^ p[i]) * 16777619u;
+    }
+    return sum;
+}
+
+DnsHistory::DnsHistory()
+    : fs(NULL), slots(NULL), dirty(NULL), dirtyCount(0), snapshotDue(false), slotMask(0), capacityLimit(0),
+      count(0), logSize(0), liveBytes(0), changed(0), stamp(0), journalEnd(0) {
+    memset(&counters, 0, sizeof(counters));
+}
+
+DnsHistory::~DnsHistory() {
+    end();
+}
+
+bool DnsHistory::begin(fs::FS &filesystem, uint32_t capacity) {
+    end();
+    if (capacity == 0) {
+        return false;
+    }
+
+    // Same load factor as the answer cache: at most half the slots in use.
+    uint32_t slotCount = 1;
+    while (slotCount < capacity * 2) {
+        slotCount <<= 1;
+    }
+    slots = (Slot *)dnsAlloc(sizeof(Slot) * slotCount);
+    dirty = (uint32_t *)dnsAlloc(sizeof(uint32_t) * DNS_HISTORY_DIRTY_MAX);
+    if (!slots || !dirty) {
+        end();
+        return false;
+    }
+    fs = &filesystem;
+    slotMask = slotCount - 1;
+    capacityLimit = capacity;
+    dirtyCount = 0;
+    snapshotDue = false;
+    changed = 0;
+    memset(&counters, 0, sizeof(counters));
+
+    if (!openLog()) {
+        end();
+        return false;
+    }
+    uint32_t from = loadIndex() ? logSize : LOG_HEADER_SIZE;
+    if (from == LOG_HEADER_SIZE) {
+        memset(slots, 0, sizeof(Slot) * slotCount);
+        count = 0;
+        liveBytes = 0;
+        snapshotDue = true;
+    }
+    if (!replay(from)) {
+        // Torn tail after a power cut: rewrite the log without it.
+        if (!compact()) {
+            end();
+            return false;
+        }
+    }
+    if (from != logSize || snapshotDue) {
+        saveIndex();
+    }
+    return true;
+}
+
+void DnsHistory::end() {
+    fileLock.lock();
+    if (log) {
+        log.flush();
+        if (slots && (changed > 0 || snapshotDue)) {
+            saveIndex();
+        }
+        log.close();
+    }
+    tableLock.lock();
+    dnsFree(slots);
+    dnsFree(dirty);
+    slots = NULL;
+    dirty = NULL;
+    dirtyCount = 0;
+    slotMask = 0;
+    count = 0;
+    tableLock.unlock();
+    fileLock.unlock();
+}
+
+bool DnsHistory::lookup(const char *name, uint32_t &addr) {
+    size_t length;
+    uint32_t hash = dnsNameHash(name, &length);
+    uint32_t check = nameCheck(name, length);
+    tableLock.lock();
+    if (!slots) {
+        tableLock.unlock();
+        return false;
+    }
+    counters.lookups++;
+    int32_t slot = findSlot(hash, check);
+    if (slot >= 0) {
+        addr = slots[slot].addr;
+        counters.hits++;
+    }
+    tableLock.unlock();
+    return slot >= 0;
+}
+
+bool DnsHistory::record(const char *name, uint32_t addr, uint32_t timestamp) {
+    size_t length;
+    uint32_t hash = dnsNameHash(name, &length);
+    if (length == 0 || length > DNS_NAME_MAX_LENGTH) {
+        return false;
+    }
+    uint32_t check = nameCheck(name, length);
+
+    // Only holders of fileLock change the table, so it can be read here
+    // without tableLock, and lookups go on while the record is written.
+    fileLock.lock();
+    if (!slots) {
+        fileLock.unlock();
+        return false;
+    }
+    // A repeat of a known answer is the common case; don't touch the card.
+    int32_t slot = findSlot(hash, check);
+    if (slot >= 0 && slots[slot].addr == addr) {
+        fileLock.unlock();
+        return true;
+    }
+    if (slot < 0 && count >= capacityLimit) {
+        tableLock.lock();
+        counters.full++;
+        tableLock.unlock();
+        fileLock.unlock();
+        return false;
+    }
+
+    uint32_t offset;
+    bool ok = appendRecord(name, length, hash, addr, timestamp, offset);
+    if (ok) {
+        tableLock.lock();
+        indexRecord(hash, check, offset, addr, length);
+        changed++;
+        counters.appends++;
+        tableLock.unlock();
+    }
+    fileLock.unlock();
+    return ok;
+}
+
+void DnsHistory::flush() {
+    fileLock.lock();
+    if (slots) {
+        log.flush();
+        if (logSize >= DNS_HISTORY_COMPACT_SIZE && liveBytes < (logSize - LOG_HEADER_SIZE) / 2) {
+            compact();
+        } else if (changed >= DNS_HISTORY_SAVE_INTERVAL) {
+            saveIndex();
+        }
+    }
+    fileLock.unlock();
+}
+
+uint32_t DnsHistory::importTextLog(const char *path) {
+    if (!slots) {
+        return 0;
+    }
+    File text = fs->open(path, FILE_READ);
+    if (!text) {
+        return 0;
+    }
+    uint32_t imported = 0;
+    char line[DNS_NAME_MAX_LENGTH + 64];
+    while (text.available()) {
+        size_t n = text.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[n] = '\0';
+        char *query = strstr(line, "Query: ");
+        char *ip = query ? strstr(query, " IP: ") : NULL;
+        unsigned a, b, c, d;
+        if (!ip || sscanf(ip + 5, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+            continue;
+        }
+        *ip = '\0';
+        uint32_t addr = a | (b << 8) | (c << 16) | (d << 24);
+        if (record(query + 7, addr, (uint32_t)strtoul(line, NULL, 10))) {
+            imported++;
+        }
+    }
+    text.close();
+    return imported;
+}
+
+DnsHistoryStats DnsHistory::stats() const {
+    DnsHistoryStats s = counters;
+    s.names = count;
+    return s;
+}
+
+// Opened for update rather than append, so records go where the table
+// says the log ends and not after a torn tail.
+bool DnsHistory::openLog() {
+    if (fs->exists(DNS_HISTORY_LOG_FILE)) {
+        log = fs->open(DNS_HISTORY_LOG_FILE, "r+");
+        if (!log) {
+            return false;
+        }
+        logSize = log.size();
+        uint32_t header[2];
+        if (logSize >= LOG_HEADER_SIZE && log.seek(0) &&
+            log.read((uint8_t *)header, sizeof(header)) == sizeof(header) && header[0] == LOG_MAGIC) {
+            stamp = header[1];
+            return true;
+        }
+        // Not ours; start over rather than append to it.
+        log.close();
+        fs->remove(DNS_HISTORY_LOG_FILE);
+    }
+    log = fs->open(DNS_HISTORY_LOG_FILE, "w+");
+    if (!log) {
+        return false;
+    }
+    uint32_t header[2] = {LOG_MAGIC, dnsRandom()};
+    if (log.write((const uint8_t *)header, sizeof(header)) != sizeof(header)) {
+        log.close();
+        return false;
+    }
+    log.flush();
+    stamp = header[1];
+    logSize = LOG_HEADER_SIZE;
+    return true;
+}
+
+bool DnsHistory::loadIndex() {
+    File index = fs->open(DNS_HISTORY_INDEX_FILE, FILE_READ);
+    if (!index) {
+        return false;
+    }
+    IndexHeader header;
+    size_t slotBytes = sizeof(Slot) * (slotMask + 1);
+    bool ok = index.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == INDEX_MAGIC && header.stamp == stamp &&
+              header.slotCount == slotMask + 1 && header.count <= capacityLimit &&
+              header.logSize >= LOG_HEADER_SIZE && header.logSize <= logSize &&
+              index.read((uint8_t *)slots, slotBytes) == slotBytes;
+    if (ok) {
+        uint32_t logLimit = logSize;
+        count = header.count;
+        liveBytes = header.liveBytes;
+        logSize = header.logSize;
+        journalEnd = sizeof(header) + slotBytes;
+        loadJournal(index, logLimit);
+    }
+    index.close();
+    return ok;
+}
+
+// Applies the batches saved after the snapshot, up to the first one that is
+// torn or belongs to another log.
+void DnsHistory::loadJournal(File &index, uint32_t logLimit) {
+    JournalEntry chunk[JOURNAL_CHUNK];
+    for (;;) {
+        JournalHeader header;
+        if (!index.seek(journalEnd) ||
+            index.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+            header.magic != JOURNAL_MAGIC || header.stamp != stamp || header.entries > slotMask + 1 ||
+            header.count > capacityLimit || header.logSize < logSize || header.logSize > logLimit) {
+            return;
+        }
+        // Checked as a whole before any of it is applied.
+        uint32_t sum = 2166136261u;
+        for (uint32_t done = 0; done < header.entries;) {
+            uint32_t n = header.entries - done < JOURNAL_CHUNK ? header.entries - done : JOURNAL_CHUNK;
+            size_t bytes = n * sizeof(JournalEntry);
+            if (index.read((uint8_t *)chunk, bytes) != bytes) {
+                return;
+            }
+            for (uint32_t k = 0; k < n; k++) {
+                if (chunk[k].slot > slotMask) {
+                    return;
+                }
+            }
+            sum = journalSum(sum, chunk, bytes);
+            done += n;
+        }
+        if (sum != header.sum || !index.seek(journalEnd + sizeof(header))) {
+            return;
+        }
+        for (uint32_t done = 0; done < header.entries;) {
+            uint32_t n = header.entries - done < JOURNAL_CHUNK ? header.entries - done : JOURNAL_CHUNK;
+            size_t bytes = n * sizeof(JournalEntry);
+            if (index.read((uint8_t *)chunk, bytes) != bytes) {
+                return;
+            }
+            for (uint32_t k = 0; k < n; k++) {
+                slots[chunk[k].slot] = chunk[k].value;
+            }
+            done += n;
+        }
+        count = header.count;
+        liveBytes = header.liveBytes;
+        logSize = header.logSize;
+        journalEnd += sizeof(header) + header.entries * sizeof(JournalEntry);
+    }
+}
+
+// Appends the slots changed since the last save, falling back to a new
+// snapshot when they were not all tracked or the journal has grown as big
+// as the snapshot. A batch covers the log up to logSize, so the log goes
+// to the card first.
+bool DnsHistory::saveIndex() {
+    log.flush();
+    size_t snapshotBytes = sizeof(IndexHeader) + sizeof(Slot) * (slotMask + 1);
+    size_t batchBytes = sizeof(JournalHeader) + dirtyCount * sizeof(JournalEntry);
+    if (snapshotDue || journalEnd + batchBytes > snapshotBytes * 2) {
+        return saveSnapshot();
+    }
+    if (dirtyCount == 0) {
+        changed = 0;
+        return true;
+    }
+    File index = fs->open(DNS_HISTORY_INDEX_FILE, "r+");
+    if (!index) {
+        return saveSnapshot();
+    }
+
+    JournalHeader header;
+    header.magic = JOURNAL_MAGIC;
+    header.stamp = stamp;
+    header.entries = dirtyCount;
+    header.count = count;
+    header.logSize = logSize;
+    header.liveBytes = liveBytes;
+    header.sum = 2166136261u;
+    JournalEntry chunk[JOURNAL_CHUNK];
+    for (int pass = 0; pass < 2; pass++) {
+        bool ok = pass == 0 || (index.seek(journalEnd) &&
+                                index.write((const uint8_t *)&header, sizeof(header)) == sizeof(header));
+        for (uint32_t done = 0; ok && done < dirtyCount;) {
+            uint32_t n = dirtyCount - done < JOURNAL_CHUNK ? dirtyCount - done : JOURNAL_CHUNK;
+            for (uint32_t k = 0; k < n; k++) {
+                chunk[k].slot = dirty[done + k];
+                chunk[k].value = slots[dirty[done + k]];
+            }
+            size_t bytes = n * sizeof(JournalEntry);
+            if (pass == 0) {
+                header.sum = journalSum(header.sum, chunk, bytes);
+            } else {
+                ok = index.write((const uint8_t *)chunk, bytes) == bytes;
+            }
+            done += n;
+        }
+        if (!ok) {
+            // Left for the next save to write over; the log still has it all.
+            index.close();
+            return false;
+        }
+    }
+    index.close();
+    journalEnd += batchBytes;
+    dirtyCount = 0;
+    changed = 0;
+    return true;
+}
+
+bool DnsHistory::saveSnapshot() {
+    // Write aside and swap, so a power cut leaves either index intact.
+    File index = fs->open(DNS_HISTORY_TEMP_FILE, FILE_WRITE);
+    if (!index) {
+        return false;
+    }
+    IndexHeader header;
+    header.magic = INDEX_MAGIC;
+    header.stamp = stamp;
+    header.slotCount = slotMask + 1;
+    header.count = count;
+    header.logSize = logSize;
+    header.liveBytes = liveBytes;
+    size_t slotBytes = sizeof(Slot) * (slotMask + 1);
+    bool ok = index.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              index.write((const uint8_t *)slots, slotBytes) == slotBytes;
+    index.close();
+    if (!ok) {
+        fs->remove(DNS_HISTORY_TEMP_FILE);
+        return false;
+    }
+    fs->remove(DNS_HISTORY_INDEX_FILE);
+    if (!fs->rename(DNS_HISTORY_TEMP_FILE, DNS_HISTORY_INDEX_FILE)) {
+        return false;
+    }
+    journalEnd = sizeof(header) + slotBytes;
+    dirtyCount = 0;
+    snapshotDue = false;
+    changed = 0;
+    return true;
+}
+
+bool DnsHistory::replay(uint32_t from) {
+    uint32_t end = log.size();
+    uint32_t offset = from;
+    char name[DNS_NAME_MAX_LENGTH + 1];
+    log.seek(offset);
+    while (offset < end) {
+        RecordHeader header;
+        if (end - offset < sizeof(header) ||
+            log.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+            header.nameLength == 0 || header.nameLength > DNS_NAME_MAX_LENGTH ||
+            end - offset - sizeof(header) < header.nameLength ||
+            log.read((uint8_t *)name, header.nameLength) != header.nameLength) {
+            break;
+        }
+        name[header.nameLength] = '\0';
+        uint32_t hash = dnsNameHash(name);
+        if ((hash & 0xFFFF) != header.check) {
+            break;
+        }
+        if (!indexRecord(hash, nameCheck(name, header.nameLength), offset, header.addr, header.nameLength)) {
+            counters.full++;
+        }
+        offset += sizeof(header) + header.nameLength;
+    }
+    logSize = offset;
+    return offset == end;
+}
+
+// Runs under fileLock, reading the table as it goes; lookups only wait for
+// the offsets to be swapped at the end.
+bool DnsHistory::compact() {
+    uint32_t slotCount = slotMask + 1;
+    uint32_t *moved = (uint32_t *)dnsAlloc(sizeof(uint32_t) * slotCount);
+    File out = fs->open(DNS_HISTORY_TEMP_FILE, FILE_WRITE);
+    if (!moved || !out) {
+        dnsFree(moved);
+        if (out) {
+            out.close();
+        }
+        return false;
+    }
+
+    uint32_t newStamp = dnsRandom();
+    uint32_t header[2] = {LOG_MAGIC, newStamp};
+    uint32_t position = LOG_HEADER_SIZE;
+    bool ok = out.write((const uint8_t *)header, sizeof(header)) == sizeof(header);
+    uint8_t buffer[sizeof(RecordHeader) + DNS_NAME_MAX_LENGTH];
+    for (uint32_t i = 0; ok && i < slotCount; i++) {
+        if (slots[i].offset == 0) {
+            continue;
+        }
+        RecordHeader *record = (RecordHeader *)buffer;
+        ok = log.seek(slots[i].offset) &&
+             log.read(buffer, sizeof(RecordHeader)) == sizeof(RecordHeader) &&
+             record->nameLength <= DNS_NAME_MAX_LENGTH &&
+             log.read(buffer + sizeof(RecordHeader), record->nameLength) == record->nameLength;
+        size_t size = sizeof(RecordHeader) + (ok ? record->nameLength : 0);
+        ok = ok && out.write(buffer, size) == size;
+        moved[i] = position;
+        position += size;
+    }
+    out.close();
+    if (!ok) {
+        fs->remove(DNS_HISTORY_TEMP_FILE);
+        dnsFree(moved);
+        return false;
+    }
+
+    log.close();
+    fs->remove(DNS_HISTORY_LOG_FILE);
+    ok = fs->rename(DNS_HISTORY_TEMP_FILE, DNS_HISTORY_LOG_FILE) && openLog();
+    tableLock.lock();
+    if (ok) {
+        for (uint32_t i = 0; i < slotCount; i++) {
+            if (slots[i].offset != 0) {
+                slots[i].offset = moved[i];
+            }
+        }
+        logSize = position;
+        liveBytes = position - LOG_HEADER_SIZE;
+        counters.compactions++;
+    } else {
+        // The old log is gone; start a fresh, empty one.
+        memset(slots, 0, sizeof(Slot) * slotCount);
+        count = 0;
+        liveBytes = 0;
+    }
+    tableLock.unlock();
+    if (!ok) {
+        ok = openLog();
+    }
+    // The stamp changed, so the old snapshot and journal no longer apply.
+    snapshotDue = true;
+    saveIndex();
+    dnsFree(moved);
+    return ok;
+}
+
+bool DnsHistory::appendRecord(const char *name, size_t length, uint32_t hash, uint32_t addr,
+                              uint32_t timestamp, uint32_t &offset) {
+    uint8_t buffer[sizeof(RecordHeader) + DNS_NAME_MAX_LENGTH];
+    RecordHeader *header = (RecordHeader *)buffer;
+    header->timestamp = timestamp;
+    header->addr = addr;
+    header->nameLength = (uint16_t)length;
+    header->check = (uint16_t)(hash & 0xFFFF);
+    for (size_t i = 0; i < length; i++) {
+        buffer[sizeof(RecordHeader) + i] = (uint8_t)dnsToLower(name[i]);
+    }
+
+    // Compaction reads move the file position; appends always go to the end.
+    size_t size = sizeof(RecordHeader) + length;
+    if (!log.seek(logSize) || log.write(buffer, size) != size) {
+        return false;
+    }
+    offset = logSize;
+    logSize += size;
+    return true;
+}
+
+int32_t DnsHistory::findSlot(uint32_t hash, uint32_t check) const {
+    uint32_t i = hash & slotMask;
+    while (slots[i].offset != 0) {
+        if (slots[i].hash == hash && slots[i].check == check) {
+            return (int32_t)i;
+        }
+        i = (i + 1) & slotMask;
+    }
+    return -1;
+}
+
+bool DnsHistory::indexRecord(uint32_t hash, uint32_t check, uint32_t offset, uint32_t addr, size_t length) {
+    int32_t slot = findSlot(hash, check);
+    if (slot >= 0) {
+        slots[slot].offset = offset;
+        slots[slot].addr = addr;
+        markDirty((uint32_t)slot);
+        return true;
+    }
+    if (count >= capacityLimit) {
+        return false;
+    }
+    uint32_t i = hash & slotMask;
+    while (slots[i].offset != 0) {
+        i = (i + 1) & slotMask;
+    }
+    slots[i].hash = hash;
+    slots[i].check = check;
+    slots[i].offset = offset;
+    slots[i].addr = addr;
+    count++;
+    liveBytes += sizeof(RecordHeader) + length;
+    markDirty(i);
+    return true;
+}
+
+void DnsHistory::markDirty(uint32_t slot) {
+    if (dirtyCount < DNS_HISTORY_DIRTY_MAX) {
+        dirty[dirtyCount++] = slot;
+    } else {
+        snapshotDue = true;
+    }
+}
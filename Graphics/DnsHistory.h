@@ -0,0 +1,148 @@
+#ifndef DNSHISTORY_H
+#define DNSHISTORY_H
+
+#include <FS.h>
+#include "DnsCache.h"
+#include "DnsPlatform.h"
+
+#define DNS_HISTORY_LOG_FILE        "/dnshist.bin"
+#define DNS_HISTORY_INDEX_FILE      "/dnshist.idx"
+#define DNS_HISTORY_TEMP_FILE       "/dnshist.tmp"
+
+#ifndef DNS_HISTORY_CAPACITY
+#define DNS_HISTORY_CAPACITY        65536
+#endif
+
+// Persist the index once this many names have changed since the last save.
+#define DNS_HISTORY_SAVE_INTERVAL   1024
+// Slots remembered for the next save; past this it rewrites the whole index.
+#define DNS_HISTORY_DIRTY_MAX       (DNS_HISTORY_SAVE_INTERVAL * 2)
+// Rewrite the log once it is this big and mostly superseded records.
+#define DNS_HISTORY_COMPACT_SIZE    (1024 * 1024)
+
+struct DnsHistoryStats {
+    uint32_t names;
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t appends;
+    uint32_t compactions;
+    uint32_t full;
+};
+
+// Persistent name -> address history on the SD card.
+//
+// DNS_HISTORY_LOG_FILE is an append-only sequence of records:
+//     uint32 timestamp, uint32 addr, uint16 nameLength, uint16 check, name
+// where `check` is the low half of the name hash and catches torn writes.
+// A record is only appended when a name is new or its address changed. The
+// file starts with a magic word and a random stamp that is renewed whenever
+// the log is rewritten.
+//
+// The index is an open-addressing table (hash, check, log offset, addr) that
+// lives in PSRAM while running. Names are told apart by their two 32-bit
+// hashes rather than by reading them back, so a lookup never touches the
+// card. DNS_HISTORY_INDEX_FILE holds a snapshot of the table followed by a
+// journal: each save appends only the slots changed since the one before,
+// with the log size it covers and a checksum, and the snapshot is only
+// rewritten once the journal has grown as big as it. begin() loads the
+// snapshot, applies every complete batch and replays the records written
+// after the last one, or rebuilds the table from the log if it is missing.
+//
+// All methods are safe to call from several tasks. Lookups only wait for
+// the table itself, never for the card.
+class DnsHistory {
+public:
+    DnsHistory();
+    ~DnsHistory();
+
+    bool begin(fs::FS &fs, uint32_t capacity = DNS_HISTORY_CAPACITY);
+    void end();
+
+    bool lookup(const char *name, uint32_t &addr);
+    bool record(const char *name, uint32_t addr, uint32_t timestamp);
+
+    // Pushes buffered records to the card and saves the index when due.
+    void flush();
+
+    // Converts a text query log ("<time> Query: <name> IP: <a.b.c.d>" lines)
+    // written by DnsQueryLog or older firmware.
+    uint32_t importTextLog(const char *path);
+
+    uint32_t size() const { return count; }
+    DnsHistoryStats stats() const;
+
+private:
+    struct RecordHeader {
+        uint32_t timestamp;
+        uint32_t addr;
+        uint16_t nameLength;
+        uint16_t check;
+    };
+
+    struct IndexHeader {
+        uint32_t magic;
+        uint32_t stamp;     // must match the log it was built from
+        uint32_t slotCount;
+        uint32_t count;
+        uint32_t logSize;
+        uint32_t liveBytes;
+    };
+
+    // Followed by `entries` JournalEntry
+    struct JournalHeader {
+        uint32_t magic;
+        uint32_t stamp;
+        uint32_t entries;
+        uint32_t count;
+        uint32_t logSize;
+        uint32_t liveBytes;
+        uint32_t sum;       // of the entries
+    };
+
+    struct Slot {
+        uint32_t hash;
+        uint32_t check;     // second hash of the name
+        uint32_t offset;    // 0 means empty; the log starts with a magic word
+        uint32_t addr;
+    };
+
+    struct JournalEntry {
+        uint32_t slot;
+        Slot value;
+    };
+
+    bool loadIndex();
+    void loadJournal(File &index, uint32_t logLimit);
+    bool saveIndex();
+    bool saveSnapshot();
+    bool replay(uint32_t from);
+    bool compact();
+    bool openLog();
+    bool appendRecord(const char *name, size_t length, uint32_t hash, uint32_t addr, uint32_t timestamp, uint32_t &offset);
+    int32_t findSlot(uint32_t hash, uint32_t check) const;
+    bool indexRecord(uint32_t hash, uint32_t check, uint32_t offset, uint32_t addr, size_t length);
+    void markDirty(uint32_t slot);
+
+    fs::FS *fs;
+    File log;
+    Slot *slots;
+    uint32_t *dirty;
+    uint32_t dirtyCount;
+    bool snapshotDue;
+    uint32_t slotMask;
+    uint32_t capacityLimit;
+    uint32_t count;
+    uint32_t logSize;
+    uint32_t liveBytes;
+    uint32_t changed;
+    uint32_t stamp;
+    uint32_t journalEnd;
+    // `tableLock` guards the table and the counters and is only held for
+    // work in memory; `fileLock` serialises everything that touches the
+    // card, and is taken first. Only holders of `fileLock` change the table.
+    DnsLock tableLock;
+    DnsLock fileLock;
+    DnsHistoryStats counters;
+};
+
+#endif // DNSHISTORY_H
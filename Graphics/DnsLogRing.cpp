@@ -0,0 +1,107 @@
+#include "DnsLogRing.h"
+#include "DnsPlatform.h"
+#include <string.h>
+#include <new>
+
+DnsLogRing::DnsLogRing()
+    : sequence(NULL), records(NULL), mask(0), enqueuePos(0), dequeuePos(0), droppedCount(0) {
+}
+
+DnsLogRing::~DnsLogRing() {
+    end();
+}
+
+bool DnsLogRing::begin(uint32_t capacity) {
+    end();
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    sequence = (std::atomic<uint32_t> *)malloc(sizeof(std::atomic<uint32_t>) * capacity);
+    records = (DnsLogRecord *)dnsAlloc(sizeof(DnsLogRecord) * capacity);
+    if (!sequence || !records) {
+        end();
+        return false;
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+        new (&sequence[i]) std::atomic<uint32_t>(i);
+    }
+    mask = capacity - 1;
+    enqueuePos.store(0);
+    dequeuePos.store(0);
+    droppedCount.store(0);
+    return true;
+}
+
+void DnsLogRing::end() {
+    free(sequence);
+    dnsFree(records);
+    sequence = NULL;
+    records = NULL;
+    mask = 0;
+}
+
+bool DnsLogRing::push(const char *name, uint32_t addr, uint32_t timestamp) {
+    if (!records) {
+        return false;
+    }
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t seq = sequence[pos & mask].load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    DnsLogRecord &r = records[pos & mask];
+    size_t length = strlen(name);
+    if (length > DNS_LOG_NAME_MAX) {
+        length = DNS_LOG_NAME_MAX;
+    }
+    memcpy(r.name, name, length);
+    r.name[length] = '\0';
+    r.nameLength = (uint8_t)length;
+    r.addr = addr;
+    r.timestamp = timestamp;
+    sequence[pos & mask].store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool DnsLogRing::pop(DnsLogRecord &record) {
+    if (!records) {
+        return false;
+    }
+    uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t seq = sequence[pos & mask].load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    const DnsLogRecord &r = records[pos & mask];
+    record.timestamp = r.timestamp;
+    record.addr = r.addr;
+    record.nameLength = r.nameLength;
+    memcpy(record.name, r.name, r.nameLength + 1);
+    sequence[pos & mask].store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+uint32_t DnsLogRing::size() const {
+    return enqueuePos.load(std::memory_order_relaxed) - dequeuePos.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,46 @@
+#ifndef DNSLOGRING_H
+#define DNSLOGRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define DNS_LOG_NAME_MAX    253
+
+struct DnsLogRecord {
+    uint32_t timestamp;
+    uint32_t addr;
+    uint8_t nameLength;
+    char name[DNS_LOG_NAME_MAX + 1];
+};
+
+// Bounded lock-free queue of log records (Vyukov's sequence-per-cell ring).
+// Any number of DNS workers may push; the SD writer task pops. push() never
+// blocks: when the ring is full the record is counted as dropped.
+// The sequence counters stay in internal RAM because atomics on PSRAM are
+// not supported; the record payloads go to PSRAM.
+class DnsLogRing {
+public:
+    DnsLogRing();
+    ~DnsLogRing();
+
+    bool begin(uint32_t capacity);     // power of two
+    void end();
+
+    bool push(const char *name, uint32_t addr, uint32_t timestamp);
+    bool pop(DnsLogRecord &record);
+
+    uint32_t size() const;
+    uint32_t capacity() const { return mask + 1; }
+    uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> *sequence;
+    DnsLogRecord *records;
+    uint32_t mask;
+    std::atomic<uint32_t> enqueuePos;
+    std::atomic<uint32_t> dequeuePos;
+    std::atomic<uint32_t> droppedCount;
+};
+
+#endif // DNSLOGRING_H
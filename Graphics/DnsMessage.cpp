@@ -0,0 +1,627 @@
+#include "DnsMessage.h"
+#include "DnsPlatform.h"
+#include <string.h>
+
+#define DNS_MAX_POINTER_HOPS    16
+#define DNS_MAX_WIRE_NAME       255
+
+// Walks the labels of a name, following compression pointers.
+class LabelWalker {
+public:
+    LabelWalker(const uint8_t *packet, uint16_t packetLength, uint16_t offset)
+        : packet(packet), packetLength(packetLength), position(offset), hops(0), total(0), failed(false) {}
+
+    // Returns true with the next label, false at the root or on error.
+    bool next(const uint8_t *&label, uint8_t &length) {
+        while (position < packetLength) {
+            uint8_t len = packet[position];
+            if ((len & 0xC0) == 0xC0) {
+                if (position + 1 >= packetLength || ++hops > DNS_MAX_POINTER_HOPS) {
+                    break;
+                }
+                position = ((len & 0x3F) << 8) | packet[position + 1];
+                continue;
+            }
+            if (len & 0xC0) {
+                break;
+            }
+            if (len == 0) {
+                return false;
+            }
+            total += len + 1;
+            if (total > DNS_MAX_WIRE_NAME || position + 1 + len > packetLength) {
+                break;
+            }
+            label = packet + position + 1;
+            length = len;
+            position += len + 1;
+            return true;
+        }
+        failed = true;
+        return false;
+    }
+
+    bool ok() const { return !failed; }
+
+private:
+    const uint8_t *packet;
+    uint16_t packetLength;
+    uint16_t position;
+    uint8_t hops;
+    uint16_t total;
+    bool failed;
+};
+
+// Offset just past the name as stored at `offset` (a pointer ends it), or 0.
+static uint16_t skipName(const uint8_t *packet, uint16_t packetLength, uint16_t offset) {
+    LabelWalker walker(packet, packetLength, offset);
+    const uint8_t *label;
+    uint8_t length;
+    while (walker.next(label, length)) {
+    }
+    if (!walker.ok()) {
+        return 0;
+    }
+    while (offset < packetLength) {
+        uint8_t len = packet[offset];
+        if ((len & 0xC0) == 0xC0) {
+            return offset + 2;
+        }
+        if (len == 0) {
+            return offset + 1;
+        }
+        offset += len + 1;
+    }
+    return 0;
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+size_t DnsName::toString(char *out, size_t outSize) const {
+    LabelWalker walker(packet, packetLength, offset);
+    const uint8_t *label;
+    uint8_t length;
+    size_t j = 0;
+    while (walker.next(label, length)) {
+        if (j + (j ? 1 : 0) + length >= outSize) {
+            return 0;
+        }
+        if (j) {
+            out[j++] = '.';
+        }
+        memcpy(out + j, label, length);
+        j += length;
+    }
+    if (!walker.ok() || outSize == 0) {
+        return 0;
+    }
+    out[j] = '\0';
+    return j;
+}
+
+bool DnsName::equals(const char *dotted) const {
+    LabelWalker walker(packet, packetLength, offset);
+    const uint8_t *label;
+    uint8_t length;
+    size_t i = 0;
+    while (walker.next(label, length)) {
+        if (i && dotted[i++] != '.') {
+            return false;
+        }
+        for (uint8_t k = 0; k < length; k++, i++) {
+            if (dotted[i] == '\0' || dnsToLower((char)label[k]) != dnsToLower(dotted[i])) {
+                return false;
+            }
+        }
+    }
+    return walker.ok() && (dotted[i] == '\0' || (dotted[i] == '.' && dotted[i + 1] == '\0'));
+}
+
+bool DnsName::equals(const DnsName &other) const {
+    LabelWalker a(packet, packetLength, offset);
+    LabelWalker b(other.packet, other.packetLength, other.offset);
+    const uint8_t *la, *lb;
+    uint8_t na, nb;
+    for (;;) {
+        bool moreA = a.next(la, na);
+        bool moreB = b.next(lb, nb);
+        if (!moreA || !moreB) {
+            return moreA == moreB && a.ok() && b.ok();
+        }
+        if (na != nb) {
+            return false;
+        }
+        for (uint8_t k = 0; k < na; k++) {
+            if (dnsToLower((char)la[k]) != dnsToLower((char)lb[k])) {
+                return false;
+            }
+        }
+    }
+}
+
+uint32_t DnsName::hash() const {
+    LabelWalker walker(packet, packetLength, offset);
+    const uint8_t *label;
+    uint8_t length;
+    uint32_t hash = 2166136261u;
+    bool first = true;
+    while (walker.next(label, length)) {
+        if (!first) {
+            hash ^= '.';
+            hash *= 16777619u;
+        }
+        first = false;
+        for (uint8_t k = 0; k < length; k++) {
+            hash ^= (uint8_t)dnsToLower((char)label[k]);
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool DnsRecord::a(uint32_t &addr) const {
+    if (type != DNS_TYPE_A || rdLength != 4) {
+        return false;
+    }
+    memcpy(&addr, name.packet + rdOffset, 4);
+    return true;
+}
+
+bool DnsRecord::aaaa(uint8_t addr[16]) const {
+    if (type != DNS_TYPE_AAAA || rdLength != 16) {
+        return false;
+    }
+    memcpy(addr, name.packet + rdOffset, 16);
+    return true;
+}
+
+bool DnsRecord::target(DnsName &out) const {
+    if (type != DNS_TYPE_CNAME && type != DNS_TYPE_NS && type != DNS_TYPE_PTR) {
+        return false;
+    }
+    out.packet = name.packet;
+    out.packetLength = name.packetLength;
+    out.offset = rdOffset;
+    uint16_t end = skipName(name.packet, rdOffset + rdLength, rdOffset);
+    return end == rdOffset + rdLength;
+}
+
+bool DnsRecord::srv(uint16_t &priority, uint16_t &weight, uint16_t &port, DnsName &out) const {
+    if (type != DNS_TYPE_SRV || rdLength < 7) {
+        return false;
+    }
+    const uint8_t *p = name.packet + rdOffset;
+    priority = get16(p);
+    weight = get16(p + 2);
+    port = get16(p + 4);
+    out.packet = name.packet;
+    out.packetLength = name.packetLength;
+    out.offset = rdOffset + 6;
+    return skipName(name.packet, rdOffset + rdLength, out.offset) == rdOffset + rdLength;
+}
+
+bool DnsRecord::txt(uint16_t index, const uint8_t *&data, uint8_t &length) const {
+    if (type != DNS_TYPE_TXT) {
+        return false;
+    }
+    uint16_t at = rdOffset;
+    uint16_t end = rdOffset + rdLength;
+    while (at < end) {
+        uint8_t len = name.packet[at];
+        if (at + 1 + len > end) {
+            return false;
+        }
+        if (index-- == 0) {
+            data = name.packet + at + 1;
+            length = len;
+            return true;
+        }
+        at += 1 + len;
+    }
+    return false;
+}
+
+bool DnsRecord::soaMinimum(uint32_t &minimum) const {
+    if (type != DNS_TYPE_SOA) {
+        return false;
+    }
+    uint16_t end = rdOffset + rdLength;
+    uint16_t at = skipName(name.packet, end, rdOffset);
+    if (at != 0) {
+        at = skipName(name.packet, end, at);
+    }
+    if (at == 0 || at + 20 != end) {
+        return false;
+    }
+    minimum = get32(name.packet + at + 16);
+    return true;
+}
+
+bool DnsRecordCursor::next(DnsRecord &record) {
+    if (remaining == 0) {
+        return false;
+    }
+    uint16_t at = skipName(packet, packetLength, position);
+    if (at == 0 || at + 10 > packetLength) {
+        remaining = 0;
+        return false;
+    }
+    record.name.packet = packet;
+    record.name.packetLength = packetLength;
+    record.name.offset = position;
+    record.type = get16(packet + at);
+    record.cls = get16(packet + at + 2);
+    record.ttl = get32(packet + at + 4);
+    record.rdLength = get16(packet + at + 8);
+    record.rdOffset = at + 10;
+    if (record.rdOffset + record.rdLength > packetLength) {
+        remaining = 0;
+        return false;
+    }
+    position = record.rdOffset + record.rdLength;
+    remaining--;
+    return true;
+}
+
+bool DnsMessageView::parse(const uint8_t *data, size_t length) {
+    packet = data;
+    packetLength = 0;
+    if (length < DNS_HEADER_LENGTH || length > 0xFFFF) {
+        return false;
+    }
+    uint16_t limit = (uint16_t)length;
+
+    uint16_t at = DNS_HEADER_LENGTH;
+    for (uint16_t q = get16(data + 4); q > 0; q--) {
+        at = skipName(data, limit, at);
+        if (at == 0 || at + 4 > limit) {
+            return false;
+        }
+        at += 4;
+    }
+
+    for (int s = 0; s < 3; s++) {
+        sections[s] = at;
+        for (uint16_t r = get16(data + 6 + s * 2); r > 0; r--) {
+            at = skipName(data, limit, at);
+            if (at == 0 || at + 10 > limit) {
+                return false;
+            }
+            at += 10;
+            uint16_t rdLength = get16(data + at - 2);
+            if (at + rdLength > limit) {
+                return false;
+            }
+            at += rdLength;
+        }
+    }
+    recordsEnd = at;
+    packetLength = limit;
+    return true;
+}
+
+bool DnsMessageView::firstQuestion(DnsQuestion &question) const {
+    if (packetLength == 0 || questionCount() == 0) {
+        return false;
+    }
+    question.name.packet = packet;
+    question.name.packetLength = packetLength;
+    question.name.offset = DNS_HEADER_LENGTH;
+    uint16_t at = skipName(packet, packetLength, DNS_HEADER_LENGTH);
+    question.type = get16(packet + at);
+    question.cls = get16(packet + at + 2);
+    return true;
+}
+
+DnsRecordCursor DnsMessageView::records(DnsSection section) const {
+    if (packetLength == 0) {
+        return DnsRecordCursor();
+    }
+    return DnsRecordCursor(packet, packetLength, sections[section], read16(6 + section * 2));
+}
+
+bool DnsMessageView::findOpt(DnsRecord &opt) const {
+    DnsRecordCursor additional = records(DNS_SECTION_ADDITIONAL);
+    while (additional.next(opt)) {
+        if (opt.type == DNS_TYPE_OPT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint16_t DnsMessageView::ednsPayloadSize() const {
+    DnsRecord opt;
+    if (!findOpt(opt)) {
+        return 0;
+    }
+    // RFC 6891 section 6.2.3: values below 512 are treated as 512.
+    return opt.cls < DNS_UDP_MAX_PAYLOAD ? DNS_UDP_MAX_PAYLOAD : opt.cls;
+}
+
+DnsMessageWriter::DnsMessageWriter(uint8_t *buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity), position(0), rdLengthAt(0), questionName(0), section(-1), overflow(false) {
+}
+
+void DnsMessageWriter::begin(uint16_t id, uint16_t flags) {
+    position = 0;
+    questionName = 0;
+    section = -1;
+    overflow = capacity < DNS_HEADER_LENGTH;
+    if (overflow) {
+        return;
+    }
+    memset(buffer, 0, DNS_HEADER_LENGTH);
+    buffer[0] = id >> 8;
+    buffer[1] = id & 0xFF;
+    buffer[2] = flags >> 8;
+    buffer[3] = flags & 0xFF;
+    position = DNS_HEADER_LENGTH;
+}
+
+bool DnsMessageWriter::beginResponse(const DnsMessageView &query, uint8_t rcode) {
+    begin(query.id(), DNS_FLAG_QR | DNS_FLAG_RA | (query.flags() & DNS_FLAG_RD) | (rcode & 0x0F));
+    if (query.questionCount() == 0) {
+        return !overflow;
+    }
+    // Echo only the first question. The name is copied label by label: a
+    // compression pointer in it would point into the wrong message here.
+    LabelWalker walker(query.data(), query.length(), DNS_HEADER_LENGTH);
+    const uint8_t *label;
+    uint8_t length;
+    while (walker.next(label, length)) {
+        if (!put8(length) || !putBytes(label, length)) {
+            return false;
+        }
+    }
+    uint16_t at = skipName(query.data(), query.length(), DNS_HEADER_LENGTH);
+    if (!walker.ok() || !put8(0) || !putBytes(query.data() + at, 4)) {
+        return false;
+    }
+    questionName = DNS_HEADER_LENGTH;
+    bumpCount(4);
+    return true;
+}
+
+void DnsMessageWriter::setRcode(uint8_t rcode) {
+    if (position >= DNS_HEADER_LENGTH) {
+        buffer[3] = (buffer[3] & 0xF0) | (rcode & 0x0F);
+    }
+}
+
+void DnsMessageWriter::setFlag(uint16_t flag, bool on) {
+    if (position >= DNS_HEADER_LENGTH) {
+        uint16_t flags = get16(buffer + 2);
+        flags = on ? (flags | flag) : (flags & ~flag);
+        buffer[2] = flags >> 8;
+        buffer[3] = flags & 0xFF;
+    }
+}
+
+bool DnsMessageWriter::addQuestion(const char *name, uint16_t type, uint16_t cls) {
+    if (section >= 0) {
+        return false;
+    }
+    size_t at = position;
+    if (!writeName(name) || !put16(type) || !put16(cls)) {
+        return false;
+    }
+    if (questionName == 0) {
+        questionName = (uint16_t)at;
+    }
+    bumpCount(4);
+    return true;
+}
+
+bool DnsMessageWriter::addA(const char *name, uint32_t ttl, uint32_t addr, DnsSection s) {
+    return addRecord(name, DNS_TYPE_A, DNS_CLASS_IN, ttl, (const uint8_t *)&addr, 4, s);
+}
+
+bool DnsMessageWriter::addAAAA(const char *name, uint32_t ttl, const uint8_t addr[16], DnsSection s) {
+    return addRecord(name, DNS_TYPE_AAAA, DNS_CLASS_IN, ttl, addr, 16, s);
+}
+
+bool DnsMessageWriter::addCname(const char *name, uint32_t ttl, const char *target, DnsSection s) {
+    return startRecord(name, DNS_TYPE_CNAME, DNS_CLASS_IN, ttl, s) && writeName(target) && endRecord();
+}
+
+bool DnsMessageWriter::addTxt(const char *name, uint32_t ttl, const char *text, DnsSection s) {
+    if (!startRecord(name, DNS_TYPE_TXT, DNS_CLASS_IN, ttl, s)) {
+        return false;
+    }
+    size_t length = strlen(text);
+    do {
+        uint8_t chunk = length > 255 ? 255 : (uint8_t)length;
+        if (!put8(chunk) || !putBytes(text, chunk)) {
+            return false;
+        }
+        text += chunk;
+        length -= chunk;
+    } while (length > 0);
+    return endRecord();
+}
+
+bool DnsMessageWriter::addSrv(const char *name, uint32_t ttl, uint16_t priority, uint16_t weight, uint16_t port,
+                              const char *target, DnsSection s) {
+    return startRecord(name, DNS_TYPE_SRV, DNS_CLASS_IN, ttl, s) &&
+           put16(priority) && put16(weight) && put16(port) && writeName(target) && endRecord();
+}
+
+bool DnsMessageWriter::addRecord(const char *name, uint16_t type, uint16_t cls, uint32_t ttl,
+                                 const uint8_t *rdata, uint16_t rdLength, DnsSection s) {
+    return startRecord(name, type, cls, ttl, s) && putBytes(rdata, rdLength) && endRecord();
+}
+
+bool DnsMessageWriter::addOpt(uint16_t payloadSize) {
+    // Root owner name, the payload size in the class field, TTL 0 for
+    // extended RCODE 0, version 0 and no flags.
+    return startRecord("", DNS_TYPE_OPT, payloadSize, 0, DNS_SECTION_ADDITIONAL) && endRecord();
+}
+
+bool DnsMessageWriter::startRecord(const char *name, uint16_t type, uint16_t cls, uint32_t ttl, DnsSection s) {
+    if (overflow || (int8_t)s < section) {
+        return false;
+    }
+    section = (int8_t)s;
+    if (!writeName(name) || !put16(type) || !put16(cls) || !put32(ttl)) {
+        return false;
+    }
+    rdLengthAt = position;
+    return put16(0);
+}
+
+bool DnsMessageWriter::endRecord() {
+    if (overflow) {
+        return false;
+    }
+    uint16_t rdLength = (uint16_t)(position - rdLengthAt - 2);
+    buffer[rdLengthAt] = rdLength >> 8;
+    buffer[rdLengthAt + 1] = rdLength & 0xFF;
+    bumpCount(6 + section * 2);
+    return true;
+}
+
+bool DnsMessageWriter::writeName(const char *name) {
+    if (name == NULL || (questionName && DnsName{buffer, (uint16_t)position, questionName}.equals(name))) {
+        if (!questionName) {
+            overflow = true;
+            return false;
+        }
+        return put16(0xC000 | questionName);
+    }
+
+    size_t total = 0;
+    while (*name != '\0') {
+        const char *dot = strchr(name, '.');
+        size_t length = dot ? (size_t)(dot - name) : strlen(name);
+        total += length + 1;
+        if (length == 0 || length > 63 || total >= DNS_MAX_WIRE_NAME) {
+            overflow = true;
+            return false;
+        }
+        if (!put8((uint8_t)length) || !putBytes(name, length)) {
+            return false;
+        }
+        name += length;
+        if (*name == '.') {
+            name++;
+        }
+    }
+    return put8(0);
+}
+
+bool DnsMessageWriter::put8(uint8_t value) {
+    return putBytes(&value, 1);
+}
+
+bool DnsMessageWriter::put16(uint16_t value) {
+    uint8_t bytes[2] = {(uint8_t)(value >> 8), (uint8_t)value};
+    return putBytes(bytes, 2);
+}
+
+bool DnsMessageWriter::put32(uint32_t value) {
+    uint8_t bytes[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    return putBytes(bytes, 4);
+}
+
+bool DnsMessageWriter::putBytes(const void *data, size_t length) {
+    if (overflow || position + length > capacity) {
+        overflow = true;
+        return false;
+    }
+    memcpy(buffer + position, data, length);
+    position += length;
+    return true;
+}
+
+void DnsMessageWriter::bumpCount(uint16_t at) {
+    uint16_t count = get16(buffer + at) + 1;
+    buffer[at] = count >> 8;
+    buffer[at + 1] = count & 0xFF;
+}
+
+size_t dnsSetEdnsPayload(uint8_t *message, size_t length, uint16_t payloadSize) {
+    DnsMessageView view;
+    DnsRecord opt;
+    if (!view.parse(message, length) || !view.findOpt(opt)) {
+        return 0;
+    }
+    // The class field sits 8 bytes before the RDATA.
+    uint8_t *cls = message + opt.rdOffset - 8;
+    uint8_t old[2] = {cls[0], cls[1]};
+    cls[0] = payloadSize >> 8;
+    cls[1] = payloadSize & 0xFF;
+    // Unless a compression pointer leads into it
+    if (!view.parse(message, length)) {
+        cls[0] = old[0];
+        cls[1] = old[1];
+        return 0;
+    }
+    return length;
+}
+
+size_t dnsAppendOpt(uint8_t *message, size_t length, size_t capacity, uint16_t payloadSize) {
+    // Goes right after the last record; trailing bytes would otherwise be
+    // read as the first part of it.
+    DnsMessageView view;
+    if (!view.parse(message, length)) {
+        return 0;
+    }
+    length = view.end();
+    if (length + 11 > capacity || get16(message + 10) == 0xFFFF) {
+        return 0;
+    }
+    uint8_t *p = message + length;
+    p[0] = 0;                           // root
+    p[1] = DNS_TYPE_OPT >> 8;
+    p[2] = DNS_TYPE_OPT & 0xFF;
+    p[3] = payloadSize >> 8;
+    p[4] = payloadSize & 0xFF;
+    memset(p + 5, 0, 6);                // TTL and RDLENGTH
+    uint16_t count = get16(message + 10) + 1;
+    message[10] = count >> 8;
+    message[11] = count & 0xFF;
+    // Unless a compression pointer leads into the count
+    if (!view.parse(message, length + 11)) {
+        count--;
+        message[10] = count >> 8;
+        message[11] = count & 0xFF;
+        return 0;
+    }
+    return length + 11;
+}
+
+size_t dnsRemoveOpt(uint8_t *message, size_t length) {
+    DnsMessageView view;
+    if (!view.parse(message, length)) {
+        return 0;
+    }
+    DnsRecordCursor additional = view.records(DNS_SECTION_ADDITIONAL);
+    DnsRecord record;
+    bool last = false;
+    uint16_t start = 0;
+    while (additional.next(record)) {
+        last = record.type == DNS_TYPE_OPT;
+        start = record.name.offset;
+    }
+    if (!last || record.rdOffset + record.rdLength != length) {
+        return 0;
+    }
+    uint16_t count = get16(message + 10) - 1;
+    message[10] = count >> 8;
+    message[11] = count & 0xFF;
+    // A name before it may point forward into the record being dropped
+    if (!view.parse(message, start)) {
+        count++;
+        message[10] = count >> 8;
+        message[11] = count & 0xFF;
+        return 0;
+    }
+    return start;
+}
@@ -0,0 +1,206 @@
+#ifndef DNSMESSAGE_H
+#define DNSMESSAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DNS_HEADER_LENGTH       12
+#define DNS_NAME_BUFFER_SIZE    256     // dotted name plus terminator
+
+#define DNS_UDP_MAX_PAYLOAD     512     // without EDNS (RFC 1035 section 4.2.1)
+#define DNS_EDNS_MAX_PAYLOAD    4096
+// UDP payload size we advertise upstream and accept from clients; 1232
+// avoids IP fragmentation on common paths.
+#ifndef DNS_EDNS_PAYLOAD_SIZE
+#define DNS_EDNS_PAYLOAD_SIZE   1232
+#endif
+#if DNS_EDNS_PAYLOAD_SIZE < DNS_UDP_MAX_PAYLOAD || DNS_EDNS_PAYLOAD_SIZE > DNS_EDNS_MAX_PAYLOAD
+#error "DNS_EDNS_PAYLOAD_SIZE must be between 512 and 4096"
+#endif
+
+#define DNS_TYPE_A              1
+#define DNS_TYPE_NS             2
+#define DNS_TYPE_CNAME          5
+#define DNS_TYPE_SOA            6
+#define DNS_TYPE_PTR            12
+#define DNS_TYPE_TXT            16
+#define DNS_TYPE_AAAA           28
+#define DNS_TYPE_SRV            33
+#define DNS_TYPE_OPT            41
+#define DNS_CLASS_IN            1
+
+#define DNS_FLAG_QR             0x8000
+#define DNS_FLAG_AA             0x0400
+#define DNS_FLAG_TC             0x0200
+#define DNS_FLAG_RD             0x0100
+#define DNS_FLAG_RA             0x0080
+
+#define DNS_RCODE_NOERROR       0
+#define DNS_RCODE_FORMERR       1
+#define DNS_RCODE_SERVFAIL      2
+#define DNS_RCODE_NXDOMAIN      3
+
+enum DnsSection {
+    DNS_SECTION_ANSWER,
+    DNS_SECTION_AUTHORITY,
+    DNS_SECTION_ADDITIONAL,
+};
+
+// A possibly compressed name inside a packet. Nothing is copied; every
+// accessor follows the labels in place and is bounds- and loop-checked.
+struct DnsName {
+    const uint8_t *packet;
+    uint16_t packetLength;
+    uint16_t offset;
+
+    // Writes the dotted form; returns its length, or 0 if it does not fit.
+    size_t toString(char *out, size_t outSize) const;
+    bool equals(const char *dotted) const;
+    bool equals(const DnsName &other) const;
+    // Same value as dnsNameHash() over the dotted form.
+    uint32_t hash() const;
+};
+
+struct DnsQuestion {
+    DnsName name;
+    uint16_t type;
+    uint16_t cls;
+};
+
+struct DnsRecord {
+    DnsName name;
+    uint16_t type;
+    uint16_t cls;
+    uint32_t ttl;
+    uint16_t rdOffset;
+    uint16_t rdLength;
+
+    // `addr` is in network byte order.
+    bool a(uint32_t &addr) const;
+    bool aaaa(uint8_t addr[16]) const;
+    // CNAME, NS and PTR targets.
+    bool target(DnsName &out) const;
+    bool srv(uint16_t &priority, uint16_t &weight, uint16_t &port, DnsName &out) const;
+    // The index-th character-string of a TXT record.
+    bool txt(uint16_t index, const uint8_t *&data, uint8_t &length) const;
+    bool soaMinimum(uint32_t &minimum) const;
+};
+
+class DnsRecordCursor {
+public:
+    DnsRecordCursor() : packet(NULL), packetLength(0), position(0), remaining(0) {}
+    DnsRecordCursor(const uint8_t *packet, uint16_t packetLength, uint16_t position, uint16_t count)
+        : packet(packet), packetLength(packetLength), position(position), remaining(count) {}
+
+    bool next(DnsRecord &record);
+
+private:
+    const uint8_t *packet;
+    uint16_t packetLength;
+    uint16_t position;
+    uint16_t remaining;
+};
+
+// Read-only view over a received message. parse() validates the framing of
+// every section once; afterwards the accessors only index into the buffer,
+// which must outlive the view.
+class DnsMessageView {
+public:
+    DnsMessageView() : packet(NULL), packetLength(0), recordsEnd(0) {}
+
+    bool parse(const uint8_t *data, size_t length);
+
+    uint16_t id() const { return read16(0); }
+    uint16_t flags() const { return read16(2); }
+    uint8_t rcode() const { return flags() & 0x0F; }
+    bool isResponse() const { return flags() & DNS_FLAG_QR; }
+    uint16_t questionCount() const { return read16(4); }
+    uint16_t answerCount() const { return read16(6); }
+    uint16_t authorityCount() const { return read16(8); }
+    uint16_t additionalCount() const { return read16(10); }
+
+    bool firstQuestion(DnsQuestion &question) const;
+    // Raw bytes of the question section, for echoing into a response.
+    const uint8_t *questionBytes() const { return packet + DNS_HEADER_LENGTH; }
+    uint16_t questionLength() const { return sections[0] - DNS_HEADER_LENGTH; }
+
+    DnsRecordCursor records(DnsSection section) const;
+    // The EDNS0 OPT pseudo-record, if the additional section has one.
+    bool findOpt(DnsRecord &opt) const;
+    // The requester's UDP payload size, at least 512, or 0 without EDNS.
+    uint16_t ednsPayloadSize() const;
+    const uint8_t *data() const { return packet; }
+    uint16_t length() const { return packetLength; }
+    // Where the last record ends; bytes after it belong to no section.
+    uint16_t end() const { return recordsEnd; }
+
+private:
+    uint16_t read16(uint16_t at) const { return (packet[at] << 8) | packet[at + 1]; }
+
+    const uint8_t *packet;
+    uint16_t packetLength;
+    uint16_t sections[3];
+    uint16_t recordsEnd;
+};
+
+// Builds a message straight into the outgoing packet buffer. Records must
+// be added in section order. A name of NULL refers to the first question
+// and is written as a compression pointer. Once the buffer would overflow
+// every further call fails and finish() returns 0.
+class DnsMessageWriter {
+public:
+    DnsMessageWriter(uint8_t *buffer, size_t capacity);
+
+    void begin(uint16_t id, uint16_t flags);
+    // Starts a response to `query`: same ID, RD copied, question echoed.
+    bool beginResponse(const DnsMessageView &query, uint8_t rcode);
+    void setRcode(uint8_t rcode);
+    void setFlag(uint16_t flag, bool on);
+
+    bool addQuestion(const char *name, uint16_t type, uint16_t cls = DNS_CLASS_IN);
+    bool addA(const char *name, uint32_t ttl, uint32_t addr, DnsSection section = DNS_SECTION_ANSWER);
+    bool addAAAA(const char *name, uint32_t ttl, const uint8_t addr[16], DnsSection section = DNS_SECTION_ANSWER);
+    bool addCname(const char *name, uint32_t ttl, const char *target, DnsSection section = DNS_SECTION_ANSWER);
+    bool addTxt(const char *name, uint32_t ttl, const char *text, DnsSection section = DNS_SECTION_ANSWER);
+    bool addSrv(const char *name, uint32_t ttl, uint16_t priority, uint16_t weight, uint16_t port,
+                const char *target, DnsSection section = DNS_SECTION_ANSWER);
+    bool addRecord(const char *name, uint16_t type, uint16_t cls, uint32_t ttl,
+                   const uint8_t *rdata, uint16_t rdLength, DnsSection section = DNS_SECTION_ANSWER);
+    // An empty OPT record; must come last.
+    bool addOpt(uint16_t payloadSize = DNS_EDNS_PAYLOAD_SIZE);
+
+    size_t length() const { return position; }
+    bool overflowed() const { return overflow; }
+    size_t finish() const { return overflow ? 0 : position; }
+
+private:
+    bool startRecord(const char *name, uint16_t type, uint16_t cls, uint32_t ttl, DnsSection section);
+    bool endRecord();
+    bool writeName(const char *name);
+    bool put8(uint8_t value);
+    bool put16(uint16_t value);
+    bool put32(uint32_t value);
+    bool putBytes(const void *data, size_t length);
+    void bumpCount(uint16_t at);
+
+    uint8_t *buffer;
+    size_t capacity;
+    size_t position;
+    size_t rdLengthAt;
+    uint16_t questionName;
+    int8_t section;
+    bool overflow;
+};
+
+// In-place edits for relaying a message without re-encoding it. Each takes
+// a message that DnsMessageView accepts and returns the new length, or 0 if
+// nothing could be done.
+//
+// Sets the UDP payload size of an existing OPT record.
+size_t dnsSetEdnsPayload(uint8_t *message, size_t length, uint16_t payloadSize);
+// Appends an empty OPT record; `capacity` is the size of the buffer.
+size_t dnsAppendOpt(uint8_t *message, size_t length, size_t capacity, uint16_t payloadSize);
+// Drops the OPT record if it is the last record, as servers place it.
+size_t dnsRemoveOpt(uint8_t *message, size_t length);
+
+#endif // DNSMESSAGE_H
@@ -0,0 +1,413 @@
+#include "DnsOverrides.h"
+#include "DnsPlatform.h"
+#include <string.h>
+#include <stdio.h>
+
+#define LABEL_MAX_LENGTH    63
+#define LINE_MAX_LENGTH     512
+
+static uint32_t labelHash(uint32_t parent, const char *label, size_t length) {
+    uint32_t hash = 2166136261u ^ (parent * 0x9E3779B1u);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)dnsToLower(label[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Reads one line into `line`, without its '\n'. A line that does not fit
+// is skipped up to its end rather than split, as its tail would read as a
+// rule of its own; false for those.
+static bool readLine(File &file, char *line, size_t size, size_t &length) {
+    length = file.readBytesUntil('\n', line, size - 1);
+    line[length] = '\0';
+    if (length < size - 1) {
+        return true;
+    }
+    int c = file.peek();
+    if (c < 0) {
+        return true;
+    }
+    if (c == '\n') {
+        file.read();
+        return true;
+    }
+    while ((c = file.read()) >= 0 && c != '\n') {
+    }
+    return false;
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Strict dotted quad, so names such as "1.2.3.4.example" are not taken
+// for an address.
+static bool parseAddress(const char *token, uint32_t &addr) {
+    uint32_t octets[4];
+    int count = 0;
+    const char *p = token;
+    while (count < 4) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        uint32_t value = 0;
+        while (*p >= '0' && *p <= '9') {
+            value = value * 10 + (uint32_t)(*p++ - '0');
+            if (value > 255) {
+                return false;
+            }
+        }
+        octets[count++] = value;
+        if (count < 4 && *p++ != '.') {
+            return false;
+        }
+    }
+    if (*p != '\0') {
+        return false;
+    }
+    addr = octets[0] | (octets[1] << 8) | (octets[2] << 16) | (octets[3] << 24);
+    return true;
+}
+
+DnsOverrides::DnsOverrides()
+    : nodeArray(NULL), slots(NULL), labels(NULL), nodeCount(0), nodeCapacity(0), slotMask(0),
+      labelUsed(0), labelCapacity(0), ruleCount(0), skippedCount(0) {
+}
+
+DnsOverrides::~DnsOverrides() {
+    end();
+}
+
+void DnsOverrides::end() {
+    dnsFree(nodeArray);
+    dnsFree(slots);
+    dnsFree(labels);
+    nodeArray = NULL;
+    slots = NULL;
+    labels = NULL;
+    nodeCount = 0;
+    nodeCapacity = 0;
+    slotMask = 0;
+    labelUsed = 0;
+    labelCapacity = 0;
+    ruleCount = 0;
+    skippedCount = 0;
+}
+
+bool DnsOverrides::load(fs::FS &fs, const char *path) {
+    end();
+    File file = fs.open(path, FILE_READ);
+    if (!file) {
+        return true;
+    }
+
+    // First pass: an upper bound on nodes and label bytes, so the table is
+    // allocated once instead of growing through repeated copies.
+    char line[LINE_MAX_LENGTH];
+    uint32_t nodeTotal = 0;
+    size_t labelTotal = 0;
+    size_t n;
+    while (file.available()) {
+        if (!readLine(file, line, sizeof(line), n)) {
+            continue;
+        }
+        bool inToken = false;
+        for (size_t i = 0; i < n && line[i] != '#'; i++) {
+            if (isSpace(line[i])) {
+                inToken = false;
+                continue;
+            }
+            if (!inToken || line[i] == '.') {
+                nodeTotal++;
+            }
+            inToken = true;
+            labelTotal++;
+        }
+    }
+    if (!reserve(nodeTotal, labelTotal)) {
+        file.close();
+        return false;
+    }
+
+    file.seek(0);
+    while (file.available()) {
+        if (readLine(file, line, sizeof(line), n)) {
+            addLine(line);
+        } else {
+            skippedCount++;
+        }
+    }
+    file.close();
+    shrink();
+    return true;
+}
+
+void DnsOverrides::addLine(char *line) {
+    char *comment = strchr(line, '#');
+    if (comment) {
+        *comment = '\0';
+    }
+
+    // "<address> <name>..." or a bare blocklist "<name>...".
+    bool first = true;
+    bool haveAddress = false;
+    uint32_t addr = 0;
+    char *p = line;
+    for (;;) {
+        while (isSpace(*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            return;
+        }
+        char *token = p;
+        while (*p != '\0' && !isSpace(*p)) {
+            p++;
+        }
+        bool last = *p == '\0';
+        *p = '\0';
+
+        // Bad names are skipped rather than failing the whole file.
+        if (first && parseAddress(token, addr)) {
+            haveAddress = true;
+        } else if (haveAddress) {
+            add(token, addr, addr == 0);
+        } else if (token[0] == '*' && token[1] == '.') {
+            add(token, 0, true);
+        } else {
+            addRule(token, false, 0, true);
+            addRule(token, true, 0, true);
+        }
+        first = false;
+        if (last) {
+            return;
+        }
+        p++;
+    }
+}
+
+bool DnsOverrides::add(const char *pattern, uint32_t addr, bool blocked) {
+    if (pattern[0] == '*' && pattern[1] == '.') {
+        return addRule(pattern + 2, true, addr, blocked);
+    }
+    return addRule(pattern, false, addr, blocked);
+}
+
+bool DnsOverrides::addRule(const char *name, bool wildcard, uint32_t addr, bool blocked) {
+    size_t length;
+    dnsNameHash(name, &length);
+    if (length == 0 || length > DNS_NAME_MAX_LENGTH || name[0] == '.') {
+        return false;
+    }
+    uint32_t labelTotal = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (name[i] == '.') {
+            labelTotal++;
+        }
+    }
+    if (!reserve(nodeCount + labelTotal, labelUsed + length)) {
+        return false;
+    }
+
+    uint32_t node = 0;
+    size_t end = length;
+    while (end > 0) {
+        size_t start = end;
+        while (start > 0 && name[start - 1] != '.') {
+            start--;
+        }
+        size_t labelLength = end - start;
+        if (labelLength == 0 || labelLength > LABEL_MAX_LENGTH) {
+            // Nodes added so far stay as harmless empty interior nodes.
+            return false;
+        }
+        uint32_t hash = labelHash(node, name + start, labelLength);
+        uint32_t next = child(node, name + start, labelLength, hash);
+        node = next ? next : addChild(node, name + start, labelLength, hash);
+        end = start > 0 ? start - 1 : 0;
+    }
+
+    Node &n = nodeArray[node - 1];
+    uint8_t has = wildcard ? FLAG_WILDCARD : FLAG_EXACT;
+    uint8_t block = wildcard ? FLAG_WILDCARD_BLOCKED : FLAG_EXACT_BLOCKED;
+    if (!(n.flags & has)) {
+        ruleCount++;
+    }
+    n.flags = (uint8_t)((n.flags | has) & ~block);
+    if (blocked) {
+        n.flags |= block;
+    }
+    if (wildcard) {
+        n.wildcardAddr = addr;
+    } else {
+        n.addr = addr;
+    }
+    return true;
+}
+
+DnsOverrideResult DnsOverrides::lookup(const char *name, uint32_t &addr) const {
+    if (nodeCount == 0) {
+        return DNS_OVERRIDE_NONE;
+    }
+    size_t length;
+    dnsNameHash(name, &length);
+
+    DnsOverrideResult result = DNS_OVERRIDE_NONE;
+    uint32_t node = 0;
+    size_t end = length;
+    while (end > 0) {
+        size_t start = end;
+        while (start > 0 && name[start - 1] != '.') {
+            start--;
+        }
+        size_t labelLength = end - start;
+        if (labelLength == 0) {
+            return result;
+        }
+        node = child(node, name + start, labelLength, labelHash(node, name + start, labelLength));
+        if (node == 0) {
+            return result;
+        }
+        const Node &n = nodeArray[node - 1];
+        if (start == 0) {
+            if (n.flags & FLAG_EXACT) {
+                addr = n.addr;
+                return (n.flags & FLAG_EXACT_BLOCKED) ? DNS_OVERRIDE_BLOCKED : DNS_OVERRIDE_ADDRESS;
+            }
+            return result;
+        }
+        // A wildcard covers what is left of the name; deeper ones win.
+        if (n.flags & FLAG_WILDCARD) {
+            addr = n.wildcardAddr;
+            result = (n.flags & FLAG_WILDCARD_BLOCKED) ? DNS_OVERRIDE_BLOCKED : DNS_OVERRIDE_ADDRESS;
+        }
+        end = start - 1;
+    }
+    return result;
+}
+
+size_t DnsOverrides::memoryUsed() const {
+    return sizeof(Node) * nodeCapacity + sizeof(Slot) * (slots ? slotMask + 1 : 0) + labelCapacity;
+}
+
+bool DnsOverrides::reserve(uint32_t nodeTotal, size_t labelTotal) {
+    if (nodeTotal > nodeCapacity) {
+        uint32_t capacity = nodeCapacity * 2 > nodeTotal ? nodeCapacity * 2 : nodeTotal;
+        Node *grown = (Node *)dnsRealloc(nodeArray, sizeof(Node) * capacity);
+        if (!grown) {
+            return false;
+        }
+        nodeArray = grown;
+        nodeCapacity = capacity;
+    }
+    if (labelTotal > labelCapacity) {
+        size_t capacity = labelCapacity * 2 > labelTotal ? labelCapacity * 2 : labelTotal;
+        char *grown = (char *)dnsRealloc(labels, capacity);
+        if (!grown) {
+            return false;
+        }
+        labels = grown;
+        labelCapacity = capacity;
+    }
+
+    // Keep the index at most half full.
+    uint32_t slotCount = slotsFor(nodeCapacity);
+    if (slots && slotMask + 1 >= slotCount) {
+        return true;
+    }
+    return rebuildIndex(slotCount);
+}
+
+uint32_t DnsOverrides::slotsFor(uint32_t nodeTotal) {
+    uint32_t slotCount = 1;
+    while (slotCount < nodeTotal * 2) {
+        slotCount <<= 1;
+    }
+    return slotCount;
+}
+
+bool DnsOverrides::rebuildIndex(uint32_t slotCount) {
+    Slot *index = (Slot *)dnsAlloc(sizeof(Slot) * slotCount);
+    if (!index) {
+        return false;
+    }
+    dnsFree(slots);
+    slots = index;
+    slotMask = slotCount - 1;
+    memset(slots, 0, sizeof(Slot) * slotCount);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const Node &n = nodeArray[i];
+        indexNode(i + 1, labelHash(n.parent, labels + n.labelOffset, n.labelLength));
+    }
+    return true;
+}
+
+// The first pass counts every label, while shared suffixes ("com") are only
+// stored once; give the surplus back.
+void DnsOverrides::shrink() {
+    if (nodeCount == 0) {
+        end();
+        return;
+    }
+    Node *fitted = (Node *)dnsRealloc(nodeArray, sizeof(Node) * nodeCount);
+    if (fitted) {
+        nodeArray = fitted;
+        nodeCapacity = nodeCount;
+    }
+    char *packed = (char *)dnsRealloc(labels, labelUsed);
+    if (packed) {
+        labels = packed;
+        labelCapacity = labelUsed;
+    }
+    uint32_t slotCount = slotsFor(nodeCapacity);
+    if (slotCount < slotMask + 1) {
+        rebuildIndex(slotCount);
+    }
+}
+
+uint32_t DnsOverrides::child(uint32_t parent, const char *label, size_t length, uint32_t hash) const {
+    uint32_t i = hash & slotMask;
+    while (slots[i].node != 0) {
+        if (slots[i].hash == hash) {
+            const Node &n = nodeArray[slots[i].node - 1];
+            if (n.parent == parent && n.labelLength == length) {
+                const char *stored = labels + n.labelOffset;
+                size_t k = 0;
+                while (k < length && stored[k] == dnsToLower(label[k])) {
+                    k++;
+                }
+                if (k == length) {
+                    return slots[i].node;
+                }
+            }
+        }
+        i = (i + 1) & slotMask;
+    }
+    return 0;
+}
+
+uint32_t DnsOverrides::addChild(uint32_t parent, const char *label, size_t length, uint32_t hash) {
+    Node &n = nodeArray[nodeCount];
+    n.parent = parent;
+    n.labelOffset = (uint32_t)labelUsed;
+    n.labelLength = (uint8_t)length;
+    n.flags = 0;
+    n.addr = 0;
+    n.wildcardAddr = 0;
+    for (size_t i = 0; i < length; i++) {
+        labels[labelUsed++] = dnsToLower(label[i]);
+    }
+    nodeCount++;
+    indexNode(nodeCount, hash);
+    return nodeCount;
+}
+
+void DnsOverrides::indexNode(uint32_t node, uint32_t hash) {
+    uint32_t i = hash & slotMask;
+    while (slots[i].node != 0) {
+        i = (i + 1) & slotMask;
+    }
+    slots[i].hash = hash;
+    slots[i].node = node;
+}
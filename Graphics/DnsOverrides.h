@@ -0,0 +1,98 @@
+#ifndef DNSOVERRIDES_H
+#define DNSOVERRIDES_H
+
+#include <FS.h>
+#include "DnsCache.h"
+
+#define DNS_OVERRIDES_FILE      "/overrides.txt"
+
+enum DnsOverrideResult {
+    DNS_OVERRIDE_NONE,
+    DNS_OVERRIDE_ADDRESS,
+    DNS_OVERRIDE_BLOCKED,
+};
+
+// Local answers and blocklist, matched by domain suffix.
+//
+// Names are kept as a trie over reversed labels ("www.example.com" is
+// com -> example -> www). Nodes sit in one PSRAM array and children are found
+// through a single open-addressing index keyed by (parent, label), so a
+// lookup costs one probe per label of the query no matter how many rules
+// share a suffix.
+//
+// A node can carry an exact rule (the name itself) and a wildcard rule
+// ("*.name", every name strictly below it). The exact rule wins, then the
+// deepest wildcard, so "good.ads.example 10.0.0.1" can punch a hole in
+// "*.ads.example" being blocked.
+//
+// The file format is a superset of a hosts file, one rule per line:
+//     192.168.1.10 nas.home *.nas.home   address for one or more names
+//     0.0.0.0 tracker.example            blocked (hosts-style blocklists)
+//     ads.example                        blocked, with all its subdomains
+//     # comment
+class DnsOverrides {
+public:
+    DnsOverrides();
+    ~DnsOverrides();
+
+    // Drops any rules and reads `path`, sizing the table in a first pass.
+    // A missing file leaves an empty table and is not an error.
+    bool load(fs::FS &fs, const char *path = DNS_OVERRIDES_FILE);
+    void end();
+
+    // `pattern` is a name, optionally prefixed with "*." for a wildcard.
+    bool add(const char *pattern, uint32_t addr, bool blocked = false);
+
+    DnsOverrideResult lookup(const char *name, uint32_t &addr) const;
+
+    uint32_t rules() const { return ruleCount; }
+    // Lines too long to read, left out of the table
+    uint32_t skipped() const { return skippedCount; }
+    uint32_t nodes() const { return nodeCount; }
+    size_t memoryUsed() const;
+
+private:
+    enum {
+        FLAG_EXACT = 1,
+        FLAG_WILDCARD = 2,
+        FLAG_EXACT_BLOCKED = 4,
+        FLAG_WILDCARD_BLOCKED = 8,
+    };
+
+    struct Node {
+        uint32_t parent;        // node index + 1, 0 is the root
+        uint32_t labelOffset;   // into the label pool
+        uint8_t labelLength;
+        uint8_t flags;
+        uint32_t addr;
+        uint32_t wildcardAddr;
+    };
+
+    struct Slot {
+        uint32_t hash;
+        uint32_t node;          // index + 1, 0 means empty
+    };
+
+    bool reserve(uint32_t nodeTotal, size_t labelTotal);
+    void shrink();
+    static uint32_t slotsFor(uint32_t nodeTotal);
+    bool rebuildIndex(uint32_t slotCount);
+    void addLine(char *line);
+    bool addRule(const char *name, bool wildcard, uint32_t addr, bool blocked);
+    uint32_t child(uint32_t parent, const char *label, size_t length, uint32_t hash) const;
+    uint32_t addChild(uint32_t parent, const char *label, size_t length, uint32_t hash);
+    void indexNode(uint32_t node, uint32_t hash);
+
+    Node *nodeArray;
+    Slot *slots;
+    char *labels;
+    uint32_t nodeCount;
+    uint32_t nodeCapacity;
+    uint32_t slotMask;
+    size_t labelUsed;
+    size_t labelCapacity;
+    uint32_t ruleCount;
+    uint32_t skippedCount;
+};
+
+#endif // DNSOVERRIDES_H
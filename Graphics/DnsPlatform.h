@@ -0,0 +1,124 @@
+#ifndef DNSPLATFORM_H
+#define DNSPLATFORM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Small shim so the DNS building blocks only depend on the C library and
+// can be compiled outside the Arduino core as well.
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_system.h>
+#include <FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Large tables live in PSRAM when the board has it.
+static inline void *dnsAlloc(size_t size) {
+    return psramFound() ? ps_malloc(size) : malloc(size);
+}
+
+static inline void *dnsRealloc(void *ptr, size_t size) {
+    return psramFound() ? ps_realloc(ptr, size) : realloc(ptr, size);
+}
+
+static inline uint32_t dnsMillis() {
+    return millis();
+}
+
+static inline uint32_t dnsMicros() {
+    return micros();
+}
+
+static inline uint32_t dnsRandom() {
+    return esp_random();
+}
+
+// Mutex for writers that may sit on either core. A FreeRTOS mutex rather
+// than a spinlock, so a preempted holder inherits the waiter's priority.
+// Built in place when the object is constructed, so it can be taken before
+// begin(), e.g. by the GUI polling stats of a server that never started.
+class DnsLock {
+public:
+    DnsLock() : handle(xSemaphoreCreateMutexStatic(&storage)) {}
+    bool begin() { return handle != NULL; }
+    void end() {}
+    void lock() { xSemaphoreTake(handle, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(handle); }
+
+private:
+    StaticSemaphore_t storage;
+    SemaphoreHandle_t handle;
+};
+#else
+#include <time.h>
+#include <mutex>
+
+static inline void *dnsAlloc(size_t size) {
+    return malloc(size);
+}
+
+static inline void *dnsRealloc(void *ptr, size_t size) {
+    return realloc(ptr, size);
+}
+
+static inline uint32_t dnsMillis() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL);
+}
+
+static inline uint32_t dnsMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000UL + ts.tv_nsec / 1000UL);
+}
+
+static inline uint32_t dnsRandom() {
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+class DnsLock {
+public:
+    bool begin() { return true; }
+    void end() {}
+    void lock() { handle.lock(); }
+    void unlock() { handle.unlock(); }
+
+private:
+    std::mutex handle;
+};
+#endif
+
+static inline void dnsFree(void *ptr) {
+    free(ptr);
+}
+
+static inline char dnsToLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+// Case-folded FNV-1a over a dotted name, ignoring a trailing root dot.
+static inline uint32_t dnsNameHash(const char *name, size_t *outLength = NULL) {
+    uint32_t hash = 2166136261u;
+    size_t len = 0;
+    while (name[len] != '\0') {
+        if (name[len] == '.' && name[len + 1] == '\0') {
+            break;
+        }
+        hash ^= (uint8_t)dnsToLower(name[len]);
+        hash *= 16777619u;
+        len++;
+    }
+    if (outLength) {
+        *outLength = len;
+    }
+    return hash;
+}
+
+// True once `now` has reached `deadline`, tolerant of millis() wrap-around.
+static inline bool dnsTimeReached(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+#endif // DNSPLATFORM_H
@@ -0,0 +1,206 @@
+#include "DnsQueryLog.h"
+#include <string.h>
+#include <time.h>
+
+void dnsLogFileName(char *out, size_t size, int index) {
+    snprintf(out, size, "%s%d%s", DNS_LOG_FILE_BASE_NAME, index, DNS_LOG_FILE_EXTENSION);
+}
+
+DnsQueryLog::DnsQueryLog()
+    : fs(NULL), history(NULL), fileSize(0), batch(NULL), batchUsed(0), task(NULL), running(false),
+      written(0), writes(0), rotations(0), errors(0) {
+}
+
+bool DnsQueryLog::begin(fs::FS &filesystem, DnsHistory *store, UBaseType_t priority) {
+    if (task != NULL) {
+        return true;
+    }
+    // The batch is handed to the SD driver, so keep it in internal RAM.
+    batch = (uint8_t *)malloc(DNS_LOG_BATCH_SIZE);
+    if (!batch || !ring.begin(DNS_LOG_RING_CAPACITY)) {
+        free(batch);
+        batch = NULL;
+        return false;
+    }
+    fs = &filesystem;
+    history = store;
+    batchUsed = 0;
+    running = true;
+    TaskHandle_t writer;
+    if (xTaskCreate(writerTask, "DNS Log Writer", 4096, this, priority, &writer) != pdPASS) {
+        running = false;
+        ring.end();
+        free(batch);
+        batch = NULL;
+        return false;
+    }
+    task = writer;
+    return true;
+}
+
+void DnsQueryLog::end() {
+    if (task == NULL) {
+        return;
+    }
+    // The writer flushes what is left and clears `task` on its way out.
+    running = false;
+    xTaskNotifyGive(task);
+    while (task != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ring.end();
+    free(batch);
+    batch = NULL;
+}
+
+bool DnsQueryLog::log(const char *name, uint32_t addr) {
+    if (!running) {
+        return false;
+    }
+    time_t now = time(NULL);
+    if (!ring.push(name, addr, (uint32_t)now)) {
+        return false;
+    }
+    // Only wake the writer early once a real batch has piled up.
+    TaskHandle_t writer = task;
+    if (writer != NULL && ring.size() >= ring.capacity() / 2) {
+        xTaskNotifyGive(writer);
+    }
+    return true;
+}
+
+DnsQueryLogStats DnsQueryLog::stats() const {
+    DnsQueryLogStats s;
+    s.dropped = ring.dropped();
+    s.written = written;
+    s.writes = writes;
+    s.rotations = rotations;
+    s.errors = errors;
+    return s;
+}
+
+void DnsQueryLog::writerTask(void *arg) {
+    DnsQueryLog *log = (DnsQueryLog *)arg;
+    log->run();
+    log->task = NULL;
+    vTaskDelete(NULL);
+}
+
+void DnsQueryLog::run() {
+    openActive();
+    while (running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DNS_LOG_FLUSH_MS));
+
+        DnsLogRecord record;
+        bool any = false;
+        while (ring.pop(record)) {
+            append(record);
+            any = true;
+        }
+        // Idle: push the partial sector out so readers see it.
+        if (!any) {
+            writeOut(true);
+            if (history) {
+                history->flush();
+            }
+        }
+    }
+
+    DnsLogRecord record;
+    while (ring.pop(record)) {
+        append(record);
+    }
+    writeOut(true);
+    file.close();
+    if (history) {
+        history->flush();
+    }
+}
+
+void DnsQueryLog::append(const DnsLogRecord &record) {
+    char line[DNS_LOG_NAME_MAX + 48];
+    int length = snprintf(line, sizeof(line), "%lu Query: %s IP: %u.%u.%u.%u\n",
+                          (unsigned long)record.timestamp, record.name,
+                          (unsigned)(record.addr & 0xFF), (unsigned)((record.addr >> 8) & 0xFF),
+                          (unsigned)((record.addr >> 16) & 0xFF), (unsigned)(record.addr >> 24));
+    if (length <= 0) {
+        return;
+    }
+
+    // Rotate on a line boundary so no entry is split across files.
+    if (fileSize + batchUsed + length > DNS_LOG_MAX_FILE_SIZE) {
+        writeOut(true);
+        rotate();
+    }
+    if (batchUsed + length > DNS_LOG_BATCH_SIZE) {
+        writeOut(false);
+    }
+    memcpy(batch + batchUsed, line, length);
+    batchUsed += length;
+    written++;
+
+    if (history) {
+        history->record(record.name, record.addr, record.timestamp);
+    }
+}
+
+// Short of `all`, only up to the last sector boundary of the file, which is
+// not the batch's own after an appended-to file or an idle flush.
+void DnsQueryLog::writeOut(bool all) {
+    size_t length = batchUsed;
+    if (!all) {
+        size_t end = fileSize + batchUsed;
+        end -= end % DNS_LOG_SECTOR_SIZE;
+        length = end > fileSize ? end - fileSize : 0;
+    }
+    if (length == 0) {
+        return;
+    }
+    if (!file && !openActive()) {
+        // No card: the batch is lost, but the pipeline keeps draining.
+        errors++;
+        batchUsed = 0;
+        return;
+    }
+    size_t n = file.write(batch, length);
+    if (n != length) {
+        errors++;
+    }
+    if (all) {
+        file.flush();
+    }
+    fileSize += n;
+    writes++;
+    memmove(batch, batch + length, batchUsed - length);
+    batchUsed -= length;
+}
+
+bool DnsQueryLog::openActive() {
+    char path[32];
+    dnsLogFileName(path, sizeof(path), 0);
+    file = fs->open(path, FILE_APPEND);
+    if (!file) {
+        fileSize = 0;
+        return false;
+    }
+    fileSize = file.size();
+    return true;
+}
+
+void DnsQueryLog::rotate() {
+    char oldName[32];
+    char newName[32];
+    file.close();
+    for (int i = DNS_LOG_MAX_FILES - 1; i > 0; i--) {
+        dnsLogFileName(oldName, sizeof(oldName), i);
+        dnsLogFileName(newName, sizeof(newName), i - 1);
+        if (fs->exists(oldName)) {
+            fs->remove(oldName);
+        }
+        if (fs->exists(newName)) {
+            fs->rename(newName, oldName);
+        }
+    }
+    rotations++;
+    openActive();
+}
@@ -0,0 +1,73 @@
+#ifndef DNSQUERYLOG_H
+#define DNSQUERYLOG_H
+
+#include <atomic>
+#include <FS.h>
+#include <FreeRTOS.h>
+#include "DnsLogRing.h"
+#include "DnsHistory.h"
+
+#define DNS_LOG_FILE_BASE_NAME  "/dnslog"
+#define DNS_LOG_FILE_EXTENSION  ".txt"
+#define DNS_LOG_MAX_FILES       5
+#define DNS_LOG_MAX_FILE_SIZE   (1024 * 10)
+#define DNS_LOG_RING_CAPACITY   256
+#define DNS_LOG_SECTOR_SIZE     512
+#define DNS_LOG_BATCH_SIZE      (DNS_LOG_SECTOR_SIZE * 8)
+#define DNS_LOG_FLUSH_MS        2000
+
+struct DnsQueryLogStats {
+    uint32_t dropped;       // records the ring had no room for
+    uint32_t written;
+    uint32_t writes;
+    uint32_t rotations;
+    uint32_t errors;
+};
+
+// "/dnslog<index>.txt"; index 0 is the file being written.
+void dnsLogFileName(char *out, size_t size, int index);
+
+// Query log pipeline.
+// DNS workers hand records to a lock-free ring and never touch the card.
+// A low-priority writer task drains the ring into a batch buffer, keeps the
+// active log file open, and writes up to the file's sector boundaries; the
+// tail is written once the log has been idle for DNS_LOG_FLUSH_MS. Files
+// rotate when they reach DNS_LOG_MAX_FILE_SIZE. Records the ring has no room
+// for are counted in stats().dropped. When a history store is attached, the
+// writer also records each answer there, off the DNS workers' path.
+class DnsQueryLog {
+public:
+    DnsQueryLog();
+
+    bool begin(fs::FS &fs, DnsHistory *history = NULL, UBaseType_t priority = 0);
+    void end();
+
+    // Never blocks; returns false if the record had to be dropped.
+    bool log(const char *name, uint32_t addr);
+
+    DnsQueryLogStats stats() const;
+
+private:
+    static void writerTask(void *arg);
+    void run();
+    void append(const DnsLogRecord &record);
+    void writeOut(bool all);
+    bool openActive();
+    void rotate();
+
+    DnsLogRing ring;
+    fs::FS *fs;
+    DnsHistory *history;
+    File file;
+    size_t fileSize;
+    uint8_t *batch;
+    size_t batchUsed;
+    std::atomic<TaskHandle_t> task;     // cleared by the writer as it leaves
+    std::atomic<bool> running;
+    uint32_t written;
+    uint32_t writes;
+    uint32_t rotations;
+    uint32_t errors;
+};
+
+#endif // DNSQUERYLOG_H
@@ -0,0 +1,289 @@
+#include "DnsTcpServer.h"
+#include "DnsPlatform.h"
+#include <string.h>
+#include <errno.h>
+
+#ifndef ARDUINO
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define DNS_HEADER_SIZE 12
+
+// A peer that went away must not take the host process down with SIGPIPE.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+DnsTcpServer::DnsTcpServer() : pool(NULL), listener(-1), callback(NULL), callbackArg(NULL) {
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        conns[i].sock = -1;
+        conns[i].generation = 0;
+    }
+    memset(&counters, 0, sizeof(counters));
+}
+
+DnsTcpServer::~DnsTcpServer() {
+    end();
+}
+
+bool DnsTcpServer::begin(uint16_t port, DnsBufferPool &bufferPool, DnsTcpQueryCallback cb, void *arg) {
+    end();
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(listener, (struct sockaddr *)&local, sizeof(local)) < 0 ||
+            listen(listener, DNS_TCP_MAX_CONNECTIONS) < 0) {
+        end();
+        return false;
+    }
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL, 0) | O_NONBLOCK);
+
+    pool = &bufferPool;
+    callback = cb;
+    callbackArg = arg;
+    memset(&counters, 0, sizeof(counters));
+    return true;
+}
+
+void DnsTcpServer::end() {
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        if (conns[i].sock >= 0) {
+            closeConnection(i);
+        }
+    }
+    if (listener >= 0) {
+        close(listener);
+        listener = -1;
+    }
+}
+
+int DnsTcpServer::prepareSelect(fd_set &readable, fd_set &writable) const {
+    if (listener < 0) {
+        return -1;
+    }
+    FD_SET(listener, &readable);
+    int highest = listener;
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        const Connection &c = conns[i];
+        if (c.sock < 0) {
+            continue;
+        }
+        // A connection with its pipeline full is not read until answers
+        // drain, which pushes back on the client through the TCP window.
+        if (c.pending < DNS_TCP_MAX_PIPELINED && c.rxUsed < pool->bufferSize()) {
+            FD_SET(c.sock, &readable);
+        }
+        if (c.txUsed > 0) {
+            FD_SET(c.sock, &writable);
+        }
+        if (c.sock > highest) {
+            highest = c.sock;
+        }
+    }
+    return highest;
+}
+
+void DnsTcpServer::poll(uint32_t now) {
+    if (listener < 0) {
+        return;
+    }
+    acceptConnections(now);
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        Connection &c = conns[i];
+        if (c.sock < 0) {
+            continue;
+        }
+        bool open = flush(i) && receive(i, now) && !c.failed;
+        if (open && dnsTimeReached(now, c.lastActive + DNS_TCP_IDLE_TIMEOUT_MS)) {
+            counters.idleClosed++;
+            open = false;
+        }
+        if (!open) {
+            closeConnection(i);
+        }
+    }
+}
+
+void DnsTcpServer::acceptConnections(uint32_t now) {
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        int sock = accept(listener, (struct sockaddr *)&from, &fromLength);
+        if (sock < 0) {
+            return;
+        }
+
+        int index = -1;
+        for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS && index < 0; i++) {
+            if (conns[i].sock < 0) {
+                index = i;
+            }
+        }
+        if (index < 0) {
+            index = victim();
+            if (index >= 0) {
+                closeConnection(index);
+            }
+        }
+        uint8_t *rx = index >= 0 ? pool->acquire() : NULL;
+        uint8_t *tx = rx ? pool->acquire() : NULL;
+        if (!tx) {
+            pool->release(rx);
+            close(sock);
+            counters.refused++;
+            continue;
+        }
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+        Connection &c = conns[index];
+        c.sock = sock;
+        c.addr = from.sin_addr.s_addr;
+        c.port = ntohs(from.sin_port);
+        c.generation++;
+        c.pending = 0;
+        c.failed = false;
+        c.lastActive = now;
+        c.rx = rx;
+        c.tx = tx;
+        c.rxUsed = 0;
+        c.txUsed = 0;
+        counters.accepted++;
+    }
+}
+
+bool DnsTcpServer::receive(int index, uint32_t now) {
+    Connection &c = conns[index];
+    size_t size = pool->bufferSize();
+    if (c.pending < DNS_TCP_MAX_PIPELINED && c.rxUsed < size) {
+        int n = recv(c.sock, c.rx + c.rxUsed, size - c.rxUsed, 0);
+        if (n == 0 || (n < 0 && !wouldBlock())) {
+            return false;
+        }
+        if (n > 0) {
+            c.rxUsed += (uint16_t)n;
+            c.lastActive = now;
+        }
+    }
+
+    // Every message is prefixed with its length; hand out all complete ones.
+    uint16_t at = 0;
+    while (c.pending < DNS_TCP_MAX_PIPELINED && c.rxUsed - at >= 2) {
+        uint16_t length = (c.rx[at] << 8) | c.rx[at + 1];
+        if (length < DNS_HEADER_SIZE || length + 2u > size) {
+            return false;
+        }
+        if (c.rxUsed - at < 2 + length) {
+            break;
+        }
+        const uint8_t *query = c.rx + at + 2;
+        DnsClient client = {c.addr, c.port, (uint16_t)((query[0] << 8) | query[1]), 0, handle(index)};
+        c.pending++;
+        counters.queries++;
+        callback(client, query, length, callbackArg);
+        if (c.failed) {
+            return false;
+        }
+        at += 2 + length;
+    }
+    if (at > 0) {
+        memmove(c.rx, c.rx + at, c.rxUsed - at);
+        c.rxUsed -= at;
+    }
+    return true;
+}
+
+bool DnsTcpServer::reply(const DnsClient &client, const uint8_t *response, size_t length) {
+    int index = (client.connection & 0xFF) - 1;
+    if (index < 0 || index >= DNS_TCP_MAX_CONNECTIONS) {
+        return false;
+    }
+    Connection &c = conns[index];
+    if (c.sock < 0 || c.failed || handle(index) != client.connection) {
+        return false;
+    }
+    if (c.pending > 0) {
+        c.pending--;
+    }
+    size_t size = pool->bufferSize();
+    if (c.txUsed + 2 + length > size && (!flush(index) || c.txUsed + 2 + length > size)) {
+        // The client is not reading; RFC 7766 lets us give up on it.
+        counters.overflows++;
+        c.failed = true;
+        return false;
+    }
+    c.tx[c.txUsed] = (uint8_t)(length >> 8);
+    c.tx[c.txUsed + 1] = (uint8_t)length;
+    memcpy(c.tx + c.txUsed + 2, response, length);
+    c.txUsed += (uint16_t)(2 + length);
+    c.lastActive = dnsMillis();
+    if (!flush(index)) {
+        c.failed = true;
+    }
+    return !c.failed;
+}
+
+bool DnsTcpServer::flush(int index) {
+    Connection &c = conns[index];
+    while (c.txUsed > 0) {
+        int n = send(c.sock, c.tx, c.txUsed, MSG_NOSIGNAL);
+        if (n < 0) {
+            return wouldBlock();
+        }
+        memmove(c.tx, c.tx + n, c.txUsed - n);
+        c.txUsed -= (uint16_t)n;
+    }
+    return true;
+}
+
+void DnsTcpServer::closeConnection(int index) {
+    Connection &c = conns[index];
+    close(c.sock);
+    c.sock = -1;
+    pool->release(c.rx);
+    pool->release(c.tx);
+    c.rx = NULL;
+    c.tx = NULL;
+}
+
+// Longest idle connection with nothing in flight, or -1.
+int DnsTcpServer::victim() const {
+    int best = -1;
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        const Connection &c = conns[i];
+        if (c.sock >= 0 && c.pending == 0 && c.txUsed == 0 &&
+                (best < 0 || (int32_t)(c.lastActive - conns[best].lastActive) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint16_t DnsTcpServer::handle(int index) const {
+    return (uint16_t)((conns[index].generation << 8) | (index + 1));
+}
+
+uint32_t DnsTcpServer::connections() const {
+    uint32_t open = 0;
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        if (conns[i].sock >= 0) {
+            open++;
+        }
+    }
+    return open;
+}
@@ -0,0 +1,96 @@
+#ifndef DNSTCPSERVER_H
+#define DNSTCPSERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DnsBufferPool.h"
+#include "DnsForwarder.h"
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#else
+#include <sys/select.h>
+#endif
+
+#ifndef DNS_TCP_MAX_CONNECTIONS
+#define DNS_TCP_MAX_CONNECTIONS     4
+#endif
+#define DNS_TCP_MAX_PIPELINED       8       // unanswered queries per connection
+#define DNS_TCP_IDLE_TIMEOUT_MS     10000   // RFC 7766 section 6.2.3: seconds, not minutes
+
+struct DnsTcpStats {
+    uint32_t accepted;
+    uint32_t refused;
+    uint32_t queries;
+    uint32_t idleClosed;
+    uint32_t overflows;
+};
+
+// Called for every complete query read from a connection. `client` carries
+// the connection handle to pass back to reply(); `query` is only valid
+// during the call. A query that never gets an answer holds one of the
+// connection's DNS_TCP_MAX_PIPELINED slots until the connection idles out.
+typedef void (*DnsTcpQueryCallback)(const DnsClient &client, const uint8_t *query, size_t length, void *arg);
+
+// DNS over TCP (RFC 7766) on non-blocking sockets.
+// Connections stay open between queries and several queries may be in
+// flight on one of them; answers go out in whatever order they are ready,
+// matched by the client through the message ID. Each connection takes a
+// receive and a send buffer from the pool, so a message is at most
+// pool.bufferSize() - 2 bytes. When every slot is taken, the connection that
+// has been idle longest makes room for a new one.
+//
+// Not thread-safe: poll() and reply() must run on the same task.
+class DnsTcpServer {
+public:
+    DnsTcpServer();
+    ~DnsTcpServer();
+
+    bool begin(uint16_t port, DnsBufferPool &pool, DnsTcpQueryCallback cb, void *arg = NULL);
+    void end();
+
+    // Adds the sockets poll() wants to service; returns the highest
+    // descriptor added, or -1.
+    int prepareSelect(fd_set &readable, fd_set &writable) const;
+
+    // Accepts, reads, flushes and closes idle connections. Never blocks.
+    void poll(uint32_t now);
+
+    // Queues an answer for a client that asked over TCP. Fails if the
+    // connection has gone away since the query arrived.
+    bool reply(const DnsClient &client, const uint8_t *response, size_t length);
+
+    uint32_t connections() const;
+    const DnsTcpStats &stats() const { return counters; }
+
+private:
+    struct Connection {
+        int sock;
+        uint32_t addr;
+        uint16_t port;
+        uint8_t generation;
+        uint8_t pending;        // queries handed out, not yet answered
+        bool failed;            // closed by the next poll()
+        uint32_t lastActive;
+        uint8_t *rx;
+        uint8_t *tx;
+        uint16_t rxUsed;
+        uint16_t txUsed;
+    };
+
+    void acceptConnections(uint32_t now);
+    bool receive(int index, uint32_t now);
+    bool flush(int index);
+    void closeConnection(int index);
+    int victim() const;
+    uint16_t handle(int index) const;
+
+    Connection conns[DNS_TCP_MAX_CONNECTIONS];
+    DnsBufferPool *pool;
+    int listener;
+    DnsTcpQueryCallback callback;
+    void *callbackArg;
+    DnsTcpStats counters;
+};
+
+#endif // DNSTCPSERVER_H
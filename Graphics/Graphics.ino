@@ -19,13 +19,15 @@
  */
 #include <LilyGo_AMOLED.h>
 #include <LV_Helper.h>
+#include <lvglAlloc.h>
+#include <lvglBlend.h>
 #include <Arduino.h>
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
 #include <WiFi.h>
 #include <time.h>
 #include <lvgl.h>
-#include "gui.h"
+#include "Gui.h"
 #include <esp_sntp.h>
 #include "zones.h"
 #include <Adafruit_NeoPixel.h>      //https://github.com/adafruit/Adafruit_NeoPixel
@@ -33,6 +35,10 @@
 #include <cJSON.h>
 #include "rootCa.h"
 #include <esp_wifi.h>
+#ifdef DNS_BENCHMARK
+#include "LocalDNS.h"
+#include "DnsBench.h"
+#endif
 
 using namespace ace_button;
 
@@ -101,6 +107,30 @@ static CoinMarketCapApiDataStream coinData[4];
 static String httpBody;
 extern CoinMarketCapApiSubsribe coinSubsribe[4] ;
 
+#ifdef DNS_BENCHMARK
+// Build with -DDNS_BENCHMARK to measure the DNS server at boot: it is pointed
+// at a loopback stand-in upstream and driven over loopback UDP. Answers go
+// into the query log and history, so use a scratch SD card.
+void dnsBenchmarkTask(void *ptr)
+{
+    DnsBenchConfig config;
+    dnsBenchDefaults(config);
+    setDnsUpstream(IPAddress(127, 0, 0, 1), config.upstreamPort);
+    startDnsServer();
+
+    DnsBenchResult result;
+    char line[256];
+    if (runDnsBenchmark(config, result)) {
+        formatDnsBenchResult(result, line, sizeof(line));
+        Serial.printf("[DNS bench] %s\n", line);
+    } else {
+        Serial.println("[DNS bench] Could not open the benchmark sockets");
+    }
+    stopDnsServer();
+    vTaskDelete(NULL);
+}
+#endif
+
 
 void buttonHandleEvent(AceButton *button,
                        uint8_t eventType,
@@ -268,6 +298,58 @@ void setup()
     // Draw Factory GUI
     factoryGUI();
 
+#ifdef DISPLAY_BENCHMARK
+    // Build with -DDISPLAY_BENCHMARK to compare blocking and DMA-queued flushes
+    lv_refr_now(NULL);
+    bool vsync = lvglHelperSetVsync(false);
+    lvglHelperSetAsyncFlush(false);
+    float pollingFps = lvglHelperMeasureFps(100);
+    bool async = lvglHelperSetAsyncFlush(true);
+    float asyncFps = async ? lvglHelperMeasureFps(100) : 0;
+    Serial.printf("[Display bench] polling %.1f fps, async %.1f fps\n", pollingFps, asyncFps);
+    if (vsync) {
+        lvglHelperSetVsync(true);
+        float vsyncFps = lvglHelperMeasureFps(100);
+        LvglVsyncStats stats = lvglHelperGetVsyncStats();
+        Serial.printf("[Display bench] vsync %.1f fps, refresh %lu us, missed %lu of %lu\n", vsyncFps,
+                      (unsigned long)stats.periodUs, (unsigned long)stats.missed, (unsigned long)stats.frames);
+    }
+    if (lvglHelperSetScanlineDiff(true)) {
+        // The first frame fills the copy of the panel; asking again clears the stats
+        lv_refr_now(NULL);
+        lvglHelperSetScanlineDiff(true);
+        float diffFps = lvglHelperMeasureFps(100);
+        LvglDiffStats stats = lvglHelperGetDiffStats();
+        Serial.printf("[Display bench] scanline diff %.1f fps, sent %llu of %llu bytes\n", diffFps,
+                      (unsigned long long)stats.sentBytes, (unsigned long long)stats.renderedBytes);
+        lvglHelperSetScanlineDiff(false);
+    }
+    LvglPipelineStats pipeline = lvglHelperGetPipelineStats();
+    // Build once more with LV_COLOR_16_SWAP 1 in lv_conf.h for the render time
+    // in the panel's byte order
+    Serial.printf("[Display bench] %s byte order: render %lu us, latency max %lu us, per flush %lu px rotate %lu us spi %lu us, queue %u\n",
+                  LV_COLOR_16_SWAP ? "panel" : "native", (unsigned long)pipeline.renderUs, (unsigned long)pipeline.maxLatencyUs,
+                  (unsigned long)pipeline.pixelsPerFlush, (unsigned long)pipeline.rotateUs,
+                  (unsigned long)pipeline.spiUs, pipeline.maxQueueDepth);
+    // Build again with -DLVGL_ALLOC_POOL_SIZE=0 for the render time with every
+    // LVGL block in PSRAM
+    LvglAllocStats heap;
+    lvglAllocGetStats(&heap);
+    Serial.printf("[Display bench] lvgl heap: pool %lu/%lu bytes peak %lu, free %lu largest %lu frag %u%%, "
+                  "psram %lu bytes peak %lu, allocs %lu pool %lu psram %lu fallback\n",
+                  (unsigned long)heap.poolUsed, (unsigned long)heap.poolSize, (unsigned long)heap.poolPeak,
+                  (unsigned long)heap.poolFree, (unsigned long)heap.poolLargestFree, heap.poolFragmentation,
+                  (unsigned long)heap.psramUsed, (unsigned long)heap.psramPeak, (unsigned long)heap.poolAllocs,
+                  (unsigned long)heap.psramAllocs, (unsigned long)heap.fallbacks);
+    for (int op = 0; op < LVGL_BLEND_OP_COUNT; op++) {
+        float lvgl = lvglBlendMeasure(NULL, (LvglBlendOp)op, 240, 60, 50);
+        float portable = lvglBlendMeasure(&lvglBlendPortable, (LvglBlendOp)op, 240, 60, 50);
+        Serial.printf("[Display bench] blend %s: lvgl %.1f Mpx/s, %s %.1f Mpx/s\n", lvglBlendOpName((LvglBlendOp)op),
+                      lvgl, lvglBlendPortable.name, portable);
+    }
+    lvglHelperShowStats(true);
+#endif
+
 
     WiFi.mode(WIFI_STA);
 
@@ -321,6 +403,9 @@ void setup()
         checkMs = millis() + 200;
     }, NULL);
 
+#ifdef DNS_BENCHMARK
+    xTaskCreate(dnsBenchmarkTask, "dnsBench", 6 * 1024, NULL, 1, NULL);
+#endif
 }
 
 void loop()
@@ -8,7 +8,7 @@
  */
 
 #include <LilyGo_AMOLED.h>
-#include "gui.h"
+#include "Gui.h"
 #include <Adafruit_NeoPixel.h>
 #include <WiFi.h>
 #include "LocalDNS.h"
@@ -110,6 +110,22 @@ void DNS_UI(lv_obj_t *parent) {
         // Code to stop DNS server here
         stopDnsServer();
     }, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *stats_label = lv_label_create(cont);
+    lv_label_set_text(stats_label, "");
+    lv_obj_set_style_text_color(stats_label, lv_color_white(), LV_PART_MAIN);
+    lv_obj_align_to(stats_label, btns_bg, LV_ALIGN_OUT_BOTTOM_MID, -23, 10);
+
+    lv_timer_create([](lv_timer_t *t) {
+        lv_obj_t *label = (lv_obj_t *)t->user_data;
+        DnsServerStats s;
+        getDnsServerStats(s);
+        lv_label_set_text_fmt(label, "Queries %lu  Hits %lu  Neg %lu  Stale %lu\nForwarded %lu  Timeouts %lu  Blocked %lu  Unlogged %lu",
+                              (unsigned long)s.queries, (unsigned long)s.cacheHits, (unsigned long)s.negativeHits,
+                              (unsigned long)s.staleServed, (unsigned long)s.forwarded,
+                              (unsigned long)s.upstreamTimeouts, (unsigned long)s.blocked,
+                              (unsigned long)s.logDropped);
+    }, 1000, stats_label);
 }
 
 
@@ -297,8 +313,10 @@ static void pixels_event_handler(lv_event_t *e)
             break;
         case 3: {
             lv_obj_t *cw =  (lv_obj_t *)lv_event_get_user_data(e);
-            lv_color_t c =  lv_colorwheel_get_rgb(cw);
-            pixels.setPixelColor(0, pixels.Color(c.ch.red, (c.ch.green_h << 3) | c.ch.green_l, c.ch.blue)); pixels.show();
+            // Whatever LV_COLOR_16_SWAP is, as 8-bit channels
+            lv_color32_t c;
+            c.full = lv_color_to32(lv_colorwheel_get_rgb(cw));
+            pixels.setPixelColor(0, pixels.Color(c.ch.red, c.ch.green, c.ch.blue)); pixels.show();
         }
         break;
         case 4: {
@@ -3,23 +3,25 @@
 #include <SPI.h>
 #include <SD.h>
 #include <FreeRTOS.h>
-
-struct DNSHeader {
-    uint16_t ID;
-    uint16_t Flags;
-    uint16_t QCount;
-    uint16_t AnsCount;
-    uint16_t AuthCount;
-    uint16_t AddCount;
-} __attribute__((packed));
-
-const int DNS_PORT = 53;
+#include <lwip/sockets.h>
+#include <atomic>
+#include "LocalDNS.h"
+#include "DnsBufferPool.h"
+#include "DnsCache.h"
+#include "DnsForwarder.h"
+#include "DnsTcpServer.h"
+#include "DnsMessage.h"
+#include "DnsHistory.h"
+#include "DnsOverrides.h"
+#include "DnsQueryLog.h"
+
+// Where the server listens, UDP and TCP. Host builds use an unprivileged one.
+#ifndef DNS_PORT
+#define DNS_PORT 53
+#endif
 const IPAddress UPSTREAM_DNS(9, 9, 9, 9); // Quad9 DNS for good security
+const uint16_t UPSTREAM_DNS_PORT = 53;
 const int CHIP_SELECT = 12;
-const char* LOG_FILE_BASE_NAME = "dnslog";
-const char* LOG_FILE_EXTENSION = ".txt";
-const int MAX_LOG_FILES = 5;
-const size_t MAX_LOG_FILE_SIZE = 1024 * 10;
 
 struct DomainMapping {
     const char* domainName;
@@ -33,295 +35,590 @@ DomainMapping domainMappings[] = {
 
 const int DOMAIN_MAPPINGS_COUNT = sizeof(domainMappings) / sizeof(DomainMapping);
 
-struct DnsCacheEntry {
-    char domainName[100];
-    IPAddress ipAddress;
+const uint32_t LOCAL_ANSWER_TTL = 60;
+// How long an upstream failure is remembered; RFC 2308 section 7 allows up
+// to five minutes.
+const uint32_t FAILURE_CACHE_TTL = 30;
+
+IPAddress upstreamAddress = UPSTREAM_DNS;
+uint16_t upstreamPort = UPSTREAM_DNS_PORT;
+
+#ifndef DNS_WORKER_COUNT
+#define DNS_WORKER_COUNT 2
+#endif
+const uint32_t DNS_WORKER_STACK = 6144;
+const UBaseType_t DNS_WORKER_PRIORITY = 1;
+// How often a blocked worker wakes up to notice the server stopping.
+const int DNS_RECEIVE_TIMEOUT_MS = 250;
+
+// Pool buffers hold a whole upstream answer plus the TCP length prefix.
+const size_t DNS_BUFFER_SIZE = DNS_FORWARDER_MAX_RESPONSE + 2;
+const uint32_t DNS_BUFFER_COUNT = (DNS_WORKER_COUNT + 1) * 2 + DNS_TCP_MAX_CONNECTIONS * 2;
+static_assert(DNS_BUFFER_COUNT <= DNS_BUFFER_POOL_MAX,
+              "The buffer pool tracks its buffers in one 32-bit mask; use fewer workers or TCP connections");
+
+#if DNS_EDNS_PAYLOAD_SIZE > DNS_FORWARDER_MAX_RESPONSE
+#error "The forwarder cannot receive DNS_EDNS_PAYLOAD_SIZE byte answers"
+#endif
+
+// Each worker owns its packet buffers, so nothing on the hot path is
+// shared between cores except the lock-free cache reads.
+struct DnsWorker {
+    TaskHandle_t task;
+    byte* query;
+    byte* response;
 };
 
-const int DNS_CACHE_SIZE = 10;
-DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
-
-WiFiUDP udp;
-TaskHandle_t dnsTaskHandle = NULL;
-volatile bool serverRunning = false;
-
-void DNSserverTask(void *pvParameters);
+DnsCache dnsCache;
+DnsForwarder upstreamForwarder;
+DnsHistory dnsHistory;
+DnsOverrides dnsOverrides;
+DnsQueryLog queryLog;
+
+DnsBufferPool bufferPool;
+DnsTcpServer tcpServer;
+
+DnsWorker dnsWorkers[DNS_WORKER_COUNT];
+// Queries arriving over TCP are handled on the upstream task.
+DnsWorker tcpWorker;
+TaskHandle_t upstreamTaskHandle = NULL;
+DnsLock forwarderLock;
+int dnsSocket = -1;
+std::atomic<bool> serverRunning(false);
+std::atomic<uint32_t> queryCount(0);
+std::atomic<uint32_t> blockedCount(0);
+
+void dnsWorkerTask(void *pvParameters);
+void upstreamTask(void *pvParameters);
 bool startDnsServer();
 void stopDnsServer();
-void processDnsQueries();
+bool openDnsSocket();
+bool allocateBuffers();
+bool dnsTasksRunning();
 void setupWifiWithSmartConfig();
-void DNSsetup();
-void handleDnsQuery(const byte* query, int querySize, WiFiUDP& udp);
-void setupDNSResponseHeader(byte* response, int* responseSize, const byte* query);
-void appendDNSAnswer(byte* response, int* responseSize, IPAddress ip);
-void setResponseCodeNXDOMAIN(byte* response, int* responseSize);
-bool forwardQueryToUpstream(const byte* query, int querySize, IPAddress& responseIp);
-bool extractIPFromResponse(const byte* response, int packetSize, IPAddress& ip);
-bool lookupCache(const char* domain, IPAddress& ip);
-bool extractDomainNameFromQuery(const byte* query, int querySize, char* queryDomain);
-bool findDomainIP(const char* domain, IPAddress& outIpAddress);
-void addCacheEntry(const char* domain, const IPAddress& ip);
-void logToSDCard(const char* logMessage);
-void rotateLogs();
-bool findInLogs(const char* domain, IPAddress& ipAddress);
-void sendDnsResponse(WiFiUDP& udp, const byte* response, int responseSize);
-
-void DNSsetup() {
+bool DNSsetup();
+void handleDnsQuery(DnsWorker& worker, DnsClient client, size_t querySize);
+bool forwardQuery(DnsWorker& worker, const DnsClient& client, size_t querySize);
+void onTcpQuery(const DnsClient& client, const uint8_t* query, size_t length, void* arg);
+void onUpstreamAnswer(const DnsClient& client, const uint8_t* response, size_t length, void* arg);
+void cacheUpstreamAnswer(const uint8_t* response, size_t length);
+bool extractIPFromResponse(const DnsMessageView& response, IPAddress& ip, uint32_t& ttl);
+uint32_t negativeTtl(const DnsMessageView& response);
+DnsOverrideResult findOverride(const char* domain, IPAddress& outIpAddress);
+void loadOverrides(bool haveCard);
+void addCacheEntry(const char* domain, const IPAddress& ip, uint32_t ttl);
+bool findInHistory(const char* domain, IPAddress& ipAddress);
+void importTextLogs();
+void sendDnsResponse(const DnsClient& client, const byte* response, size_t length);
+void sendDnsResponseTo(const IPAddress& ip, uint16_t port, const byte* response, int responseSize);
+
+bool DNSsetup() {
     Serial.begin(115200);
     if (!SD.begin(CHIP_SELECT)) {
         Serial.println("Card Mount Failed");
-        return;
+        return false;
     }
-    Serial.println("SD Card initialized.");}
+    Serial.println("SD Card initialized.");
+    return true;
+}
 
 bool startDnsServer() {
-    DNSsetup();
-    if (dnsTaskHandle == NULL) {
-        serverRunning = true;
-        xTaskCreate(DNSserverTask, "DNS Server Task", 4096, NULL, 1, &dnsTaskHandle);
-        Serial.println("DNS Server task created and started.");
+    if (serverRunning) {
+        return WiFi.isConnected();
+    }
+    bool haveCard = DNSsetup();
+    loadOverrides(haveCard);
+    if (haveCard) {
+        DnsHistory* history = NULL;
+        if (dnsHistory.begin(SD)) {
+            if (dnsHistory.size() == 0) {
+                importTextLogs();
+            }
+            history = &dnsHistory;
+        } else {
+            Serial.println("DNS history store could not be opened.");
+        }
+        if (!queryLog.begin(SD, history)) {
+            Serial.println("DNS query log could not be started.");
+        }
+    }
+    if (dnsCache.capacity() == 0 && !dnsCache.begin(DNS_CACHE_CAPACITY)) {
+        Serial.println("DNS cache allocation failed.");
+        return false;
+    }
+    // The cache outlives a stop; nothing swept it in the meantime.
+    dnsCache.sweep(millis(), dnsCache.capacity());
+    if (bufferPool.capacity() == 0 && !allocateBuffers()) {
+        Serial.println("DNS buffer pool allocation failed.");
+        return false;
     }
+    if (!forwarderLock.begin() || !openDnsSocket()) {
+        Serial.println("Failed to open DNS server socket.");
+        return false;
+    }
+    if (!upstreamForwarder.begin((uint32_t)upstreamAddress, upstreamPort, onUpstreamAnswer)) {
+        Serial.println("Failed to open upstream DNS socket.");
+    }
+    if (!tcpServer.begin(DNS_PORT, bufferPool, onTcpQuery)) {
+        Serial.println("Failed to open DNS TCP listener.");
+    }
+
+    serverRunning = true;
+    xTaskCreate(upstreamTask, "DNS Upstream", DNS_WORKER_STACK, NULL, DNS_WORKER_PRIORITY, &upstreamTaskHandle);
+    for (int i = 0; i < DNS_WORKER_COUNT; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "DNS Worker %d", i);
+        xTaskCreatePinnedToCore(dnsWorkerTask, name, DNS_WORKER_STACK, &dnsWorkers[i], DNS_WORKER_PRIORITY,
+                                &dnsWorkers[i].task, i % portNUM_PROCESSORS);
+    }
+    Serial.printf("DNS Server started with %d workers.\n", DNS_WORKER_COUNT);
     return WiFi.isConnected() && serverRunning;
 }
 
 void stopDnsServer() {
-    if (dnsTaskHandle != NULL) {
-        serverRunning = false;
-        vTaskDelete(dnsTaskHandle);
-        dnsTaskHandle = NULL;
-        udp.stop();
-        Serial.println("DNS Server stopped and task deleted.");
+    if (!serverRunning) {
+        return;
     }
+    // Tasks blocked in the socket calls notice within a receive timeout and
+    // leave on their own; deleting them mid-call could strand lwIP state.
+    serverRunning = false;
+    while (dnsTasksRunning()) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    // Fails the clients still waiting, so it needs the server sockets open.
+    upstreamForwarder.end();
+    tcpServer.end();
+    close(dnsSocket);
+    dnsSocket = -1;
+    queryLog.end();
+    dnsHistory.end();
+    Serial.println("DNS Server stopped.");
 }
 
-void DNSserverTask(void *pvParameters) {
-    udp.begin(DNS_PORT);
-    while (serverRunning) {
-        processDnsQueries();
-        vTaskDelay(pdMS_TO_TICKS(10));
+void setDnsUpstream(const IPAddress& addr, uint16_t port) {
+    upstreamAddress = addr;
+    upstreamPort = port;
+}
+
+void getDnsServerStats(DnsServerStats& stats) {
+    DnsCacheStats cache = dnsCache.stats();
+    stats.queries = queryCount.load(std::memory_order_relaxed);
+    stats.cacheHits = cache.hits;
+    stats.cacheMisses = cache.misses;
+    stats.negativeHits = cache.negativeHits;
+    stats.staleServed = cache.staleHits;
+    stats.refreshes = cache.refreshes;
+    stats.blocked = blockedCount.load(std::memory_order_relaxed);
+    stats.cachedNames = dnsCache.size();
+    stats.logDropped = queryLog.stats().dropped;
+    forwarderLock.lock();
+    stats.forwarded = upstreamForwarder.stats().forwarded;
+    stats.upstreamTimeouts = upstreamForwarder.stats().timeouts;
+    forwarderLock.unlock();
+}
+
+bool openDnsSocket() {
+    dnsSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (dnsSocket < 0) {
+        return false;
     }
-    vTaskDelete(NULL);
+    struct timeval timeout = {0, DNS_RECEIVE_TIMEOUT_MS * 1000};
+    setsockopt(dnsSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(DNS_PORT);
+    if (bind(dnsSocket, (struct sockaddr*)&local, sizeof(local)) < 0) {
+        close(dnsSocket);
+        dnsSocket = -1;
+        return false;
+    }
+    return true;
 }
 
-void processDnsQueries() {
-    int packetSize = udp.parsePacket();
-    if (packetSize > 0) {
-        byte query[512];
-        udp.read(query, packetSize);
-        handleDnsQuery(query, packetSize, udp);
+// Taken once and kept across restarts; TCP connections borrow the rest.
+bool allocateBuffers() {
+    if (!bufferPool.begin(DNS_BUFFER_COUNT, DNS_BUFFER_SIZE)) {
+        return false;
+    }
+    for (int i = 0; i < DNS_WORKER_COUNT; i++) {
+        dnsWorkers[i].query = bufferPool.acquire();
+        dnsWorkers[i].response = bufferPool.acquire();
     }
+    tcpWorker.query = bufferPool.acquire();
+    tcpWorker.response = bufferPool.acquire();
+    return tcpWorker.response != NULL;
 }
 
-void handleDnsQuery(const byte* query, int querySize, WiFiUDP& udp) {
-    IPAddress responseIp;
-    byte response[512];
-    int responseSize = 0;
-    char queryDomain[256];
-
-    if (extractDomainNameFromQuery(query, querySize, queryDomain)) {
-        if (!lookupCache(queryDomain, responseIp) && !findInLogs(queryDomain, responseIp) && !findDomainIP(queryDomain, responseIp)) {
-            if (!forwardQueryToUpstream(query, querySize, responseIp)) {
-                setResponseCodeNXDOMAIN(response, &responseSize);
-            } else {
-                addCacheEntry(queryDomain, responseIp);
-            }
+bool dnsTasksRunning() {
+    if (upstreamTaskHandle != NULL) {
+        return true;
+    }
+    for (int i = 0; i < DNS_WORKER_COUNT; i++) {
+        if (dnsWorkers[i].task != NULL) {
+            return true;
         }
+    }
+    return false;
+}
 
-        if (responseSize == 0) {
-            setupDNSResponseHeader(response, &responseSize, query);
-            appendDNSAnswer(response, &responseSize, responseIp);
+// All workers block on the one socket; lwIP hands each datagram to exactly
+// one of them, which spreads the load without a dispatcher.
+void dnsWorkerTask(void *pvParameters) {
+    DnsWorker* worker = (DnsWorker*)pvParameters;
+    while (serverRunning) {
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        int packetSize = recvfrom(dnsSocket, worker->query, bufferPool.bufferSize(), 0,
+                                  (struct sockaddr*)&from, &fromLength);
+        if (packetSize > 0) {
+            DnsClient client = {from.sin_addr.s_addr, ntohs(from.sin_port)};
+            handleDnsQuery(*worker, client, packetSize);
         }
-
-        sendDnsResponse(udp, response, responseSize);
     }
+    worker->task = NULL;
+    vTaskDelete(NULL);
 }
 
-void setupDNSResponseHeader(byte* response, int* responseSize, const byte* query) {
-    DNSHeader* dnsHeader = (DNSHeader*)response;
-    DNSHeader* queryHeader = (DNSHeader*)query;
-
-    dnsHeader->ID = queryHeader->ID;
-    dnsHeader->Flags = htons(0x8400);
-    dnsHeader->QCount = htons(1);
-    dnsHeader->AnsCount = htons(1);
-    dnsHeader->AuthCount = 0;
-    dnsHeader->AddCount = 0;
-
-    *responseSize = sizeof(DNSHeader);
+// Owns the upstream side and the TCP connections: sleeps until a socket is
+// ready or the next timer wheel tick is due. Answers for TCP clients are
+// only ever sent from here, so the TCP server needs no lock of its own.
+void upstreamTask(void *pvParameters) {
+    while (serverRunning) {
+        fd_set readable;
+        fd_set writable;
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+        int fd = upstreamForwarder.socketFd();
+        if (fd >= 0) {
+            FD_SET(fd, &readable);
+        }
+        int highest = tcpServer.prepareSelect(readable, writable);
+        if (fd > highest) {
+            highest = fd;
+        }
+        if (highest >= 0) {
+            struct timeval timeout = {0, DNS_WHEEL_TICK_MS * 1000};
+            select(highest + 1, &readable, &writable, NULL, &timeout);
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(DNS_WHEEL_TICK_MS));
+        }
+        forwarderLock.lock();
+        upstreamForwarder.poll(millis());
+        forwarderLock.unlock();
+        tcpServer.poll(millis());
+        dnsCache.sweep(millis());
+    }
+    upstreamTaskHandle = NULL;
+    vTaskDelete(NULL);
 }
 
-void appendDNSAnswer(byte* response, int* responseSize, IPAddress ip) {
-    int index = *responseSize;
-
-    response[index++] = 0xC0;
-    response[index++] = 0x0C;
-
-    response[index++] = 0x00;
-    response[index++] = 0x01;
-
-    response[index++] = 0x00;
-    response[index++] = 0x01;
-
-    uint32_t ttl = htonl(60);
-    memcpy(response + index, &ttl, sizeof(ttl));
-    index += sizeof(ttl);
+void handleDnsQuery(DnsWorker& worker, DnsClient client, size_t querySize) {
+    DnsMessageView message;
+    DnsQuestion question;
+    char queryDomain[DNS_NAME_BUFFER_SIZE];
+    if (!message.parse(worker.query, querySize) || message.isResponse() || !message.firstQuestion(question) ||
+            !question.name.toString(queryDomain, sizeof(queryDomain))) {
+        return;
+    }
+    queryCount.fetch_add(1, std::memory_order_relaxed);
+    client.id = message.id();
+    uint16_t payloadSize = message.ednsPayloadSize();
+    client.payloadSize = payloadSize > DNS_EDNS_PAYLOAD_SIZE ? DNS_EDNS_PAYLOAD_SIZE : payloadSize;
+
+    // Overrides come first so a blocked name is never served from the cache
+    // or the history. The cache and the history only hold A records; local
+    // mappings answer every type for their name so other types cannot leak
+    // past them.
+    IPAddress responseIp;
+    uint32_t responseTtl = LOCAL_ANSWER_TTL;
+    uint8_t rcode = DNS_RCODE_NOERROR;
+    bool isA = question.type == DNS_TYPE_A;
+    bool found = false;
+    bool answered = false;
+    bool refresh = false;
+    DnsOverrideResult rule = findOverride(queryDomain, responseIp);
+    if (rule == DNS_OVERRIDE_BLOCKED) {
+        blockedCount.fetch_add(1, std::memory_order_relaxed);
+        rcode = DNS_RCODE_NXDOMAIN;
+        answered = true;
+    } else if (rule == DNS_OVERRIDE_ADDRESS) {
+        found = answered = true;
+    } else if (isA) {
+        // Negative entries answer too: NXDOMAIN, an empty NOERROR, or the
+        // SERVFAIL upstream gave moments ago.
+        DnsCacheAnswer cached;
+        if (dnsCache.lookup(queryDomain, millis(), cached)) {
+            answered = true;
+            found = cached.kind == DNS_CACHE_ADDRESS;
+            responseIp = IPAddress(cached.addr);
+            responseTtl = cached.ttl;
+            if (cached.kind == DNS_CACHE_NXDOMAIN) {
+                rcode = DNS_RCODE_NXDOMAIN;
+            } else if (cached.kind == DNS_CACHE_SERVFAIL) {
+                rcode = DNS_RCODE_SERVFAIL;
+            }
+            refresh = cached.refresh;
+        } else if (findInHistory(queryDomain, responseIp)) {
+            // The history has no expiry of its own, so its address goes out
+            // as stale and upstream is asked to bring the cache up to date.
+            found = answered = refresh = true;
+            responseTtl = DNS_CACHE_STALE_TTL;
+        }
+    }
 
-    response[index++] = 0x00;
-    response[index++] = 0x04;
+    if (!answered) {
+        // The forwarder answers the client once upstream replies.
+        if (forwardQuery(worker, client, querySize)) {
+            return;
+        }
+        rcode = DNS_RCODE_SERVFAIL;
+    }
 
-    for (int i = 0; i < 4; i++) {
-        response[index++] = ip[i];
+    DnsMessageWriter writer(worker.response, bufferPool.bufferSize());
+    writer.beginResponse(message, rcode);
+    if (found && isA) {
+        writer.addA(NULL, responseTtl, (uint32_t)responseIp);
+        queryLog.log(queryDomain, (uint32_t)responseIp);
+    }
+    if (client.payloadSize != 0) {
+        writer.addOpt();
     }
+    sendDnsResponse(client, worker.response, writer.finish());
 
-    *responseSize = index;
+    if (refresh) {
+        // The client already has its stale or soon expiring answer; port 0
+        // tells onUpstreamAnswer to update the cache without replying.
+        DnsClient none = {0, 0, 0};
+        forwardQuery(worker, none, querySize);
+    }
 }
 
-void setResponseCodeNXDOMAIN(byte* response, int* responseSize) {
-    DNSHeader* dnsHeader = (DNSHeader*)response;
-    dnsHeader->Flags = htons(0x8403);
-    *responseSize = sizeof(DNSHeader);
+// Upstream always gets our EDNS payload size, whatever the client offered,
+// so one answer can serve every client; sendDnsResponse() fits it to each.
+// Rewrites the query in the worker's buffer.
+bool forwardQuery(DnsWorker& worker, const DnsClient& client, size_t querySize) {
+    size_t length = dnsSetEdnsPayload(worker.query, querySize, DNS_EDNS_PAYLOAD_SIZE);
+    if (length == 0) {
+        length = dnsAppendOpt(worker.query, querySize, bufferPool.bufferSize(), DNS_EDNS_PAYLOAD_SIZE);
+    }
+    if (length == 0) {
+        length = querySize;
+    }
+    forwarderLock.lock();
+    bool forwarded = upstreamForwarder.forward(client, worker.query, length, millis());
+    forwarderLock.unlock();
+    return forwarded;
 }
 
-bool forwardQueryToUpstream(const byte* query, int querySize, IPAddress& responseIp) {
-    WiFiUDP udpUpstream;
-    udpUpstream.beginPacket(UPSTREAM_DNS, 53);
-    udpUpstream.write(query, querySize);
-    udpUpstream.endPacket();
+void onTcpQuery(const DnsClient& client, const uint8_t* query, size_t length, void* arg) {
+    memcpy(tcpWorker.query, query, length);
+    handleDnsQuery(tcpWorker, client, length);
+}
 
-    unsigned long startTime = millis();
-    while (millis() - startTime < 5000) {
-        int packetSize = udpUpstream.parsePacket();
-        if (packetSize > 0) {
-            byte response[512];
-            udpUpstream.read(response, packetSize);
-            if (extractIPFromResponse(response, packetSize, responseIp)) {
-                return true;
-            }
+// Upstream is only asked over UDP. A truncated answer sends a UDP client
+// to TCP, but would look final to a client already there, so that one gets
+// a SERVFAIL instead.
+void onUpstreamAnswer(const DnsClient& client, const uint8_t* response, size_t length, void* arg) {
+    cacheUpstreamAnswer(response, length);
+    DnsMessageView message;
+    if (client.connection != 0 && message.parse(response, length) && (message.flags() & DNS_FLAG_TC)) {
+        DnsMessageWriter writer(tcpWorker.response, bufferPool.bufferSize());
+        writer.beginResponse(message, DNS_RCODE_SERVFAIL);
+        if (client.payloadSize != 0) {
+            writer.addOpt();
         }
+        response = tcpWorker.response;
+        length = writer.finish();
     }
-    return false;
+    sendDnsResponse(client, response, length);
 }
 
-bool extractIPFromResponse(const byte* response, int packetSize, IPAddress& ip) {
-    if (packetSize > sizeof(DNSHeader)) {
-        int rDataStart = sizeof(DNSHeader) + 12;
-        if (packetSize > rDataStart + 10) {
-            ip = IPAddress(response[rDataStart + 10], response[rDataStart + 11], response[rDataStart + 12], response[rDataStart + 13]);
-            return true;
+// Positive A answers, NXDOMAIN for any type (it covers the whole name),
+// NODATA for A and, briefly, failures including timed out queries.
+void cacheUpstreamAnswer(const uint8_t* response, size_t length) {
+    DnsMessageView message;
+    DnsQuestion question;
+    char domain[DNS_NAME_BUFFER_SIZE];
+    // A truncated answer is missing records, so it says nothing final.
+    if (!message.parse(response, length) || (message.flags() & DNS_FLAG_TC) || !message.firstQuestion(question) ||
+            !question.name.toString(domain, sizeof(domain))) {
+        return;
+    }
+    bool isA = question.type == DNS_TYPE_A;
+    uint32_t now = millis();
+    IPAddress ip;
+    uint32_t ttl;
+    switch (message.rcode()) {
+    case DNS_RCODE_NOERROR:
+        if (!isA) {
+            break;
+        }
+        if (extractIPFromResponse(message, ip, ttl)) {
+            addCacheEntry(domain, ip, ttl);
+            queryLog.log(domain, (uint32_t)ip);
+        } else {
+            dnsCache.insertNegative(domain, DNS_CACHE_NODATA, negativeTtl(message), now);
+        }
+        break;
+    case DNS_RCODE_NXDOMAIN:
+        dnsCache.insertNegative(domain, DNS_CACHE_NXDOMAIN, negativeTtl(message), now);
+        break;
+    case DNS_RCODE_SERVFAIL:
+        if (isA) {
+            dnsCache.insertNegative(domain, DNS_CACHE_SERVFAIL, FAILURE_CACHE_TTL, now);
         }
+        break;
     }
-    return false;
 }
 
-bool lookupCache(const char* domain, IPAddress& ip) {
-    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
-        if (strcasecmp(dnsCache[i].domainName, domain) == 0) {
-            ip = dnsCache[i].ipAddress;
+bool extractIPFromResponse(const DnsMessageView& response, IPAddress& ip, uint32_t& ttl) {
+    // CNAME chains come first; the answer lives as long as its shortest link.
+    DnsRecordCursor answers = response.records(DNS_SECTION_ANSWER);
+    DnsRecord record;
+    uint32_t minTtl = UINT32_MAX;
+    while (answers.next(record)) {
+        if (record.ttl < minTtl) {
+            minTtl = record.ttl;
+        }
+        uint32_t addr;
+        if (record.a(addr)) {
+            ip = IPAddress(addr);
+            ttl = minTtl;
             return true;
         }
     }
     return false;
 }
 
-bool extractDomainNameFromQuery(const byte* query, int querySize, char* queryDomain) {
-    int index = sizeof(DNSHeader);
-    int j = 0;
-    while (index < querySize && query[index] != 0) {
-        int labelLen = query[index++];
-        for (int i = 0; i < labelLen && index < querySize; ++i) {
-            queryDomain[j++] = query[index++];
-        }
-        if (query[index] != 0) {
-            queryDomain[j++] = '.';
+// RFC 2308 section 5: the lesser of the SOA record's TTL and its MINIMUM
+// field. Without an SOA the answer is only kept briefly.
+uint32_t negativeTtl(const DnsMessageView& response) {
+    DnsRecordCursor authority = response.records(DNS_SECTION_AUTHORITY);
+    DnsRecord record;
+    while (authority.next(record)) {
+        uint32_t minimum;
+        if (record.type == DNS_TYPE_SOA && record.soaMinimum(minimum)) {
+            return record.ttl < minimum ? record.ttl : minimum;
         }
     }
-    queryDomain[j] = '\0';
-    return j > 0;
+    return DNS_CACHE_MIN_TTL;
 }
 
-bool findDomainIP(const char* domain, IPAddress& outIpAddress) {
-    for (int i = 0; i < DOMAIN_MAPPINGS_COUNT; i++) {
-        if (strcasecmp(domain, domainMappings[i].domainName) == 0) {
-            outIpAddress = domainMappings[i].ipAddress;
-            return true;
-        }
+DnsOverrideResult findOverride(const char* domain, IPAddress& outIpAddress) {
+    uint32_t addr;
+    DnsOverrideResult result = dnsOverrides.lookup(domain, addr);
+    if (result == DNS_OVERRIDE_ADDRESS) {
+        outIpAddress = IPAddress(addr);
     }
-    return false;
+    return result;
 }
 
-void addCacheEntry(const char* domain, const IPAddress& ip) {
-    for (int i = DNS_CACHE_SIZE - 1; i > 0; i--) {
-        dnsCache[i] = dnsCache[i - 1];
+// Rules from the card take precedence over the built-in mappings.
+void loadOverrides(bool haveCard) {
+    if (haveCard) {
+        if (!dnsOverrides.load(SD)) {
+            Serial.println("DNS override table could not be allocated.");
+        }
+        if (dnsOverrides.skipped() != 0) {
+            Serial.printf("DNS overrides: skipped %lu over-long lines.\n", (unsigned long)dnsOverrides.skipped());
+        }
+    } else {
+        dnsOverrides.end();
     }
-    strncpy(dnsCache[0].domainName, domain, sizeof(dnsCache[0].domainName) - 1);
-    dnsCache[0].ipAddress = ip;
-}
-
-void logToSDCard(const char* logMessage) {
-    File logFile;
-    for (int i = 0; i < MAX_LOG_FILES; i++) {
-        String fileName = String(LOG_FILE_BASE_NAME) + i + LOG_FILE_EXTENSION;
-        logFile = SD.open(fileName, FILE_WRITE);
-        if (logFile && logFile.size() < MAX_LOG_FILE_SIZE) {
-            break;
+    for (int i = 0; i < DOMAIN_MAPPINGS_COUNT; i++) {
+        uint32_t addr;
+        if (dnsOverrides.lookup(domainMappings[i].domainName, addr) == DNS_OVERRIDE_NONE) {
+            dnsOverrides.add(domainMappings[i].domainName, (uint32_t)domainMappings[i].ipAddress);
         }
-        logFile.close();
     }
+    Serial.printf("DNS overrides: %lu rules, %lu bytes.\n", (unsigned long)dnsOverrides.rules(),
+                  (unsigned long)dnsOverrides.memoryUsed());
+}
 
-    if (logFile) {
-        logFile.println(logMessage);
-        logFile.close();
-    } else {
-        Serial.println("Failed to open log file for writing.");
-        rotateLogs();
+void addCacheEntry(const char* domain, const IPAddress& ip, uint32_t ttl) {
+    dnsCache.insert(domain, (uint32_t)ip, ttl, millis());
+}
+
+bool findInHistory(const char* domain, IPAddress& ipAddress) {
+    uint32_t addr;
+    if (dnsHistory.lookup(domain, addr)) {
+        ipAddress = IPAddress(addr);
+        return true;
     }
+    return false;
 }
 
-void rotateLogs() {
-    for (int i = MAX_LOG_FILES - 1; i > 0; i--) {
-        String oldName = String(LOG_FILE_BASE_NAME) + i + LOG_FILE_EXTENSION;
-        if (SD.exists(oldName)) {
-            SD.remove(oldName);
-        }
-        String newName = String(LOG_FILE_BASE_NAME) + (i - 1) + LOG_FILE_EXTENSION;
-        if (SD.exists(newName)) {
-            SD.rename(newName, oldName);
-        }
+// One-time conversion of the text logs kept before the history store existed,
+// oldest file first so the newest answer wins.
+void importTextLogs() {
+    char fileName[32];
+    uint32_t imported = 0;
+    for (int i = DNS_LOG_MAX_FILES - 1; i >= 0; i--) {
+        dnsLogFileName(fileName, sizeof(fileName), i);
+        imported += dnsHistory.importTextLog(fileName);
+    }
+    if (imported > 0) {
+        Serial.printf("Imported %lu DNS log entries into the history store.\n", (unsigned long)imported);
     }
 }
 
-bool findInLogs(const char* domain, IPAddress& ipAddress) {
-    File logFile;
-    for (int i = 0; i < MAX_LOG_FILES; i++) {
-        String fileName = String(LOG_FILE_BASE_NAME) + i + LOG_FILE_EXTENSION;
-        logFile = SD.open(fileName, FILE_READ);
-        if (!logFile) {
-            continue;
+// Fits an answer to the way the client asked. Over UDP it must stay within
+// the client's payload size, or 512 bytes without EDNS; a bigger one goes
+// out as just the question with TC set, so the client retries over TCP.
+// A client that sent no OPT record must not get one back (RFC 6891 section
+// 7), but forwarded answers carry the one forwardQuery() added.
+void sendDnsResponse(const DnsClient& client, const byte* response, size_t length) {
+    DnsMessageView message;
+    if (client.port == 0 || !message.parse(response, length)) {
+        return;
+    }
+    DnsRecord opt;
+    bool stripOpt = client.payloadSize == 0 && message.findOpt(opt);
+
+    if (client.connection != 0) {
+        // Runs on the upstream task, so the TCP worker's buffer is free:
+        // local answers never carry an unrequested OPT record.
+        if (stripOpt && response != tcpWorker.response) {
+            memcpy(tcpWorker.response, response, length);
+            size_t stripped = dnsRemoveOpt(tcpWorker.response, length);
+            response = tcpWorker.response;
+            length = stripped ? stripped : length;
         }
+        tcpServer.reply(client, response, length);
+        return;
+    }
 
-        while (logFile.available()) {
-            String logEntry = logFile.readStringUntil('\n');
-            int domainPos = logEntry.indexOf("Query: ");
-            int ipPos = logEntry.indexOf(" IP: ");
-            if (domainPos != -1 && ipPos != -1) {
-                String foundDomain = logEntry.substring(domainPos + 7, ipPos);
-                if (foundDomain.equalsIgnoreCase(domain)) {
-                    String ipString = logEntry.substring(ipPos + 5);
-                    ipAddress.fromString(ipString);
-                    logFile.close();
-                    return true;
-                }
-            }
+    byte small[DNS_UDP_MAX_PAYLOAD];
+    size_t limit = client.payloadSize ? client.payloadSize : DNS_UDP_MAX_PAYLOAD;
+    if (length > limit) {
+        DnsMessageWriter writer(small, sizeof(small));
+        writer.beginResponse(message, message.rcode());
+        writer.setFlag(DNS_FLAG_AA, message.flags() & DNS_FLAG_AA);
+        writer.setFlag(DNS_FLAG_TC, true);
+        if (client.payloadSize != 0) {
+            writer.addOpt();
         }
-        logFile.close();
+        response = small;
+        length = writer.finish();
+    } else if (stripOpt) {
+        memcpy(small, response, length);
+        size_t stripped = dnsRemoveOpt(small, length);
+        response = small;
+        length = stripped ? stripped : length;
     }
-    return false;
+    sendDnsResponseTo(IPAddress(client.addr), client.port, response, length);
 }
 
-void sendDnsResponse(WiFiUDP& udp, const byte* response, int responseSize) {
-    if (responseSize > 0) {
-        udp.beginPacket(udp.remoteIP(), udp.remotePort());
-        udp.write(response, responseSize);
-        udp.endPacket();
+void sendDnsResponseTo(const IPAddress& ip, uint16_t port, const byte* response, int responseSize) {
+    if (responseSize > 0 && dnsSocket >= 0) {
+        struct sockaddr_in to;
+        memset(&to, 0, sizeof(to));
+        to.sin_family = AF_INET;
+        to.sin_addr.s_addr = (uint32_t)ip;
+        to.sin_port = htons(port);
+        sendto(dnsSocket, response, responseSize, 0, (struct sockaddr*)&to, sizeof(to));
     }
 }
@@ -7,7 +7,24 @@
 #include <SD.h>
 #include <FreeRTOS.h>
 
+struct DnsServerStats {
+    uint32_t queries;
+    uint32_t cacheHits;
+    uint32_t cacheMisses;
+    uint32_t negativeHits;      // NXDOMAIN, NODATA or a recent failure from the cache
+    uint32_t staleServed;
+    uint32_t refreshes;         // background queries for stale or expiring names
+    uint32_t forwarded;
+    uint32_t upstreamTimeouts;
+    uint32_t blocked;
+    uint32_t cachedNames;
+    uint32_t logDropped;        // queries the log writer could not keep up with
+};
+
 bool startDnsServer();
 void stopDnsServer();
+// Takes effect the next time the server starts.
+void setDnsUpstream(const IPAddress& addr, uint16_t port);
+void getDnsServerStats(DnsServerStats& stats);
 
 #endif // LOCALDNS_H
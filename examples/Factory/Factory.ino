@@ -19,6 +19,8 @@
  */
 #include <LilyGo_AMOLED.h>
 #include <LV_Helper.h>
+#include <lvglBands.h>
+#include <lvglGlyphCache.h>
 #include <Arduino.h>
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
@@ -278,6 +280,37 @@ void setup()
     // Draw Factory GUI
     factoryGUI();
 
+#ifdef DISPLAY_BENCHMARK
+    // Build with -DDISPLAY_BENCHMARK, then again with LV_COLOR_16_SWAP 1 in
+    // lv_conf.h, to compare rendering in native and in the panel's byte order
+    lv_refr_now(NULL);
+    float fps = lvglHelperMeasureFps(100);
+    LvglPipelineStats pipeline = lvglHelperGetPipelineStats();
+    Serial.printf("[Display bench] %s byte order: %.1f fps, render %lu us, copy %lu us per flush\n",
+                  LV_COLOR_16_SWAP ? "panel" : "native", fps, (unsigned long)pipeline.renderUs,
+                  (unsigned long)pipeline.rotateUs);
+    // The clock's digits are unpacked once, then blended from the cache
+    LvglGlyphCacheStats glyphs = lvglGlyphCacheGetStats();
+    Serial.printf("[Display bench] glyph cache: %lu hits %lu misses, %lu glyphs in %lu of %lu KB\n",
+                  (unsigned long)glyphs.hits, (unsigned long)glyphs.misses, (unsigned long)glyphs.entries,
+                  (unsigned long)glyphs.bytes / 1024, (unsigned long)glyphs.budget / 1024);
+    // Each area drawn by one core, then in two bands by both
+    uint32_t bands = lvglBandsGet();
+    for (uint32_t n = 1; n <= 2; n++) {
+        if (lvglHelperSetRenderBands(n) != n) {
+            break;
+        }
+        lvglBandsResetStats();
+        fps = lvglHelperMeasureFps(100);
+        pipeline = lvglHelperGetPipelineStats();
+        LvglBandsStats banded = lvglBandsGetStats();
+        Serial.printf("[Display bench] %lu band(s): %.1f fps, render %lu us, %lu us per frame waiting for the other core\n",
+                      (unsigned long)n, fps, (unsigned long)pipeline.renderUs,
+                      (unsigned long)(banded.waitUs / 100));
+    }
+    lvglHelperSetRenderBands(bands);
+#endif
+
 
     WiFi.mode(WIFI_STA);
 
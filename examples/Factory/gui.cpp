@@ -348,8 +348,10 @@ static void pixels_event_handler(lv_event_t *e)
             break;
         case 3: {
             lv_obj_t *cw =  (lv_obj_t *)lv_event_get_user_data(e);
-            lv_color_t c =  lv_colorwheel_get_rgb(cw);
-            pixels.setPixelColor(0, pixels.Color(c.ch.red, (c.ch.green_h << 3) | c.ch.green_l, c.ch.blue)); pixels.show();
+            // Whatever LV_COLOR_16_SWAP is, as 8-bit channels
+            lv_color32_t c;
+            c.full = lv_color_to32(lv_colorwheel_get_rgb(cw));
+            pixels.setPixelColor(0, pixels.Color(c.ch.red, c.ch.green, c.ch.blue)); pixels.show();
         }
         break;
         case 4: {
@@ -12,6 +12,7 @@
  */
 #include <LilyGo_AMOLED.h>
 #include <LV_Helper.h>
+#include <lvglImageCache.h>
 
 #if !LV_USE_PNG || !LV_USE_BMP || !LV_USE_SJPG
 #error "lvgl png , bmp , sjpg decoder library is not enable!"
@@ -87,6 +88,18 @@ void setup(void)
         static int i = 0;
         String fspath = LV_FS_POSIX_LETTER + String(":/") + filename[i];
         lv_img_set_src((lv_obj_t *)t->user_data, fspath.c_str());
+#ifdef DISPLAY_BENCHMARK
+        // Build with -DDISPLAY_BENCHMARK to see the image cache at work:
+        // from the second round on, images are drawn without decoding
+        uint32_t start = millis();
+        lv_refr_now(NULL);
+        uint32_t ms = millis() - start;
+        LvglImageCacheStats cache = lvglImageCacheGetStats();
+        Serial.printf("[Display bench] %s: %lu ms, cache %lu hits %lu misses, %lu of %lu KB, %lu ms decoding so far\n",
+                      filename[i], (unsigned long)ms, (unsigned long)cache.hits, (unsigned long)cache.misses,
+                      (unsigned long)cache.bytes / 1024, (unsigned long)cache.budget / 1024,
+                      (unsigned long)(cache.decodeUs / 1000));
+#endif
         i++;
         i %= sizeof(filename) / sizeof(filename[0]);
     }, 1000, img);
@@ -83,6 +83,10 @@
 /*Input device read period in milliseconds*/
 #define LV_INDEV_DEF_READ_PERIOD 30     /*[ms]*/
 
+/*Allow splitting the redrawn areas into horizontal bands drawn by several threads at once.
+ *See `lv_refr_set_bands()`. The drawing code then keeps its scratch per thread.*/
+#define LV_USE_REFR_BANDS 0
+
 /*Use a custom tick source that tells the elapsed time in milliseconds.
  *It removes the need to manually update the tick with `lv_tick_inc()`)*/
 #define LV_TICK_CUSTOM 0
@@ -34,7 +34,7 @@ static bool event_is_bubbled(lv_event_t * e);
 /**********************
  *  STATIC VARIABLES
  **********************/
-static lv_event_t * event_head;
+static LV_REFR_THREAD_LOCAL lv_event_t * event_head;
 
 /**********************
  *      MACROS
@@ -46,6 +46,11 @@
  *      DEFINES
  *********************/
 #define MY_CLASS &lv_obj_class
+#if LV_USE_REFR_BANDS
+    #define DRAW_COORDS(obj) _lv_obj_get_draw_coords(obj)
+#else
+    #define DRAW_COORDS(obj) (&(obj)->coords)
+#endif
 #define LV_OBJ_DEF_WIDTH    (LV_DPX(100))
 #define LV_OBJ_DEF_HEIGHT   (LV_DPX(50))
 #define STYLE_TRANSITION_MAX 32
@@ -534,7 +539,7 @@ static void lv_obj_draw(lv_event_t * e)
         lv_coord_t w = lv_obj_get_style_transform_width(obj, LV_PART_MAIN);
         lv_coord_t h = lv_obj_get_style_transform_height(obj, LV_PART_MAIN);
         lv_area_t coords;
-        lv_area_copy(&coords, &obj->coords);
+        lv_area_copy(&coords, DRAW_COORDS(obj));
         coords.x1 -= w;
         coords.x2 += w;
         coords.y1 -= h;
@@ -564,7 +569,7 @@ static void lv_obj_draw(lv_event_t * e)
 #if LV_DRAW_COMPLEX
         if(clip_corner) {
             lv_draw_mask_radius_param_t * mp = lv_mem_buf_get(sizeof(lv_draw_mask_radius_param_t));
-            lv_draw_mask_radius_init(mp, &obj->coords, draw_dsc.radius, false);
+            lv_draw_mask_radius_init(mp, DRAW_COORDS(obj), draw_dsc.radius, false);
             /*Add the mask and use `obj+8` as custom id. Don't use `obj` directly because it might be used by the user*/
             lv_draw_mask_add(mp, obj + 8);
 
@@ -608,7 +613,7 @@ static void lv_obj_draw(lv_event_t * e)
             lv_coord_t w = lv_obj_get_style_transform_width(obj, LV_PART_MAIN);
             lv_coord_t h = lv_obj_get_style_transform_height(obj, LV_PART_MAIN);
             lv_area_t coords;
-            lv_area_copy(&coords, &obj->coords);
+            lv_area_copy(&coords, DRAW_COORDS(obj));
             coords.x1 -= w;
             coords.x2 += w;
             coords.y1 -= h;
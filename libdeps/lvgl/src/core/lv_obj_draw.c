@@ -27,6 +27,10 @@
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if LV_USE_REFR_BANDS
+    static LV_REFR_THREAD_LOCAL const lv_obj_t * draw_coords_obj;
+    static LV_REFR_THREAD_LOCAL const lv_area_t * draw_coords;
+#endif
 
 /**********************
  *      MACROS
@@ -393,6 +397,19 @@ lv_layer_type_t _lv_obj_get_layer_type(const lv_obj_t * obj)
     else return LV_LAYER_TYPE_NONE;
 }
 
+#if LV_USE_REFR_BANDS
+void _lv_obj_set_draw_coords(const lv_obj_t * obj, const lv_area_t * coords)
+{
+    draw_coords_obj = obj;
+    draw_coords = coords;
+}
+
+const lv_area_t * _lv_obj_get_draw_coords(const lv_obj_t * obj)
+{
+    return obj == draw_coords_obj ? draw_coords : &obj->coords;
+}
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -161,6 +161,24 @@ lv_coord_t _lv_obj_get_ext_draw_size(const struct _lv_obj_t * obj);
 
 lv_layer_type_t _lv_obj_get_layer_type(const struct _lv_obj_t * obj);
 
+#if LV_USE_REFR_BANDS
+/**
+ * Let the base class draw an object at other coordinates, e.g. a transformed image its background,
+ * without changing `obj->coords`, which other threads drawing bands might be reading.
+ * Applies to the calling thread only.
+ * @param obj       pointer to an object, or NULL to draw every object at its coordinates again
+ * @param coords    the coordinates to draw `obj` at
+ */
+void _lv_obj_set_draw_coords(const struct _lv_obj_t * obj, const lv_area_t * coords);
+
+/**
+ * Get the coordinates the base class draws an object at
+ * @param obj       pointer to an object
+ * @return          the coordinates set by `_lv_obj_set_draw_coords()`, or `obj->coords`
+ */
+const lv_area_t * _lv_obj_get_draw_coords(const struct _lv_obj_t * obj);
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -56,6 +56,10 @@ static void refr_invalid_areas(void);
 static void refr_sync_areas(void);
 static void refr_area(const lv_area_t * area_p);
 static void refr_area_part(lv_draw_ctx_t * draw_ctx);
+static void refr_area_part_draw(lv_draw_ctx_t * draw_ctx);
+#if LV_USE_REFR_BANDS
+    static void refr_area_part_bands(lv_draw_ctx_t * draw_ctx, uint32_t band_cnt);
+#endif
 static lv_obj_t * lv_refr_get_top_obj(const lv_area_t * area_p, lv_obj_t * obj);
 static void refr_obj_and_children(lv_draw_ctx_t * draw_ctx, lv_obj_t * top_obj);
 static void refr_obj(lv_draw_ctx_t * draw_ctx, lv_obj_t * obj);
@@ -76,6 +80,11 @@ static void call_flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_
 static uint32_t px_num;
 static lv_disp_t * disp_refr; /*Display being refreshed*/
 
+#if LV_USE_REFR_BANDS
+    static uint32_t refr_band_cnt = 1;
+    static lv_refr_bands_run_cb_t refr_bands_run_cb;
+#endif
+
 #if LV_USE_PERF_MONITOR
     static perf_monitor_t   perf_monitor;
 #endif
@@ -280,6 +289,41 @@ void _lv_refr_set_disp_refreshing(lv_disp_t * disp)
     disp_refr = disp;
 }
 
+#if LV_USE_REFR_BANDS
+/**
+ * Split every part of the screen LVGL redraws into horizontal bands, drawn at the same time.
+ * @param band_cnt  number of bands; 0 or 1 to draw as usual
+ * @param run_cb    draws the bands. NULL: one after the other.
+ */
+void lv_refr_set_bands(uint32_t band_cnt, lv_refr_bands_run_cb_t run_cb)
+{
+    refr_band_cnt = band_cnt ? band_cnt : 1;
+    refr_bands_run_cb = run_cb;
+}
+
+/**
+ * Get the number of bands the parts are split into
+ * @return the number of bands, 1 if they are not split
+ */
+uint32_t lv_refr_get_bands(void)
+{
+    return refr_band_cnt;
+}
+
+/**
+ * Prepare the calling thread to draw bands
+ * @return LV_RES_OK: ready; LV_RES_INV: out of memory
+ */
+lv_res_t lv_refr_band_thread_init(void)
+{
+    if(_lv_mem_buf_thread_init() != LV_RES_OK) return LV_RES_INV;
+#if LV_DRAW_COMPLEX
+    if(_lv_draw_mask_thread_init() != LV_RES_OK) return LV_RES_INV;
+#endif
+    return LV_RES_OK;
+}
+#endif
+
 /**
  * Called periodically to handle the refreshing
  * @param tmr pointer to the timer itself
@@ -725,6 +769,23 @@ static void refr_area_part(lv_draw_ctx_t * draw_ctx)
 #endif
     }
 
+#if LV_USE_REFR_BANDS
+    uint32_t band_cnt = LV_MIN(refr_band_cnt, (uint32_t)lv_area_get_height(draw_ctx->clip_area));
+    if(band_cnt > 1) refr_area_part_bands(draw_ctx, band_cnt);
+    else refr_area_part_draw(draw_ctx);
+#else
+    refr_area_part_draw(draw_ctx);
+#endif
+
+    draw_buf_flush(disp_refr);
+}
+
+/**
+ * Draw the screens and the layers into the draw buffer
+ * @param draw_ctx the draw context of the part, or of a band of it
+ */
+static void refr_area_part_draw(lv_draw_ctx_t * draw_ctx)
+{
     lv_obj_t * top_act_scr = NULL;
     lv_obj_t * top_prev_scr = NULL;
 
@@ -794,9 +855,49 @@ static void refr_area_part(lv_draw_ctx_t * draw_ctx)
     /*Also refresh top and sys layer unconditionally*/
     refr_obj_and_children(draw_ctx, lv_disp_get_layer_top(disp_refr));
     refr_obj_and_children(draw_ctx, lv_disp_get_layer_sys(disp_refr));
+}
 
-    draw_buf_flush(disp_refr);
+#if LV_USE_REFR_BANDS
+/**
+ * Split the part into horizontal bands and draw them at the same time
+ * @param draw_ctx the draw context of the part
+ * @param band_cnt number of bands, at most as many as rows
+ */
+static void refr_area_part_bands(lv_draw_ctx_t * draw_ctx, uint32_t band_cnt)
+{
+    /*A copy of the draw context for each band, clipped to its rows. All of them draw into the same buffer.*/
+    size_t ctx_size = (disp_refr->driver->draw_ctx_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    uint8_t * mem = lv_mem_buf_get(band_cnt * (ctx_size + sizeof(lv_draw_ctx_t *) + sizeof(lv_area_t)));
+    if(mem == NULL) {
+        refr_area_part_draw(draw_ctx);
+        return;
+    }
+    lv_draw_ctx_t ** ctxs = (lv_draw_ctx_t **)(mem + band_cnt * ctx_size);
+    lv_area_t * clips = (lv_area_t *)(ctxs + band_cnt);
+
+    const lv_area_t * clip = draw_ctx->clip_area;
+    int32_t h = lv_area_get_height(clip);
+    uint32_t i;
+    for(i = 0; i < band_cnt; i++) {
+        clips[i].x1 = clip->x1;
+        clips[i].x2 = clip->x2;
+        clips[i].y1 = clip->y1 + (h * i) / band_cnt;
+        clips[i].y2 = clip->y1 + (h * (i + 1)) / band_cnt - 1;
+        ctxs[i] = (lv_draw_ctx_t *)(mem + i * ctx_size);
+        lv_memcpy(ctxs[i], draw_ctx, disp_refr->driver->draw_ctx_size);
+        ctxs[i]->clip_area = &clips[i];
+    }
+
+    if(refr_bands_run_cb) {
+        refr_bands_run_cb(refr_area_part_draw, ctxs, band_cnt);
+    }
+    else {
+        for(i = 0; i < band_cnt; i++) refr_area_part_draw(ctxs[i]);
+    }
+
+    lv_mem_buf_release(mem);
 }
+#endif
 
 /**
  * Search the most top object which fully covers an area
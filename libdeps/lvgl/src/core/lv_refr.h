@@ -25,6 +25,15 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_USE_REFR_BANDS
+/**
+ * Draws the bands of a part: calls `band_cb` with each of the `band_cnt` draw contexts,
+ * at the same time, e.g. on different cores, and returns when all of them are drawn.
+ * The first band may be drawn by the calling thread.
+ */
+typedef void (*lv_refr_bands_run_cb_t)(void (*band_cb)(lv_draw_ctx_t * draw_ctx), lv_draw_ctx_t * draw_ctxs[],
+                                       uint32_t band_cnt);
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
@@ -85,6 +94,31 @@ lv_disp_t * _lv_refr_get_disp_refreshing(void);
  */
 void _lv_refr_set_disp_refreshing(lv_disp_t * disp);
 
+#if LV_USE_REFR_BANDS
+/**
+ * Split every part of the screen LVGL redraws into horizontal bands, drawn at the same time.
+ * The bands share the draw buffer, each drawing its own rows, and are flushed together.
+ * Objects are drawn once for every band they are in, so their draw events have to be
+ * ready to run on several threads at once.
+ * @param band_cnt  number of bands; 0 or 1 to draw as usual
+ * @param run_cb    draws the bands, see `lv_refr_bands_run_cb_t`. NULL: one after the other.
+ */
+void lv_refr_set_bands(uint32_t band_cnt, lv_refr_bands_run_cb_t run_cb);
+
+/**
+ * Get the number of bands the parts are split into
+ * @return the number of bands, 1 if they are not split
+ */
+uint32_t lv_refr_get_bands(void);
+
+/**
+ * Prepare the calling thread to draw bands: it gets its own masks and temporal buffers.
+ * Call it once in every thread `run_cb` draws in, except LVGL's own.
+ * @return LV_RES_OK: ready; LV_RES_INV: out of memory
+ */
+lv_res_t lv_refr_band_thread_init(void);
+#endif
+
 #if LV_USE_PERF_MONITOR
 /**
  * Reset FPS counter
@@ -63,10 +63,22 @@ static inline lv_opa_t /* LV_ATTRIBUTE_FAST_MEM */ mask_mix(lv_opa_t mask_act, l
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if LV_USE_REFR_BANDS
+    /*The masks of the calling thread. Threads drawing bands get their own.*/
+    static LV_REFR_THREAD_LOCAL _lv_draw_mask_saved_t * mask_list = LV_GC_ROOT(_lv_draw_mask_list);
+    static LV_REFR_THREAD_LOCAL _lv_draw_mask_radius_circle_dsc_t * circle_cache = LV_GC_ROOT(_lv_circle_cache);
+#endif
 
 /**********************
  *      MACROS
  **********************/
+#if LV_USE_REFR_BANDS
+    #define MASK_LIST(i)    mask_list[i]
+    #define CIRCLE_CACHE(i) circle_cache[i]
+#else
+    #define MASK_LIST(i)    LV_GC_ROOT(_lv_draw_mask_list[i])
+    #define CIRCLE_CACHE(i) LV_GC_ROOT(_lv_circle_cache[i])
+#endif
 
 /**********************
  *   GLOBAL FUNCTIONS
@@ -83,7 +95,7 @@ int16_t lv_draw_mask_add(void * param, void * custom_id)
     /*Look for a free entry*/
     uint8_t i;
     for(i = 0; i < _LV_MASK_MAX_NUM; i++) {
-        if(LV_GC_ROOT(_lv_draw_mask_list[i]).param == NULL) break;
+        if(MASK_LIST(i).param == NULL) break;
     }
 
     if(i >= _LV_MASK_MAX_NUM) {
@@ -91,8 +103,8 @@ int16_t lv_draw_mask_add(void * param, void * custom_id)
         return LV_MASK_ID_INV;
     }
 
-    LV_GC_ROOT(_lv_draw_mask_list[i]).param = param;
-    LV_GC_ROOT(_lv_draw_mask_list[i]).custom_id = custom_id;
+    MASK_LIST(i).param = param;
+    MASK_LIST(i).custom_id = custom_id;
 
     return i;
 }
@@ -114,7 +126,7 @@ lv_draw_mask_res_t LV_ATTRIBUTE_FAST_MEM lv_draw_mask_apply(lv_opa_t * mask_buf,
     bool changed = false;
     _lv_draw_mask_common_dsc_t * dsc;
 
-    _lv_draw_mask_saved_t * m = LV_GC_ROOT(_lv_draw_mask_list);
+    _lv_draw_mask_saved_t * m = &MASK_LIST(0);
 
     while(m->param) {
         dsc = m->param;
@@ -152,7 +164,7 @@ lv_draw_mask_res_t LV_ATTRIBUTE_FAST_MEM lv_draw_mask_apply_ids(lv_opa_t * mask_
     for(int i = 0; i < ids_count; i++) {
         int16_t id = ids[i];
         if(id == LV_MASK_ID_INV) continue;
-        dsc = LV_GC_ROOT(_lv_draw_mask_list[id]).param;
+        dsc = MASK_LIST(id).param;
         if(!dsc) continue;
         lv_draw_mask_res_t res = LV_DRAW_MASK_RES_FULL_COVER;
         res = dsc->cb(mask_buf, abs_x, abs_y, len, dsc);
@@ -174,9 +186,9 @@ void * lv_draw_mask_remove_id(int16_t id)
     _lv_draw_mask_common_dsc_t * p = NULL;
 
     if(id != LV_MASK_ID_INV) {
-        p = LV_GC_ROOT(_lv_draw_mask_list[id]).param;
-        LV_GC_ROOT(_lv_draw_mask_list[id]).param = NULL;
-        LV_GC_ROOT(_lv_draw_mask_list[id]).custom_id = NULL;
+        p = MASK_LIST(id).param;
+        MASK_LIST(id).param = NULL;
+        MASK_LIST(id).custom_id = NULL;
     }
 
     return p;
@@ -193,8 +205,8 @@ void * lv_draw_mask_remove_custom(void * custom_id)
     _lv_draw_mask_common_dsc_t * p = NULL;
     uint8_t i;
     for(i = 0; i < _LV_MASK_MAX_NUM; i++) {
-        if(LV_GC_ROOT(_lv_draw_mask_list[i]).custom_id == custom_id) {
-            p = LV_GC_ROOT(_lv_draw_mask_list[i]).param;
+        if(MASK_LIST(i).custom_id == custom_id) {
+            p = MASK_LIST(i).param;
             lv_draw_mask_remove_id(i);
         }
     }
@@ -233,13 +245,29 @@ void _lv_draw_mask_cleanup(void)
 {
     uint8_t i;
     for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
-        if(LV_GC_ROOT(_lv_circle_cache[i]).buf) {
-            lv_mem_free(LV_GC_ROOT(_lv_circle_cache[i]).buf);
+        if(CIRCLE_CACHE(i).buf) {
+            lv_mem_free(CIRCLE_CACHE(i).buf);
         }
-        lv_memset_00(&LV_GC_ROOT(_lv_circle_cache[i]), sizeof(LV_GC_ROOT(_lv_circle_cache[i])));
+        lv_memset_00(&CIRCLE_CACHE(i), sizeof(CIRCLE_CACHE(i)));
     }
 }
 
+#if LV_USE_REFR_BANDS
+lv_res_t _lv_draw_mask_thread_init(void)
+{
+    /*The circle cache follows the list*/
+    size_t size = sizeof(_lv_draw_mask_saved_arr_t) + sizeof(_lv_draw_mask_radius_circle_dsc_arr_t);
+    _lv_draw_mask_saved_t * list = lv_mem_alloc(size);
+    LV_ASSERT_MALLOC(list);
+    if(list == NULL) return LV_RES_INV;
+
+    lv_memset_00(list, size);
+    mask_list = list;
+    circle_cache = (_lv_draw_mask_radius_circle_dsc_t *)(list + _LV_MASK_MAX_NUM);
+    return LV_RES_OK;
+}
+#endif
+
 /**
  * Count the currently added masks
  * @return number of active masks
@@ -249,21 +277,21 @@ uint8_t LV_ATTRIBUTE_FAST_MEM lv_draw_mask_get_cnt(void)
     uint8_t cnt = 0;
     uint8_t i;
     for(i = 0; i < _LV_MASK_MAX_NUM; i++) {
-        if(LV_GC_ROOT(_lv_draw_mask_list[i]).param) cnt++;
+        if(MASK_LIST(i).param) cnt++;
     }
     return cnt;
 }
 
 bool lv_draw_mask_is_any(const lv_area_t * a)
 {
-    if(a == NULL) return LV_GC_ROOT(_lv_draw_mask_list[0]).param ? true : false;
+    if(a == NULL) return MASK_LIST(0).param ? true : false;
 
     uint8_t i;
     for(i = 0; i < _LV_MASK_MAX_NUM; i++) {
-        _lv_draw_mask_common_dsc_t * comm_param = LV_GC_ROOT(_lv_draw_mask_list[i]).param;
+        _lv_draw_mask_common_dsc_t * comm_param = MASK_LIST(i).param;
         if(comm_param == NULL) continue;
         if(comm_param->type == LV_DRAW_MASK_TYPE_RADIUS) {
-            lv_draw_mask_radius_param_t * radius_param = LV_GC_ROOT(_lv_draw_mask_list[i]).param;
+            lv_draw_mask_radius_param_t * radius_param = MASK_LIST(i).param;
             if(radius_param->cfg.outer) {
                 if(!_lv_area_is_out(a, &radius_param->cfg.rect, radius_param->cfg.radius)) return true;
             }
@@ -495,10 +523,10 @@ void lv_draw_mask_radius_init(lv_draw_mask_radius_param_t * param, const lv_area
 
     /*Try to reuse a circle cache entry*/
     for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
-        if(LV_GC_ROOT(_lv_circle_cache[i]).radius == radius) {
-            LV_GC_ROOT(_lv_circle_cache[i]).used_cnt++;
-            CIRCLE_CACHE_AGING(LV_GC_ROOT(_lv_circle_cache[i]).life, radius);
-            param->circle = &LV_GC_ROOT(_lv_circle_cache[i]);
+        if(CIRCLE_CACHE(i).radius == radius) {
+            CIRCLE_CACHE(i).used_cnt++;
+            CIRCLE_CACHE_AGING(CIRCLE_CACHE(i).life, radius);
+            param->circle = &CIRCLE_CACHE(i);
             return;
         }
     }
@@ -506,9 +534,9 @@ void lv_draw_mask_radius_init(lv_draw_mask_radius_param_t * param, const lv_area
     /*If not found find a free entry with lowest life*/
     _lv_draw_mask_radius_circle_dsc_t * entry = NULL;
     for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
-        if(LV_GC_ROOT(_lv_circle_cache[i]).used_cnt == 0) {
-            if(!entry) entry = &LV_GC_ROOT(_lv_circle_cache[i]);
-            else if(LV_GC_ROOT(_lv_circle_cache[i]).life < entry->life) entry = &LV_GC_ROOT(_lv_circle_cache[i]);
+        if(CIRCLE_CACHE(i).used_cnt == 0) {
+            if(!entry) entry = &CIRCLE_CACHE(i);
+            else if(CIRCLE_CACHE(i).life < entry->life) entry = &CIRCLE_CACHE(i);
         }
     }
 
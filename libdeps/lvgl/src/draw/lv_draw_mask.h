@@ -294,6 +294,15 @@ void lv_draw_mask_free_param(void * p);
  */
 void _lv_draw_mask_cleanup(void);
 
+#if LV_USE_REFR_BANDS
+/**
+ * Give the calling thread its own mask list and circle cache.
+ * Used by `lv_refr_band_thread_init()`.
+ * @return LV_RES_OK: ready; LV_RES_INV: out of memory
+ */
+lv_res_t _lv_draw_mask_thread_init(void);
+#endif
+
 //! @cond Doxygen_Suppress
 
 /**
@@ -43,7 +43,9 @@ static size_t get_cache_item_size(lv_grad_t * c);
 static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h);
 static lv_res_t find_oldest_item_life(lv_grad_t * c, void * ctx);
 static lv_res_t kill_oldest_item(lv_grad_t * c, void * ctx);
-static lv_res_t find_item(lv_grad_t * c, void * ctx);
+#if !LV_USE_REFR_BANDS
+    static lv_res_t find_item(lv_grad_t * c, void * ctx);
+#endif
 static void free_item(lv_grad_t * c);
 static  uint32_t compute_key(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h);
 
@@ -148,12 +150,14 @@ static lv_res_t kill_oldest_item(lv_grad_t * c, void * ctx)
     return LV_RES_INV;
 }
 
+#if !LV_USE_REFR_BANDS
 static lv_res_t find_item(lv_grad_t * c, void * ctx)
 {
     uint32_t * k = (uint32_t *)ctx;
     if(c->key == *k) return LV_RES_OK;
     return LV_RES_INV;
 }
+#endif
 
 static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
 {
@@ -169,16 +173,22 @@ static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord
 #endif
 #endif
 
+#if LV_USE_REFR_BANDS
+    /*Threads drawing bands can't share the cache, every gradient is allocated for itself*/
+    size_t cache_size = 0;
+#else
+    size_t cache_size = grad_cache_size;
+#endif
     size_t act_size = (size_t)(grad_cache_end - LV_GC_ROOT(_lv_grad_cache_mem));
     lv_grad_t * item = NULL;
-    if(req_size + act_size < grad_cache_size) {
+    if(req_size + act_size < cache_size) {
         item = (lv_grad_t *)grad_cache_end;
         item->not_cached = 0;
     }
     else {
         /*Need to evict items from cache until we find enough space to allocate this one */
-        if(req_size <= grad_cache_size) {
-            while(act_size + req_size > grad_cache_size) {
+        if(req_size <= cache_size) {
+            while(act_size + req_size > cache_size) {
                 uint32_t oldest_life = UINT32_MAX;
                 iterate_cache(&find_oldest_item_life, &oldest_life, NULL);
                 iterate_cache(&kill_oldest_item, &oldest_life, NULL);
@@ -253,6 +263,8 @@ lv_grad_t * lv_gradient_get(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
     /* No gradient, no cache */
     if(g->dir == LV_GRAD_DIR_NONE) return NULL;
 
+    lv_grad_t * item = NULL;
+#if !LV_USE_REFR_BANDS
     /* Step 0: Check if the cache exist (else create it) */
     static bool inited = false;
     if(!inited) {
@@ -263,11 +275,11 @@ lv_grad_t * lv_gradient_get(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
     /* Step 1: Search cache for the given key */
     lv_coord_t size = g->dir == LV_GRAD_DIR_HOR ? w : h;
     uint32_t key = compute_key(g, size, w);
-    lv_grad_t * item = NULL;
     if(iterate_cache(&find_item, &key, &item) == LV_RES_OK) {
         item->life++; /* Don't forget to bump the counter */
         return item;
     }
+#endif
 
     /* Step 2: Need to allocate an item for it */
     item = allocate_item(g, w, h);
@@ -218,9 +218,16 @@ static void LV_ATTRIBUTE_FAST_MEM draw_letter_normal(lv_draw_ctx_t * draw_ctx, c
             return; /*Invalid bpp. Can't render the letter*/
     }
 
+#if LV_USE_REFR_BANDS
+    /*Threads drawing bands may draw with different opacities at once: build the table for each letter*/
+    lv_opa_t opa_table[256];
+    lv_opa_t prev_opa = LV_OPA_TRANSP;
+    uint32_t prev_bpp = 0;
+#else
     static lv_opa_t opa_table[256];
     static lv_opa_t prev_opa = LV_OPA_TRANSP;
     static uint32_t prev_bpp = 0;
+#endif
     if(opa < LV_OPA_MAX) {
         if(prev_opa != opa || prev_bpp != bpp) {
             uint32_t i;
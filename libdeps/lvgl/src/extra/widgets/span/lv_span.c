@@ -66,7 +66,9 @@ static lv_coord_t convert_indent_pct(lv_obj_t * spans, lv_coord_t width);
 /**********************
  *  STATIC VARIABLES
  **********************/
-static struct _snippet_stack snippet_stack;
+static struct _snippet_stack snippet_stack_def;
+/*Threads drawing bands lay out groups at the same time, each in a stack of its own*/
+static LV_REFR_THREAD_LOCAL struct _snippet_stack * snippet_stack = &snippet_stack_def;
 
 const lv_obj_class_t lv_spangroup_class  = {
     .base_class = &lv_obj_class,
@@ -590,7 +592,16 @@ static void draw_main(lv_event_t * e)
     lv_obj_t * obj = lv_event_get_target(e);
     lv_draw_ctx_t * draw_ctx = lv_event_get_draw_ctx(e);
 
+#if LV_USE_REFR_BANDS
+    struct _snippet_stack * stack = lv_mem_buf_get(sizeof(struct _snippet_stack));
+    if(stack == NULL) return;
+    snippet_stack = stack;
     lv_draw_span(obj, draw_ctx);
+    snippet_stack = &snippet_stack_def;
+    lv_mem_buf_release(stack);
+#else
+    lv_draw_span(obj, draw_ctx);
+#endif
 }
 
 /**
@@ -619,9 +630,9 @@ static bool lv_txt_get_snippet(const char * txt, const lv_font_t * font,
 
 static void lv_snippet_push(lv_snippet_t * item)
 {
-    if(snippet_stack.index < LV_SPAN_SNIPPET_STACK_SIZE) {
-        memcpy(&snippet_stack.stack[snippet_stack.index], item, sizeof(lv_snippet_t));
-        snippet_stack.index++;
+    if(snippet_stack->index < LV_SPAN_SNIPPET_STACK_SIZE) {
+        memcpy(&snippet_stack->stack[snippet_stack->index], item, sizeof(lv_snippet_t));
+        snippet_stack->index++;
     }
     else {
         LV_LOG_ERROR("span draw stack overflow, please set LV_SPAN_SNIPPET_STACK_SIZE too larger");
@@ -630,17 +641,17 @@ static void lv_snippet_push(lv_snippet_t * item)
 
 static uint16_t lv_get_snippet_cnt(void)
 {
-    return snippet_stack.index;
+    return snippet_stack->index;
 }
 
 static lv_snippet_t * lv_get_snippet(uint16_t index)
 {
-    return &snippet_stack.stack[index];
+    return &snippet_stack->stack[index];
 }
 
 static void lv_snippet_clear(void)
 {
-    snippet_stack.index = 0;
+    snippet_stack->index = 0;
 }
 
 static const lv_font_t * lv_span_get_style_text_font(lv_obj_t * par, lv_span_t * span)
@@ -36,6 +36,7 @@ static int8_t get_kern_value(const lv_font_t * font, uint32_t gid_left, uint32_t
 static int32_t unicode_list_compare(const void * ref, const void * element);
 static int32_t kern_pair_8_compare(const void * ref, const void * element);
 static int32_t kern_pair_16_compare(const void * ref, const void * element);
+static inline void cache_glyph_id(lv_font_fmt_txt_dsc_t * fdsc, uint32_t letter, uint32_t glyph_id);
 
 #if LV_USE_FONT_COMPRESSED
     static void decompress(const uint8_t * in, uint8_t * out, lv_coord_t w, lv_coord_t h, uint8_t bpp, bool prefilter);
@@ -50,14 +51,25 @@ static int32_t kern_pair_16_compare(const void * ref, const void * element);
  *  STATIC VARIABLES
  **********************/
 #if LV_USE_FONT_COMPRESSED
-    static uint32_t rle_rdp;
-    static const uint8_t * rle_in;
-    static uint8_t rle_bpp;
-    static uint8_t rle_prev_v;
-    static uint8_t rle_cnt;
-    static rle_state_t rle_state;
+    static LV_REFR_THREAD_LOCAL uint32_t rle_rdp;
+    static LV_REFR_THREAD_LOCAL const uint8_t * rle_in;
+    static LV_REFR_THREAD_LOCAL uint8_t rle_bpp;
+    static LV_REFR_THREAD_LOCAL uint8_t rle_prev_v;
+    static LV_REFR_THREAD_LOCAL uint8_t rle_cnt;
+    static LV_REFR_THREAD_LOCAL rle_state_t rle_state;
+#if LV_USE_REFR_BANDS
+    /*Threads drawing bands decompress into their own buffer*/
+    static LV_REFR_THREAD_LOCAL uint8_t * decompr_buf;
+#endif
 #endif /*LV_USE_FONT_COMPRESSED*/
 
+#if LV_USE_REFR_BANDS
+    /*Threads drawing bands look up letters at the same time,
+     *so the last letter is remembered per thread instead of in the font's cache*/
+    static LV_REFR_THREAD_LOCAL const lv_font_fmt_txt_dsc_t * cache_dsc;
+    static LV_REFR_THREAD_LOCAL lv_font_fmt_txt_glyph_cache_t cache;
+#endif
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -65,6 +77,11 @@ static int32_t kern_pair_16_compare(const void * ref, const void * element);
 /**********************
  *      MACROS
  **********************/
+#if LV_USE_REFR_BANDS
+    #define DECOMPR_BUF decompr_buf
+#else
+    #define DECOMPR_BUF LV_GC_ROOT(_lv_font_decompr_buf)
+#endif
 
 /**********************
  *   GLOBAL FUNCTIONS
@@ -92,8 +109,8 @@ const uint8_t * lv_font_get_bitmap_fmt_txt(const lv_font_t * font, uint32_t unic
     /*Handle compressed bitmap*/
     else {
 #if LV_USE_FONT_COMPRESSED
-        static size_t last_buf_size = 0;
-        if(LV_GC_ROOT(_lv_font_decompr_buf) == NULL) last_buf_size = 0;
+        static LV_REFR_THREAD_LOCAL size_t last_buf_size = 0;
+        if(DECOMPR_BUF == NULL) last_buf_size = 0;
 
         uint32_t gsize = gdsc->box_w * gdsc->box_h;
         if(gsize == 0) return NULL;
@@ -116,17 +133,17 @@ const uint8_t * lv_font_get_bitmap_fmt_txt(const lv_font_t * font, uint32_t unic
         }
 
         if(last_buf_size < buf_size) {
-            uint8_t * tmp = lv_mem_realloc(LV_GC_ROOT(_lv_font_decompr_buf), buf_size);
+            uint8_t * tmp = lv_mem_realloc(DECOMPR_BUF, buf_size);
             LV_ASSERT_MALLOC(tmp);
             if(tmp == NULL) return NULL;
-            LV_GC_ROOT(_lv_font_decompr_buf) = tmp;
+            DECOMPR_BUF = tmp;
             last_buf_size = buf_size;
         }
 
         bool prefilter = fdsc->bitmap_format == LV_FONT_FMT_TXT_COMPRESSED ? true : false;
-        decompress(&fdsc->glyph_bitmap[gdsc->bitmap_index], LV_GC_ROOT(_lv_font_decompr_buf), gdsc->box_w, gdsc->box_h,
+        decompress(&fdsc->glyph_bitmap[gdsc->bitmap_index], DECOMPR_BUF, gdsc->box_w, gdsc->box_h,
                    (uint8_t)fdsc->bpp, prefilter);
-        return LV_GC_ROOT(_lv_font_decompr_buf);
+        return DECOMPR_BUF;
 #else /*!LV_USE_FONT_COMPRESSED*/
         LV_LOG_WARN("Compressed fonts is used but LV_USE_FONT_COMPRESSED is not enabled in lv_conf.h");
         return NULL;
@@ -195,9 +212,9 @@ bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t * font, lv_font_glyph_dsc_t *
 void _lv_font_clean_up_fmt_txt(void)
 {
 #if LV_USE_FONT_COMPRESSED
-    if(LV_GC_ROOT(_lv_font_decompr_buf)) {
-        lv_mem_free(LV_GC_ROOT(_lv_font_decompr_buf));
-        LV_GC_ROOT(_lv_font_decompr_buf) = NULL;
+    if(DECOMPR_BUF) {
+        lv_mem_free(DECOMPR_BUF);
+        DECOMPR_BUF = NULL;
     }
 #endif
 }
@@ -213,7 +230,11 @@ static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter)
     lv_font_fmt_txt_dsc_t * fdsc = (lv_font_fmt_txt_dsc_t *)font->dsc;
 
     /*Check the cache first*/
+#if LV_USE_REFR_BANDS
+    if(fdsc == cache_dsc && letter == cache.last_letter) return cache.last_glyph_id;
+#else
     if(fdsc->cache && letter == fdsc->cache->last_letter) return fdsc->cache->last_glyph_id;
+#endif
 
     uint16_t i;
     for(i = 0; i < fdsc->cmap_num; i++) {
@@ -252,21 +273,29 @@ static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter)
         }
 
         /*Update the cache*/
-        if(fdsc->cache) {
-            fdsc->cache->last_letter = letter;
-            fdsc->cache->last_glyph_id = glyph_id;
-        }
+        cache_glyph_id(fdsc, letter, glyph_id);
         return glyph_id;
     }
 
-    if(fdsc->cache) {
-        fdsc->cache->last_letter = letter;
-        fdsc->cache->last_glyph_id = 0;
-    }
+    cache_glyph_id(fdsc, letter, 0);
     return 0;
 
 }
 
+static inline void cache_glyph_id(lv_font_fmt_txt_dsc_t * fdsc, uint32_t letter, uint32_t glyph_id)
+{
+    if(fdsc->cache == NULL) return;
+
+#if LV_USE_REFR_BANDS
+    cache_dsc = fdsc;
+    cache.last_letter = letter;
+    cache.last_glyph_id = glyph_id;
+#else
+    fdsc->cache->last_letter = letter;
+    fdsc->cache->last_glyph_id = glyph_id;
+#endif
+}
+
 static int8_t get_kern_value(const lv_font_t * font, uint32_t gid_left, uint32_t gid_right)
 {
     lv_font_fmt_txt_dsc_t * fdsc = (lv_font_fmt_txt_dsc_t *)font->dsc;
@@ -229,6 +229,24 @@
     #endif
 #endif
 
+/*Allow splitting the redrawn areas into horizontal bands drawn by several threads at once.
+ *See `lv_refr_set_bands()`. The drawing code then keeps its scratch per thread.*/
+#ifndef LV_USE_REFR_BANDS
+    #ifdef CONFIG_LV_USE_REFR_BANDS
+        #define LV_USE_REFR_BANDS CONFIG_LV_USE_REFR_BANDS
+    #else
+        #define LV_USE_REFR_BANDS 0
+    #endif
+#endif
+#if LV_USE_REFR_BANDS
+    /*Storage class of the per-thread scratch*/
+    #ifndef LV_REFR_THREAD_LOCAL
+        #define LV_REFR_THREAD_LOCAL __thread
+    #endif
+#else
+    #define LV_REFR_THREAD_LOCAL
+#endif
+
 /*Use a custom tick source that tells the elapsed time in milliseconds.
  *It removes the need to manually update the tick with `lv_tick_inc()`)*/
 #ifndef LV_TICK_CUSTOM
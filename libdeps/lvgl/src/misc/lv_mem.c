@@ -61,6 +61,11 @@
 
 static uint32_t zero_mem = ZERO_MEM_SENTINEL; /*Give the address of this variable if 0 byte should be allocated*/
 
+#if LV_USE_REFR_BANDS
+    /*The temporal buffers of the calling thread. Threads drawing bands get their own.*/
+    static LV_REFR_THREAD_LOCAL lv_mem_buf_t * mem_buf = LV_GC_ROOT(lv_mem_buf);
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -70,6 +75,12 @@ static uint32_t zero_mem = ZERO_MEM_SENTINEL; /*Give the address of this variabl
     #define MEM_TRACE(...)
 #endif
 
+#if LV_USE_REFR_BANDS
+    #define MEM_BUF(i) mem_buf[i]
+#else
+    #define MEM_BUF(i) LV_GC_ROOT(lv_mem_buf[i])
+#endif
+
 #define COPY32 *d32 = *s32; d32++; s32++;
 #define COPY8 *d8 = *s8; d8++; s8++;
 #define SET32(x) *d32 = x; d32++;
@@ -282,41 +293,41 @@ void * lv_mem_buf_get(uint32_t size)
     /*Try to find a free buffer with suitable size*/
     int8_t i_guess = -1;
     for(uint8_t i = 0; i < LV_MEM_BUF_MAX_NUM; i++) {
-        if(LV_GC_ROOT(lv_mem_buf[i]).used == 0 && LV_GC_ROOT(lv_mem_buf[i]).size >= size) {
-            if(LV_GC_ROOT(lv_mem_buf[i]).size == size) {
-                LV_GC_ROOT(lv_mem_buf[i]).used = 1;
-                return LV_GC_ROOT(lv_mem_buf[i]).p;
+        if(MEM_BUF(i).used == 0 && MEM_BUF(i).size >= size) {
+            if(MEM_BUF(i).size == size) {
+                MEM_BUF(i).used = 1;
+                return MEM_BUF(i).p;
             }
             else if(i_guess < 0) {
                 i_guess = i;
             }
             /*If size of `i` is closer to `size` prefer it*/
-            else if(LV_GC_ROOT(lv_mem_buf[i]).size < LV_GC_ROOT(lv_mem_buf[i_guess]).size) {
+            else if(MEM_BUF(i).size < MEM_BUF(i_guess).size) {
                 i_guess = i;
             }
         }
     }
 
     if(i_guess >= 0) {
-        LV_GC_ROOT(lv_mem_buf[i_guess]).used = 1;
+        MEM_BUF(i_guess).used = 1;
         MEM_TRACE("returning already allocated buffer (buffer id: %d, address: %p)", i_guess,
-                  LV_GC_ROOT(lv_mem_buf[i_guess]).p);
-        return LV_GC_ROOT(lv_mem_buf[i_guess]).p;
+                  MEM_BUF(i_guess).p);
+        return MEM_BUF(i_guess).p;
     }
 
     /*Reallocate a free buffer*/
     for(uint8_t i = 0; i < LV_MEM_BUF_MAX_NUM; i++) {
-        if(LV_GC_ROOT(lv_mem_buf[i]).used == 0) {
+        if(MEM_BUF(i).used == 0) {
             /*if this fails you probably need to increase your LV_MEM_SIZE/heap size*/
-            void * buf = lv_mem_realloc(LV_GC_ROOT(lv_mem_buf[i]).p, size);
+            void * buf = lv_mem_realloc(MEM_BUF(i).p, size);
             LV_ASSERT_MSG(buf != NULL, "Out of memory, can't allocate a new buffer (increase your LV_MEM_SIZE/heap size)");
             if(buf == NULL) return NULL;
 
-            LV_GC_ROOT(lv_mem_buf[i]).used = 1;
-            LV_GC_ROOT(lv_mem_buf[i]).size = size;
-            LV_GC_ROOT(lv_mem_buf[i]).p    = buf;
-            MEM_TRACE("allocated (buffer id: %d, address: %p)", i, LV_GC_ROOT(lv_mem_buf[i]).p);
-            return LV_GC_ROOT(lv_mem_buf[i]).p;
+            MEM_BUF(i).used = 1;
+            MEM_BUF(i).size = size;
+            MEM_BUF(i).p    = buf;
+            MEM_TRACE("allocated (buffer id: %d, address: %p)", i, MEM_BUF(i).p);
+            return MEM_BUF(i).p;
         }
     }
 
@@ -334,8 +345,8 @@ void lv_mem_buf_release(void * p)
     MEM_TRACE("begin (address: %p)", p);
 
     for(uint8_t i = 0; i < LV_MEM_BUF_MAX_NUM; i++) {
-        if(LV_GC_ROOT(lv_mem_buf[i]).p == p) {
-            LV_GC_ROOT(lv_mem_buf[i]).used = 0;
+        if(MEM_BUF(i).p == p) {
+            MEM_BUF(i).used = 0;
             return;
         }
     }
@@ -349,15 +360,32 @@ void lv_mem_buf_release(void * p)
 void lv_mem_buf_free_all(void)
 {
     for(uint8_t i = 0; i < LV_MEM_BUF_MAX_NUM; i++) {
-        if(LV_GC_ROOT(lv_mem_buf[i]).p) {
-            lv_mem_free(LV_GC_ROOT(lv_mem_buf[i]).p);
-            LV_GC_ROOT(lv_mem_buf[i]).p = NULL;
-            LV_GC_ROOT(lv_mem_buf[i]).used = 0;
-            LV_GC_ROOT(lv_mem_buf[i]).size = 0;
+        if(MEM_BUF(i).p) {
+            lv_mem_free(MEM_BUF(i).p);
+            MEM_BUF(i).p = NULL;
+            MEM_BUF(i).used = 0;
+            MEM_BUF(i).size = 0;
         }
     }
 }
 
+#if LV_USE_REFR_BANDS
+/**
+ * Give the calling thread its own set of temporal buffers
+ * @return LV_RES_OK: ready; LV_RES_INV: out of memory
+ */
+lv_res_t _lv_mem_buf_thread_init(void)
+{
+    lv_mem_buf_t * bufs = lv_mem_alloc(sizeof(lv_mem_buf_arr_t));
+    LV_ASSERT_MALLOC(bufs);
+    if(bufs == NULL) return LV_RES_INV;
+
+    lv_memset_00(bufs, sizeof(lv_mem_buf_arr_t));
+    mem_buf = bufs;
+    return LV_RES_OK;
+}
+#endif
+
 #if LV_MEMCPY_MEMSET_STD == 0
 /**
  * Same as `memcpy` but optimized for 4 byte operation.
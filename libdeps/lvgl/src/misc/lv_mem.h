@@ -119,6 +119,15 @@ void lv_mem_buf_release(void * p);
  */
 void lv_mem_buf_free_all(void);
 
+#if LV_USE_REFR_BANDS
+/**
+ * Give the calling thread its own set of temporal buffers.
+ * Used by `lv_refr_band_thread_init()`.
+ * @return LV_RES_OK: ready; LV_RES_INV: out of memory
+ */
+lv_res_t _lv_mem_buf_thread_init(void);
+#endif
+
 //! @cond Doxygen_Suppress
 
 #if LV_MEMCPY_MEMSET_STD
@@ -598,6 +598,13 @@ static void draw_img(lv_event_t * e)
             bg_coords.y2 += obj->coords.y1;
         }
 
+#if LV_USE_REFR_BANDS
+        /*Other bands may be reading the coordinates meanwhile, so pass the background's along instead*/
+        _lv_obj_set_draw_coords(obj, &bg_coords);
+        lv_res_t res = lv_obj_event_base(MY_CLASS, e);
+        _lv_obj_set_draw_coords(NULL, NULL);
+        if(res != LV_RES_OK) return;
+#else
         lv_area_t ori_coords;
         lv_area_copy(&ori_coords, &obj->coords);
         lv_area_copy(&obj->coords, &bg_coords);
@@ -606,6 +613,7 @@ static void draw_img(lv_event_t * e)
         if(res != LV_RES_OK) return;
 
         lv_area_copy(&obj->coords, &ori_coords);
+#endif
 
         if(code == LV_EVENT_DRAW_MAIN) {
             if(img->h == 0 || img->w == 0) return;
@@ -6,30 +6,519 @@
  * @date      2023-04-20
  *
  */
+#ifdef ARDUINO
 #include <Arduino.h>
+#include <esp_heap_caps.h>
+#else
+// Off-target builds, e.g. with LilyGo_HostDisplay, have one kind of memory
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#define BOARD_HAS_PSRAM
+#define MALLOC_CAP_DMA                  0
+#define MALLOC_CAP_INTERNAL             0
+#define ps_malloc(size)                 malloc(size)
+#define ps_calloc(n, size)              calloc(n, size)
+#define heap_caps_malloc(size, caps)    ((void)(caps), malloc(size))
+static uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static uint32_t millis()
+{
+    return micros() / 1000;
+}
+static void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+#endif
 #include "LV_Helper.h"
+#include "lvglBands.h"
+#include "lvglBlend.h"
+#include "lvglGlyphCache.h"
+#include "lvglImageCache.h"
+#include "scanlineDiff.h"
+#include "statsRing.h"
+#include "touchQueue.h"
 
 
 #if LV_VERSION_CHECK(9,0,0)
 #error "Currently not supported 9.x"
 #endif
 
+// Build with -DLV_HELPER_ASYNC_FLUSH=0 to block in disp_flush until the
+// area is on the panel, as before.
+#ifndef LV_HELPER_ASYNC_FLUSH
+#define LV_HELPER_ASYNC_FLUSH   1
+#endif
+
+// Build with -DLV_HELPER_VSYNC=0 to start frames without waiting for the
+// panel's tearing-effect edge.
+#ifndef LV_HELPER_VSYNC
+#define LV_HELPER_VSYNC         1
+#endif
+
+// Vsync stays on only if the panel's refresh period can be measured this
+// soon after turning it on, and goes off again after this many frames in a
+// row start without an edge: a TE pin the panel does not drive would
+// otherwise hold every frame for the full wait.
+#ifndef LV_HELPER_VSYNC_PROBE_MS
+#define LV_HELPER_VSYNC_PROBE_MS        100
+#endif
+#ifndef LV_HELPER_VSYNC_MAX_TIMEOUTS
+#define LV_HELPER_VSYNC_MAX_TIMEOUTS    3
+#endif
+
+// Panels that ask for full refreshes get small internal draw buffers and a
+// shadow frame instead; build with -DLV_HELPER_PARTIAL_REFRESH=0 to render
+// whole frames into PSRAM as before.
+#ifndef LV_HELPER_PARTIAL_REFRESH
+#define LV_HELPER_PARTIAL_REFRESH   1
+#endif
+#define LV_HELPER_PARTIAL_LINES     32      // rows in each internal draw buffer
+#define LV_HELPER_TILE              16      // dirty tracking granularity in pixels
+#define LV_HELPER_TILES_MAX         32      // tiles per row, one bit each
+
+// Build with -DLV_HELPER_SCANLINE_DIFF=1 to compare every flushed area with
+// what the panel already shows and send only the rows that changed.
+#ifndef LV_HELPER_SCANLINE_DIFF
+#define LV_HELPER_SCANLINE_DIFF     0
+#endif
+
+// On boards with a touch IRQ line, a task reads the controller only when
+// it raises IRQ and queues the points for LVGL. Build with
+// -DLV_HELPER_TOUCH_IRQ=0 to read it on every LVGL input poll, as before.
+#ifndef LV_HELPER_TOUCH_IRQ
+#define LV_HELPER_TOUCH_IRQ         1
+#endif
+#define LV_HELPER_TOUCH_HOLD_MS     10      // longest gap between reads while touched
+#define LV_HELPER_TOUCH_IDLE_MS     100     // how often an idle task checks it should stop
+#define LV_HELPER_TOUCH_READ_MS     10      // LVGL input poll period, cheap with the queue
+#define LV_HELPER_TOUCH_JITTER      2       // pixels a held point may wander unreported
+
+// Build with -DLV_HELPER_RENDER_BANDS=2 to draw each area in two bands at
+// once, one on each core. Off by default, as draw event handlers then run
+// on both cores; see lvglBands.h. Also needs LV_USE_REFR_BANDS 1 in
+// lv_conf.h.
+#ifndef LV_HELPER_RENDER_BANDS
+#define LV_HELPER_RENDER_BANDS      1
+#endif
+
+// Frames and transfers kept for lvglHelperGetFrameHistory() and
+// lvglHelperGetFlushHistory()
+#ifndef LV_HELPER_STATS_DEPTH
+#define LV_HELPER_STATS_DEPTH       64
+#endif
+
 static lv_disp_draw_buf_t draw_buf;
 static lv_disp_drv_t disp_drv;
 static lv_indev_drv_t  indev_drv;
+static lv_disp_t *disp = NULL;
+static bool async_flush = false;
+static bool swap_in_flush = false;          // LVGL renders native RGB565 the board cannot swap
+static bool vsync = false;
+static bool frame_open = false;             // first area of a frame is out
+static volatile bool frame_closing = false; // last transfer of a frame is on the wire
+static uint32_t frame_vsync;                // TE edges seen when the frame started
+static uint32_t vsync_misses;               // frames in a row started without one
+static LvglVsyncStats vsync_stats;
+static uint16_t *shadow = NULL;             // frame on the panel, in LVGL's orientation
+static uint32_t *dirty_tiles = NULL;        // one word per row of tiles
+static bool scanline_diff = false;
+static uint16_t *diff_shadow = NULL;        // the shadow frame, or a copy of the panel for other boards
+static uint8_t *diff_valid = NULL;          // rows of diff_shadow known to match the panel
+static uint8_t diff_rotation;               // board rotation diff_valid was recorded at
+static DiffSpan *diff_spans = NULL;
+static DiffRect *diff_rects = NULL;
+static volatile uint32_t flush_parts;       // transfers of the current area not yet done, plus one
+static LvglDiffStats diff_stats;
+static StatsRing<LvglFrameStats, LV_HELPER_STATS_DEPTH> frame_history;
+static StatsRing<DisplayFlushTiming, LV_HELPER_STATS_DEPTH> flush_history;
+// The last transfer of a frame can still be out while LVGL starts the next
+// one, so frames alternate between two slots
+struct FrameSlot {
+    LvglFrameStats stats;
+    uint32_t vsync;                         // TE edges seen when the frame started
+    volatile uint32_t pending;              // rendering and sending, until both are done
+};
+static FrameSlot frames[2];
+static uint8_t frame_cur;                   // the frame being rendered
+static volatile uint8_t frame_sending;      // the frame frame_closing is about
+static uint32_t frame_flush_us;             // of it, time spent in disp_flush
+static lv_obj_t *stats_label = NULL;
+static TouchQueue touch_queue;
+static TouchSample touch_state;             // as last reported to LVGL
+// Read by the touch task with __atomic builtins
+static bool touch_run = false;
+static bool touch_alive = false;
+static lv_indev_t *indev = NULL;
+static lv_timer_t *stats_timer = NULL;
+
+static void vsync_off(LilyGo_Display *board)
+{
+    board->setVsync(false);
+    vsync = false;
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(disp);
+    if (refr_timer) {
+        lv_timer_set_period(refr_timer, LV_DISP_DEF_REFR_PERIOD);
+    }
+}
+
+// Starts each frame on a TE edge so the panel scans out behind the writes
+// rather than through them. Waiting here also keeps LVGL from presenting
+// more frames than the panel shows, and its refresh timer is paced to the
+// measured refresh period so it stops rendering frames that would be dropped.
+static void frame_begin(LilyGo_Display *board)
+{
+    uint32_t period = board->getVsyncPeriod();
+    if (!board->waitVsync(period ? period / 500 + 1 : 50)) {
+        vsync_stats.timeouts++;
+        if (++vsync_misses >= LV_HELPER_VSYNC_MAX_TIMEOUTS) {
+            vsync_off(board);
+            return;
+        }
+    } else {
+        vsync_misses = 0;
+    }
+    uint32_t count = board->getVsyncCount();
+    if (vsync_stats.frames) {
+        uint32_t gap = count - frame_vsync;
+        vsync_stats.pacing[gap <= 1 ? 0 : gap >= 4 ? 3 : gap - 1]++;
+    }
+    frame_vsync = count;
+    frames[frame_cur].vsync = count;
+    vsync_stats.frames++;
+    vsync_stats.periodUs = period;
+
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(disp);
+    uint32_t ms = (period + 500) / 1000;
+    if (refr_timer && ms && refr_timer->period != ms) {
+        lv_timer_set_period(refr_timer, ms);
+    }
+}
+
+// Whichever finishes last of rendering and sending a frame records it
+static void frame_record(FrameSlot &frame)
+{
+    if (__atomic_sub_fetch(&frame.pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        frame_history.push(frame.stats);
+    }
+}
+
+static void render_start(lv_disp_drv_t *drv)
+{
+    lvglImageCacheNextFrame();
+    // The frame before may still be sending into its own slot. The one
+    // before that normally is not, unless a frame went without a transfer
+    // to wait for it.
+    frame_cur ^= 1;
+    FrameSlot &frame = frames[frame_cur];
+    if (__atomic_load_n(&frame.pending, __ATOMIC_ACQUIRE)) {
+        static_cast<LilyGo_Display *>(drv->user_data)->waitFlushDone();
+    }
+    memset(&frame.stats, 0, sizeof(frame.stats));
+    frame.stats.startUs = micros();
+    frame.vsync = frame_vsync;
+    frame_flush_us = 0;
+    __atomic_store_n(&frame.pending, 2, __ATOMIC_RELEASE);
+}
+
+// LVGL is done with the frame; its last transfer may still be going
+static void render_done(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+    FrameSlot &frame = frames[frame_cur];
+    frame.stats.renderUs = micros() - frame.stats.startUs - frame_flush_us;
+    frame_record(frame);
+}
+
+// Called once the last transfer of a frame is out. With vsync, the panel
+// starting another refresh before then means that refresh showed part of
+// the old frame.
+static void frame_end(LilyGo_Display *board, uint8_t slot)
+{
+    FrameSlot &frame = frames[slot];
+    if (vsync && board->getVsyncCount() != frame.vsync) {
+        vsync_stats.missed++;
+    }
+    frame.stats.latencyUs = micros() - frame.stats.startUs;
+    frame_record(frame);
+}
+
+static void flush_record(LilyGo_Display *board)
+{
+    DisplayFlushTiming timing;
+    if (board->getFlushTiming(&timing)) {
+        flush_history.push(timing);
+    }
+}
+
+// Diffs the area against diff_shadow, leaving the changed columns of each
+// row in diff_spans, and returns how many rows changed. Rows the panel may
+// not show yet (after enabling or a rotation) count as changed throughout;
+// a full-width area makes them known.
+static uint16_t diff_rows(lv_disp_drv_t *drv, LilyGo_Display *board, const lv_area_t *area,
+                          const lv_color_t *color_p)
+{
+    uint16_t stride = drv->hor_res;
+    uint16_t w = area->x2 - area->x1 + 1;
+    uint16_t h = area->y2 - area->y1 + 1;
+    if (board->getRotation() != diff_rotation) {
+        diff_rotation = board->getRotation();
+        memset(diff_valid, 0, LV_MAX(drv->hor_res, drv->ver_res));
+    }
+    uint16_t changed = diffScanlines(diff_shadow + area->y1 * stride + area->x1, stride,
+                                     (const uint16_t *)color_p, w, h, diff_spans);
+    for (uint16_t y = 0; y < h; y++) {
+        if (diff_valid[area->y1 + y]) {
+            continue;
+        }
+        if (diff_spans[y].first > diff_spans[y].last) {
+            changed++;
+        }
+        diff_spans[y].first = 0;
+        diff_spans[y].last = w - 1;
+        diff_valid[area->y1 + y] = w == stride;
+    }
+    if (!changed) {
+        diff_stats.unchanged++;
+    }
+    return changed;
+}
+
+// Partial refresh for full-refresh panels: LVGL renders only what changed
+// into small internal buffers, which are copied into the shadow frame and
+// their tiles marked dirty. Once the frame is complete the dirty tiles are
+// merged into rectangles, runs along a row of tiles first and then down
+// while the rows below have the same run dirty, and only those are sent.
+static void shadow_store(lv_disp_drv_t *drv, const lv_area_t *area, const lv_color_t *color_p)
+{
+    uint32_t stride = drv->hor_res;
+    uint32_t w = area->x2 - area->x1 + 1;
+    const uint16_t *src = (const uint16_t *)color_p;
+    if (scanline_diff) {
+        // Only tiles holding a changed pixel become dirty
+        uint16_t h = area->y2 - area->y1 + 1;
+        if (!diff_rows(drv, static_cast<LilyGo_Display *>(drv->user_data), area, color_p)) {
+            return;
+        }
+        for (uint16_t y = 0; y < h; y++) {
+            const DiffSpan &span = diff_spans[y];
+            if (span.first <= span.last) {
+                uint32_t first = (area->x1 + span.first) / LV_HELPER_TILE;
+                uint32_t last = (area->x1 + span.last) / LV_HELPER_TILE;
+                dirty_tiles[(area->y1 + y) / LV_HELPER_TILE] |= (2u << last) - (1u << first);
+            }
+        }
+        return;
+    }
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(shadow + y * stride + area->x1, src, w * sizeof(uint16_t));
+        src += w;
+    }
+    // Wraps to all ones past bit 31 on purpose
+    uint32_t bits = (2u << (area->x2 / LV_HELPER_TILE)) - (1u << (area->x1 / LV_HELPER_TILE));
+    for (int32_t ty = area->y1 / LV_HELPER_TILE; ty <= area->y2 / LV_HELPER_TILE; ty++) {
+        dirty_tiles[ty] |= bits;
+    }
+}
+
+static void shadow_push(LilyGo_Display *board, uint16_t stride, const lv_area_t &a)
+{
+    diff_stats.sentBytes += (uint32_t)(a.x2 - a.x1 + 1) * (a.y2 - a.y1 + 1) * sizeof(uint16_t);
+    board->pushColors(a.x1, a.y1, a.x2 - a.x1 + 1, a.y2 - a.y1 + 1, shadow + a.y1 * stride + a.x1, stride);
+    if (!async_flush) {
+        flush_record(board);
+    }
+}
+
+static void shadow_present(lv_disp_drv_t *drv, LilyGo_Display *board)
+{
+    uint16_t w = drv->hor_res;
+    uint16_t h = drv->ver_res;
+    uint32_t tile_rows = (h + LV_HELPER_TILE - 1) / LV_HELPER_TILE;
+    lv_area_t rect;
+    bool pending = false;
+    if (vsync) {
+        frame_begin(board);
+    }
+    for (uint32_t ty = 0; ty < tile_rows; ty++) {
+        while (dirty_tiles[ty]) {
+            uint32_t mask = dirty_tiles[ty];
+            uint32_t tx = __builtin_ctz(mask);
+            uint32_t run = (~mask >> tx) ? __builtin_ctz(~mask >> tx) : 32 - tx;
+            uint32_t bits = (run == 32 ? 0xFFFFFFFFu : (1u << run) - 1) << tx;
+            uint32_t end = ty + 1;
+            while (end < tile_rows && (dirty_tiles[end] & bits) == bits) {
+                dirty_tiles[end++] &= ~bits;
+            }
+            dirty_tiles[ty] &= ~bits;
+            // Sent one behind so the last one is known for frame_end()
+            if (pending) {
+                shadow_push(board, w, rect);
+            }
+            rect.x1 = tx * LV_HELPER_TILE;
+            rect.y1 = ty * LV_HELPER_TILE;
+            rect.x2 = LV_MIN((tx + run) * LV_HELPER_TILE, w) - 1;
+            rect.y2 = LV_MIN(end * LV_HELPER_TILE, h) - 1;
+            pending = true;
+        }
+    }
+    if (pending) {
+        // An earlier rectangle finishing must not end the frame
+        board->waitFlushDone();
+        frame_sending = frame_cur;
+        frame_closing = true;
+        shadow_push(board, w, rect);
+    } else {
+        frame_end(board, frame_cur);
+    }
+    if (!async_flush && frame_closing) {
+        frame_closing = false;
+        frame_end(board, frame_cur);
+    }
+}
 
 /* Display flushing */
-static void disp_flush( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p )
+static void flush_area( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p )
 {
     uint32_t w = ( area->x2 - area->x1 + 1 );
     uint32_t h = ( area->y2 - area->y1 + 1 );
-    static_cast<LilyGo_Display *>(disp_drv->user_data)->pushColors(area->x1, area->y1, w, h, (uint16_t *)color_p);
-    lv_disp_flush_ready( disp_drv );
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(disp_drv->user_data);
+    bool last = lv_disp_flush_is_last(disp_drv);
+    diff_stats.areas++;
+    diff_stats.renderedBytes += w * h * sizeof(uint16_t);
+    if (shadow) {
+        // The draw buffer is free again as soon as it is copied
+        shadow_store(disp_drv, area, color_p);
+        lv_disp_flush_ready( disp_drv );
+        if (last) {
+            shadow_present(disp_drv, board);
+        }
+        return;
+    }
+    if (vsync && !frame_open) {
+        frame_begin(board);
+    }
+    frame_open = !last;
+
+    // Unchanged rows split the area into rectangles, sent straight out of
+    // the draw buffer
+    DiffRect whole = {0, 0, (uint16_t)w, (uint16_t)h};
+    const DiffRect *rects = &whole;
+    uint16_t parts = 1;
+    if (scanline_diff) {
+        parts = 0;
+        if (diff_rows(disp_drv, board, area, color_p)) {
+            parts = mergeScanlines(diff_spans, w, h, disp_drv->rounder_cb ? 2 : 1, diff_rects);
+        }
+        rects = diff_rects;
+    }
+    // Each transfer reports back through disp_flush_done; the extra count
+    // keeps one finishing early from releasing the buffer before the rest
+    // are queued.
+    flush_parts = 1;
+    frame_closing = false;
+    frame_sending = frame_cur;
+    for (uint16_t i = 0; i < parts; i++) {
+        const DiffRect &r = rects[i];
+        if (i + 1 == parts) {
+            board->waitFlushDone();
+            frame_closing = last;
+        }
+        __atomic_add_fetch(&flush_parts, 1, __ATOMIC_ACQ_REL);
+        diff_stats.sentBytes += (uint32_t)r.w * r.h * sizeof(uint16_t);
+        board->pushColors(area->x1 + r.x, area->y1 + r.y, r.w, r.h, (uint16_t *)color_p + r.y * w + r.x, w);
+        if (!async_flush) {
+            flush_record(board);
+        }
+    }
+    if (!parts) {
+        frame_closing = last;
+    }
+    // Asynchronous transfers report back through disp_flush_done
+    if (!async_flush || !parts) {
+        if (frame_closing) {
+            frame_closing = false;
+            frame_end(board, frame_cur);
+        }
+        lv_disp_flush_ready( disp_drv );
+    } else if (__atomic_sub_fetch(&flush_parts, 1, __ATOMIC_ACQ_REL) == 0) {
+        lv_disp_flush_ready( disp_drv );
+    }
+}
+
+static void swap_bytes(lv_color_t *color_p, uint32_t pixels)
+{
+    uint16_t *p = (uint16_t *)color_p;
+    for (uint32_t i = 0; i < pixels; i++) {
+        p[i] = (uint16_t)((p[i] >> 8) | (p[i] << 8));
+    }
+}
+
+static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    uint32_t start = micros();
+    LvglFrameStats &stats = frames[frame_cur].stats;
+    stats.areas++;
+    stats.pixels += lv_area_get_size(area);
+    if (swap_in_flush) {
+        swap_bytes(color_p, lv_area_get_size(area));
+    }
+    flush_area(disp_drv, area, color_p);
+    frame_flush_us += micros() - start;
+}
+
+static void disp_flush_done(void *arg)
+{
+    lv_disp_drv_t *drv = (lv_disp_drv_t *)arg;
+    flush_record(static_cast<LilyGo_Display *>(drv->user_data));
+    if (frame_closing) {
+        frame_closing = false;
+        frame_end(static_cast<LilyGo_Display *>(drv->user_data), frame_sending);
+    }
+    if (!shadow && __atomic_sub_fetch(&flush_parts, 1, __ATOMIC_ACQ_REL) == 0) {
+        lv_disp_flush_ready(drv);
+    }
+}
+
+// Sleeps until the controller raises IRQ, so nothing goes over I2C while
+// the screen is not touched. While it is, the controller is also read
+// every LV_HELPER_TOUCH_HOLD_MS in case the release raises no IRQ.
+static void touch_task(void *arg)
+{
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(arg);
+    bool down = false;
+    while (__atomic_load_n(&touch_run, __ATOMIC_ACQUIRE)) {
+        if (!board->waitTouchInterrupt(down ? LV_HELPER_TOUCH_HOLD_MS : LV_HELPER_TOUCH_IDLE_MS) && !down) {
+            continue;
+        }
+        TouchSample sample;
+        sample.pressed = board->getPoint(&sample.x, &sample.y, 1) != 0;
+        sample.timeMs = millis();
+        touch_queue.push(sample);
+        down = sample.pressed;
+    }
+    __atomic_store_n(&touch_alive, false, __ATOMIC_RELEASE);
+#ifdef ARDUINO
+    vTaskDelete(NULL);
+#endif
 }
 
 /*Read the touchpad*/
 static void touchpad_read( lv_indev_drv_t *indev_driver, lv_indev_data_t *data )
 {
+    if (touch_run) {
+        data->continue_reading = touchQueueDrain(touch_queue, touch_state, LV_HELPER_TOUCH_JITTER);
+        data->point.x = touch_state.x;
+        data->point.y = touch_state.y;
+        data->state = touch_state.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+        return;
+    }
     static int16_t x, y;
     uint8_t touched =   static_cast<LilyGo_Display *>(indev_driver->user_data)->getPoint(&x, &y, 1);
     if ( touched ) {
@@ -45,16 +534,30 @@ static void touchpad_read( lv_indev_drv_t *indev_driver, lv_indev_data_t *data )
 #error "Please turn on PSRAM to OPI !"
 #else
 static lv_color_t *buf = NULL;
+static lv_color_t *buf2 = NULL;
 #endif
 
 #if LV_USE_LOG
 void lv_log_print_g_cb(const char *buf)
 {
+#ifdef ARDUINO
     Serial.println(buf);
     Serial.flush();
+#else
+    puts(buf);
+#endif
 }
 #endif
 
+// LVGL's software renderer, blending through lvglBlend and drawing decoded
+// images and letters out of lvglImageCache and lvglGlyphCache
+static void draw_ctx_init(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+    lvglBlendInitCtx(drv, draw_ctx);
+    lvglImageCacheAttach(draw_ctx);
+    lvglGlyphCacheAttach(draw_ctx);
+}
+
 static void lv_rounder_cb(lv_disp_drv_t *disp_drv, lv_area_t *area)
 {
     // make sure all coordinates are even
@@ -79,11 +582,41 @@ void beginLvglHelper(LilyGo_Display &board, bool debug)
     }
 #endif
 
-    size_t lv_buffer_size = board.width() * board.height() * sizeof(lv_color_t);
-    buf = (lv_color_t *)ps_malloc(lv_buffer_size);
-    assert(buf);
+    // With two buffers LVGL renders into one while the other is being sent
+    bool full_refresh = board.needFullRefresh();
+    uint32_t lv_buffer_pixels = board.width() * board.height();
+#if LV_HELPER_PARTIAL_REFRESH
+    uint16_t longest = LV_MAX(board.width(), board.height());
+    if (full_refresh && longest <= LV_HELPER_TILE * LV_HELPER_TILES_MAX) {
+        uint32_t pixels = longest * LV_HELPER_PARTIAL_LINES;
+        uint32_t caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+        buf = (lv_color_t *)heap_caps_malloc(pixels * sizeof(lv_color_t), caps);
+        buf2 = (lv_color_t *)heap_caps_malloc(pixels * sizeof(lv_color_t), caps);
+        shadow = (uint16_t *)ps_calloc(lv_buffer_pixels, sizeof(uint16_t));
+        dirty_tiles = (uint32_t *)calloc(longest / LV_HELPER_TILE + 1, sizeof(uint32_t));
+        if (buf && buf2 && shadow && dirty_tiles) {
+            full_refresh = false;
+            lv_buffer_pixels = pixels;
+        } else {
+            free(buf);
+            free(buf2);
+            free(shadow);
+            free(dirty_tiles);
+            buf = buf2 = NULL;
+            shadow = NULL;
+            dirty_tiles = NULL;
+        }
+    }
+#endif
+    if (!buf) {
+        size_t lv_buffer_size = lv_buffer_pixels * sizeof(lv_color_t);
+        buf = (lv_color_t *)ps_malloc(lv_buffer_size);
+        assert(buf);
+        buf2 = (lv_color_t *)ps_malloc(lv_buffer_size);
+        assert(buf2);
+    }
 
-    lv_disp_draw_buf_init( &draw_buf, buf, NULL, board.width() * board.height());
+    lv_disp_draw_buf_init( &draw_buf, buf, buf2, lv_buffer_pixels);
 
     /*Initialize the display*/
     lv_disp_drv_init( &disp_drv );
@@ -92,19 +625,278 @@ void beginLvglHelper(LilyGo_Display &board, bool debug)
     disp_drv.ver_res = board.height();
     disp_drv.flush_cb = disp_flush;
     disp_drv.draw_buf = &draw_buf;
-    bool full_refresh = board.needFullRefresh();
     disp_drv.full_refresh = full_refresh;
     disp_drv.user_data = &board;
-    if (!full_refresh) {
+    disp_drv.render_start_cb = render_start;
+    disp_drv.monitor_cb = render_done;
+    disp_drv.draw_ctx_init = draw_ctx_init;
+    // LVGL renders in native byte order unless LV_COLOR_16_SWAP. Boards swap
+    // where they copy pixels anyway, e.g. while rotating; for the rest it is
+    // done here, once per pixel.
+#if LV_COLOR_16_SWAP
+    board.setSwapBytes(false);
+#else
+    swap_in_flush = !board.setSwapBytes(true);
+#endif
+    // The shadow frame is sent in whole tiles, which are already even
+    if (!board.needFullRefresh()) {
         disp_drv.rounder_cb = lv_rounder_cb;
     }
-    lv_disp_drv_register( &disp_drv );
+    disp = lv_disp_drv_register( &disp_drv );
+    lvglHelperSetAsyncFlush(LV_HELPER_ASYNC_FLUSH);
+    lvglHelperSetVsync(LV_HELPER_VSYNC);
+    lvglHelperSetScanlineDiff(LV_HELPER_SCANLINE_DIFF);
+    lvglHelperSetRenderBands(LV_HELPER_RENDER_BANDS);
 
     if (board.hasTouch()) {
         lv_indev_drv_init( &indev_drv );
         indev_drv.type = LV_INDEV_TYPE_POINTER;
         indev_drv.read_cb = touchpad_read;
         indev_drv.user_data = &board;
-        lv_indev_drv_register( &indev_drv );
+        indev = lv_indev_drv_register( &indev_drv );
+        lvglHelperSetTouchInterrupt(LV_HELPER_TOUCH_IRQ);
+    }
+}
+
+bool lvglHelperSetAsyncFlush(bool enable)
+{
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(disp_drv.user_data);
+    if (!board) {
+        return false;
+    }
+    if (enable) {
+        async_flush = board->setFlushDoneCallback(disp_flush_done, &disp_drv);
+    } else {
+        board->setFlushDoneCallback(NULL, NULL);
+        async_flush = false;
+    }
+    return async_flush;
+}
+
+bool lvglHelperSetVsync(bool enable)
+{
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(disp_drv.user_data);
+    if (!board || !disp) {
+        return false;
+    }
+    board->waitFlushDone();
+    frame_open = false;
+    frame_closing = false;
+    vsync_off(board);
+    if (!enable || !board->setVsync(true)) {
+        return false;
+    }
+    // The pin may be wired while the panel's TE output is off
+    uint32_t start = millis();
+    while (!board->getVsyncPeriod() && millis() - start < LV_HELPER_VSYNC_PROBE_MS) {
+        board->waitVsync(LV_HELPER_VSYNC_PROBE_MS);
+    }
+    if (!board->getVsyncPeriod()) {
+        vsync_off(board);
+        return false;
+    }
+    memset(&vsync_stats, 0, sizeof(vsync_stats));
+    vsync_misses = 0;
+    vsync = true;
+    return vsync;
+}
+
+LvglVsyncStats lvglHelperGetVsyncStats()
+{
+    return vsync_stats;
+}
+
+static void free_scanline_diff()
+{
+    if (diff_shadow != shadow) {
+        free(diff_shadow);
+    }
+    free(diff_valid);
+    free(diff_spans);
+    free(diff_rects);
+    diff_shadow = NULL;
+    diff_valid = NULL;
+    diff_spans = NULL;
+    diff_rects = NULL;
+}
+
+bool lvglHelperSetScanlineDiff(bool enable)
+{
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(disp_drv.user_data);
+    if (!board || !disp) {
+        return false;
+    }
+    board->waitFlushDone();
+    if (enable && !scanline_diff) {
+        // Sized for either orientation
+        uint16_t longest = LV_MAX(disp_drv.hor_res, disp_drv.ver_res);
+        uint32_t pixels = (uint32_t)disp_drv.hor_res * disp_drv.ver_res;
+        diff_shadow = shadow ? shadow : (uint16_t *)ps_malloc(pixels * sizeof(uint16_t));
+        diff_valid = (uint8_t *)calloc(longest, sizeof(uint8_t));
+        diff_spans = (DiffSpan *)malloc(longest * sizeof(DiffSpan));
+        diff_rects = (DiffRect *)malloc((longest + 1) / 2 * sizeof(DiffRect));
+        if (diff_shadow && diff_valid && diff_spans && diff_rects) {
+            diff_rotation = board->getRotation();
+            scanline_diff = true;
+            // Repaints the screen once so every row is known
+            lv_obj_invalidate(lv_scr_act());
+        } else {
+            free_scanline_diff();
+        }
+    } else if (!enable && scanline_diff) {
+        scanline_diff = false;
+        free_scanline_diff();
+    }
+    memset(&diff_stats, 0, sizeof(diff_stats));
+    return scanline_diff;
+}
+
+LvglDiffStats lvglHelperGetDiffStats()
+{
+    return diff_stats;
+}
+
+uint32_t lvglHelperSetRenderBands(uint32_t bands)
+{
+    if (!disp) {
+        return 1;
+    }
+    return lvglBandsSet(bands);
+}
+
+bool lvglHelperSetTouchInterrupt(bool enable)
+{
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(indev_drv.user_data);
+    if (!board || !indev) {
+        return false;
+    }
+    if (touch_run) {
+        __atomic_store_n(&touch_run, false, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&touch_alive, __ATOMIC_ACQUIRE)) {
+            delay(1);
+        }
+        board->setTouchInterrupt(false);
+    }
+    lv_timer_set_period(indev->driver->read_timer, LV_INDEV_DEF_READ_PERIOD);
+    if (!enable || !board->setTouchInterrupt(true)) {
+        return false;
+    }
+    // Drop what the old task left behind
+    TouchSample sample;
+    while (touch_queue.pop(&sample)) {
+    }
+    memset(&touch_state, 0, sizeof(touch_state));
+    touch_run = true;
+    touch_alive = true;
+#ifdef ARDUINO
+    if (xTaskCreate(touch_task, "touch", 3072, board, 2, NULL) != pdPASS) {
+        touch_run = false;
+        touch_alive = false;
+        board->setTouchInterrupt(false);
+        return false;
+    }
+#else
+    std::thread(touch_task, board).detach();
+#endif
+    lv_timer_set_period(indev->driver->read_timer, LV_HELPER_TOUCH_READ_MS);
+    return true;
+}
+
+uint32_t lvglHelperGetTouchDropped()
+{
+    return touch_queue.droppedCount();
+}
+
+uint16_t lvglHelperGetFrameHistory(LvglFrameStats *out, uint16_t max)
+{
+    return frame_history.copy(out, max);
+}
+
+uint16_t lvglHelperGetFlushHistory(DisplayFlushTiming *out, uint16_t max)
+{
+    return flush_history.copy(out, max);
+}
+
+LvglPipelineStats lvglHelperGetPipelineStats()
+{
+    static LvglFrameStats frames[LV_HELPER_STATS_DEPTH];
+    static DisplayFlushTiming flushes[LV_HELPER_STATS_DEPTH];
+    LvglPipelineStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    uint16_t n = frame_history.copy(frames, LV_HELPER_STATS_DEPTH);
+    uint64_t render = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        render += frames[i].renderUs;
+        stats.maxLatencyUs = LV_MAX(stats.maxLatencyUs, frames[i].latencyUs);
+    }
+    if (n) {
+        stats.renderUs = render / n;
+    }
+    if (n > 1 && frames[n - 1].startUs != frames[0].startUs) {
+        stats.fps = (n - 1) * 1000000.0f / (frames[n - 1].startUs - frames[0].startUs);
+    }
+
+    n = flush_history.copy(flushes, LV_HELPER_STATS_DEPTH);
+    uint64_t pixels = 0, rotate = 0, spi = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        pixels += flushes[i].pixels;
+        rotate += flushes[i].rotateUs;
+        spi += flushes[i].spiUs;
+        stats.maxQueueDepth = LV_MAX(stats.maxQueueDepth, flushes[i].queueDepth);
+    }
+    if (n) {
+        stats.pixelsPerFlush = pixels / n;
+        stats.rotateUs = rotate / n;
+        stats.spiUs = spi / n;
+    }
+    return stats;
+}
+
+static void stats_update(lv_timer_t *timer)
+{
+    LvglPipelineStats stats = lvglHelperGetPipelineStats();
+    lv_label_set_text_fmt(stats_label, "%d FPS  render %lu us\nlatency max %lu us\n"
+                          "%lu px/flush  rot %lu us  spi %lu us  q%u",
+                          (int)(stats.fps + 0.5f), (unsigned long)stats.renderUs,
+                          (unsigned long)stats.maxLatencyUs, (unsigned long)stats.pixelsPerFlush,
+                          (unsigned long)stats.rotateUs, (unsigned long)stats.spiUs, stats.maxQueueDepth);
+}
+
+void lvglHelperShowStats(bool show)
+{
+    if (show && !stats_label) {
+        stats_label = lv_label_create(lv_layer_sys());
+        lv_obj_set_style_bg_opa(stats_label, LV_OPA_50, 0);
+        lv_obj_set_style_bg_color(stats_label, lv_color_black(), 0);
+        lv_obj_set_style_text_color(stats_label, lv_color_white(), 0);
+        lv_obj_set_style_pad_all(stats_label, 3, 0);
+#if LV_FONT_MONTSERRAT_12
+        lv_obj_set_style_text_font(stats_label, &lv_font_montserrat_12, 0);
+#endif
+        lv_obj_align(stats_label, LV_ALIGN_BOTTOM_RIGHT, 0, 0);
+        stats_timer = lv_timer_create(stats_update, 500, NULL);
+        stats_update(stats_timer);
+    } else if (!show && stats_label) {
+        lv_timer_del(stats_timer);
+        lv_obj_del(stats_label);
+        stats_timer = NULL;
+        stats_label = NULL;
+    }
+}
+
+float lvglHelperMeasureFps(uint32_t frames)
+{
+    LilyGo_Display *board = static_cast<LilyGo_Display *>(disp_drv.user_data);
+    if (!board || frames == 0) {
+        return 0;
+    }
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < frames; i++) {
+        lv_obj_invalidate(lv_scr_act());
+        lv_refr_now(NULL);
     }
+    // The last frame counts once it has reached the panel
+    board->waitFlushDone();
+    return frames * 1000000.0f / (micros() - start);
 }
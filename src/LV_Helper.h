@@ -13,3 +13,82 @@
 
 
 void beginLvglHelper(LilyGo_Display &board, bool debug = false);
+
+// Lets LVGL render the next area while the previous one is sent by DMA.
+// On by default where the display supports it; returns whether it is on.
+bool lvglHelperSetAsyncFlush(bool enable);
+
+// Draws each area LVGL renders in `bands` horizontal bands at once, on
+// both cores; 1 draws it on LVGL's thread alone. Draw event handlers must
+// be ready to run on several threads, see lvglBands.h. Off by default;
+// returns how many bands are used.
+uint32_t lvglHelperSetRenderBands(uint32_t bands);
+
+// Reads touch in a task woken by the controller's IRQ line, queueing the
+// points for LVGL, instead of over I2C on every LVGL input poll. On by
+// default where the board has the line; returns whether it is on.
+bool lvglHelperSetTouchInterrupt(bool enable);
+// Touch samples lost because LVGL did not read the queue in time
+uint32_t lvglHelperGetTouchDropped();
+
+struct LvglVsyncStats {
+    uint32_t frames;        // frames started on a TE edge
+    uint32_t missed;        // frames still being sent when the next refresh began
+    uint32_t timeouts;      // frames started without seeing a TE edge
+    uint32_t pacing[4];     // frames started 1, 2, 3 and 4+ refreshes after the last
+    uint32_t periodUs;      // measured panel refresh period
+};
+
+// Starts every frame on the panel's tearing-effect edge and paces the LVGL
+// refresh timer to it. On by default on boards with a TE pin that the
+// panel drives; returns whether it is on, which it is not if no edges come
+// within LV_HELPER_VSYNC_PROBE_MS. It turns itself off again if the edges
+// stop. Turning it on clears the statistics.
+bool lvglHelperSetVsync(bool enable);
+LvglVsyncStats lvglHelperGetVsyncStats();
+
+struct LvglDiffStats {
+    uint32_t areas;         // areas LVGL rendered
+    uint32_t unchanged;     // areas identical to what the panel showed
+    uint64_t renderedBytes; // pixels LVGL rendered, two bytes each
+    uint64_t sentBytes;     // pixels sent to the panel; the rest were saved
+};
+
+// Compares each rendered area with a copy of what the panel shows and sends
+// only the rectangles around changed rows. Costs a frame of PSRAM on boards
+// without a shadow frame; returns whether it is on. Every call clears the
+// statistics, which are kept with it off too.
+bool lvglHelperSetScanlineDiff(bool enable);
+LvglDiffStats lvglHelperGetDiffStats();
+
+struct LvglFrameStats {
+    uint32_t startUs;       // micros() when LVGL started rendering it
+    uint32_t renderUs;      // LVGL's own time, not counting disp_flush
+    uint32_t latencyUs;     // from startUs until its last pixel was out
+    uint32_t pixels;        // rendered
+    uint16_t areas;
+};
+
+struct LvglPipelineStats {
+    float fps;              // over the recorded frames
+    uint32_t renderUs;      // mean per frame
+    uint32_t maxLatencyUs;
+    uint32_t pixelsPerFlush;    // mean per transfer
+    uint32_t rotateUs;      // mean per transfer
+    uint32_t spiUs;         // mean per transfer
+    uint8_t maxQueueDepth;
+};
+
+// The last frames and the last transfers to the panel, oldest first, as
+// far as the board measures them. Return how many were copied to `out`.
+uint16_t lvglHelperGetFrameHistory(LvglFrameStats *out, uint16_t max);
+uint16_t lvglHelperGetFlushHistory(DisplayFlushTiming *out, uint16_t max);
+LvglPipelineStats lvglHelperGetPipelineStats();
+
+// Shows the pipeline statistics in a corner of the screen, updated twice
+// a second. Its own redraws are counted too.
+void lvglHelperShowStats(bool show);
+
+// Redraws the whole active screen `frames` times and returns frames per
+// second, counting until the last frame has reached the panel.
+float lvglHelperMeasureFps(uint32_t frames);
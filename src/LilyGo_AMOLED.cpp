@@ -8,8 +8,16 @@
  */
 
 #include "LilyGo_AMOLED.h"
+#include "pixelRotate.h"
 #include <esp_adc_cal.h>
 #include <driver/gpio.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5,0,0)
+#include <soc/soc_memory_layout.h>
+#else
+#include <esp_memory_utils.h>
+#endif
 
 #define SEND_BUF_SIZE           (16384)
 #define TFT_SPI_MODE            SPI_MODE0
@@ -18,6 +26,21 @@
 LilyGo_AMOLED::LilyGo_AMOLED() : boards(NULL)
 {
     pBuffer = NULL;
+    _queued = 0;
+    _slot = 0;
+    _flushDoneCb = NULL;
+    _flushDoneArg = NULL;
+    _flushTask = NULL;
+    _flushSem = NULL;
+    _flushIdle = NULL;
+    _flushPending = 0;
+    memset(&_timing, 0, sizeof(_timing));
+    _swapBytes = false;
+    _vsyncSem = NULL;
+    _touchSem = NULL;
+    _vsyncCount = 0;
+    _vsyncPeriod = 0;
+    _vsyncLast = 0;
     _brightness = AMOLED_DEFAULT_BRIGHTNESS;
     // Prevent previously set hold
     switch (esp_sleep_get_wakeup_cause()) {
@@ -35,6 +58,15 @@ LilyGo_AMOLED::LilyGo_AMOLED() : boards(NULL)
 
 LilyGo_AMOLED::~LilyGo_AMOLED()
 {
+    waitFlushDone();
+    setVsync(false);
+    setTouchInterrupt(false);
+    if (_flushTask) {
+        vTaskDelete(_flushTask);
+        vSemaphoreDelete(_flushSem);
+        vSemaphoreDelete(_flushIdle);
+        _flushTask = NULL;
+    }
     if (pBuffer) {
         free(pBuffer);
         pBuffer = NULL;
@@ -303,13 +335,12 @@ bool LilyGo_AMOLED::initBUS()
         digitalWrite(boards->PMICEnPins, HIGH);
     }
 
-    //reset display
-    digitalWrite(boards->display.rst, HIGH);
-    delay(200);
+    //reset display, then set up the bus while it comes out of reset
+    uint32_t start = millis();
     digitalWrite(boards->display.rst, LOW);
-    delay(300);
+    delay(AMOLED_RESET_LOW_MS);
     digitalWrite(boards->display.rst, HIGH);
-    delay(200);
+    uint32_t released = millis();
 
     spi_bus_config_t buscfg = {
         .data0_io_num = boards->display.d0,
@@ -332,7 +363,9 @@ bool LilyGo_AMOLED::initBUS()
         .clock_speed_hz = boards->display.freq,
         .spics_io_num = -1,
         .flags = SPI_DEVICE_HALFDUPLEX,
-        .queue_size = 17,
+        .queue_size = AMOLED_SPI_QUEUE_SIZE,
+        .pre_cb = transferStart,
+        .post_cb = transferDone,
     };
     esp_err_t ret = spi_bus_initialize(DEFAULT_SPI_HANDLER, &buscfg, SPI_DMA_CH_AUTO);
     if (ret != ESP_OK) {
@@ -344,23 +377,88 @@ bool LilyGo_AMOLED::initBUS()
         log_e("spi_bus_add_device fail!");
         return false;
     }
-    // prevent initialization failure
-    int retry = 2;
-    while (retry--) {
-        const lcd_cmd_t *t = boards->display.initSequence;
-        for (uint32_t i = 0; i < boards->display.initSize; i++) {
-            writeCommand(t[i].addr, (uint8_t *)t[i].param, t[i].len & 0x1F);
-            if (t[i].len & 0x80) {
-                delay(120);
-            }
-            if (t[i].len & 0x20) {
-                delay(10);
-            }
-        }
+    uint32_t elapsed = millis() - released;
+    if (elapsed < AMOLED_RESET_WAIT_MS) {
+        delay(AMOLED_RESET_WAIT_MS - elapsed);
     }
+
+    // The sequence used to be sent twice to prevent initialization
+    // failure. Now it is sent again only if the panel does not report
+    // Sleep Out and Display On afterwards, which includes panels whose
+    // registers cannot be read back: a data line nobody drives reads as
+    // all ones, or all zeros, and all ones would pass the bit test.
+    writeInitStream(boards->display.initStream);
+    uint8_t mode = readRegister(0x0A);
+    if (mode == 0xFF || (mode & 0x14) != 0x14) {
+        log_w("Display power mode %02X after init, sending it again", mode);
+        writeInitStream(boards->display.initStream);
+        mode = readRegister(0x0A);
+    }
+    log_i("Display ID %02X, power mode %02X, init took %lu ms", readRegister(0xDA), mode,
+          (unsigned long)(millis() - start));
     return true;
 }
 
+// Queues the commands back to back, waiting only where one needs the panel
+// to settle before the next.
+void LilyGo_AMOLED::writeInitStream(const lcd_init_stream_t *stream)
+{
+    waitFlushDone();
+    const uint8_t *p = stream->data;
+    const uint8_t *end = p + stream->size;
+    while (p < end) {
+        uint8_t flags = p[0];
+        uint8_t len = flags & LCD_CMD_PARAM_MASK;
+        if (_queued >= AMOLED_SPI_QUEUE_SIZE) {
+            reapTransfer();
+        }
+        spi_transaction_ext_t &t = _trans[_slot];
+        _slot = (_slot + 1) % AMOLED_SPI_QUEUE_SIZE;
+        memset(&t, 0, sizeof(t));
+        t.base.flags = SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR;
+        t.base.cmd = 0x02;
+        t.base.addr = p[1] << 8;
+        t.base.length = 8 * len;
+        if (len <= sizeof(t.base.tx_data)) {
+            t.base.flags |= SPI_TRANS_USE_TXDATA;
+            memcpy(t.base.tx_data, p + 2, len);
+        } else {
+            t.base.tx_buffer = p + 2;
+        }
+        // transferStart() and transferDone() frame each command with CS
+        t.base.user = this;
+        if (spi_device_queue_trans(spi, (spi_transaction_t *)&t, portMAX_DELAY) == ESP_OK) {
+            _queued++;
+        } else {
+            log_e("spi_device_queue_trans fail!");
+            waitFlushDone();
+            spi_device_polling_transmit(spi, (spi_transaction_t *)&t);
+        }
+        p += 2 + len;
+        if (flags & (LCD_CMD_DELAY_10MS | LCD_CMD_DELAY_120MS)) {
+            waitFlushDone();
+            delay(flags & LCD_CMD_DELAY_120MS ? 120 : 10);
+        }
+    }
+    waitFlushDone();
+}
+
+// Single-line read (instruction 0x03) of one byte from a panel register
+uint8_t LilyGo_AMOLED::readRegister(uint8_t reg)
+{
+    waitFlushDone();
+    setCS();
+    spi_transaction_t t;
+    memset(&t, 0, sizeof(t));
+    t.flags = SPI_TRANS_USE_RXDATA;
+    t.cmd = 0x03;
+    t.addr = reg << 8;
+    t.rxlength = 8;
+    spi_device_polling_transmit(spi, &t);
+    clrCS();
+    return t.rx_data[0];
+}
+
 
 bool LilyGo_AMOLED::begin()
 {
@@ -566,12 +664,10 @@ bool LilyGo_AMOLED::beginAMOLED_147()
     initBUS();
 
 
-    if (boards->display.frameBufferSize) {
-        if (psramFound()) {
-            pBuffer = (uint16_t *)ps_malloc(boards->display.frameBufferSize);
-        } else {
-            pBuffer = (uint16_t *)malloc(boards->display.frameBufferSize);
-        }
+    // Two bounce buffers in DMA-capable internal RAM take the rotated pixels
+    if (boards->display.frameBufferSize && !pBuffer) {
+        pBuffer = (uint16_t *)heap_caps_malloc(2 * AMOLED_BOUNCE_PIXELS * sizeof(uint16_t),
+                                               MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
         assert(pBuffer);
     }
 
@@ -611,6 +707,7 @@ bool LilyGo_AMOLED::beginAMOLED_147()
 
 void LilyGo_AMOLED::writeCommand(uint32_t cmd, uint8_t *pdat, uint32_t lenght)
 {
+    waitFlushDone();
     setCS();
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));
@@ -675,64 +772,388 @@ void LilyGo_AMOLED::setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_
     }
 }
 
+// Fills in one chunk of a memory write. Only the first chunk carries the
+// write command; the rest continue it while CS stays low.
+static void setupColorTrans(spi_transaction_ext_t &t, const uint16_t *data, size_t len, bool first)
+{
+    memset(&t, 0, sizeof(t));
+    if (first) {
+        t.base.flags = SPI_TRANS_MODE_QIO;
+        t.base.cmd = 0x32 ;
+        t.base.addr = 0x002C00;
+    } else {
+        t.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+        t.command_bits = 0;
+        t.address_bits = 0;
+        t.dummy_bits = 0;
+    }
+    t.base.tx_buffer = data;
+    t.base.length = len * 16;
+}
+
 // Push (aka write pixel) colours to the TFT (use setAddrWindow() first)
 void LilyGo_AMOLED::pushColors(uint16_t *data, uint32_t len)
 {
-    bool first_send = true;
-    uint16_t *p = data;
-    assert(p);
+    assert(data);
     assert(spi);
+    waitFlushDone();
     setCS();
-    do {
-        size_t chunk_size = len;
-        spi_transaction_ext_t t = {0};
-        memset(&t, 0, sizeof(t));
-        if (first_send) {
-            t.base.flags = SPI_TRANS_MODE_QIO;
-            t.base.cmd = 0x32 ;
-            t.base.addr = 0x002C00;
-            first_send = 0;
+    writeColors(data, len, true, true, false);
+    clrCS();
+}
+
+void LilyGo_AMOLED::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data)
+{
+    pushColors(x, y, width, hight, data, width);
+}
+
+void LilyGo_AMOLED::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data, uint16_t stride)
+{
+    bool queue = _flushDoneCb != NULL;
+    waitFlushDone();
+    memset(&_timing, 0, sizeof(_timing));
+    _timing.startUs = (uint32_t)esp_timer_get_time();
+    _timing.pixels = (uint32_t)width * hight;
+    bool rotate = boards->display.frameBufferSize != 0;
+    if (!rotate && !_swapBytes) {
+        setAddrWindow(x, y, x + width - 1, y + hight - 1);
+        setCS();
+        if (stride == width) {
+            writeColors(data, width * hight, true, true, queue);
         } else {
-            t.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
-            t.command_bits = 0;
-            t.address_bits = 0;
-            t.dummy_bits = 0;
+            for (uint16_t i = 0; i < hight; i++) {
+                writeColors(data + (uint32_t)i * stride, width, i == 0, i == hight - 1, queue);
+            }
+        }
+        if (!queue) {
+            clrCS();
+            _timing.spiUs = (uint32_t)esp_timer_get_time() - _timing.startUs;
+        }
+        return;
+    }
+
+    // The panel's own orientation cannot be changed, or the bytes need
+    // swapping, so the area is rotated or copied in bands straight into the
+    // DMA bounce buffers, alternating between them so one fills while the
+    // other is on the wire.
+    assert(pBuffer);
+    static const uint8_t turns[4] = {PIXEL_ROTATE_90, PIXEL_ROTATE_0, PIXEL_ROTATE_270, PIXEL_ROTATE_180};
+    uint8_t turn = rotate ? turns[_rotation & 3] : PIXEL_ROTATE_0;
+    uint16_t _x, _y;
+    switch (turn) {
+    case PIXEL_ROTATE_90:
+        _x = _height - (y + hight);
+        _y = x;
+        break;
+    case PIXEL_ROTATE_180:
+        _x = _width - (x + width);
+        _y = _height - (y + hight);
+        break;
+    case PIXEL_ROTATE_270:
+        _x = y;
+        _y = _width - (x + width);
+        break;
+    default:
+        _x = x;
+        _y = y;
+        break;
+    }
+    uint16_t _w = rotatedWidth(width, hight, turn);
+    uint16_t _h = rotatedHeight(width, hight, turn);
+    uint16_t band = (AMOLED_BOUNCE_PIXELS / _w) & ~1;
+    setAddrWindow(_x, _y, _x + _w - 1, _y + _h - 1);
+    setCS();
+    uint16_t *bounce = pBuffer;
+    for (uint16_t row = 0; row < _h; row += band) {
+        uint16_t rows = _h - row < band ? _h - row : band;
+        // The band sent from this buffer last time round must be out
+        while (_queued >= 2) {
+            reapTransfer();
         }
+        int64_t rotateStart = esp_timer_get_time();
+        rotatePixels(bounce, data, stride, width, hight, turn, row, rows, _swapBytes);
+        _timing.rotateUs += esp_timer_get_time() - rotateStart;
+        writeColors(bounce, (uint32_t)rows * _w, row == 0, row + rows == _h, queue);
+        bounce = bounce == pBuffer ? pBuffer + AMOLED_BOUNCE_PIXELS : pBuffer;
+    }
+    if (!queue) {
+        clrCS();
+        _timing.spiUs = (uint32_t)esp_timer_get_time() - _timing.startUs;
+    }
+}
+
+// Sends pixels as part of the memory write `first` starts, with CS already
+// low. Queued chunks go to the SPI DMA and the call returns at once; the
+// last chunk of the write carries `this` in its user field so
+// transferDone() can release CS and have flushTask() report the flush.
+void LilyGo_AMOLED::writeColors(uint16_t *data, uint32_t len, bool first, bool last, bool queue)
+{
+    uint32_t depth = esp_ptr_dma_capable(data) ? AMOLED_SPI_QUEUE_SIZE : AMOLED_PSRAM_QUEUE_DEPTH;
+    do {
+        size_t chunk_size = len;
         if (chunk_size > SEND_BUF_SIZE) {
             chunk_size = SEND_BUF_SIZE;
         }
-        t.base.tx_buffer = p;
-        t.base.length = chunk_size * 16;
-        spi_device_polling_transmit(spi, (spi_transaction_t *)&t);
+        if (!queue) {
+            spi_transaction_ext_t t;
+            setupColorTrans(t, data, chunk_size, first);
+            spi_device_polling_transmit(spi, (spi_transaction_t *)&t);
+        } else {
+            // Chunks complete in order, so reaping the oldest frees a slot
+            if (_queued >= depth) {
+                reapTransfer();
+            }
+            spi_transaction_ext_t &t = _trans[_slot];
+            _slot = (_slot + 1) % AMOLED_SPI_QUEUE_SIZE;
+            setupColorTrans(t, data, chunk_size, first);
+            t.base.user = last && chunk_size == len ? this : NULL;
+            if (t.base.user) {
+                __atomic_add_fetch(&_flushPending, 1, __ATOMIC_ACQ_REL);
+            }
+            if (spi_device_queue_trans(spi, (spi_transaction_t *)&t, portMAX_DELAY) == ESP_OK) {
+                _queued++;
+                _timing.queueDepth = _queued > _timing.queueDepth ? _queued : _timing.queueDepth;
+            } else {
+                // No memory for a bounce buffer: send this chunk the slow way.
+                // Polling transactions run post_cb as well, once the flushes
+                // before this one are reported.
+                log_e("spi_device_queue_trans fail!");
+                if (t.base.user) {
+                    __atomic_sub_fetch(&_flushPending, 1, __ATOMIC_ACQ_REL);
+                }
+                waitFlushDone();
+                if (t.base.user) {
+                    __atomic_add_fetch(&_flushPending, 1, __ATOMIC_ACQ_REL);
+                }
+                spi_device_polling_transmit(spi, (spi_transaction_t *)&t);
+            }
+        }
+        first = false;
         len -= chunk_size;
-        p += chunk_size;
+        data += chunk_size;
     } while (len > 0);
-    clrCS();
 }
 
-void LilyGo_AMOLED::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data)
+void LilyGo_AMOLED::reapTransfer()
 {
+    spi_transaction_t *done;
+    spi_device_get_trans_result(spi, &done, portMAX_DELAY);
+    _queued--;
+}
 
-    if (boards->display.frameBufferSize) {
-        assert(pBuffer);
-        uint16_t _x = this->height() - (y + hight);
-        uint16_t _y = x;
-        uint16_t _h = width;
-        uint16_t _w = hight;
-        uint16_t *p = data;
-        uint32_t cum = 0;
-        for (uint16_t j = 0; j < width; j++) {
-            for (uint16_t i = 0; i < hight; i++) {
-                pBuffer[cum] = ((uint16_t)p[width * (hight - i - 1) + j]);
-                cum++;
+// Queued commands (multi-line command phase) need CS for themselves;
+// memory writes keep it low from before the first chunk. Both run in the
+// SPI interrupt, so they only touch CS and wake flushTask().
+void IRAM_ATTR LilyGo_AMOLED::transferStart(spi_transaction_t *t)
+{
+    LilyGo_AMOLED *self = (LilyGo_AMOLED *)t->user;
+    if (self && (t->flags & SPI_TRANS_MULTILINE_CMD)) {
+        gpio_set_level((gpio_num_t)self->boards->display.cs, 0);
+    }
+}
+
+void IRAM_ATTR LilyGo_AMOLED::transferDone(spi_transaction_t *t)
+{
+    LilyGo_AMOLED *self = (LilyGo_AMOLED *)t->user;
+    if (self) {
+        gpio_set_level((gpio_num_t)self->boards->display.cs, 1);
+        if (t->flags & SPI_TRANS_MULTILINE_CMD) {
+            return;
+        }
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(self->_flushSem, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+// Reports each finished flush in task context, where the callback may
+// take the time, log its statistics and run code from flash
+void LilyGo_AMOLED::flushTask(void *arg)
+{
+    LilyGo_AMOLED *self = (LilyGo_AMOLED *)arg;
+    for (;;) {
+        xSemaphoreTake(self->_flushSem, portMAX_DELAY);
+        self->_timing.spiUs = (uint32_t)esp_timer_get_time() - self->_timing.startUs;
+        if (self->_flushDoneCb) {
+            self->_flushDoneCb(self->_flushDoneArg);
+        }
+        if (__atomic_sub_fetch(&self->_flushPending, 1, __ATOMIC_ACQ_REL) == 0) {
+            xSemaphoreGive(self->_flushIdle);
+        }
+    }
+}
+
+bool LilyGo_AMOLED::setFlushDoneCallback(DisplayFlushDoneCallback cb, void *arg)
+{
+    waitFlushDone();
+    if (cb && !_flushTask) {
+        _flushSem = xSemaphoreCreateCounting(AMOLED_SPI_QUEUE_SIZE, 0);
+        _flushIdle = xSemaphoreCreateBinary();
+        if (!_flushSem || !_flushIdle ||
+                xTaskCreate(flushTask, "flushDone", AMOLED_FLUSH_TASK_STACK, this,
+                            AMOLED_FLUSH_TASK_PRIORITY, &_flushTask) != pdPASS) {
+            if (_flushSem) {
+                vSemaphoreDelete(_flushSem);
+            }
+            if (_flushIdle) {
+                vSemaphoreDelete(_flushIdle);
             }
+            _flushSem = NULL;
+            _flushIdle = NULL;
+            _flushTask = NULL;
+            return false;
         }
-        setAddrWindow(_x, _y, _x + _w - 1, _y + _h - 1);
-        pushColors(pBuffer, width * hight);
-    } else {
-        setAddrWindow(x, y, x + width - 1, y + hight - 1);
-        pushColors(data, width * hight);
     }
+    _flushDoneCb = cb;
+    _flushDoneArg = arg;
+    return true;
+}
+
+bool LilyGo_AMOLED::getFlushTiming(DisplayFlushTiming *timing)
+{
+    *timing = _timing;
+    return true;
+}
+
+// Panels that rotate in software swap as they rotate, for free. The others
+// send straight from the caller's buffer, and with swapping on copy areas
+// through bounce buffers like the rotating ones.
+bool LilyGo_AMOLED::setSwapBytes(bool swap)
+{
+    if (swap && !pBuffer) {
+        pBuffer = (uint16_t *)heap_caps_malloc(2 * AMOLED_BOUNCE_PIXELS * sizeof(uint16_t),
+                                               MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!pBuffer) {
+            return false;
+        }
+    }
+    waitFlushDone();
+    _swapBytes = swap;
+    return true;
+}
+
+// Waits for the SPI driver, then for flushTask() to report what it sent
+void LilyGo_AMOLED::waitFlushDone()
+{
+    while (_queued) {
+        reapTransfer();
+    }
+    while (__atomic_load_n(&_flushPending, __ATOMIC_ACQUIRE)) {
+        xSemaphoreTake(_flushIdle, portMAX_DELAY);
+    }
+}
+
+void IRAM_ATTR LilyGo_AMOLED::vsyncHandler(void *arg)
+{
+    LilyGo_AMOLED *self = (LilyGo_AMOLED *)arg;
+    int64_t now = esp_timer_get_time();
+    int64_t last = self->_vsyncLast;
+    self->_vsyncLast = now;
+    self->_vsyncCount++;
+    // Smooth over 8 refreshes; ignore the gap after the line was idle
+    uint32_t period = (uint32_t)(now - last);
+    if (last != 0 && period < 100000) {
+        uint32_t average = self->_vsyncPeriod;
+        self->_vsyncPeriod = average ? (average * 7 + period) / 8 : period;
+    }
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->_vsyncSem, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void IRAM_ATTR LilyGo_AMOLED::touchHandler(void *arg)
+{
+    LilyGo_AMOLED *self = (LilyGo_AMOLED *)arg;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->_touchSem, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool LilyGo_AMOLED::setTouchInterrupt(bool enable)
+{
+    if (!boards || !boards->touch || boards->touch->irq == -1 || !_touchOnline) {
+        return false;
+    }
+    if (!enable) {
+        if (_touchSem) {
+            detachInterrupt(boards->touch->irq);
+            vSemaphoreDelete(_touchSem);
+            _touchSem = NULL;
+        }
+        return true;
+    }
+    if (_touchSem) {
+        return true;
+    }
+    _touchSem = xSemaphoreCreateBinary();
+    if (!_touchSem) {
+        return false;
+    }
+    // The controllers pull IRQ low for every report while touched
+    attachInterruptArg(boards->touch->irq, touchHandler, this, FALLING);
+    return true;
+}
+
+// Unlike waitVsync(), an edge from before the call counts: it means a
+// report is waiting.
+bool LilyGo_AMOLED::waitTouchInterrupt(uint32_t timeout_ms)
+{
+    if (!_touchSem) {
+        return false;
+    }
+    return xSemaphoreTake(_touchSem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+bool LilyGo_AMOLED::setVsync(bool enable)
+{
+    if (!boards || boards->display.te == -1) {
+        return false;
+    }
+    if (!enable) {
+        if (_vsyncSem) {
+            detachInterrupt(boards->display.te);
+            vSemaphoreDelete(_vsyncSem);
+            _vsyncSem = NULL;
+        }
+        return true;
+    }
+    if (_vsyncSem) {
+        return true;
+    }
+    _vsyncSem = xSemaphoreCreateBinary();
+    if (!_vsyncSem) {
+        return false;
+    }
+    _vsyncLast = 0;
+    _vsyncPeriod = 0;
+    attachInterruptArg(boards->display.te, vsyncHandler, this, RISING);
+    return true;
+}
+
+bool LilyGo_AMOLED::waitVsync(uint32_t timeout_ms)
+{
+    if (!_vsyncSem) {
+        return false;
+    }
+    // An edge that came before the call does not count
+    xSemaphoreTake(_vsyncSem, 0);
+    return xSemaphoreTake(_vsyncSem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+uint32_t LilyGo_AMOLED::getVsyncCount()
+{
+    return _vsyncCount;
+}
+
+uint32_t LilyGo_AMOLED::getVsyncPeriod()
+{
+    return _vsyncPeriod;
 }
 
 
@@ -987,6 +1408,25 @@ void LilyGo_AMOLED::setRotation(uint8_t rotation)
             break;
         }
         writeCommand(0x3600, &data, 1);
+    } else if (boards == &BOARD_AMOLED_147) {
+        // The SH8501 cannot rotate, pushColors() turns every area instead.
+        // Touch reports panel coordinates, mapped to match.
+        static const bool swapXY[4] = {true, false, true, false};
+        static const bool mirrorX[4] = {false, false, true, true};
+        static const bool mirrorY[4] = {true, false, false, true};
+        waitFlushDone();
+        if (_rotation & 1) {
+            _width = boards->display.height;
+            _height = boards->display.width;
+        } else {
+            _width = boards->display.width;
+            _height = boards->display.height;
+        }
+        if (_touchOnline) {
+            TouchDrvCHSC5816::setMaxCoordinates(_width, _height);
+            TouchDrvCHSC5816::setSwapXY(swapXY[_rotation]);
+            TouchDrvCHSC5816::setMirrorXY(mirrorX[_rotation], mirrorY[_rotation]);
+        }
     } else {
         Serial.println("The screen you are currently using does not support screen rotation!!!");
     }
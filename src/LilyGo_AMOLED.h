@@ -62,6 +62,43 @@
 #define BOARD_PIXELS_NUM    (1)
 #define DEFAULT_SCK_SPEED   (30 * 1000 * 1000)
 
+// Transactions the SPI driver queues for one device. A 600x450 frame is 17
+// chunks of SEND_BUF_SIZE pixels.
+#define AMOLED_SPI_QUEUE_SIZE   (17)
+
+// The driver copies chunks outside DMA-capable memory (PSRAM draw buffers)
+// into internal bounce buffers of 32 KB that it frees only when the
+// transaction is reaped, so fewer of those may be in flight at once.
+#ifndef AMOLED_PSRAM_QUEUE_DEPTH
+#define AMOLED_PSRAM_QUEUE_DEPTH    (2)
+#endif
+
+// Pixels in each of the two internal buffers that panels without hardware
+// rotation turn areas into before they are sent, and that others copy
+// areas into when their bytes need swapping.
+#ifndef AMOLED_BOUNCE_PIXELS
+#define AMOLED_BOUNCE_PIXELS    (8192)
+#endif
+
+// The task that reports finished flushes. The SPI completion interrupt
+// only wakes it; the flush-done callback runs here, outside the ISR.
+#ifndef AMOLED_FLUSH_TASK_STACK
+#define AMOLED_FLUSH_TASK_STACK     (3072)
+#endif
+#ifndef AMOLED_FLUSH_TASK_PRIORITY
+#define AMOLED_FLUSH_TASK_PRIORITY  (4)
+#endif
+
+// Reset timing: how long RST is held low, and how long after its release
+// before the init sequence starts. Panels take commands 5 ms after reset
+// but refuse Sleep Out for 120 ms, and some sequences open with it.
+#ifndef AMOLED_RESET_LOW_MS
+#define AMOLED_RESET_LOW_MS     (20)
+#endif
+#ifndef AMOLED_RESET_WAIT_MS
+#define AMOLED_RESET_WAIT_MS    (120)
+#endif
+
 typedef struct __DisplayConfigure {
     int d0;
     int d1;
@@ -75,8 +112,7 @@ typedef struct __DisplayConfigure {
     uint8_t cmdBit;
     uint8_t addBit;
     int  freq;
-    lcd_cmd_t *initSequence;
-    uint32_t initSize;
+    const lcd_init_stream_t *initStream;
     uint16_t width;
     uint16_t height;
     uint32_t frameBufferSize;
@@ -139,8 +175,7 @@ static const DisplayConfigure_t SH8501_AMOLED  = {
     8,//command bit
     24,//address bit
     30000000,
-    (lcd_cmd_t *)sh8501_cmd,
-    SH8501_INIT_SEQUENCE_LENGHT,
+    &sh8501_init,
     SH8501_WIDTH, //width
     SH8501_HEIGHT, //height
     SH8501_WIDTH *SH8501_HEIGHT * sizeof(uint16_t), //frameBufferSize
@@ -171,8 +206,7 @@ static const DisplayConfigure_t RM67162_AMOLED  = {
     8, //command bit
     24,//address bit
     75000000,
-    (lcd_cmd_t *)rm67162_cmd,
-    RM67162_INIT_SEQUENCE_LENGHT,
+    &rm67162_init,
     RM67162_WIDTH,//width
     RM67162_HEIGHT,//height
     0,//frameBufferSize
@@ -196,8 +230,7 @@ static const DisplayConfigure_t RM690B0_AMOLED  = {
     8, //command bit
     24,//address bit
     36000000,
-    (lcd_cmd_t *)rm690b0_cmd,
-    RM690B0_INIT_SEQUENCE_LENGHT,
+    &rm690b0_init,
     RM690B0_WIDTH,//width
     RM690B0_HEIGHT,//height
     0,//frameBufferSize
@@ -305,6 +338,7 @@ public:
     void setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
     void pushColors(uint16_t *data, uint32_t len);
     void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data);
+    void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data, uint16_t stride);
 
 
     bool installSD(int miso = -1, int mosi = -1, int sclk = -1, int cs = -1);
@@ -343,18 +377,55 @@ public:
     bool hasTouch();
 
     bool needFullRefresh();
+
+    bool setFlushDoneCallback(DisplayFlushDoneCallback cb, void *arg) override;
+    void waitFlushDone() override;
+    bool getFlushTiming(DisplayFlushTiming *timing) override;
+    bool setSwapBytes(bool swap) override;
+
+    bool setTouchInterrupt(bool enable) override;
+    bool waitTouchInterrupt(uint32_t timeout_ms) override;
+    bool setVsync(bool enable) override;
+    bool waitVsync(uint32_t timeout_ms) override;
+    uint32_t getVsyncCount() override;
+    uint32_t getVsyncPeriod() override;
 private:
     bool initBUS();
     bool initPMU();
     void inline setCS();
     void inline clrCS();
     void writeCommand(uint32_t cmd, uint8_t *pdat, uint32_t lenght);
+    void writeInitStream(const lcd_init_stream_t *stream);
+    uint8_t readRegister(uint8_t reg);
+    void writeColors(uint16_t *data, uint32_t len, bool first, bool last, bool queue);
+    void reapTransfer();
+    static void transferStart(spi_transaction_t *t);
+    static void transferDone(spi_transaction_t *t);
+    static void flushTask(void *arg);
+    static void vsyncHandler(void *arg);
+    static void touchHandler(void *arg);
     uint16_t *pBuffer;
     spi_device_handle_t spi;
     uint8_t _brightness;
     const BoardsConfigure_t *boards;
     bool _touchOnline;
     uint16_t _width, _height;
+    spi_transaction_ext_t _trans[AMOLED_SPI_QUEUE_SIZE];
+    uint8_t _queued;        // queued transactions not yet reaped
+    uint8_t _slot;          // next entry of _trans to queue
+    DisplayFlushDoneCallback _flushDoneCb;
+    void *_flushDoneArg;
+    TaskHandle_t _flushTask;
+    SemaphoreHandle_t _flushSem;    // given by transferDone() per flush
+    SemaphoreHandle_t _flushIdle;   // given once every flush is reported
+    uint8_t _flushPending;          // flushes not yet reported, atomic
+    DisplayFlushTiming _timing;     // of the last strided pushColors()
+    bool _swapBytes;                // pixels arrive native, see setSwapBytes()
+    SemaphoreHandle_t _vsyncSem;
+    SemaphoreHandle_t _touchSem;
+    volatile uint32_t _vsyncCount;
+    volatile uint32_t _vsyncPeriod;
+    volatile int64_t _vsyncLast;
 
 #if ESP_IDF_VERSION > ESP_IDF_VERSION_VAL(5,0,0)
     temperature_sensor_handle_t temp_sensor;
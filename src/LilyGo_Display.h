@@ -15,6 +15,19 @@
 //     DISP_HORIZONTAL,    // horizontal
 // };
 
+// Called once the pixels passed to pushColors(x, y, width, height, data) are
+// on the wire and the buffer may be drawn into again. May run in an ISR.
+typedef void (*DisplayFlushDoneCallback)(void *arg);
+
+// Where the last strided pushColors() spent its time. Times are micros().
+typedef struct {
+    uint32_t startUs;       // when pushColors() was called
+    uint32_t pixels;
+    uint32_t rotateUs;      // copying or rotating into bounce buffers
+    uint32_t spiUs;         // from the call until the last pixel was out
+    uint8_t queueDepth;     // most transactions in flight at once
+} DisplayFlushTiming;
+
 class LilyGo_Display
 {
 public:
@@ -24,6 +37,14 @@ public:
     virtual void setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye) = 0;
     virtual void pushColors(uint16_t *data, uint32_t len) = 0;
     virtual void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) = 0;
+    // Same for a block whose rows are `stride` pixels apart, such as part of
+    // a larger frame.
+    virtual void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data, uint16_t stride)
+    {
+        for (uint16_t i = 0; i < height; i++) {
+            pushColors(x, y + i, width, 1, data + (uint32_t)i * stride);
+        }
+    }
     virtual uint16_t  width() = 0;
     virtual uint16_t  height() = 0;
 
@@ -32,6 +53,69 @@ public:
 
     virtual bool needFullRefresh() = 0;
 
+    // Touch interrupt: lets a reader sleep until the controller pulls its
+    // IRQ line, instead of polling it. Returns false if the board has no
+    // IRQ line from its touch controller.
+    virtual bool setTouchInterrupt(bool enable)
+    {
+        return false;
+    }
+    // Blocks until the IRQ line has fired since the last call; false on
+    // timeout or with the interrupt off.
+    virtual bool waitTouchInterrupt(uint32_t timeout_ms)
+    {
+        return false;
+    }
+
+    // With a callback set, pushColors(x, y, width, height, data) only queues
+    // the transfer and returns; the callback reports when it has finished,
+    // from a task of the display's rather than an interrupt.
+    // Pass NULL to go back to blocking transfers. Returns false if the
+    // display can only push synchronously.
+    virtual bool setFlushDoneCallback(DisplayFlushDoneCallback cb, void *arg)
+    {
+        return false;
+    }
+    // Blocks until every queued transfer has finished.
+    virtual void waitFlushDone() {}
+
+    // Tearing-effect sync: counts the edges the panel raises on its TE pin
+    // as it starts each refresh. Returns false if the board has no TE pin.
+    virtual bool setVsync(bool enable)
+    {
+        return false;
+    }
+    // Blocks until the next TE edge; false on timeout or with vsync off.
+    virtual bool waitVsync(uint32_t timeout_ms)
+    {
+        return false;
+    }
+    virtual uint32_t getVsyncCount()
+    {
+        return 0;
+    }
+    // Smoothed time between TE edges in microseconds, 0 until measured.
+    virtual uint32_t getVsyncPeriod()
+    {
+        return 0;
+    }
+
+    // Timing of the last pushColors(x, y, width, height, data, stride), once
+    // it has finished. Returns false if the display does not measure it.
+    virtual bool getFlushTiming(DisplayFlushTiming *timing)
+    {
+        return false;
+    }
+
+    // With `swap`, pushColors(x, y, width, height, data) takes native
+    // little-endian RGB565, as LVGL renders with LV_COLOR_16_SWAP 0, and
+    // swaps the bytes on the way to the panel. Returns false if the display
+    // cannot, in which case pixels must arrive big-endian.
+    virtual bool setSwapBytes(bool swap)
+    {
+        return !swap;
+    }
+
 protected:
     uint16_t _offset_x = 0;
     uint16_t _offset_y = 0;
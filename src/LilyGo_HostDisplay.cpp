@@ -0,0 +1,403 @@
+/**
+ * @file      LilyGo_HostDisplay.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#ifndef ARDUINO
+
+#include "LilyGo_HostDisplay.h"
+#include "LV_Helper.h"
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+#define COMMAND_HEADER_BYTES    4
+#define TOUCH_REPORT_MS         10      // how often a held controller raises IRQ
+
+static uint64_t hostMillis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t hostMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LilyGo_HostDisplay::LilyGo_HostDisplay(uint16_t width, uint16_t height, bool fullRefresh, bool bigEndian) :
+    frame((size_t)width * height, 0), _width(width), _height(height), fullRefresh(fullRefresh),
+    bigEndian(bigEndian), winX0(0), winY0(0), winX1(width - 1), winY1(height - 1), cursorX(0), cursorY(0),
+    script(NULL), scriptLength(0), scriptStart(0), lastReport(0)
+{
+    resetStats();
+    memset(&timing, 0, sizeof(timing));
+}
+
+// The frame keeps its size; odd rotations only swap how it is addressed.
+void LilyGo_HostDisplay::setRotation(uint8_t rotation)
+{
+    rotation %= 4;
+    if ((rotation ^ _rotation) & 1) {
+        uint16_t w = _width;
+        _width = _height;
+        _height = w;
+    }
+    _rotation = rotation;
+}
+
+uint8_t LilyGo_HostDisplay::getRotation()
+{
+    return _rotation;
+}
+
+void LilyGo_HostDisplay::setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+    winX0 = xs < _width ? xs : _width - 1;
+    winY0 = ys < _height ? ys : _height - 1;
+    winX1 = xe < _width ? xe : _width - 1;
+    winY1 = ye < _height ? ye : _height - 1;
+    cursorX = winX0;
+    cursorY = winY0;
+    counters.windows++;
+    counters.bytes += 3 * COMMAND_HEADER_BYTES + 8;
+}
+
+void LilyGo_HostDisplay::writePixel(uint16_t color)
+{
+    frame[(size_t)cursorY * _width + cursorX] = color;
+    if (cursorX++ == winX1) {
+        cursorX = winX0;
+        cursorY = cursorY == winY1 ? winY0 : cursorY + 1;
+    }
+}
+
+// Like the panel, starts at the window origin and wraps inside it.
+void LilyGo_HostDisplay::pushColors(uint16_t *data, uint32_t len)
+{
+    cursorX = winX0;
+    cursorY = winY0;
+    for (uint32_t i = 0; i < len; i++) {
+        writePixel(data[i]);
+    }
+    counters.flushes++;
+    counters.pixels += len;
+    counters.bytes += COMMAND_HEADER_BYTES + (uint64_t)len * 2;
+}
+
+void LilyGo_HostDisplay::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data)
+{
+    setAddrWindow(x, y, x + width - 1, y + height - 1);
+    pushColors(data, (uint32_t)width * height);
+}
+
+void LilyGo_HostDisplay::pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data,
+                                    uint16_t stride)
+{
+    uint64_t start = hostMicros();
+    setAddrWindow(x, y, x + width - 1, y + height - 1);
+    for (uint16_t i = 0; i < height; i++) {
+        for (uint16_t j = 0; j < width; j++) {
+            writePixel(data[(uint32_t)i * stride + j]);
+        }
+    }
+    counters.flushes++;
+    counters.pixels += (uint32_t)width * height;
+    counters.bytes += COMMAND_HEADER_BYTES + (uint64_t)width * height * 2;
+    timing.startUs = (uint32_t)start;
+    timing.pixels = (uint32_t)width * height;
+    timing.spiUs = (uint32_t)(hostMicros() - start);
+}
+
+uint16_t LilyGo_HostDisplay::width()
+{
+    return _width;
+}
+
+uint16_t LilyGo_HostDisplay::height()
+{
+    return _height;
+}
+
+const HostTouchEvent *LilyGo_HostDisplay::touchEvent()
+{
+    std::lock_guard<std::mutex> guard(scriptLock);
+    if (!script || !scriptLength) {
+        return NULL;
+    }
+    uint64_t elapsed = hostMillis() - scriptStart;
+    const HostTouchEvent *event = NULL;
+    for (size_t i = 0; i < scriptLength && script[i].timeMs <= elapsed; i++) {
+        event = &script[i];
+    }
+    return event;
+}
+
+uint8_t LilyGo_HostDisplay::getPoint(int16_t *x, int16_t *y, uint8_t get_point)
+{
+    __atomic_add_fetch(&counters.touchReads, 1, __ATOMIC_RELAXED);
+    const HostTouchEvent *event = touchEvent();
+    if (!event || !event->pressed) {
+        return 0;
+    }
+    *x = event->x;
+    *y = event->y;
+    return 1;
+}
+
+bool LilyGo_HostDisplay::hasTouch()
+{
+    return true;
+}
+
+bool LilyGo_HostDisplay::needFullRefresh()
+{
+    return fullRefresh;
+}
+
+bool LilyGo_HostDisplay::setTouchInterrupt(bool enable)
+{
+    return true;
+}
+
+bool LilyGo_HostDisplay::waitTouchInterrupt(uint32_t timeout_ms)
+{
+    uint64_t end = hostMillis() + timeout_ms;
+    for (;;) {
+        const HostTouchEvent *event = touchEvent();
+        uint64_t now = hostMillis();
+        if (event && event->pressed && now - lastReport >= TOUCH_REPORT_MS) {
+            lastReport = now;
+            return true;
+        }
+        if (hostMillis() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// The copy into the frame stands in for the transfer
+bool LilyGo_HostDisplay::getFlushTiming(DisplayFlushTiming *timing)
+{
+    *timing = this->timing;
+    return true;
+}
+
+// The frame keeps pixels in the order they arrive, so it is converted too
+bool LilyGo_HostDisplay::setSwapBytes(bool swap)
+{
+    if (swap == bigEndian) {
+        for (uint16_t &c : frame) {
+            c = (uint16_t)((c >> 8) | (c << 8));
+        }
+        bigEndian = !swap;
+    }
+    return true;
+}
+
+void LilyGo_HostDisplay::setTouchScript(const HostTouchEvent *events, size_t count)
+{
+    std::lock_guard<std::mutex> guard(scriptLock);
+    script = events;
+    scriptLength = count;
+    scriptStart = hostMillis();
+}
+
+HostDisplayStats LilyGo_HostDisplay::stats() const
+{
+    HostDisplayStats s;
+    s.flushes = counters.flushes;
+    s.windows = counters.windows;
+    s.pixels = counters.pixels;
+    s.bytes = counters.bytes;
+    s.touchReads = __atomic_load_n(&counters.touchReads, __ATOMIC_RELAXED);
+    return s;
+}
+
+void LilyGo_HostDisplay::resetStats()
+{
+    counters.flushes = 0;
+    counters.windows = 0;
+    counters.pixels = 0;
+    counters.bytes = 0;
+    __atomic_store_n(&counters.touchReads, 0, __ATOMIC_RELAXED);
+}
+
+uint32_t LilyGo_HostDisplay::getPixel(uint16_t x, uint16_t y) const
+{
+    uint16_t c = frame[(size_t)y * _width + x];
+    if (bigEndian) {
+        c = (uint16_t)((c >> 8) | (c << 8));
+    }
+    uint32_t r = (c >> 11) & 0x1F;
+    uint32_t g = (c >> 5) & 0x3F;
+    uint32_t b = c & 0x1F;
+    return (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void put32(std::vector<uint8_t> &out, uint32_t v)
+{
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+static void pngChunk(FILE *f, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> chunk;
+    put32(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put32(chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+// RGB8 PNG kept in stored (uncompressed) deflate blocks, so no zlib needed.
+bool LilyGo_HostDisplay::savePng(const char *path) const
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<uint8_t> header;
+    put32(header, _width);
+    put32(header, _height);
+    header.push_back(8);    // bit depth
+    header.push_back(2);    // truecolour
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    pngChunk(f, "IHDR", header);
+
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)_height * (_width * 3 + 1));
+    for (uint16_t y = 0; y < _height; y++) {
+        raw.push_back(0);   // no filter
+        for (uint16_t x = 0; x < _width; x++) {
+            uint32_t rgb = getPixel(x, y);
+            raw.push_back(rgb >> 16);
+            raw.push_back(rgb >> 8);
+            raw.push_back(rgb);
+        }
+    }
+    std::vector<uint8_t> z;
+    z.push_back(0x78);
+    z.push_back(0x01);
+    size_t at = 0;
+    do {
+        size_t n = raw.size() - at > 65535 ? 65535 : raw.size() - at;
+        z.push_back(at + n == raw.size());
+        z.push_back(n);
+        z.push_back(n >> 8);
+        z.push_back(~n);
+        z.push_back(~n >> 8);
+        z.insert(z.end(), raw.begin() + at, raw.begin() + at + n);
+        at += n;
+    } while (at < raw.size());
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put32(z, (b << 16) | a);
+    pngChunk(f, "IDAT", z);
+    pngChunk(f, "IEND", std::vector<uint8_t>());
+    return fclose(f) == 0;
+}
+
+void hostBenchmarkTileview(LilyGo_HostDisplay &display, lv_obj_t *tileview, uint32_t frames,
+                           const char *pngPrefix, FILE *out)
+{
+    uint32_t tiles = lv_obj_get_child_cnt(tileview);
+    for (uint32_t i = 0; i < tiles; i++) {
+        display.resetStats();
+        uint64_t start = hostMicros();
+        lv_obj_set_tile(tileview, lv_obj_get_child(tileview, i), LV_ANIM_OFF);
+        lv_refr_now(NULL);
+        uint64_t switchUs = hostMicros() - start;
+        HostDisplayStats switched = display.stats();
+
+        display.resetStats();
+        start = hostMicros();
+        for (uint32_t n = 0; n < frames; n++) {
+            lv_obj_invalidate(lv_scr_act());
+            lv_refr_now(NULL);
+        }
+        uint64_t redrawUs = hostMicros() - start;
+        HostDisplayStats redraw = display.stats();
+
+        fprintf(out, "tile %lu: switch %.2f ms %llu bytes, redraw %.2f ms/frame %llu bytes/frame %lu flushes/frame\n",
+                (unsigned long)i, switchUs / 1000.0, (unsigned long long)switched.bytes,
+                frames ? redrawUs / 1000.0 / frames : 0.0,
+                (unsigned long long)(frames ? redraw.bytes / frames : 0),
+                (unsigned long)(frames ? redraw.flushes / frames : 0));
+        if (pngPrefix) {
+            char path[256];
+            snprintf(path, sizeof(path), "%s%lu.png", pngPrefix, (unsigned long)i);
+            display.savePng(path);
+        }
+    }
+}
+
+bool hostWriteChromeTrace(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    std::vector<LvglFrameStats> frames(256);
+    std::vector<DisplayFlushTiming> flushes(256);
+    frames.resize(lvglHelperGetFrameHistory(frames.data(), frames.size()));
+    flushes.resize(lvglHelperGetFlushHistory(flushes.data(), flushes.size()));
+
+    fputs("{\"traceEvents\":[\n", f);
+    fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"LVGL render\"}},\n", f);
+    fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"frame latency\"}},\n", f);
+    fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,\"args\":{\"name\":\"transfers\"}}", f);
+    for (size_t i = 0; i < frames.size(); i++) {
+        const LvglFrameStats &fr = frames[i];
+        fprintf(f, ",\n{\"name\":\"render\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lu,\"dur\":%lu,"
+                "\"args\":{\"areas\":%u,\"pixels\":%lu}}",
+                (unsigned long)fr.startUs, (unsigned long)fr.renderUs, fr.areas, (unsigned long)fr.pixels);
+        fprintf(f, ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%lu,\"dur\":%lu}",
+                (unsigned long)fr.startUs, (unsigned long)fr.latencyUs);
+    }
+    for (size_t i = 0; i < flushes.size(); i++) {
+        const DisplayFlushTiming &t = flushes[i];
+        fprintf(f, ",\n{\"name\":\"flush\",\"ph\":\"X\",\"pid\":1,\"tid\":3,\"ts\":%lu,\"dur\":%lu,"
+                "\"args\":{\"pixels\":%lu,\"rotateUs\":%lu,\"queueDepth\":%u}}",
+                (unsigned long)t.startUs, (unsigned long)t.spiUs, (unsigned long)t.pixels,
+                (unsigned long)t.rotateUs, t.queueDepth);
+    }
+    fputs("\n]}\n", f);
+    return fclose(f) == 0;
+}
+
+#endif // ARDUINO
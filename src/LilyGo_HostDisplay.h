@@ -0,0 +1,109 @@
+/**
+ * @file      LilyGo_HostDisplay.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Off-target only: lets the LVGL helper and UI code run on a desktop, e.g.
+// to profile screens without a board. Arduino builds see an empty header.
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <mutex>
+#include <vector>
+#include <lvgl.h>
+#include "LilyGo_Display.h"
+
+// One step of a scripted touch sequence, `timeMs` after setTouchScript().
+typedef struct {
+    uint32_t timeMs;
+    int16_t x;
+    int16_t y;
+    bool pressed;
+} HostTouchEvent;
+
+// What would have gone over QSPI: every command is a 4-byte header plus its
+// parameters, and pixels are two bytes each.
+typedef struct {
+    uint32_t flushes;       // pushColors() calls
+    uint32_t windows;       // setAddrWindow() calls
+    uint64_t pixels;
+    uint64_t bytes;
+    uint32_t touchReads;    // getPoint() calls, each an I2C transfer on a board
+} HostDisplayStats;
+
+// LilyGo_Display that draws into an RGB565 frame in memory.
+class LilyGo_HostDisplay : public LilyGo_Display
+{
+public:
+    // `bigEndian` matches LV_COLOR_16_SWAP 1, where pixels arrive in the
+    // byte order the panel takes; setSwapBytes(true) switches to native.
+    LilyGo_HostDisplay(uint16_t width, uint16_t height, bool fullRefresh = false, bool bigEndian = true);
+
+    void setRotation(uint8_t rotation) override;
+    uint8_t getRotation() override;
+    void setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye) override;
+    void pushColors(uint16_t *data, uint32_t len) override;
+    void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data) override;
+    void pushColors(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *data, uint16_t stride) override;
+    uint16_t width() override;
+    uint16_t height() override;
+
+    uint8_t getPoint(int16_t *x, int16_t *y, uint8_t get_point) override;
+    bool hasTouch() override;
+    bool needFullRefresh() override;
+    bool getFlushTiming(DisplayFlushTiming *timing) override;
+    bool setSwapBytes(bool swap) override;
+    // The script stands in for the controller: IRQ is active while it
+    // holds a press.
+    bool setTouchInterrupt(bool enable) override;
+    bool waitTouchInterrupt(uint32_t timeout_ms) override;
+
+    // Replays `events` by wall-clock time; the last one holds. The array
+    // must outlive the script.
+    void setTouchScript(const HostTouchEvent *events, size_t count);
+
+    // touchReads is counted on the helper's touch thread
+    HostDisplayStats stats() const;
+    void resetStats();
+
+    // Pixel (x, y) of the frame as 0xRRGGBB.
+    uint32_t getPixel(uint16_t x, uint16_t y) const;
+    bool savePng(const char *path) const;
+
+private:
+    void writePixel(uint16_t color);
+    const HostTouchEvent *touchEvent();
+
+    std::vector<uint16_t> frame;
+    uint16_t _width, _height;
+    bool fullRefresh;
+    bool bigEndian;
+    uint16_t winX0, winY0, winX1, winY1;
+    uint16_t cursorX, cursorY;
+    std::mutex scriptLock;  // between the test and the touch thread
+    const HostTouchEvent *script;
+    size_t scriptLength;
+    uint64_t scriptStart;
+    uint64_t lastReport;
+    HostDisplayStats counters;
+    DisplayFlushTiming timing;
+};
+
+// Shows each tile of `tileview` in turn and prints, per tile, the time and
+// bytes of switching to it, then of `frames` full redraws of it. With
+// `pngPrefix`, the tile is also saved as <pngPrefix><index>.png.
+void hostBenchmarkTileview(LilyGo_HostDisplay &display, lv_obj_t *tileview, uint32_t frames,
+                           const char *pngPrefix = NULL, FILE *out = stdout);
+
+// Writes the frames and transfers the LVGL helper has recorded as a Chrome
+// trace (chrome://tracing or ui.perfetto.dev): rendering and latency per
+// frame, and each transfer on its own track.
+bool hostWriteChromeTrace(const char *path);
+
+#endif // ARDUINO
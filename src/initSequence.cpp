@@ -9,8 +9,81 @@
 
 #include "initSequence.h"
 
+// Compile-time packing of the tables into lcd_init_stream_t. Written as
+// single-return constexpr functions so it builds as C++11.
+namespace
+{
 
-const lcd_cmd_t sh8501_cmd[SH8501_INIT_SEQUENCE_LENGHT] = {
+template <uint32_t... I> struct Indices {};
+
+template <class A, class B> struct JoinIndices;
+template <uint32_t... A, uint32_t... B>
+struct JoinIndices<Indices<A...>, Indices<B...>> {
+    typedef Indices<A..., (sizeof...(A) + B)...> type;
+};
+
+// 0 .. N-1, built by halves so long streams stay well inside the template
+// depth limit
+template <uint32_t N> struct MakeIndices {
+    typedef typename JoinIndices<typename MakeIndices<N / 2>::type, typename MakeIndices<N - N / 2>::type>::type type;
+};
+template <> struct MakeIndices<0> {
+    typedef Indices<> type;
+};
+template <> struct MakeIndices<1> {
+    typedef Indices<0> type;
+};
+
+constexpr uint32_t commandSize(const lcd_cmd_t &c)
+{
+    return 2 + (c.len & LCD_CMD_PARAM_MASK);
+}
+
+constexpr uint32_t streamSize(const lcd_cmd_t *t, uint32_t n)
+{
+    return n ? commandSize(*t) + streamSize(t + 1, n - 1) : 0;
+}
+
+// Every command must fit in one byte and the flags in the len byte
+constexpr bool packable(const lcd_cmd_t *t, uint32_t n)
+{
+    return !n || ((t->addr & ~0xFF00u) == 0 &&
+                  (t->len & ~(LCD_CMD_PARAM_MASK | LCD_CMD_DELAY_10MS | LCD_CMD_DELAY_120MS)) == 0 &&
+                  (t->len & LCD_CMD_PARAM_MASK) <= sizeof(t->param) && packable(t + 1, n - 1));
+}
+
+constexpr uint8_t commandByte(const lcd_cmd_t &c, uint32_t i)
+{
+    return i == 0 ? c.len : i == 1 ? c.addr >> 8 : c.param[i - 2];
+}
+
+constexpr uint8_t streamByte(const lcd_cmd_t *t, uint32_t i)
+{
+    return i < commandSize(*t) ? commandByte(*t, i) : streamByte(t + 1, i - commandSize(*t));
+}
+
+template <uint32_t N> struct StreamBytes {
+    uint8_t data[N];
+};
+
+template <uint32_t... I>
+constexpr StreamBytes<sizeof...(I)> packStream(const lcd_cmd_t *t, Indices<I...>)
+{
+    return {{streamByte(t, I)...}};
+}
+
+} // namespace
+
+#define INIT_STREAM_COUNT(table)    (sizeof(table) / sizeof(table[0]))
+
+#define DEFINE_INIT_STREAM(name, table)                                                         \
+    static_assert(packable(table, INIT_STREAM_COUNT(table)), #table " does not fit a stream");  \
+    static constexpr StreamBytes<streamSize(table, INIT_STREAM_COUNT(table))> name##_bytes =    \
+        packStream(table, MakeIndices<streamSize(table, INIT_STREAM_COUNT(table))>::type());    \
+    const lcd_init_stream_t name = {name##_bytes.data, sizeof(name##_bytes.data)}
+
+
+constexpr lcd_cmd_t sh8501_cmd[SH8501_INIT_SEQUENCE_LENGHT] = {
 
     // ===  CMD2 password  ===
     {0xfe00, {0x20}, 0x01},
@@ -501,10 +574,10 @@ const lcd_cmd_t sh8501_cmd[SH8501_INIT_SEQUENCE_LENGHT] = {
     {0x2900, {}, 0x80},
 };
 
-const lcd_cmd_t rm67162_cmd[RM67162_INIT_SEQUENCE_LENGHT] = {
+constexpr lcd_cmd_t rm67162_cmd[RM67162_INIT_SEQUENCE_LENGHT] = {
     {0x1100, {0x00}, 0x80}, // Sleep Out
     // {0x44, {0x01, 0x66},        0x02}, //Set_Tear_Scanline
-    // {0x35, {0x00},        0x00}, //TE ON
+    {0x3500, {0x00}, 0x01}, // TE ON, V-blank only, for vsync on GPIO 9
     // {0x34, {0x00},        0x00}, //TE OFF
     // {0x36, {0x00},        0x01}, //Scan Direction Control
     {0x3A00, {0x55}, 0x01}, // Interface Pixel Format 16bit/pixel
@@ -516,7 +589,7 @@ const lcd_cmd_t rm67162_cmd[RM67162_INIT_SEQUENCE_LENGHT] = {
     {0x3600, {0x60}, 0x01}, //
 };
 
-const lcd_cmd_t rm690b0_cmd[RM690B0_INIT_SEQUENCE_LENGHT] = {
+constexpr lcd_cmd_t rm690b0_cmd[RM690B0_INIT_SEQUENCE_LENGHT] = {
     {0xFE00, {0x20}, 0x01},           //SET PAGE
     {0x2600, {0x0A}, 0x01},           //MIPI OFF
     {0x2400, {0x80}, 0x01},           //SPI write RAM
@@ -532,6 +605,10 @@ const lcd_cmd_t rm690b0_cmd[RM690B0_INIT_SEQUENCE_LENGHT] = {
     {0x5100, {0xFF}, 0x01},           //Write Display Brightness  MAX_VAL=0XFF
 };
 
+DEFINE_INIT_STREAM(sh8501_init, sh8501_cmd);
+DEFINE_INIT_STREAM(rm67162_init, rm67162_cmd);
+DEFINE_INIT_STREAM(rm690b0_init, rm690b0_cmd);
+
 const lcd_cmd_t jd9613_cmd[JD9613_INIT_SEQUENCE_LENGHT] = {
     {0xfe, {0x01}, 0x02},
     {0xf7, {0x96, 0x13, 0xa9}, 0x04},
@@ -16,16 +16,32 @@ typedef struct {
     uint32_t len;
 } lcd_cmd_t;
 
+// lcd_cmd_t::len: parameter count, plus how long the panel needs after it
+#define LCD_CMD_PARAM_MASK                      0x1F
+#define LCD_CMD_DELAY_10MS                      0x20
+#define LCD_CMD_DELAY_120MS                     0x80
+
+// An init sequence as it is sent: for each command its len byte, the
+// command byte and then only the parameters it has. The streams are packed
+// from the lcd_cmd_t tables below at compile time; with nothing else
+// using the tables, the linker leaves them out.
+typedef struct {
+    const uint8_t *data;
+    uint32_t size;
+} lcd_init_stream_t;
+
 #define AMOLED_DEFAULT_BRIGHTNESS               175
 
 #define SH8501_INIT_SEQUENCE_LENGHT             407
 extern const lcd_cmd_t sh8501_cmd[SH8501_INIT_SEQUENCE_LENGHT];
+extern const lcd_init_stream_t sh8501_init;
 #define SH8501_WIDTH                            368
 #define SH8501_HEIGHT                           194
 
 
-#define RM67162_INIT_SEQUENCE_LENGHT             6
+#define RM67162_INIT_SEQUENCE_LENGHT             7
 extern const lcd_cmd_t rm67162_cmd[RM67162_INIT_SEQUENCE_LENGHT];
+extern const lcd_init_stream_t rm67162_init;
 #define RM67162_WIDTH                           240
 #define RM67162_HEIGHT                          536
 #define RM67162_MADCTL_MY                       0x80
@@ -38,6 +54,7 @@ extern const lcd_cmd_t rm67162_cmd[RM67162_INIT_SEQUENCE_LENGHT];
 
 #define RM690B0_INIT_SEQUENCE_LENGHT             13
 extern const lcd_cmd_t rm690b0_cmd[RM690B0_INIT_SEQUENCE_LENGHT];
+extern const lcd_init_stream_t rm690b0_init;
 #define RM690B0_WIDTH                            600
 #define RM690B0_HEIGHT                           450
 #define RM690B0_MADCTL_MY                       0x80
@@ -26,8 +26,9 @@
 /*Color depth: 1 (1 byte per pixel), 8 (RGB332), 16 (RGB565), 32 (ARGB8888)*/
 #define LV_COLOR_DEPTH 16
 
-/*Swap the 2 bytes of RGB565 color. Useful if the display has an 8-bit interface (e.g. SPI)*/
-#define LV_COLOR_16_SWAP 1
+/*Swap the 2 bytes of RGB565 color. Useful if the display has an 8-bit interface (e.g. SPI)
+ *Not needed with LV_Helper: the display swaps while it copies or rotates the flushed pixels*/
+#define LV_COLOR_16_SWAP 0
 
 /*Enable features to draw on transparent background.
  *It's required if opa, and transform_* style properties are used.
@@ -60,10 +61,11 @@
 #endif
 
 #else       /*LV_MEM_CUSTOM*/
-#define LV_MEM_CUSTOM_INCLUDE <esp32-hal-psram.h>   /*Header for the dynamic memory function*/
-#define LV_MEM_CUSTOM_ALLOC   ps_malloc
-#define LV_MEM_CUSTOM_FREE    free
-#define LV_MEM_CUSTOM_REALLOC ps_realloc
+/*Small blocks from an internal SRAM pool, the rest from PSRAM; see lvglAlloc.h*/
+#define LV_MEM_CUSTOM_INCLUDE "lvglAlloc.h"   /*Header for the dynamic memory function*/
+#define LV_MEM_CUSTOM_ALLOC   lvglAlloc
+#define LV_MEM_CUSTOM_FREE    lvglFree
+#define LV_MEM_CUSTOM_REALLOC lvglRealloc
 #endif     /*LV_MEM_CUSTOM*/
 
 /*Number of the intermediate memory buffer used during rendering and other internal processing mechanisms.
@@ -83,6 +85,11 @@
 /*Input device read period in milliseconds*/
 #define LV_INDEV_DEF_READ_PERIOD 30     /*[ms]*/
 
+/*Allow splitting the redrawn areas into horizontal bands drawn by several threads at once.
+ *See `lv_refr_set_bands()`. The drawing code then keeps its scratch per thread.
+ *Only the LVGL under libdeps/ has it; other copies ignore it and draw on one thread.*/
+#define LV_USE_REFR_BANDS 0
+
 /*Use a custom tick source that tells the elapsed time in milliseconds.
  *It removes the need to manually update the tick with `lv_tick_inc()`)*/
 #define LV_TICK_CUSTOM 1
@@ -140,7 +147,8 @@
  *If only the built-in image formats are used there is no real advantage of caching. (I.e. if no new image decoder is added)
  *With complex image decoders (e.g. PNG or JPG) caching can save the continuous open/decode of images.
  *However the opened images might consume additional RAM.
- *0: to disable caching*/
+ *0: to disable caching
+ *Left at 0 with LV_Helper: lvglImageCache.h keeps decoded images by bytes instead*/
 #define LV_IMG_CACHE_DEF_SIZE 0
 
 /*Number of stops allowed per gradient. Increase this to allow more stops.
@@ -0,0 +1,222 @@
+/**
+ * @file      lvglAlloc.c
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include "lvglAlloc.h"
+#include "lvglLock.h"
+#include <lvgl.h>
+#include <string.h>
+
+#if LV_MEM_CUSTOM
+
+#ifdef ARDUINO
+#include <esp32-hal-psram.h>
+#include <esp_heap_caps.h>
+#define allocated_size(ptr)     heap_caps_get_allocated_size(ptr)
+#else
+// Off-target builds have one kind of memory
+#include <stdlib.h>
+#include <malloc.h>
+#define ps_malloc(size)                 malloc(size)
+#define ps_realloc(ptr, size)           realloc(ptr, size)
+#define heap_caps_malloc(size, caps)    malloc(size)
+#define allocated_size(ptr)             malloc_usable_size(ptr)
+#endif
+
+// LVGL builds its TLSF only when it manages memory itself
+// (LV_MEM_CUSTOM 0), so with LV_MEM_CUSTOM 1 it is compiled here instead,
+// sized for the pool.
+#undef LV_MEM_CUSTOM
+#define LV_MEM_CUSTOM   0
+#undef LV_MEM_SIZE
+#define LV_MEM_SIZE     LVGL_ALLOC_POOL_SIZE
+#include "src/misc/lv_tlsf.c"
+#undef LV_MEM_SIZE
+#undef LV_MEM_CUSTOM
+#define LV_MEM_CUSTOM   1
+
+static uint8_t *pool = NULL;
+static lv_tlsf_t tlsf = NULL;
+static bool pool_tried = false;
+// Per thread when LVGL draws in bands, so each band puts back its own
+static LVGL_THREAD_LOCAL LvglAllocHint alloc_hint = LVGL_ALLOC_AUTO;
+static LvglAllocStats stats;
+// Around the pool and the statistics; the system heap has its own
+static LvglSpinlock lock = LVGL_SPINLOCK_INIT;
+
+static void pool_init(void)
+{
+    pool_tried = true;
+    if (LVGL_ALLOC_POOL_SIZE == 0) {
+        return;
+    }
+    pool = (uint8_t *)heap_caps_malloc(LVGL_ALLOC_POOL_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (pool) {
+        tlsf = lv_tlsf_create_with_pool(pool, LVGL_ALLOC_POOL_SIZE);
+        stats.poolSize = LVGL_ALLOC_POOL_SIZE;
+    }
+}
+
+static bool in_pool(const void *ptr)
+{
+    return pool && (const uint8_t *)ptr >= pool && (const uint8_t *)ptr < pool + LVGL_ALLOC_POOL_SIZE;
+}
+
+static bool wants_pool(size_t size)
+{
+    return tlsf && (alloc_hint == LVGL_ALLOC_INTERNAL || (alloc_hint == LVGL_ALLOC_AUTO && size <= LVGL_ALLOC_SMALL_MAX));
+}
+
+static void pool_used(size_t add, size_t sub)
+{
+    stats.poolUsed += add - sub;
+    if (stats.poolUsed > stats.poolPeak) {
+        stats.poolPeak = stats.poolUsed;
+    }
+}
+
+static void psram_used(size_t add, size_t sub)
+{
+    stats.psramUsed += add - sub;
+    if (stats.psramUsed > stats.psramPeak) {
+        stats.psramPeak = stats.psramUsed;
+    }
+}
+
+static void *psram_alloc(size_t size)
+{
+    void *ptr = ps_malloc(size);
+    size_t got = ptr ? allocated_size(ptr) : 0;
+    lvglSpinlockTake(&lock);
+    if (ptr) {
+        stats.psramAllocs++;
+        psram_used(got, 0);
+    } else {
+        stats.failures++;
+    }
+    lvglSpinlockGive(&lock);
+    return ptr;
+}
+
+void *lvglAlloc(size_t size)
+{
+    if (!pool_tried) {
+        pool_init();
+    }
+    if (wants_pool(size)) {
+        lvglSpinlockTake(&lock);
+        void *ptr = lv_tlsf_malloc(tlsf, size);
+        if (ptr) {
+            stats.poolAllocs++;
+            pool_used(lv_tlsf_block_size(ptr), 0);
+        } else {
+            stats.fallbacks++;
+        }
+        lvglSpinlockGive(&lock);
+        if (ptr) {
+            return ptr;
+        }
+    }
+    return psram_alloc(size);
+}
+
+void lvglFree(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    if (in_pool(ptr)) {
+        lvglSpinlockTake(&lock);
+        pool_used(0, lv_tlsf_block_size(ptr));
+        lv_tlsf_free(tlsf, ptr);
+        lvglSpinlockGive(&lock);
+    } else {
+        size_t size = allocated_size(ptr);
+        lvglSpinlockTake(&lock);
+        psram_used(0, size);
+        lvglSpinlockGive(&lock);
+        free(ptr);
+    }
+}
+
+// A block stays in its tier while it fits there; one that outgrows the
+// pool moves to PSRAM.
+void *lvglRealloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return lvglAlloc(size);
+    }
+    if (in_pool(ptr)) {
+        lvglSpinlockTake(&lock);
+        size_t old = lv_tlsf_block_size(ptr);
+        if (wants_pool(size)) {
+            void *moved = lv_tlsf_realloc(tlsf, ptr, size);
+            if (moved) {
+                pool_used(lv_tlsf_block_size(moved), old);
+                lvglSpinlockGive(&lock);
+                return moved;
+            }
+            stats.fallbacks++;
+        }
+        lvglSpinlockGive(&lock);
+        void *moved = psram_alloc(size);
+        if (moved) {
+            memcpy(moved, ptr, old < size ? old : size);
+            lvglFree(ptr);
+        }
+        return moved;
+    }
+    size_t old = allocated_size(ptr);
+    void *moved = ps_realloc(ptr, size);
+    size_t got = moved ? allocated_size(moved) : 0;
+    lvglSpinlockTake(&lock);
+    if (moved) {
+        psram_used(got, old);
+    } else {
+        stats.failures++;
+    }
+    lvglSpinlockGive(&lock);
+    return moved;
+}
+
+LvglAllocHint lvglAllocSetHint(LvglAllocHint hint)
+{
+    LvglAllocHint previous = alloc_hint;
+    alloc_hint = hint;
+    return previous;
+}
+
+static void count_free(void *ptr, size_t size, int used, void *user)
+{
+    LvglAllocStats *s = (LvglAllocStats *)user;
+    (void)ptr;
+    if (!used) {
+        s->poolFree += size;
+        s->poolFreeBlocks++;
+        if (size > s->poolLargestFree) {
+            s->poolLargestFree = size;
+        }
+    }
+}
+
+void lvglAllocGetStats(LvglAllocStats *out)
+{
+    lvglSpinlockTake(&lock);
+    *out = stats;
+    out->poolFree = 0;
+    out->poolLargestFree = 0;
+    out->poolFreeBlocks = 0;
+    out->poolFragmentation = 0;
+    if (tlsf) {
+        lv_tlsf_walk_pool(lv_tlsf_get_pool(tlsf), count_free, out);
+    }
+    lvglSpinlockGive(&lock);
+    if (out->poolFree) {
+        out->poolFragmentation = 100 - (uint64_t)out->poolLargestFree * 100 / out->poolFree;
+    }
+}
+
+#endif /* LV_MEM_CUSTOM */
@@ -0,0 +1,70 @@
+/**
+ * @file      lvglAlloc.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LVGL's allocator (LV_MEM_CUSTOM_ALLOC and friends in lv_conf.h). Small
+// blocks, which are most of them and the most often touched (objects,
+// styles, timers, animations, list nodes, draw scratch buffers), come from
+// a TLSF pool in internal SRAM. Larger ones, and small ones once the pool
+// is full, come from PSRAM as before.
+
+// Internal SRAM set aside for the pool, taken on the first allocation.
+// 0 puts everything in PSRAM, e.g. to compare render times.
+#ifndef LVGL_ALLOC_POOL_SIZE
+#define LVGL_ALLOC_POOL_SIZE    (32 * 1024)
+#endif
+
+// Largest block that goes to the pool without a hint
+#ifndef LVGL_ALLOC_SMALL_MAX
+#define LVGL_ALLOC_SMALL_MAX    2048
+#endif
+
+typedef enum {
+    LVGL_ALLOC_AUTO,        // by size
+    LVGL_ALLOC_INTERNAL,    // pool whenever it has room
+    LVGL_ALLOC_PSRAM,       // never the pool
+} LvglAllocHint;
+
+typedef struct {
+    uint32_t poolSize;
+    uint32_t poolUsed;          // bytes in blocks handed out
+    uint32_t poolPeak;
+    uint32_t poolFree;
+    uint32_t poolLargestFree;
+    uint32_t poolFreeBlocks;
+    uint8_t poolFragmentation;  // percent of free space outside the largest free block
+    uint32_t psramUsed;
+    uint32_t psramPeak;
+    uint32_t poolAllocs;
+    uint32_t psramAllocs;
+    uint32_t fallbacks;         // meant for the pool but it was full
+    uint32_t failures;
+} LvglAllocStats;
+
+void *lvglAlloc(size_t size);
+void *lvglRealloc(void *ptr, size_t size);
+void lvglFree(void *ptr);
+
+// Steers the allocations that follow, e.g. LVGL_ALLOC_PSRAM around
+// creating a large image or LVGL_ALLOC_INTERNAL around a hot widget.
+// Returns the previous hint so it can be put back. Each thread drawing
+// bands (lvglBands.h) has its own.
+LvglAllocHint lvglAllocSetHint(LvglAllocHint hint);
+
+void lvglAllocGetStats(LvglAllocStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file      lvglBands.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include <string.h>
+#include "lvglBands.h"
+#include "lvglLock.h"
+
+#if LVGL_REFR_BANDS
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/semphr.h>
+#else
+// Off-target the workers are threads, e.g. to measure the speedup with
+// LilyGo_HostDisplay
+#include <chrono>
+#include <pthread.h>
+#include <semaphore.h>
+static uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+struct BandWorker {
+    lv_draw_ctx_t *ctx;     // band to draw next
+#ifdef ARDUINO
+    TaskHandle_t task;
+#else
+    pthread_t thread;
+    sem_t start;
+#endif
+};
+
+static BandWorker workers[LV_MAX(LVGL_BANDS_MAX - 1, 1)];
+static uint32_t worker_cnt = 0;
+static uint32_t band_cnt = 1;
+static void (*draw_band)(lv_draw_ctx_t *draw_ctx);
+static volatile bool worker_ready;
+static LvglBandsStats stats;
+
+// Given by each worker when its band is drawn, and once as it starts
+#ifdef ARDUINO
+static StaticSemaphore_t done_storage;
+static SemaphoreHandle_t done = NULL;
+
+static void wake(BandWorker *w)
+{
+    xTaskNotifyGive(w->task);
+}
+static void park(BandWorker *w)
+{
+    (void)w;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+static void giveDone()
+{
+    xSemaphoreGive(done);
+}
+static void takeDone()
+{
+    xSemaphoreTake(done, portMAX_DELAY);
+}
+#else
+static sem_t done;
+
+static void wake(BandWorker *w)
+{
+    sem_post(&w->start);
+}
+static void park(BandWorker *w)
+{
+    while (sem_wait(&w->start) != 0) {
+    }
+}
+static void giveDone()
+{
+    sem_post(&done);
+}
+static void takeDone()
+{
+    while (sem_wait(&done) != 0) {
+    }
+}
+#endif
+
+static void worker_loop(BandWorker *w)
+{
+    // Its own masks and scratch buffers, LVGL's being for its own thread
+    bool ready = lv_refr_band_thread_init() == LV_RES_OK;
+    worker_ready = ready;
+    giveDone();
+    if (!ready) {
+        return;
+    }
+    for (;;) {
+        park(w);
+        draw_band(w->ctx);
+        giveDone();
+    }
+}
+
+#ifdef ARDUINO
+static void worker_task(void *arg)
+{
+    worker_loop(static_cast<BandWorker *>(arg));
+    vTaskDelete(NULL);
+}
+#else
+static void *worker_thread(void *arg)
+{
+    worker_loop(static_cast<BandWorker *>(arg));
+    return NULL;
+}
+#endif
+
+static bool startWorker(BandWorker *w, uint32_t index)
+{
+    memset(w, 0, sizeof(*w));
+#ifdef ARDUINO
+    if (!done) {
+        done = xSemaphoreCreateCountingStatic(LVGL_BANDS_MAX, 0, &done_storage);
+    }
+    // One per core other than LVGL's
+    BaseType_t core = (xPortGetCoreID() + 1 + index) % portNUM_PROCESSORS;
+    if (xTaskCreatePinnedToCore(worker_task, "lvglBand", LVGL_BANDS_TASK_STACK, w,
+                                LVGL_BANDS_TASK_PRIORITY, &w->task, core) != pdPASS) {
+        return false;
+    }
+#else
+    static bool done_init = false;
+    if (!done_init) {
+        sem_init(&done, 0, 0);
+        done_init = true;
+    }
+    (void)index;
+    sem_init(&w->start, 0, 0);
+    if (pthread_create(&w->thread, NULL, worker_thread, w) != 0) {
+        sem_destroy(&w->start);
+        return false;
+    }
+    pthread_detach(w->thread);
+#endif
+    takeDone();
+    if (!worker_ready) {
+        LV_LOG_WARN("Bands: not enough memory for another band");
+    }
+    return worker_ready;
+}
+
+// LVGL's thread draws the first band and waits for the rest before the
+// part is flushed
+static void run(void (*band_cb)(lv_draw_ctx_t *draw_ctx), lv_draw_ctx_t *draw_ctxs[], uint32_t cnt)
+{
+    draw_band = band_cb;
+    for (uint32_t i = 1; i < cnt; i++) {
+        workers[i - 1].ctx = draw_ctxs[i];
+        wake(&workers[i - 1]);
+    }
+    band_cb(draw_ctxs[0]);
+    uint32_t start = micros();
+    for (uint32_t i = 1; i < cnt; i++) {
+        takeDone();
+    }
+    stats.waitUs += micros() - start;
+    stats.parts++;
+}
+
+uint32_t lvglBandsSet(uint32_t bands)
+{
+    bands = LV_MAX(1u, LV_MIN(bands, (uint32_t)LVGL_BANDS_MAX));
+    while (worker_cnt + 1 < bands && startWorker(&workers[worker_cnt], worker_cnt)) {
+        worker_cnt++;
+    }
+    band_cnt = LV_MIN(bands, worker_cnt + 1);
+    lv_refr_set_bands(band_cnt, band_cnt > 1 ? run : NULL);
+    return band_cnt;
+}
+
+uint32_t lvglBandsGet()
+{
+    return band_cnt;
+}
+
+LvglBandsStats lvglBandsGetStats()
+{
+    return stats;
+}
+
+void lvglBandsResetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+#else
+
+uint32_t lvglBandsSet(uint32_t bands)
+{
+    (void)bands;
+    return 1;
+}
+
+uint32_t lvglBandsGet()
+{
+    return 1;
+}
+
+LvglBandsStats lvglBandsGetStats()
+{
+    LvglBandsStats stats;
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+}
+
+void lvglBandsResetStats()
+{
+}
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file      lvglBands.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <lvgl.h>
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#endif
+
+// Draws every part of the screen LVGL refreshes in horizontal bands at
+// once: LVGL's own thread draws the top one and a worker per other core
+// the rest, each into its own rows of the draw buffer, and the part is
+// flushed once all of them are done. Needs LV_USE_REFR_BANDS in lv_conf.h
+// and the LVGL under libdeps/; otherwise everything is drawn in one band.
+//
+// Objects in several bands are drawn by each of them, clipped to its
+// rows, so draw event handlers can run on two cores at the same time.
+// The ones that only change the descriptor they are given are fine; ones
+// that touch shared state are not.
+
+// Most bands, LVGL's thread included
+#ifndef LVGL_BANDS_MAX
+#ifdef ARDUINO
+#define LVGL_BANDS_MAX              portNUM_PROCESSORS
+#else
+#define LVGL_BANDS_MAX              4
+#endif
+#endif
+
+// Bytes of stack for each worker, as much as loop() gets
+#ifndef LVGL_BANDS_TASK_STACK
+#define LVGL_BANDS_TASK_STACK       8192
+#endif
+
+// Above loop() and the touch task, so a band is not left waiting behind
+// them while LVGL's thread waits for it; Wi-Fi stays above
+#ifndef LVGL_BANDS_TASK_PRIORITY
+#define LVGL_BANDS_TASK_PRIORITY    3
+#endif
+
+struct LvglBandsStats {
+    uint32_t parts;         // drawn in bands
+    uint64_t waitUs;        // LVGL's thread spent waiting for the other bands
+};
+
+// Splits the parts into `bands`, starting the workers that are missing;
+// 1 draws them as before. Call from LVGL's thread, between refreshes.
+// Returns how many bands are used, fewer if workers could not start.
+uint32_t lvglBandsSet(uint32_t bands);
+uint32_t lvglBandsGet();
+
+LvglBandsStats lvglBandsGetStats();
+void lvglBandsResetStats();
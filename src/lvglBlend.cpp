@@ -0,0 +1,549 @@
+/**
+ * @file      lvglBlend.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdlib.h>
+#include <chrono>
+static uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+#include <string.h>
+#include "lvglBlend.h"
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_MIX_ROUND_OFS == 0
+
+// lv_color_mix() on 16-bit colour: both colours spread over a word with
+// room for the products, mixed with opa reduced to 0..32. Each channel
+// comes out as bg + floor((fg - bg) * level / 32) on its own, so a result
+// depends only on the two colours and the level.
+#define SPREAD_MASK 0x07E0F81FU
+
+static inline uint16_t native(uint16_t c)
+{
+#if LV_COLOR_16_SWAP
+    return (uint16_t)((c >> 8) | (c << 8));
+#else
+    return c;
+#endif
+}
+
+static inline uint32_t spread(uint16_t c)
+{
+    uint32_t n = native(c);
+    return (n | (n << 16)) & SPREAD_MASK;
+}
+
+static inline uint16_t mix(uint32_t fg, uint32_t bg, uint32_t level)
+{
+    uint32_t r = ((((fg - bg) * level) >> 5) + bg) & SPREAD_MASK;
+    return native((uint16_t)((r >> 16) | r));
+}
+
+static inline uint32_t level(uint32_t opa)
+{
+    return (opa + 4) >> 3;
+}
+
+static inline bool aligned(const void *p)
+{
+    return ((uintptr_t)p & 3) == 0;
+}
+
+// How a mask byte becomes the opa handed to lv_color_mix(), per path of
+// lv_draw_sw_blend.c
+enum MaskMode {
+    MASK_NONE,      // opa throughout
+    MASK_ONLY,      // the mask byte
+    MASK_OPA,       // 255 gives opa, else mask * opa >> 8
+    MASK_OPA_MAX,   // LV_OPA_MAX and up give opa, else mask * opa >> 8
+};
+
+template <int Mode>
+static inline uint32_t maskOpa(uint32_t m, uint32_t opa)
+{
+    if (Mode == MASK_NONE) {
+        return opa;
+    } else if (Mode == MASK_ONLY) {
+        return m;
+    } else if (Mode == MASK_OPA) {
+        return m == LV_OPA_COVER ? opa : (m * opa) >> 8;
+    }
+    return m >= LV_OPA_MAX ? opa : (m * opa) >> 8;
+}
+
+// Foreground of lv_draw_sw_blend.c's blend modes for one background, on
+// unswapped 565. With LV_COLOR_16_SWAP its green is reproduced as it comes
+// out there, quirks included.
+static uint16_t blendMode(uint16_t fg, uint16_t bg, lv_blend_mode_t mode)
+{
+    int32_t r = fg >> 11, g = (fg >> 5) & 0x3F, b = fg & 0x1F;
+    int32_t br = bg >> 11, bgr = (bg >> 5) & 0x3F, bb = bg & 0x1F;
+    switch (mode) {
+    case LV_BLEND_MODE_ADDITIVE:
+        r = LV_MIN(br + r, 31);
+        g = LV_MIN(bgr + g, 63);
+        b = LV_MIN(bb + b, 31);
+        break;
+    case LV_BLEND_MODE_SUBTRACTIVE:
+        r = LV_MAX(br - r, 0);
+#if LV_COLOR_16_SWAP
+        g = (bgr + g) & 0x3F;
+#else
+        g = LV_MAX(bgr - g, 0);
+#endif
+        b = LV_MAX(bb - b, 0);
+        break;
+    default:
+        r = (r * br) >> 5;
+#if LV_COLOR_16_SWAP
+        // LV_COLOR_SET_G() evaluates the product again for the low bits,
+        // after the high bits have changed
+        g = (((g * bgr) >> 6) & 0x38) | (((((g * bgr) >> 9) << 3 | (g & 7)) * bgr >> 6) & 7);
+#else
+        g = (g * bgr) >> 6;
+#endif
+        b = (b * bb) >> 5;
+        break;
+    }
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// The last destination colour with the two sides of lv_color_mix() for it
+struct LastDest {
+    uint16_t dest;
+    uint32_t bg;
+    uint32_t fg;
+
+    void reset(uint16_t d, uint32_t f)
+    {
+        dest = d;
+        bg = spread(d);
+        fg = f;
+    }
+};
+
+// Fills with a constant colour, or with a blend mode, whose foreground then
+// depends on the destination and is worked out once per run of one colour.
+template <int Mode, bool Blended>
+static void LV_ATTRIBUTE_FAST_MEM fillMixed(uint16_t *dst, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                                             uint16_t color, lv_opa_t opa, const lv_opa_t *mask,
+                                             lv_coord_t maskStride, lv_blend_mode_t mode)
+{
+    const uint32_t fg = spread(color);
+    const uint16_t fgNative = native(color);
+    LastDest cache;
+    cache.reset(dst[0], Blended ? spread(native(blendMode(fgNative, native(dst[0]), mode))) : fg);
+
+#define FILL_PX(i)                                                                              \
+    do {                                                                                        \
+        uint32_t m = Mode == MASK_NONE ? (lv_opa_t)LV_OPA_COVER : mask[i];                      \
+        if (Mode == MASK_ONLY && !Blended && m == LV_OPA_COVER) {                               \
+            dst[i] = color;                                                                     \
+        } else if (m) {                                                                         \
+            uint16_t d = dst[i];                                                                \
+            if (d != cache.dest) {                                                              \
+                cache.reset(d, Blended ? spread(native(blendMode(fgNative, native(d), mode))) : fg); \
+            }                                                                                   \
+            dst[i] = mix(cache.fg, cache.bg, level(maskOpa<Mode>(m, opa)));                     \
+        }                                                                                       \
+    } while (0)
+
+    for (lv_coord_t y = 0; y < h; y++) {
+        lv_coord_t x = 0;
+        if (Mode != MASK_NONE) {
+            // Four mask bytes at a time skip runs outside a shape and fill
+            // runs inside it
+            for (; x < w && !aligned(mask + x); x++) {
+                FILL_PX(x);
+            }
+            for (; x + 4 <= w; x += 4) {
+                uint32_t m4 = *(const uint32_t *)(mask + x);
+                if (m4 == 0) {
+                    continue;
+                }
+                if (Mode == MASK_ONLY && !Blended && m4 == 0xFFFFFFFF) {
+                    dst[x] = dst[x + 1] = dst[x + 2] = dst[x + 3] = color;
+                    continue;
+                }
+                FILL_PX(x);
+                FILL_PX(x + 1);
+                FILL_PX(x + 2);
+                FILL_PX(x + 3);
+            }
+        }
+        for (; x < w; x++) {
+            FILL_PX(x);
+        }
+        dst += dstStride;
+        if (Mode != MASK_NONE) {
+            mask += maskStride;
+        }
+    }
+#undef FILL_PX
+}
+
+// fill_normal() without a mask mixes with lv_color_mix_premult(), whose
+// rounding differs, and starts from a result for black made by
+// lv_color_mix(). Both are reproduced, the second through the same
+// last-colour cache. Large areas look channels up in tables.
+static void LV_ATTRIBUTE_FAST_MEM fillOpa(lv_color_t *dstColor, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                                          lv_color_t color, lv_opa_t opa, const lv_opa_t *, lv_coord_t)
+{
+    uint16_t *dst = (uint16_t *)dstColor;
+    uint16_t lastDest = lv_color_black().full;
+    uint16_t lastResult = mix(spread(color.full), spread(lastDest), level(opa));
+
+    // As there: opa is rounded to the levels lv_color_mix() uses, in an
+    // lv_opa_t, so 252 wraps to 0
+    lv_opa_t q = (lv_opa_t)(level(opa) << 3);
+    lv_opa_t inv = 255 - q;
+    uint16_t c = native(color.full);
+    uint32_t pr = (c >> 11) * q, pg = ((c >> 5) & 0x3F) * q, pb = (c & 0x1F) * q;
+
+    bool tables = (uint32_t)w * h >= 256;
+    uint16_t lutR[32], lutG[64], lutB[32];
+    if (tables) {
+        for (uint32_t i = 0; i < 32; i++) {
+            lutR[i] = LV_UDIV255(pr + i * inv) << 11;
+            lutB[i] = LV_UDIV255(pb + i * inv);
+        }
+        for (uint32_t i = 0; i < 64; i++) {
+            lutG[i] = LV_UDIV255(pg + i * inv) << 5;
+        }
+    }
+
+    for (lv_coord_t y = 0; y < h; y++) {
+        for (lv_coord_t x = 0; x < w; x++) {
+            uint16_t d = dst[x];
+            if (d != lastDest) {
+                lastDest = d;
+                uint16_t n = native(d);
+                uint32_t r = n >> 11, g = (n >> 5) & 0x3F, b = n & 0x1F;
+                if (tables) {
+                    lastResult = native(lutR[r] | lutG[g] | lutB[b]);
+                } else {
+                    lastResult = native((uint16_t)((LV_UDIV255(pr + r * inv) << 11) |
+                                                   (LV_UDIV255(pg + g * inv) << 5) | LV_UDIV255(pb + b * inv)));
+                }
+            }
+            dst[x] = lastResult;
+        }
+        dst += dstStride;
+    }
+}
+
+static void fillMask(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                     lv_color_t color, lv_opa_t opa, const lv_opa_t *mask, lv_coord_t maskStride)
+{
+    if (opa >= LV_OPA_MAX) {
+        fillMixed<MASK_ONLY, false>((uint16_t *)dst, dstStride, w, h, color.full, opa, mask, maskStride,
+                                     LV_BLEND_MODE_NORMAL);
+    } else {
+        fillMixed<MASK_OPA, false>((uint16_t *)dst, dstStride, w, h, color.full, opa, mask, maskStride,
+                                    LV_BLEND_MODE_NORMAL);
+    }
+}
+
+static void fillBlended(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                        lv_color_t color, lv_opa_t opa, const lv_opa_t *mask, lv_coord_t maskStride,
+                        lv_blend_mode_t mode)
+{
+    if (mask) {
+        fillMixed<MASK_OPA_MAX, true>((uint16_t *)dst, dstStride, w, h, color.full, opa, mask, maskStride, mode);
+    } else {
+        fillMixed<MASK_NONE, true>((uint16_t *)dst, dstStride, w, h, color.full, opa, NULL, 0, mode);
+    }
+}
+
+template <int Mode>
+static void LV_ATTRIBUTE_FAST_MEM mapMixed(uint16_t *dst, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                                            const uint16_t *src, lv_coord_t srcStride, lv_opa_t opa,
+                                            const lv_opa_t *mask, lv_coord_t maskStride)
+{
+    const uint32_t opaLevel = level(opa);
+
+#define MAP_PX(i)                                                                               \
+    do {                                                                                        \
+        uint32_t m = mask[i];                                                                   \
+        if (Mode == MASK_ONLY && m == LV_OPA_COVER) {                                           \
+            dst[i] = src[i];                                                                    \
+        } else if (m) {                                                                         \
+            dst[i] = mix(spread(src[i]), spread(dst[i]), level(maskOpa<Mode>(m, opa)));         \
+        }                                                                                       \
+    } while (0)
+
+    for (lv_coord_t y = 0; y < h; y++) {
+        lv_coord_t x = 0;
+        if (Mode == MASK_NONE) {
+            for (; x < w; x++) {
+                dst[x] = mix(spread(src[x]), spread(dst[x]), opaLevel);
+            }
+        } else {
+            for (; x < w && !aligned(mask + x); x++) {
+                MAP_PX(x);
+            }
+            for (; x + 4 <= w; x += 4) {
+                uint32_t m4 = *(const uint32_t *)(mask + x);
+                if (m4 == 0) {
+                    continue;
+                }
+                if (Mode == MASK_ONLY && m4 == 0xFFFFFFFF) {
+                    memcpy(dst + x, src + x, 4 * sizeof(uint16_t));
+                    continue;
+                }
+                MAP_PX(x);
+                MAP_PX(x + 1);
+                MAP_PX(x + 2);
+                MAP_PX(x + 3);
+            }
+            for (; x < w; x++) {
+                MAP_PX(x);
+            }
+            mask += maskStride;
+        }
+        dst += dstStride;
+        src += srcStride;
+    }
+#undef MAP_PX
+}
+
+static void mapOpa(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                   const lv_color_t *src, lv_coord_t srcStride, lv_opa_t opa, const lv_opa_t *, lv_coord_t)
+{
+    mapMixed<MASK_NONE>((uint16_t *)dst, dstStride, w, h, (const uint16_t *)src, srcStride, opa, NULL, 0);
+}
+
+// map_normal() takes the mask alone only above LV_OPA_MAX
+static void mapMask(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t w, lv_coord_t h,
+                    const lv_color_t *src, lv_coord_t srcStride, lv_opa_t opa,
+                    const lv_opa_t *mask, lv_coord_t maskStride)
+{
+    if (opa > LV_OPA_MAX) {
+        mapMixed<MASK_ONLY>((uint16_t *)dst, dstStride, w, h, (const uint16_t *)src, srcStride, opa,
+                             mask, maskStride);
+    } else {
+        mapMixed<MASK_OPA_MAX>((uint16_t *)dst, dstStride, w, h, (const uint16_t *)src, srcStride, opa,
+                                mask, maskStride);
+    }
+}
+
+const LvglBlendBackend lvglBlendPortable = {
+    "portable",
+    fillOpa,
+    fillMask,
+    mapOpa,
+    mapMask,
+#if LV_DRAW_COMPLEX
+    fillBlended,
+#else
+    NULL,
+#endif
+};
+
+static const LvglBlendBackend *backend = LVGL_BLEND_BACKEND ? &lvglBlendPortable : NULL;
+
+#else
+
+const LvglBlendBackend lvglBlendPortable = {"portable", NULL, NULL, NULL, NULL, NULL};
+
+static const LvglBlendBackend *backend = NULL;
+
+#endif
+
+// lv_draw_sw_blend_basic() up to the point where it picks a path, for the
+// paths a backend takes
+static void LV_ATTRIBUTE_FAST_MEM blend(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc)
+{
+    const LvglBlendBackend *b = backend;
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    if (!b || disp->driver->set_px_cb || disp->driver->screen_transp) {
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+    if (dsc->mask_buf && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP) {
+        return;
+    }
+    lv_opa_t *mask = dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER ? NULL : dsc->mask_buf;
+
+    LvglBlendFill fill = NULL;
+    LvglBlendMap map = NULL;
+    LvglBlendFillMode fillMode = NULL;
+    if (dsc->blend_mode == LV_BLEND_MODE_NORMAL) {
+        if (dsc->src_buf == NULL) {
+            if (mask) {
+                fill = b->fillMask;
+            } else if (dsc->opa < LV_OPA_MAX) {
+                fill = b->fillOpa;
+            }
+        } else {
+            if (mask) {
+                map = b->mapMask;
+            } else if (dsc->opa < LV_OPA_MAX) {
+                map = b->mapOpa;
+            }
+        }
+    } else if (dsc->src_buf == NULL && (dsc->blend_mode == LV_BLEND_MODE_ADDITIVE ||
+                                        dsc->blend_mode == LV_BLEND_MODE_SUBTRACTIVE ||
+                                        dsc->blend_mode == LV_BLEND_MODE_MULTIPLY)) {
+        fillMode = b->fillBlended;
+    }
+    if (!fill && !map && !fillMode) {
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area)) {
+        return;
+    }
+
+    lv_coord_t dest_stride = lv_area_get_width(draw_ctx->buf_area);
+    lv_color_t *dest_buf = (lv_color_t *)draw_ctx->buf;
+    dest_buf += dest_stride * (blend_area.y1 - draw_ctx->buf_area->y1) + (blend_area.x1 - draw_ctx->buf_area->x1);
+
+    const lv_color_t *src_buf = dsc->src_buf;
+    lv_coord_t src_stride = 0;
+    if (src_buf) {
+        src_stride = lv_area_get_width(dsc->blend_area);
+        src_buf += src_stride * (blend_area.y1 - dsc->blend_area->y1) + (blend_area.x1 - dsc->blend_area->x1);
+    }
+
+    lv_coord_t mask_stride = 0;
+    if (mask) {
+        if (disp->driver->antialiasing == 0) {
+            int32_t mask_size = lv_area_get_size(dsc->mask_area);
+            for (int32_t i = 0; i < mask_size; i++) {
+                mask[i] = mask[i] > 128 ? LV_OPA_COVER : LV_OPA_TRANSP;
+            }
+        }
+        mask_stride = lv_area_get_width(dsc->mask_area);
+        mask += mask_stride * (blend_area.y1 - dsc->mask_area->y1) + (blend_area.x1 - dsc->mask_area->x1);
+    }
+
+    lv_coord_t w = lv_area_get_width(&blend_area);
+    lv_coord_t h = lv_area_get_height(&blend_area);
+    if (fill) {
+        fill(dest_buf, dest_stride, w, h, dsc->color, dsc->opa, mask, mask_stride);
+    } else if (map) {
+        map(dest_buf, dest_stride, w, h, src_buf, src_stride, dsc->opa, mask, mask_stride);
+    } else {
+        fillMode(dest_buf, dest_stride, w, h, dsc->color, dsc->opa, mask, mask_stride, dsc->blend_mode);
+    }
+}
+
+void lvglBlendInitCtx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+    ((lv_draw_sw_ctx_t *)draw_ctx)->blend = blend;
+}
+
+const LvglBlendBackend *lvglBlendSetBackend(const LvglBlendBackend *next)
+{
+    const LvglBlendBackend *previous = backend;
+    backend = next;
+    return previous;
+}
+
+const char *lvglBlendOpName(LvglBlendOp op)
+{
+    static const char *const names[LVGL_BLEND_OP_COUNT] = {
+        "fill opa", "fill mask", "map opa", "map mask", "fill additive",
+    };
+    return op < LVGL_BLEND_OP_COUNT ? names[op] : "?";
+}
+
+float lvglBlendMeasure(const LvglBlendBackend *with, LvglBlendOp op, uint16_t width, uint16_t height,
+                       uint32_t rounds)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+    uint32_t pixels = (uint32_t)width * height;
+    lv_color_t *dst = (lv_color_t *)lv_mem_alloc(pixels * sizeof(lv_color_t));
+    lv_color_t *background = (lv_color_t *)lv_mem_alloc(pixels * sizeof(lv_color_t));
+    lv_color_t *src = (lv_color_t *)lv_mem_alloc(pixels * sizeof(lv_color_t));
+    lv_opa_t *mask = (lv_opa_t *)lv_mem_alloc(pixels);
+    if (!disp || !dst || !background || !src || !mask) {
+        lv_mem_free(dst);
+        lv_mem_free(background);
+        lv_mem_free(src);
+        lv_mem_free(mask);
+        return 0;
+    }
+
+    // A quarter of the mask is transparent, a quarter opaque, the rest an
+    // edge; images are a gradient and the background plain 32-pixel blocks,
+    // as under most widgets
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < pixels; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t r = seed >> 16;
+        mask[i] = (i / 16) % 4 == 0 ? (lv_opa_t)LV_OPA_TRANSP : (i / 16) % 4 == 1 ? (lv_opa_t)LV_OPA_COVER : (lv_opa_t)r;
+        src[i] = lv_color_make((uint8_t)(i * 7), (uint8_t)(i / width), (uint8_t)r);
+        background[i] = lv_color_make((uint8_t)(i / width * 3), 0x40, (uint8_t)(i % width / 32 * 40));
+    }
+
+    lv_area_t area = {0, 0, (lv_coord_t)(width - 1), (lv_coord_t)(height - 1)};
+    lv_draw_sw_ctx_t ctx;
+    lv_memset_00(&ctx, sizeof(ctx));
+    ctx.base_draw.buf = dst;
+    ctx.base_draw.buf_area = &area;
+    ctx.base_draw.clip_area = &area;
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &area;
+    dsc.mask_area = &area;
+    dsc.color = lv_color_make(0x20, 0xA0, 0xE0);
+    dsc.opa = LV_OPA_COVER;
+    dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+    dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    switch (op) {
+    case LVGL_BLEND_OP_FILL_OPA:
+        dsc.opa = LV_OPA_60;
+        break;
+    case LVGL_BLEND_OP_FILL_MASK:
+        dsc.mask_buf = mask;
+        break;
+    case LVGL_BLEND_OP_MAP_OPA:
+        dsc.src_buf = src;
+        dsc.opa = LV_OPA_60;
+        break;
+    case LVGL_BLEND_OP_MAP_MASK:
+        dsc.src_buf = src;
+        dsc.mask_buf = mask;
+        break;
+    default:
+        dsc.mask_buf = mask;
+        dsc.blend_mode = LV_BLEND_MODE_ADDITIVE;
+        break;
+    }
+
+    const LvglBlendBackend *previous = lvglBlendSetBackend(with);
+    lv_disp_t *refreshing = _lv_refr_get_disp_refreshing();
+    _lv_refr_set_disp_refreshing(disp);
+    // Every round starts from the same background, as a widget is drawn
+    // over what is behind it
+    uint32_t elapsed = 0;
+    for (uint32_t i = 0; i < rounds; i++) {
+        lv_memcpy(dst, background, pixels * sizeof(lv_color_t));
+        uint32_t start = micros();
+        blend(&ctx.base_draw, &dsc);
+        elapsed += micros() - start;
+    }
+    _lv_refr_set_disp_refreshing(refreshing);
+    lvglBlendSetBackend(previous);
+
+    lv_mem_free(dst);
+    lv_mem_free(background);
+    lv_mem_free(src);
+    lv_mem_free(mask);
+    return elapsed ? (float)pixels * rounds / elapsed : 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file      lvglBlend.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <lvgl.h>
+#include "src/draw/sw/lv_draw_sw.h"
+
+// Kernels for the blends LVGL's software renderer spends its time in:
+// translucent and masked fills (rectangles, anti-aliased edges, text) and
+// translucent and masked copies (images). A backend gives the same result
+// as lv_draw_sw_blend_basic() to the bit, including its rounding; any
+// member left NULL, and every other case, goes to LVGL's code.
+
+// 1: the portable 32-bit kernels below, 0: LVGL's own blending
+#ifndef LVGL_BLEND_BACKEND
+#define LVGL_BLEND_BACKEND  1
+#endif
+
+// `dst`, `src` and `mask` point at the top-left pixel of the area; strides
+// are in pixels.
+typedef void (*LvglBlendFill)(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t width, lv_coord_t height,
+                              lv_color_t color, lv_opa_t opa, const lv_opa_t *mask, lv_coord_t maskStride);
+typedef void (*LvglBlendMap)(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t width, lv_coord_t height,
+                             const lv_color_t *src, lv_coord_t srcStride, lv_opa_t opa,
+                             const lv_opa_t *mask, lv_coord_t maskStride);
+typedef void (*LvglBlendFillMode)(lv_color_t *dst, lv_coord_t dstStride, lv_coord_t width, lv_coord_t height,
+                                  lv_color_t color, lv_opa_t opa, const lv_opa_t *mask, lv_coord_t maskStride,
+                                  lv_blend_mode_t mode);
+
+struct LvglBlendBackend {
+    const char *name;
+    LvglBlendFill fillOpa;          // no mask, opa below LV_OPA_MAX
+    LvglBlendFill fillMask;
+    LvglBlendMap mapOpa;            // no mask, opa below LV_OPA_MAX
+    LvglBlendMap mapMask;
+    LvglBlendFillMode fillBlended;  // additive, subtractive and multiply, with or without mask
+};
+
+// Plain C++ on 32-bit words: masks are read four bytes at a time to skip or
+// copy runs outside or inside a shape, a constant colour is unpacked once
+// per call rather than per pixel, and translucent fills look channels up in
+// tables. RGB565 only, swapped or not.
+extern const LvglBlendBackend lvglBlendPortable;
+
+// For lv_disp_drv_t::draw_ctx_init: LVGL's software context with blending
+// routed through the current backend.
+void lvglBlendInitCtx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx);
+
+// NULL goes back to LVGL's own blending. Returns the previous backend.
+const LvglBlendBackend *lvglBlendSetBackend(const LvglBlendBackend *backend);
+
+enum LvglBlendOp {
+    LVGL_BLEND_OP_FILL_OPA,
+    LVGL_BLEND_OP_FILL_MASK,
+    LVGL_BLEND_OP_MAP_OPA,
+    LVGL_BLEND_OP_MAP_MASK,
+    LVGL_BLEND_OP_FILL_ADDITIVE,
+    LVGL_BLEND_OP_COUNT,
+};
+
+const char *lvglBlendOpName(LvglBlendOp op);
+
+// Mpixel/s of `op` over a width x height area, blended through `backend`
+// (NULL: LVGL's code) `rounds` times. Masks and images are a fixed mix of
+// transparent, opaque and partial values. Needs a registered display.
+float lvglBlendMeasure(const LvglBlendBackend *backend, LvglBlendOp op, uint16_t width, uint16_t height,
+                       uint32_t rounds);
@@ -0,0 +1,352 @@
+/**
+ * @file      lvglGlyphCache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include <string.h>
+#include "lvglGlyphCache.h"
+#include "lvglAlloc.h"
+#include "lvglLock.h"
+#include "src/draw/sw/lv_draw_sw.h"
+
+// lv_draw_sw_letter.c's opacity of each shade
+extern "C" const uint8_t _lv_bpp1_opa_table[];
+extern "C" const uint8_t _lv_bpp2_opa_table[];
+extern "C" const uint8_t _lv_bpp4_opa_table[];
+extern "C" const uint8_t _lv_bpp8_opa_table[];
+
+// The mask follows the entry in the same block
+struct GlyphEntry {
+    const lv_font_t *font;
+    uint32_t letter;
+    uint32_t hash;
+    uint32_t bytes;
+    GlyphEntry *next;       // in its bucket
+    GlyphEntry *newer;      // in drawing order
+    GlyphEntry *older;
+    int16_t x, y;           // top-left of the box from where the letter is drawn
+    uint16_t width, height;
+    uint16_t users;         // bands drawing it, which keep it from being evicted
+};
+
+static GlyphEntry *buckets[LVGL_GLYPH_CACHE_BUCKETS];
+static GlyphEntry *newest = NULL;
+static GlyphEntry *oldest = NULL;
+static size_t budget = LVGL_GLYPH_CACHE_SIZE;
+static LvglGlyphCacheStats stats;
+// Held for lookups and list updates, not while unpacking or blending
+static LvglSpinlock lock = LVGL_SPINLOCK_INIT;
+
+static inline lv_opa_t *maskOf(GlyphEntry *e)
+{
+    return (lv_opa_t *)(e + 1);
+}
+
+static uint32_t hashGlyph(const lv_font_t *font, uint32_t letter)
+{
+    uint32_t h = (uint32_t)(uintptr_t)font ^ (letter * 0x9E3779B1u);
+    return h ^ (h >> 15);
+}
+
+static GlyphEntry **bucket(uint32_t hash)
+{
+    return &buckets[hash & (LVGL_GLYPH_CACHE_BUCKETS - 1)];
+}
+
+static void unlinkOrder(GlyphEntry *e)
+{
+    *(e->newer ? &e->newer->older : &newest) = e->older;
+    *(e->older ? &e->older->newer : &oldest) = e->newer;
+}
+
+static void linkNewest(GlyphEntry *e)
+{
+    e->newer = NULL;
+    e->older = newest;
+    *(newest ? &newest->newer : &oldest) = e;
+    newest = e;
+}
+
+static GlyphEntry *find(const lv_font_t *font, uint32_t letter, uint32_t hash)
+{
+    GlyphEntry *e = *bucket(hash);
+    while (e && (e->font != font || e->letter != letter)) {
+        e = e->next;
+    }
+    return e;
+}
+
+// Takes it out of the cache and onto `dropped`, to be freed once the lock
+// is given back
+static void dropEntry(GlyphEntry *e, GlyphEntry **dropped)
+{
+    GlyphEntry **link = bucket(e->hash);
+    while (*link != e) {
+        link = &(*link)->next;
+    }
+    *link = e->next;
+    unlinkOrder(e);
+    stats.entries--;
+    stats.bytes -= e->bytes;
+    e->next = *dropped;
+    *dropped = e;
+}
+
+static void freeEntries(GlyphEntry *dropped)
+{
+    while (dropped) {
+        GlyphEntry *next = dropped->next;
+        lv_mem_free(dropped);
+        dropped = next;
+    }
+}
+
+// Never the newest, which is about to be drawn, nor one another band is
+// drawing
+static GlyphEntry *evict(size_t limit)
+{
+    GlyphEntry *dropped = NULL;
+    GlyphEntry *e = oldest;
+    while (e && stats.bytes > limit && e != newest) {
+        GlyphEntry *newer = e->newer;
+        if (!e->users) {
+            dropEntry(e, &dropped);
+            stats.evictions++;
+        }
+        e = newer;
+    }
+    return dropped;
+}
+
+// Unpacks the glyph the way lv_draw_sw_letter() does at full opacity:
+// rows follow each other without padding, 3 bpp is read as 4.
+static bool unpack(lv_opa_t *mask, const uint8_t *bitmap, uint32_t bpp, uint32_t pixels)
+{
+    const uint8_t *table;
+    switch (bpp) {
+    case 1: table = _lv_bpp1_opa_table; break;
+    case 2: table = _lv_bpp2_opa_table; break;
+    case 4: table = _lv_bpp4_opa_table; break;
+    case 8: table = _lv_bpp8_opa_table; break;
+    default: return false;
+    }
+    uint32_t shift = 8 - bpp;
+    uint32_t bit = 0;
+    for (uint32_t i = 0; i < pixels; i++, bit += bpp) {
+        mask[i] = table[(uint8_t)(bitmap[bit >> 3] << (bit & 7)) >> shift];
+    }
+    return true;
+}
+
+// Returns NULL for letters LVGL has to draw: missing, sub-pixel, image
+// fonts and bpp it does not know. The letter is unpacked without the lock;
+// if another band cached it meanwhile, that one is used.
+static GlyphEntry *openEntry(const lv_draw_label_dsc_t *dsc, uint32_t letter, uint32_t hash)
+{
+    lv_font_glyph_dsc_t g;
+    if (!lv_font_get_glyph_dsc(dsc->font, &g, letter, '\0') || g.resolved_font->subpx) {
+        return NULL;
+    }
+    uint32_t bpp = g.bpp == 3 ? 4 : g.bpp;
+    if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) {
+        return NULL;
+    }
+    const uint8_t *bitmap = NULL;
+    uint32_t pixels = (uint32_t)g.box_w * g.box_h;
+    if (pixels && !(bitmap = lv_font_get_glyph_bitmap(g.resolved_font, letter))) {
+        return NULL;
+    }
+
+    uint32_t bytes = sizeof(GlyphEntry) + pixels;
+    LvglAllocHint hint = lvglAllocSetHint(LVGL_ALLOC_PSRAM);
+    GlyphEntry *e = (GlyphEntry *)lv_mem_alloc(bytes);
+    lvglAllocSetHint(hint);
+    if (!e) {
+        return NULL;
+    }
+    unpack(maskOf(e), bitmap, bpp, pixels);
+    e->font = dsc->font;
+    e->letter = letter;
+    e->hash = hash;
+    e->bytes = bytes;
+    e->x = g.ofs_x;
+    e->y = (dsc->font->line_height - dsc->font->base_line) - g.box_h - g.ofs_y;
+    e->width = g.box_w;
+    e->height = g.box_h;
+    e->users = 1;
+
+    GlyphEntry *dropped = NULL;
+    lvglSpinlockTake(&lock);
+    stats.misses++;
+    GlyphEntry *cached = find(dsc->font, letter, hash);
+    if (cached) {
+        cached->users++;
+        e->next = NULL;
+        dropped = e;
+        e = cached;
+    } else {
+        GlyphEntry **link = bucket(hash);
+        e->next = *link;
+        *link = e;
+        linkNewest(e);
+        stats.entries++;
+        stats.bytes += bytes;
+        stats.peakBytes = LV_MAX(stats.peakBytes, stats.bytes);
+        dropped = evict(budget);
+    }
+    lvglSpinlockGive(&lock);
+    freeEntries(dropped);
+    return e;
+}
+
+// Translucent text and text under other masks go a row at a time through a
+// copy, with the opacity folded in as lv_draw_sw_letter() does
+static void blendRows(lv_draw_ctx_t *draw_ctx, lv_draw_sw_blend_dsc_t *blend_dsc, GlyphEntry *e,
+                      const lv_area_t &box, lv_opa_t opa)
+{
+    lv_area_t clip;
+    if (!_lv_area_intersect(&clip, draw_ctx->clip_area, &box)) {
+        return;
+    }
+    lv_coord_t width = lv_area_get_width(&clip);
+    lv_opa_t *buf = (lv_opa_t *)lv_mem_buf_get(width);
+    bool masked = lv_draw_mask_is_any(&clip);
+    lv_area_t row = clip;
+    blend_dsc->mask_buf = buf;
+    blend_dsc->blend_area = &row;
+    blend_dsc->mask_area = &row;
+    for (row.y2 = row.y1; row.y1 <= clip.y2; row.y1++, row.y2++) {
+        const lv_opa_t *src = maskOf(e) + (row.y1 - box.y1) * e->width + (clip.x1 - box.x1);
+        if (opa < LV_OPA_MAX) {
+            for (lv_coord_t i = 0; i < width; i++) {
+                buf[i] = src[i] == LV_OPA_COVER ? opa : (lv_opa_t)((src[i] * opa) >> 8);
+            }
+        } else {
+            memcpy(buf, src, width);
+        }
+        if (masked && lv_draw_mask_apply(buf, clip.x1, row.y1, width) == LV_DRAW_MASK_RES_TRANSP) {
+            continue;
+        }
+        lv_draw_sw_blend(draw_ctx, blend_dsc);
+    }
+    lv_mem_buf_release(buf);
+}
+
+static void blendEntry(lv_draw_ctx_t *draw_ctx, const lv_draw_label_dsc_t *dsc, const lv_point_t *pos_p,
+                       GlyphEntry *e)
+{
+    if (!e->width || !e->height) {
+        return;
+    }
+
+    lv_area_t box;
+    box.x1 = pos_p->x + e->x;
+    box.y1 = pos_p->y + e->y;
+    box.x2 = box.x1 + e->width - 1;
+    box.y2 = box.y1 + e->height - 1;
+    if (!_lv_area_is_on(&box, draw_ctx->clip_area)) {
+        return;
+    }
+
+    lv_draw_sw_blend_dsc_t blend_dsc;
+    lv_memset_00(&blend_dsc, sizeof(blend_dsc));
+    blend_dsc.color = dsc->color;
+    blend_dsc.opa = dsc->opa;
+    blend_dsc.blend_mode = dsc->blend_mode;
+    blend_dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    if (dsc->opa < LV_OPA_MAX || lv_draw_mask_is_any(&box)) {
+        blendRows(draw_ctx, &blend_dsc, e, box, dsc->opa);
+        return;
+    }
+    // The whole letter at once; the blend clips it and steps through the
+    // mask by the box's width
+    blend_dsc.mask_buf = maskOf(e);
+    blend_dsc.blend_area = &box;
+    blend_dsc.mask_area = &box;
+    lv_draw_sw_blend(draw_ctx, &blend_dsc);
+}
+
+static void draw_letter(lv_draw_ctx_t *draw_ctx, const lv_draw_label_dsc_t *dsc, const lv_point_t *pos_p,
+                        uint32_t letter)
+{
+    // Without anti-aliasing the blend thresholds the mask in place
+    if (!budget || !_lv_refr_get_disp_refreshing()->driver->antialiasing) {
+        lv_draw_sw_letter(draw_ctx, dsc, pos_p, letter);
+        return;
+    }
+    uint32_t hash = hashGlyph(dsc->font, letter);
+    lvglSpinlockTake(&lock);
+    GlyphEntry *e = find(dsc->font, letter, hash);
+    if (e) {
+        stats.hits++;
+        unlinkOrder(e);
+        linkNewest(e);
+        e->users++;
+    }
+    lvglSpinlockGive(&lock);
+    if (!e && !(e = openEntry(dsc, letter, hash))) {
+        lv_draw_sw_letter(draw_ctx, dsc, pos_p, letter);
+        return;
+    }
+    blendEntry(draw_ctx, dsc, pos_p, e);
+    lvglSpinlockTake(&lock);
+    e->users--;
+    lvglSpinlockGive(&lock);
+}
+
+void lvglGlyphCacheAttach(lv_draw_ctx_t *draw_ctx)
+{
+    draw_ctx->draw_letter = draw_letter;
+}
+
+size_t lvglGlyphCacheSetBudget(size_t bytes)
+{
+    GlyphEntry *dropped = NULL;
+    lvglSpinlockTake(&lock);
+    size_t previous = budget;
+    budget = bytes;
+    while (oldest && stats.bytes > budget) {
+        dropEntry(oldest, &dropped);
+        stats.evictions++;
+    }
+    lvglSpinlockGive(&lock);
+    freeEntries(dropped);
+    return previous;
+}
+
+void lvglGlyphCacheInvalidate(const lv_font_t *font)
+{
+    GlyphEntry *dropped = NULL;
+    lvglSpinlockTake(&lock);
+    GlyphEntry *e = newest;
+    while (e) {
+        GlyphEntry *older = e->older;
+        if (!font || e->font == font) {
+            dropEntry(e, &dropped);
+        }
+        e = older;
+    }
+    lvglSpinlockGive(&lock);
+    freeEntries(dropped);
+}
+
+LvglGlyphCacheStats lvglGlyphCacheGetStats()
+{
+    lvglSpinlockTake(&lock);
+    stats.budget = budget;
+    LvglGlyphCacheStats out = stats;
+    lvglSpinlockGive(&lock);
+    return out;
+}
+
+void lvglGlyphCacheResetStats()
+{
+    lvglSpinlockTake(&lock);
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+    stats.peakBytes = stats.bytes;
+    lvglSpinlockGive(&lock);
+}
@@ -0,0 +1,61 @@
+/**
+ * @file      lvglGlyphCache.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <lvgl.h>
+
+// Keeps glyphs as 8-bit alpha masks, ready to blend, instead of unpacking
+// the font's 1, 2, 4 or 8 bpp bitmap through an opacity table for every
+// letter drawn. A cached letter is blended in one go straight from its
+// mask, which with large fonts such as a clock's digits is most of the
+// cost of drawing text. Masks live in PSRAM, are found by a hash of the
+// font and codepoint (a font has one bpp), and the least recently drawn
+// are evicted once they take more than the budget. Sub-pixel fonts, image fonts and
+// displays without anti-aliasing are left to LVGL.
+//
+// A font is known by its address: one freed at runtime, e.g. with
+// lv_font_free(), must be passed to lvglGlyphCacheInvalidate() first.
+//
+// Bands drawn at once (lvglBands.h) share the cache. A letter is unpacked
+// and blended outside its lock, and one a band is drawing is not evicted.
+
+// Bytes of masks kept; 0 turns the cache off
+#ifndef LVGL_GLYPH_CACHE_SIZE
+#define LVGL_GLYPH_CACHE_SIZE       (128 * 1024)
+#endif
+
+// Hash table size, a power of two
+#ifndef LVGL_GLYPH_CACHE_BUCKETS
+#define LVGL_GLYPH_CACHE_BUCKETS    256
+#endif
+
+struct LvglGlyphCacheStats {
+    uint32_t hits;
+    uint32_t misses;        // letters unpacked into a new mask
+    uint32_t evictions;
+    uint32_t entries;
+    uint32_t bytes;
+    uint32_t peakBytes;
+    uint32_t budget;
+};
+
+// Routes letters drawn on a display through the cache; call after the
+// software context is set up, e.g. from lv_disp_drv_t::draw_ctx_init.
+void lvglGlyphCacheAttach(lv_draw_ctx_t *draw_ctx);
+
+// Evicts down to `bytes`; 0 empties the cache and LVGL unpacks every letter
+// again. Returns the previous budget.
+size_t lvglGlyphCacheSetBudget(size_t bytes);
+
+// Drops the masks of `font`, or of all fonts with NULL
+void lvglGlyphCacheInvalidate(const lv_font_t *font);
+
+LvglGlyphCacheStats lvglGlyphCacheGetStats();
+void lvglGlyphCacheResetStats();
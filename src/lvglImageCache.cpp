@@ -0,0 +1,417 @@
+/**
+ * @file      lvglImageCache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+static uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+#include <string.h>
+#include "lvglImageCache.h"
+#include "lvglAlloc.h"
+#include "lvglLock.h"
+
+struct CacheEntry {
+    lv_img_decoder_dsc_t dec;
+    uint32_t hash;
+    uint32_t bytes;
+    uint32_t frame;         // last one it was drawn in
+    CacheEntry *next;       // in its bucket
+    CacheEntry *newer;      // in drawing order
+    CacheEntry *older;
+};
+
+static CacheEntry *buckets[LVGL_IMAGE_CACHE_BUCKETS];
+static CacheEntry *newest = NULL;
+static CacheEntry *oldest = NULL;
+static uint32_t frame = 1;
+static size_t budget = LVGL_IMAGE_CACHE_SIZE;
+static LvglImageCacheStats stats;
+// Held while opening and reading images, not while blending decoded ones
+static LvglMutex lock = LVGL_MUTEX_INIT;
+
+// Built-in formats in memory are drawn from where they are
+static bool cacheable(const void *src, lv_img_src_t type)
+{
+    if (type == LV_IMG_SRC_FILE) {
+        return true;
+    }
+    if (type != LV_IMG_SRC_VARIABLE) {
+        return false;
+    }
+    lv_img_cf_t cf = (lv_img_cf_t)((const lv_img_dsc_t *)src)->header.cf;
+    return (cf >= LV_IMG_CF_RAW && cf <= LV_IMG_CF_RAW_CHROMA_KEYED) || cf >= LV_IMG_CF_USER_ENCODED_0;
+}
+
+// FNV-1a over the path or the descriptor's address, the colour alpha-only
+// images are drawn in and the frame
+static inline uint32_t fnv(uint32_t h, uint8_t byte)
+{
+    return (h ^ byte) * 16777619u;
+}
+
+static uint32_t hashSource(const void *src, lv_img_src_t type, lv_color_t color, int32_t frameId)
+{
+    uint32_t h = 2166136261u;
+    if (type == LV_IMG_SRC_FILE) {
+        for (const uint8_t *p = (const uint8_t *)src; *p; p++) {
+            h = fnv(h, *p);
+        }
+    } else {
+        uintptr_t v = (uintptr_t)src;
+        for (size_t i = 0; i < sizeof(v); i++, v >>= 8) {
+            h = fnv(h, (uint8_t)v);
+        }
+    }
+    uint32_t key = lv_color_to32(color);
+    for (int i = 0; i < 4; i++, key >>= 8) {
+        h = fnv(h, (uint8_t)key);
+    }
+    for (int i = 0; i < 4; i++, frameId >>= 8) {
+        h = fnv(h, (uint8_t)frameId);
+    }
+    return h;
+}
+
+static bool sameSource(const CacheEntry *e, const void *src, lv_img_src_t type)
+{
+    if (type == LV_IMG_SRC_FILE) {
+        return e->dec.src_type == LV_IMG_SRC_FILE && strcmp((const char *)e->dec.src, (const char *)src) == 0;
+    }
+    return e->dec.src == src;
+}
+
+static CacheEntry **bucket(uint32_t hash)
+{
+    return &buckets[hash & (LVGL_IMAGE_CACHE_BUCKETS - 1)];
+}
+
+static CacheEntry *find(const void *src, lv_img_src_t type, lv_color_t color, int32_t frameId, uint32_t hash)
+{
+    for (CacheEntry *e = *bucket(hash); e; e = e->next) {
+        if (e->hash == hash && e->dec.color.full == color.full && e->dec.frame_id == frameId &&
+                sameSource(e, src, type)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void unlinkOrder(CacheEntry *e)
+{
+    *(e->newer ? &e->newer->older : &newest) = e->older;
+    *(e->older ? &e->older->newer : &oldest) = e->newer;
+}
+
+static void linkNewest(CacheEntry *e)
+{
+    e->newer = NULL;
+    e->older = newest;
+    *(newest ? &newest->newer : &oldest) = e;
+    newest = e;
+}
+
+static void dropEntry(CacheEntry *e)
+{
+    CacheEntry **link = bucket(e->hash);
+    while (*link != e) {
+        link = &(*link)->next;
+    }
+    *link = e->next;
+    unlinkOrder(e);
+    stats.entries--;
+    stats.bytes -= e->bytes;
+    lv_img_decoder_close(&e->dec);
+    lv_mem_free(e);
+}
+
+// Entries are moved to the front as they are drawn, so the ones drawn in
+// this frame are all in front of the rest and eviction stops at the first.
+static void evict(size_t limit, bool keepFrame)
+{
+    while (oldest && stats.bytes > limit && !(keepFrame && oldest->frame == frame)) {
+        dropEntry(oldest);
+        stats.evictions++;
+    }
+}
+
+static size_t heapUsed()
+{
+#if LV_MEM_CUSTOM
+    LvglAllocStats alloc;
+    lvglAllocGetStats(&alloc);
+    return alloc.poolUsed + alloc.psramUsed;
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+#endif
+}
+
+static CacheEntry *openEntry(const void *src, lv_color_t color, int32_t frameId, uint32_t hash)
+{
+    CacheEntry *e = (CacheEntry *)lv_mem_alloc(sizeof(CacheEntry));
+    if (!e) {
+        return NULL;
+    }
+    lv_memset_00(e, sizeof(CacheEntry));
+    stats.misses++;
+
+    // What the decoder still holds once open is what caching it costs.
+    // Its scratch and the decoded image stay out of the internal pool.
+    // Other bands allocating meanwhile only skew the estimate.
+    size_t before = heapUsed();
+    uint32_t start = micros();
+    LvglAllocHint hint = lvglAllocSetHint(LVGL_ALLOC_PSRAM);
+    lv_res_t res = lv_img_decoder_open(&e->dec, src, color, frameId);
+    lvglAllocSetHint(hint);
+    stats.decodeUs += micros() - start;
+    if (res != LV_RES_OK || e->dec.error_msg) {
+        // LVGL opens it again and shows the error
+        if (res == LV_RES_OK) {
+            lv_img_decoder_close(&e->dec);
+        }
+        lv_mem_free(e);
+        return NULL;
+    }
+    size_t after = heapUsed();
+    size_t kept = after > before ? after - before : 0;
+    if (!kept && e->dec.img_data) {
+        // Allocations the statistics do not see
+        kept = lv_img_buf_get_img_size(e->dec.header.w, e->dec.header.h, e->dec.header.cf);
+    }
+
+    e->hash = hash;
+    e->bytes = kept + sizeof(CacheEntry);
+    CacheEntry **link = bucket(hash);
+    e->next = *link;
+    *link = e;
+    linkNewest(e);
+    stats.entries++;
+    stats.bytes += e->bytes;
+    stats.peakBytes = LV_MAX(stats.peakBytes, stats.bytes);
+    return e;
+}
+
+// How lv_draw_img() blends an open image: its decoded data, or NULL when
+// it has to be read a line at a time
+static const uint8_t *decodedData(const lv_img_decoder_dsc_t *dec, const lv_draw_img_dsc_t *dsc,
+                                  lv_img_cf_t *cf)
+{
+    if (lv_img_cf_is_chroma_keyed(dec->header.cf)) {
+        *cf = LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED;
+    } else if (dec->header.cf == LV_IMG_CF_ALPHA_8BIT) {
+        *cf = LV_IMG_CF_ALPHA_8BIT;
+    } else if (dec->header.cf == LV_IMG_CF_RGB565A8) {
+        *cf = LV_IMG_CF_RGB565A8;
+    } else if (lv_img_cf_has_alpha(dec->header.cf)) {
+        *cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    } else {
+        *cf = LV_IMG_CF_TRUE_COLOR;
+    }
+    if (*cf == LV_IMG_CF_ALPHA_8BIT && (dsc->angle || dsc->zoom != LV_IMG_ZOOM_NONE)) {
+        *cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        return NULL;
+    }
+    return dec->img_data;
+}
+
+static void drawDecoded(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords,
+                        const uint8_t *data, lv_img_cf_t cf)
+{
+    const lv_area_t *clip_area = draw_ctx->clip_area;
+    lv_area_t area = *coords;
+    lv_area_t clip;
+    if (dsc->angle || dsc->zoom != LV_IMG_ZOOM_NONE) {
+        _lv_img_buf_get_transformed_area(&area, lv_area_get_width(coords), lv_area_get_height(coords),
+                                         dsc->angle, dsc->zoom, &dsc->pivot);
+        lv_area_move(&area, coords->x1, coords->y1);
+    }
+    if (_lv_area_intersect(&clip, clip_area, &area)) {
+        draw_ctx->clip_area = &clip;
+        lv_draw_img_decoded(draw_ctx, dsc, coords, data, cf);
+        draw_ctx->clip_area = clip_area;
+    }
+}
+
+// Decoders that give a line at a time, e.g. SJPG, keep what they decoded
+// last, so this runs under the lock
+static lv_res_t drawLines(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords,
+                          lv_img_decoder_dsc_t *dec, lv_img_cf_t cf)
+{
+    const lv_area_t *clip_area = draw_ctx->clip_area;
+    lv_area_t clip;
+    if (!_lv_area_intersect(&clip, clip_area, coords)) {
+        return LV_RES_OK;
+    }
+    lv_coord_t width = lv_area_get_width(&clip);
+    uint8_t *buf = (uint8_t *)lv_mem_buf_get(width * LV_IMG_PX_SIZE_ALPHA_BYTE);
+    lv_area_t line = clip;
+    lv_res_t res = LV_RES_OK;
+    for (line.y2 = line.y1; line.y1 <= clip.y2; line.y1++, line.y2++) {
+        res = lv_img_decoder_read_line(dec, clip.x1 - coords->x1, line.y1 - coords->y1, width, buf);
+        if (res != LV_RES_OK) {
+            break;
+        }
+        draw_ctx->clip_area = &line;
+        lv_draw_img_decoded(draw_ctx, dsc, &line, buf, cf);
+    }
+    draw_ctx->clip_area = clip_area;
+    lv_mem_buf_release(buf);
+    return res;
+}
+
+static bool inBands()
+{
+#if LVGL_REFR_BANDS
+    return lv_refr_get_bands() > 1;
+#else
+    return false;
+#endif
+}
+
+// LVGL opens the image again when the cache gives up on it, through its
+// own single shared slot. Bands drawing at once can't share that, so they
+// leave the image out of this frame instead.
+static lv_res_t failed()
+{
+    return inBands() ? LV_RES_OK : LV_RES_INV;
+}
+
+// What LVGL would do for images the cache leaves alone, with an image
+// opened just for this draw
+static lv_res_t drawUncached(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords,
+                             const void *src)
+{
+    lv_img_decoder_dsc_t dec;
+    lvglMutexTake(&lock);
+    lv_res_t res = lv_img_decoder_open(&dec, src, dsc->recolor, dsc->frame_id);
+    if (res != LV_RES_OK || dec.error_msg) {
+        if (res == LV_RES_OK) {
+            lv_img_decoder_close(&dec);
+        }
+        lvglMutexGive(&lock);
+        LV_LOG_WARN("Image cache: can't open an image while drawing in bands");
+        return failed();
+    }
+    lv_img_cf_t cf;
+    const uint8_t *data = decodedData(&dec, dsc, &cf);
+    if (data) {
+        lvglMutexGive(&lock);
+        drawDecoded(draw_ctx, dsc, coords, data, cf);
+        lvglMutexTake(&lock);
+    } else {
+        res = drawLines(draw_ctx, dsc, coords, &dec, cf);
+    }
+    lv_img_decoder_close(&dec);
+    lvglMutexGive(&lock);
+    return res == LV_RES_OK ? res : failed();
+}
+
+static lv_res_t draw_img(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords,
+                         const void *src)
+{
+    lv_img_src_t type = lv_img_src_get_type(src);
+    if (!budget || !cacheable(src, type)) {
+        if (!inBands()) {
+            return LV_RES_INV;
+        }
+        return drawUncached(draw_ctx, dsc, coords, src);
+    }
+    uint32_t hash = hashSource(src, type, dsc->recolor, dsc->frame_id);
+    lvglMutexTake(&lock);
+    CacheEntry *e = find(src, type, dsc->recolor, dsc->frame_id, hash);
+    if (e) {
+        stats.hits++;
+        unlinkOrder(e);
+        linkNewest(e);
+    } else if (!(e = openEntry(src, dsc->recolor, dsc->frame_id, hash))) {
+        lvglMutexGive(&lock);
+        return failed();
+    }
+    e->frame = frame;
+    evict(budget, true);
+
+    lv_img_cf_t cf;
+    const uint8_t *data = decodedData(&e->dec, dsc, &cf);
+    if (data) {
+        // Nothing drawn in this frame is evicted, so other bands can open
+        // images while this one blends
+        lvglMutexGive(&lock);
+        drawDecoded(draw_ctx, dsc, coords, data, cf);
+        return LV_RES_OK;
+    }
+    lv_res_t res = drawLines(draw_ctx, dsc, coords, &e->dec, cf);
+    if (res != LV_RES_OK) {
+        // LVGL tries once more with a freshly opened image
+        LV_LOG_WARN("Image cache: can't read a line, closing the image");
+        dropEntry(e);
+    }
+    lvglMutexGive(&lock);
+    return res == LV_RES_OK ? res : failed();
+}
+
+void lvglImageCacheAttach(lv_draw_ctx_t *draw_ctx)
+{
+    lvglMutexInit(&lock);
+    draw_ctx->draw_img = draw_img;
+}
+
+void lvglImageCacheNextFrame()
+{
+    frame++;
+}
+
+size_t lvglImageCacheSetBudget(size_t bytes)
+{
+    lvglMutexTake(&lock);
+    size_t previous = budget;
+    budget = bytes;
+    evict(budget, false);
+    lvglMutexGive(&lock);
+    return previous;
+}
+
+void lvglImageCacheInvalidate(const void *src)
+{
+    lv_img_src_t type = src ? lv_img_src_get_type(src) : (lv_img_src_t)LV_IMG_SRC_UNKNOWN;
+    lvglMutexTake(&lock);
+    CacheEntry *e = newest;
+    while (e) {
+        CacheEntry *older = e->older;
+        if (!src || sameSource(e, src, type)) {
+            dropEntry(e);
+        }
+        e = older;
+    }
+    lvglMutexGive(&lock);
+}
+
+LvglImageCacheStats lvglImageCacheGetStats()
+{
+    lvglMutexTake(&lock);
+    stats.budget = budget;
+    LvglImageCacheStats out = stats;
+    lvglMutexGive(&lock);
+    return out;
+}
+
+void lvglImageCacheResetStats()
+{
+    lvglMutexTake(&lock);
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+    stats.peakBytes = stats.bytes;
+    stats.decodeUs = 0;
+    lvglMutexGive(&lock);
+}
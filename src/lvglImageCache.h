@@ -0,0 +1,71 @@
+/**
+ * @file      lvglImageCache.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <lvgl.h>
+
+// Keeps PNG, JPG and other decoded images open between draws, in place of
+// LVGL's image cache (LV_IMG_CACHE_DEF_SIZE), which is off in lv_conf.h
+// and otherwise counts entries and ages every one of them on each draw.
+// This one counts the bytes the decoders keep, which go to PSRAM, finds an
+// image by a hash of its source and evicts the least recently drawn. An
+// image drawn in the frame being rendered is never evicted for another
+// one, so a screen with more images than the budget does not decode them
+// again for every area; the budget is exceeded for that frame instead.
+//
+// Images LVGL draws straight from memory (C arrays in the built-in
+// formats, canvases, GIF frames) need no decoding and are left to LVGL.
+// A file or encoded array that changes under the same source must be
+// passed to lvglImageCacheInvalidate().
+//
+// When LVGL draws in bands (lvglBands.h), images are opened one at a time
+// and decoded ones blended by all bands at once. LVGL's own path shares a
+// single open image between threads, so while bands are drawn every image
+// goes through here, the ones left alone opened just for the draw.
+
+// Bytes of decoded images kept open; 0 turns the cache off
+#ifndef LVGL_IMAGE_CACHE_SIZE
+#define LVGL_IMAGE_CACHE_SIZE       (2 * 1024 * 1024)
+#endif
+
+// Hash table size, a power of two
+#ifndef LVGL_IMAGE_CACHE_BUCKETS
+#define LVGL_IMAGE_CACHE_BUCKETS    64
+#endif
+
+struct LvglImageCacheStats {
+    uint32_t hits;
+    uint32_t misses;        // decoded, or failed to
+    uint32_t evictions;
+    uint32_t entries;
+    uint32_t bytes;         // kept by the decoders of the cached images
+    uint32_t peakBytes;
+    uint32_t budget;
+    uint64_t decodeUs;      // spent opening images on misses
+};
+
+// Routes lv_draw_img() for a display through the cache; call after the
+// software context is set up, e.g. from lv_disp_drv_t::draw_ctx_init.
+void lvglImageCacheAttach(lv_draw_ctx_t *draw_ctx);
+
+// Starts a new frame: images drawn before may be evicted again. LV_Helper
+// calls it as LVGL starts rendering.
+void lvglImageCacheNextFrame();
+
+// Evicts down to `bytes`; 0 empties the cache, and LVGL opens images on
+// every draw again. Returns the previous budget.
+size_t lvglImageCacheSetBudget(size_t bytes);
+
+// Closes the cached images of `src`, a path or an lv_img_dsc_t; NULL
+// closes all of them.
+void lvglImageCacheInvalidate(const void *src);
+
+LvglImageCacheStats lvglImageCacheGetStats();
+void lvglImageCacheResetStats();
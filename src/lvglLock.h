@@ -0,0 +1,92 @@
+/**
+ * @file      lvglLock.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <lvgl.h>
+
+// Locks around what lvglAlloc and the image and glyph caches share between
+// the threads drawing bands (lvglBands.h). With LV_USE_REFR_BANDS 0 in
+// lv_conf.h only LVGL's thread draws and they compile to nothing.
+//
+// LvglSpinlock is for a few lookups or list updates: on the board it
+// spins with interrupts off on the core holding it, so nothing that can
+// block, allocate from the system heap or take long goes under it.
+// LvglMutex sleeps and can be held across decoding an image.
+
+// Bands need the LVGL under libdeps/, which defines LV_REFR_THREAD_LOCAL;
+// an upstream LVGL leaves LV_USE_REFR_BANDS from lv_conf.h unused.
+#if defined(LV_REFR_THREAD_LOCAL) && LV_USE_REFR_BANDS
+#define LVGL_REFR_BANDS             1
+#define LVGL_THREAD_LOCAL           LV_REFR_THREAD_LOCAL
+#else
+#define LVGL_REFR_BANDS             0
+#define LVGL_THREAD_LOCAL
+#endif
+
+#if LVGL_REFR_BANDS
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+typedef portMUX_TYPE LvglSpinlock;
+#define LVGL_SPINLOCK_INIT          portMUX_INITIALIZER_UNLOCKED
+#define lvglSpinlockTake(lock)      portENTER_CRITICAL(lock)
+#define lvglSpinlockGive(lock)      portEXIT_CRITICAL(lock)
+
+typedef struct {
+    SemaphoreHandle_t handle;
+    StaticSemaphore_t storage;
+} LvglMutex;
+#define LVGL_MUTEX_INIT             { NULL }
+
+// Before the first take, from LVGL's thread
+static inline void lvglMutexInit(LvglMutex *mutex)
+{
+    if (!mutex->handle) {
+        mutex->handle = xSemaphoreCreateMutexStatic(&mutex->storage);
+    }
+}
+static inline void lvglMutexTake(LvglMutex *mutex)
+{
+    xSemaphoreTake(mutex->handle, portMAX_DELAY);
+}
+static inline void lvglMutexGive(LvglMutex *mutex)
+{
+    xSemaphoreGive(mutex->handle);
+}
+
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t LvglSpinlock;
+#define LVGL_SPINLOCK_INIT          PTHREAD_MUTEX_INITIALIZER
+#define lvglSpinlockTake(lock)      pthread_mutex_lock(lock)
+#define lvglSpinlockGive(lock)      pthread_mutex_unlock(lock)
+
+typedef pthread_mutex_t LvglMutex;
+#define LVGL_MUTEX_INIT             PTHREAD_MUTEX_INITIALIZER
+#define lvglMutexInit(mutex)        ((void)(mutex))
+#define lvglMutexTake(mutex)        pthread_mutex_lock(mutex)
+#define lvglMutexGive(mutex)        pthread_mutex_unlock(mutex)
+#endif
+
+#else
+
+typedef uint8_t LvglSpinlock;
+#define LVGL_SPINLOCK_INIT          0
+#define lvglSpinlockTake(lock)      ((void)(lock))
+#define lvglSpinlockGive(lock)      ((void)(lock))
+
+typedef uint8_t LvglMutex;
+#define LVGL_MUTEX_INIT             0
+#define lvglMutexInit(mutex)        ((void)(mutex))
+#define lvglMutexTake(mutex)        ((void)(mutex))
+#define lvglMutexGive(mutex)        ((void)(mutex))
+
+#endif
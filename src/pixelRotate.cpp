@@ -0,0 +1,175 @@
+/**
+ * @file      pixelRotate.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include "pixelRotate.h"
+#include <string.h>
+
+static inline uint16_t swap16(uint16_t v)
+{
+    return (uint16_t)((v >> 8) | (v << 8));
+}
+
+static inline uint32_t swap32(uint32_t v)
+{
+    return ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+}
+
+template <bool Swap>
+static inline uint16_t px(uint16_t v)
+{
+    return Swap ? swap16(v) : v;
+}
+
+template <bool Swap>
+static inline uint32_t px2(uint32_t v)
+{
+    return Swap ? swap32(v) : v;
+}
+
+static inline bool aligned(const void *p)
+{
+    return ((uintptr_t)p & 3) == 0;
+}
+
+// 0 and 180 degrees keep source rows whole, so no tiling is needed.
+template <bool Swap>
+static void copyRows(uint16_t *dst, const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height,
+                     bool flip, uint16_t firstRow, uint16_t rows)
+{
+    bool words = aligned(dst) && aligned(src) && !(width & 1) && !(stride & 1);
+    for (uint16_t r = 0; r < rows; r++) {
+        uint32_t row = flip ? height - 1 - (firstRow + r) : firstRow + r;
+        const uint16_t *s = src + row * stride;
+        uint16_t *d = dst + (uint32_t)r * width;
+        if (!flip) {
+            if (!Swap) {
+                memcpy(d, s, width * sizeof(uint16_t));
+            } else if (words) {
+                const uint32_t *s32 = (const uint32_t *)s;
+                uint32_t *d32 = (uint32_t *)d;
+                for (uint16_t x = 0; x < width / 2; x++) {
+                    d32[x] = swap32(s32[x]);
+                }
+            } else {
+                for (uint16_t x = 0; x < width; x++) {
+                    d[x] = swap16(s[x]);
+                }
+            }
+        } else if (words) {
+            // Reversing a row swaps the two pixels of every word too
+            const uint32_t *s32 = (const uint32_t *)s + width / 2;
+            uint32_t *d32 = (uint32_t *)d;
+            for (uint16_t x = 0; x < width / 2; x++) {
+                uint32_t v = *--s32;
+                d32[x] = px2<Swap>((v >> 16) | (v << 16));
+            }
+        } else {
+            for (uint16_t x = 0; x < width; x++) {
+                d[x] = px<Swap>(s[width - 1 - x]);
+            }
+        }
+    }
+}
+
+// 90 and 270 degrees turn source columns into destination rows. Walking
+// the image tile by tile keeps both the column-stride side and the
+// row-stride side of the transpose within a few cache lines.
+//   90:  dst(r, c) = src(height - 1 - c, r)
+//   270: dst(r, c) = src(c, width - 1 - r)
+template <bool Swap>
+static void transposeRows(uint16_t *dst, const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height,
+                          bool clockwise, uint16_t firstRow, uint16_t rows)
+{
+    const uint32_t dstWidth = height;
+    const uint32_t lastRow = (uint32_t)firstRow + rows;
+    bool blocks = aligned(dst) && aligned(src) && !(width & 1) && !(height & 1) &&
+                  !(stride & 1) && !(firstRow & 1) && !(rows & 1);
+
+    for (uint32_t rr = firstRow; rr < lastRow; rr += PIXEL_ROTATE_TILE) {
+        uint32_t rEnd = rr + PIXEL_ROTATE_TILE < lastRow ? rr + PIXEL_ROTATE_TILE : lastRow;
+        for (uint32_t cc = 0; cc < dstWidth; cc += PIXEL_ROTATE_TILE) {
+            uint32_t cEnd = cc + PIXEL_ROTATE_TILE < dstWidth ? cc + PIXEL_ROTATE_TILE : dstWidth;
+
+            if (blocks) {
+                // Two source rows at a time, two pixels from each per load:
+                // a 2x2 block transposed in registers.
+                for (uint32_t c = cc; c < cEnd; c += 2) {
+                    uint32_t *d = (uint32_t *)(dst + (rr - firstRow) * dstWidth + c);
+                    if (clockwise) {
+                        const uint16_t *a = src + (height - 1 - c) * stride;
+                        const uint16_t *b = a - stride;
+                        for (uint32_t r = rr; r < rEnd; r += 2) {
+                            uint32_t va = *(const uint32_t *)(a + r);
+                            uint32_t vb = *(const uint32_t *)(b + r);
+                            d[0] = px2<Swap>((va & 0xFFFF) | (vb << 16));
+                            d[dstWidth / 2] = px2<Swap>((va >> 16) | (vb & 0xFFFF0000));
+                            d += dstWidth;
+                        }
+                    } else {
+                        const uint16_t *a = src + c * stride + width - 2;
+                        const uint16_t *b = a + stride;
+                        for (uint32_t r = rr; r < rEnd; r += 2) {
+                            uint32_t va = *(const uint32_t *)(a - r);
+                            uint32_t vb = *(const uint32_t *)(b - r);
+                            d[0] = px2<Swap>((va >> 16) | (vb & 0xFFFF0000));
+                            d[dstWidth / 2] = px2<Swap>((va & 0xFFFF) | (vb << 16));
+                            d += dstWidth;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            for (uint32_t c = cc; c < cEnd; c++) {
+                uint16_t *d = dst + (rr - firstRow) * dstWidth + c;
+                if (clockwise) {
+                    const uint16_t *s = src + (height - 1 - c) * stride;
+                    for (uint32_t r = rr; r < rEnd; r++) {
+                        *d = px<Swap>(s[r]);
+                        d += dstWidth;
+                    }
+                } else {
+                    const uint16_t *s = src + c * stride + width - 1;
+                    for (uint32_t r = rr; r < rEnd; r++) {
+                        *d = px<Swap>(*(s - r));
+                        d += dstWidth;
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <bool Swap>
+static void rotate(uint16_t *dst, const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height,
+                   uint8_t rotation, uint16_t firstRow, uint16_t rows)
+{
+    switch (rotation & 3) {
+    case PIXEL_ROTATE_90:
+        transposeRows<Swap>(dst, src, stride, width, height, true, firstRow, rows);
+        break;
+    case PIXEL_ROTATE_180:
+        copyRows<Swap>(dst, src, stride, width, height, true, firstRow, rows);
+        break;
+    case PIXEL_ROTATE_270:
+        transposeRows<Swap>(dst, src, stride, width, height, false, firstRow, rows);
+        break;
+    default:
+        copyRows<Swap>(dst, src, stride, width, height, false, firstRow, rows);
+        break;
+    }
+}
+
+void rotatePixels(uint16_t *dst, const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height,
+                  uint8_t rotation, uint16_t firstRow, uint16_t rows, bool swapBytes)
+{
+    if (swapBytes) {
+        rotate<true>(dst, src, stride, width, height, rotation, firstRow, rows);
+    } else {
+        rotate<false>(dst, src, stride, width, height, rotation, firstRow, rows);
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * @file      pixelRotate.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Clockwise quarter turns applied by rotatePixels()
+enum PixelRotation {
+    PIXEL_ROTATE_0,
+    PIXEL_ROTATE_90,
+    PIXEL_ROTATE_180,
+    PIXEL_ROTATE_270,
+};
+
+// Source pixels walked per tile edge. A 16x16 tile of RGB565 is 512 bytes on
+// each side, so a tile's source rows and destination rows stay in cache
+// while it is transposed.
+#ifndef PIXEL_ROTATE_TILE
+#define PIXEL_ROTATE_TILE   16
+#endif
+
+// Width of the image rotatePixels() produces from a width x height source.
+static inline uint16_t rotatedWidth(uint16_t width, uint16_t height, uint8_t rotation)
+{
+    return (rotation & 1) ? height : width;
+}
+
+static inline uint16_t rotatedHeight(uint16_t width, uint16_t height, uint8_t rotation)
+{
+    return (rotation & 1) ? width : height;
+}
+
+// Writes rows [firstRow, firstRow + rows) of the image rotated clockwise by
+// `rotation` quarter turns to `dst`, as packed rows of rotatedWidth()
+// pixels. `src` is width x height pixels with rows `stride` pixels apart.
+// With `swapBytes` every pixel is byte-swapped on the way, so a native-order
+// buffer comes out in the big-endian order the panel expects. Rows are
+// produced in bands so the output can go straight into a small DMA buffer.
+//
+// Aligned buffers with even sizes, stride and firstRow take a path that
+// moves 2x2 pixel blocks with 32-bit loads and stores.
+void rotatePixels(uint16_t *dst, const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height,
+                  uint8_t rotation, uint16_t firstRow, uint16_t rows, bool swapBytes);
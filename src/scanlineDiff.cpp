@@ -0,0 +1,78 @@
+/**
+ * @file      scanlineDiff.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include "scanlineDiff.h"
+#include <string.h>
+
+// Unchanged rows, the common case, are read once from each side and never
+// written. A changed row is scanned in from both ends so only its span is
+// copied.
+uint16_t diffScanlines(uint16_t *shadow, uint16_t stride, const uint16_t *src,
+                       uint16_t width, uint16_t height, DiffSpan *spans)
+{
+    uint16_t changed = 0;
+    for (uint16_t y = 0; y < height; y++) {
+        uint16_t *s = shadow + (uint32_t)y * stride;
+        const uint16_t *p = src + (uint32_t)y * width;
+        uint16_t first = 0;
+        while (first < width && s[first] == p[first]) {
+            first++;
+        }
+        if (first == width) {
+            spans[y].first = 1;
+            spans[y].last = 0;
+            continue;
+        }
+        uint16_t last = width - 1;
+        while (s[last] == p[last]) {
+            last--;
+        }
+        memcpy(s + first, p + first, (last - first + 1) * sizeof(uint16_t));
+        spans[y].first = first;
+        spans[y].last = last;
+        changed++;
+    }
+    return changed;
+}
+
+// Runs are at least one unchanged row apart, so growing them to `align`
+// never makes two rectangles overlap.
+uint16_t mergeScanlines(const DiffSpan *spans, uint16_t width, uint16_t height, uint8_t align, DiffRect *rects)
+{
+    uint16_t count = 0;
+    uint16_t y = 0;
+    while (y < height) {
+        if (spans[y].first > spans[y].last) {
+            y++;
+            continue;
+        }
+        uint16_t top = y;
+        uint16_t left = spans[y].first;
+        uint16_t right = spans[y].last;
+        while (y < height && spans[y].first <= spans[y].last) {
+            left = spans[y].first < left ? spans[y].first : left;
+            right = spans[y].last > right ? spans[y].last : right;
+            y++;
+        }
+        uint32_t bottom = y;
+        uint32_t end = right + 1;
+        if (align > 1) {
+            top -= top % align;
+            left -= left % align;
+            bottom = (bottom + align - 1) / align * align;
+            end = (end + align - 1) / align * align;
+            bottom = bottom < height ? bottom : height;
+            end = end < width ? end : width;
+        }
+        rects[count].x = left;
+        rects[count].y = top;
+        rects[count].w = end - left;
+        rects[count].h = bottom - top;
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file      scanlineDiff.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Changed columns of one row; first > last when nothing changed.
+typedef struct {
+    uint16_t first;
+    uint16_t last;
+} DiffSpan;
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} DiffRect;
+
+// Compares a width x height block of `src` (packed rows) with the same block
+// of `shadow` (rows `stride` pixels apart), copies the changed pixels into
+// the shadow, and writes the changed columns of row i to spans[i]. Returns
+// the number of rows that changed.
+uint16_t diffScanlines(uint16_t *shadow, uint16_t stride, const uint16_t *src,
+                       uint16_t width, uint16_t height, DiffSpan *spans);
+
+// Turns each run of consecutive changed rows into the rectangle bounding
+// their spans, grown outward to multiples of `align` within the
+// width x height block, so every run costs one address window. Returns the
+// number of rectangles, at most (height + 1) / 2.
+uint16_t mergeScanlines(const DiffSpan *spans, uint16_t width, uint16_t height, uint8_t align, DiffRect *rects);
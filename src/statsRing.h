@@ -0,0 +1,79 @@
+/**
+ * @file      statsRing.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Keeps the last N records pushed by a single writer, which may be an ISR,
+// for readers on any task. Nobody waits: each slot carries a sequence
+// number that is odd while it is being written, and a reader drops the
+// records that changed under it.
+template <typename T, uint16_t N>
+class StatsRing
+{
+public:
+    StatsRing() : head(0)
+    {
+        memset(slots, 0, sizeof(slots));
+    }
+
+    void push(const T &record)
+    {
+        uint32_t n = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        Slot &slot = slots[n % N];
+        __atomic_store_n(&slot.seq, 2 * n + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        slot.record = record;
+        __atomic_store_n(&slot.seq, 2 * n + 2, __ATOMIC_RELEASE);
+        __atomic_store_n(&head, n + 1, __ATOMIC_RELEASE);
+    }
+
+    // Copies up to `max` of the newest records to `out`, oldest first, and
+    // returns how many.
+    uint16_t copy(T *out, uint16_t max) const
+    {
+        uint32_t end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+        uint32_t count = end < N ? end : N;
+        count = count < max ? count : max;
+        uint16_t copied = 0;
+        for (uint32_t n = end - count; n != end; n++) {
+            const Slot &slot = slots[n % N];
+            if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != 2 * n + 2) {
+                continue;
+            }
+            out[copied] = slot.record;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) == 2 * n + 2) {
+                copied++;
+            }
+        }
+        return copied;
+    }
+
+    // Records pushed so far, including those overwritten since
+    uint32_t total() const
+    {
+        return __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    }
+
+    // Only while the writer is idle
+    void clear()
+    {
+        memset(slots, 0, sizeof(slots));
+        __atomic_store_n(&head, 0, __ATOMIC_RELEASE);
+    }
+
+private:
+    struct Slot {
+        uint32_t seq;
+        T record;
+    };
+    Slot slots[N];
+    uint32_t head;
+};
@@ -0,0 +1,61 @@
+/**
+ * @file      touchQueue.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include "touchQueue.h"
+
+bool TouchQueue::push(const TouchSample &sample)
+{
+    uint32_t h = head;
+    if (h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) == TOUCH_QUEUE_SIZE) {
+        dropped++;
+        return false;
+    }
+    slots[h % TOUCH_QUEUE_SIZE] = sample;
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool TouchQueue::pop(TouchSample *sample)
+{
+    uint32_t t = tail;
+    if (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == t) {
+        return false;
+    }
+    *sample = slots[t % TOUCH_QUEUE_SIZE];
+    __atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool TouchQueue::empty() const
+{
+    return __atomic_load_n(&head, __ATOMIC_ACQUIRE) == __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint16_t distance(int16_t a, int16_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+bool touchQueueDrain(TouchQueue &queue, TouchSample &state, uint8_t jitter)
+{
+    TouchSample sample;
+    while (queue.pop(&sample)) {
+        if (sample.pressed != state.pressed) {
+            state.timeMs = sample.timeMs;
+            state.pressed = sample.pressed;
+            if (sample.pressed) {
+                state.x = sample.x;
+                state.y = sample.y;
+            }
+            return !queue.empty();
+        }
+        if (sample.pressed && (distance(sample.x, state.x) > jitter || distance(sample.y, state.y) > jitter)) {
+            state = sample;
+        }
+    }
+    return false;
+}
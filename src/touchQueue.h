@@ -0,0 +1,55 @@
+/**
+ * @file      touchQueue.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t timeMs;        // when the controller was read
+    int16_t x;
+    int16_t y;
+    bool pressed;
+} TouchSample;
+
+// Slots in a TouchQueue; a power of two
+#ifndef TOUCH_QUEUE_SIZE
+#define TOUCH_QUEUE_SIZE    32
+#endif
+
+// Carries samples from the task reading the controller to the LVGL read
+// callback. One producer and one consumer, neither of which ever waits.
+class TouchQueue
+{
+public:
+    TouchQueue() : head(0), tail(0), dropped(0) {}
+
+    // False, and the sample counted as dropped, if the queue is full
+    bool push(const TouchSample &sample);
+    bool pop(TouchSample *sample);
+    bool empty() const;
+    uint32_t droppedCount() const
+    {
+        return dropped;
+    }
+
+private:
+    TouchSample slots[TOUCH_QUEUE_SIZE];
+    uint32_t head;          // written by the producer
+    uint32_t tail;          // written by the consumer
+    uint32_t dropped;
+};
+
+// Takes queued samples into `state`, the touch as LVGL last saw it, and
+// returns whether more are waiting (data->continue_reading):
+// - a press or a release is reported on its own, so LVGL sees every one;
+// - moves in between collapse into the newest;
+// - while pressed, a move within `jitter` pixels of the reported point
+//   is ignored.
+// A release keeps the last pressed point, as controllers often report 0,0
+// for it.
+bool touchQueueDrain(TouchQueue &queue, TouchSample &state, uint8_t jitter);
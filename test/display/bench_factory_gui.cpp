@@ -0,0 +1,57 @@
+/**
+ * @file      bench_factory_gui.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// factoryGUI() from Graphics/Gui.cpp on a 536x240 LilyGo_HostDisplay, the
+// 1.91" panel. Plays the startup fade, then prints the render time and
+// bytes sent per frame for each tile of the tileview.
+//
+//   bench_factory_gui [frames per tile] [png prefix]
+
+#include <unistd.h>
+#include <LilyGo_AMOLED.h>
+#include <Adafruit_NeoPixel.h>
+#include "Gui.h"
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "HostTest.h"
+
+extern "C" void nwLogoFill(void);
+
+LilyGo_Class amoled;
+Adafruit_NeoPixel pixels;
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 50;
+    const char *pngPrefix = argc > 2 ? argv[2] : NULL;
+
+    LilyGo_HostDisplay display(536, 240);
+    beginLvglHelper(display);
+    nwLogoFill();
+    factoryGUI();
+
+    // The startup screen fades out and deletes itself, leaving the tileview
+    display.resetStats();
+    uint64_t start = hostNanos();
+    while (lv_obj_get_child_cnt(lv_scr_act()) > 1) {
+        lv_timer_handler();
+        usleep(1000);
+        CHECK(hostNanos() - start < 10000000000ULL);
+    }
+    HostDisplayStats fade = display.stats();
+    printf("startup: %.0f ms, %lu flushes, %llu bytes\n", (hostNanos() - start) / 1e6,
+           (unsigned long)fade.flushes, (unsigned long long)fade.bytes);
+
+    lv_obj_t *tileview = lv_obj_get_child(lv_scr_act(), 0);
+    CHECK(lv_obj_check_type(tileview, &lv_tileview_class));
+    CHECK(lv_obj_get_child_cnt(tileview) == 4);
+    hostBenchmarkTileview(display, tileview, frames, pngPrefix);
+
+    lvglHelperSetTouchInterrupt(false);
+    return 0;
+}
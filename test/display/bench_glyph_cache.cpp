@@ -0,0 +1,188 @@
+/**
+ * @file      bench_glyph_cache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// lvglGlyphCache on the dashboard's fonts: a clock label ticking once a
+// frame, drawn without and with the cache, then text the cache draws row
+// by row (translucent, recoloured, in a rounded clip), montserrat with
+// symbols and a budget small enough to evict on every letter. Frames must
+// be the same with and without the cache; prints LVGL's render time per
+// frame, without the flush.
+//
+//   bench_glyph_cache [partial | full] [frames]
+//
+// "partial" is the 536x240 panel with partial refresh, "full" the 368x194
+// one that refreshes from a shadow frame.
+
+#include <string.h>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "lvglGlyphCache.h"
+#include "HostTest.h"
+
+LV_FONT_DECLARE(alibaba_font_48);
+LV_FONT_DECLARE(font_ali_70);
+
+static uint64_t frameHash(LilyGo_HostDisplay &display)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint16_t y = 0; y < display.height(); y++) {
+        for (uint16_t x = 0; x < display.width(); x++) {
+            hash = (hash ^ display.getPixel(x, y)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+typedef void (*Scene)(lv_obj_t *screen);
+typedef void (*Tick)(uint32_t frame);
+
+static lv_obj_t *clockLabel;
+static lv_obj_t *smallLabel;
+
+static void clockText(lv_obj_t *label, uint32_t seconds)
+{
+    lv_label_set_text_fmt(label, "%02lu:%02lu:%02lu", (unsigned long)(seconds / 3600 % 24),
+                          (unsigned long)(seconds / 60 % 60), (unsigned long)(seconds % 60));
+}
+
+static void clock70(lv_obj_t *screen)
+{
+    clockLabel = lv_label_create(screen);
+    lv_obj_set_style_text_font(clockLabel, &font_ali_70, 0);
+    lv_obj_center(clockLabel);
+}
+
+static void clock48(lv_obj_t *screen)
+{
+    clockLabel = lv_label_create(screen);
+    lv_obj_set_style_text_font(clockLabel, &alibaba_font_48, 0);
+    lv_obj_center(clockLabel);
+}
+
+static void tickClock(uint32_t frame)
+{
+    clockText(clockLabel, 12 * 3600 + 59 * 60 + frame);
+}
+
+// The Factory clock: time, date and a translucent seconds label over a
+// gradient, in a rounded container that clips its corners
+static void dashboard(lv_obj_t *screen)
+{
+    lv_obj_set_style_bg_color(screen, lv_color_hex(0x102040), 0);
+    lv_obj_set_style_bg_grad_color(screen, lv_color_hex(0x405080), 0);
+    lv_obj_set_style_bg_grad_dir(screen, LV_GRAD_DIR_VER, 0);
+    lv_obj_t *panel = lv_obj_create(screen);
+    lv_obj_set_size(panel, lv_pct(90), lv_pct(80));
+    lv_obj_center(panel);
+    lv_obj_set_style_radius(panel, 40, 0);
+    lv_obj_set_style_clip_corner(panel, true, 0);
+    lv_obj_set_style_bg_opa(panel, LV_OPA_40, 0);
+    lv_obj_clear_flag(panel, LV_OBJ_FLAG_SCROLLABLE);
+    clockLabel = lv_label_create(panel);
+    lv_obj_set_style_text_font(clockLabel, &font_ali_70, 0);
+    lv_obj_set_style_text_color(clockLabel, lv_color_hex(0xFFD040), 0);
+    lv_obj_align(clockLabel, LV_ALIGN_TOP_LEFT, -30, -20);
+    smallLabel = lv_label_create(panel);
+    lv_obj_set_style_text_font(smallLabel, &alibaba_font_48, 0);
+    lv_obj_set_style_text_opa(smallLabel, LV_OPA_60, 0);
+    lv_obj_align(smallLabel, LV_ALIGN_BOTTOM_RIGHT, 20, 10);
+    lv_obj_t *symbols = lv_label_create(panel);
+    lv_obj_set_style_text_font(symbols, &lv_font_montserrat_28, 0);
+    lv_label_set_recolor(symbols, true);
+    lv_label_set_text(symbols, LV_SYMBOL_WIFI " " LV_SYMBOL_BATTERY_3 " #ff4040 Sat# 17 Oct " LV_SYMBOL_BELL);
+    lv_obj_align(symbols, LV_ALIGN_BOTTOM_LEFT, -10, 0);
+}
+
+static void tickDashboard(uint32_t frame)
+{
+    uint32_t seconds = 23 * 3600 + 59 * 60 + 30 + frame;
+    lv_label_set_text_fmt(clockLabel, "%02lu:%02lu", (unsigned long)(seconds / 3600 % 24),
+                          (unsigned long)(seconds / 60 % 60));
+    lv_label_set_text_fmt(smallLabel, "%02lu", (unsigned long)(seconds % 60));
+}
+
+// Plays `frames` frames, returns the mean render time in microseconds
+static double play(LilyGo_HostDisplay &display, Scene scene, Tick tick, uint32_t frames,
+                   std::vector<uint64_t> &hashes)
+{
+    lv_obj_clean(lv_scr_act());
+    lv_obj_remove_style_all(lv_scr_act());
+    scene(lv_scr_act());
+    tick(0);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    hashes.clear();
+    uint64_t renderUs = 0;
+    for (uint32_t f = 1; f <= frames; f++) {
+        tick(f);
+        lv_refr_now(NULL);
+        hashes.push_back(frameHash(display));
+        // The frame just drawn is the newest in the history
+        LvglFrameStats history[64];
+        uint16_t count = lvglHelperGetFrameHistory(history, 64);
+        CHECK(count > 0);
+        renderUs += history[count - 1].renderUs;
+    }
+    return (double)renderUs / frames;
+}
+
+static void compare(const char *what, const std::vector<uint64_t> &a, const std::vector<uint64_t> &b)
+{
+    CHECK(a.size() == b.size());
+    for (size_t f = 0; f < a.size(); f++) {
+        if (a[f] != b[f]) {
+            fprintf(stderr, "%s: frame %lu differs\n", what, (unsigned long)f);
+            CHECK(false);
+        }
+    }
+}
+
+// The scene with the cache off, then on with `budget`
+static void run(LilyGo_HostDisplay &display, const char *what, Scene scene, Tick tick, uint32_t frames,
+                size_t budget)
+{
+    std::vector<uint64_t> plain, cached;
+    size_t previous = lvglGlyphCacheSetBudget(0);
+    double plainUs = play(display, scene, tick, frames, plain);
+    lvglGlyphCacheSetBudget(budget);
+    lvglGlyphCacheResetStats();
+    double cachedUs = play(display, scene, tick, frames, cached);
+    LvglGlyphCacheStats s = lvglGlyphCacheGetStats();
+    compare(what, plain, cached);
+    CHECK(s.hits > 0 && s.misses > 0);
+    printf("%-26s render %6.1f us/frame without the cache, %6.1f us with it; %lu hits, %lu misses, "
+           "%lu evictions, %lu glyphs in %.1f KB\n",
+           what, plainUs, cachedUs, (unsigned long)s.hits, (unsigned long)s.misses, (unsigned long)s.evictions,
+           (unsigned long)s.entries, s.bytes / 1024.0);
+    lvglGlyphCacheSetBudget(previous);
+}
+
+int main(int argc, char **argv)
+{
+    bool full = argc > 1 && strcmp(argv[1], "full") == 0;
+    uint32_t frames = argc > 2 ? strtoul(argv[2], NULL, 0) : 120;
+    CHECK(frames > 0);
+
+    LilyGo_HostDisplay display(full ? 368 : 536, full ? 194 : 240, full);
+    beginLvglHelper(display);
+    printf("%s, %lu frames\n", full ? "368x194 shadow frame" : "536x240 partial refresh", (unsigned long)frames);
+    run(display, "70 px hh:mm:ss", clock70, tickClock, frames, LVGL_GLYPH_CACHE_SIZE);
+    run(display, "48 px hh:mm:ss", clock48, tickClock, frames, LVGL_GLYPH_CACHE_SIZE);
+    run(display, "dashboard", dashboard, tickDashboard, frames, LVGL_GLYPH_CACHE_SIZE);
+    // Less than two 70 px digits: every letter evicts another
+    run(display, "dashboard, 4 KB budget", dashboard, tickDashboard, frames, 4096);
+    CHECK(lvglGlyphCacheGetStats().evictions > 0);
+
+    lvglGlyphCacheInvalidate(&font_ali_70);
+    lvglGlyphCacheInvalidate(NULL);
+    CHECK(lvglGlyphCacheGetStats().entries == 0 && lvglGlyphCacheGetStats().bytes == 0);
+    lvglHelperSetTouchInterrupt(false);
+    printf("bench_glyph_cache: ok\n");
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file      bench_image_cache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// lvglImageCache on the Lvgl_Images example's seven 368x194 pictures,
+// encoded as PNG at start-up: a slideshow without and with the cache, then
+// three images per frame, zoomed and rotated, with room for two. Frames
+// must be the same with and without the cache; prints the time per frame,
+// hits, misses and bytes. The pictures only come with LV_COLOR_16_SWAP,
+// so this is built with it.
+//
+//   bench_image_cache [partial | full] [frames]
+//
+// "partial" is the 536x240 panel with partial refresh, "full" the 368x194
+// one that refreshes from a shadow frame and so draws in 32-row bands.
+
+#include <string.h>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "lvglImageCache.h"
+#include "HostTest.h"
+
+// lodepng.h declares its C++ API too when included from C++
+extern "C" unsigned lodepng_encode32(unsigned char **out, size_t *outsize, const unsigned char *image,
+                                     unsigned w, unsigned h);
+
+LV_IMG_DECLARE(image_1_368x194);
+LV_IMG_DECLARE(image_2_368x194);
+LV_IMG_DECLARE(image_3_368x194);
+LV_IMG_DECLARE(image_4_368x194);
+LV_IMG_DECLARE(image_5_368x194);
+LV_IMG_DECLARE(image_6_368x194);
+LV_IMG_DECLARE(image_7_368x194);
+
+#define IMAGES  7
+
+static const lv_img_dsc_t *pictures[IMAGES] = {
+    &image_1_368x194, &image_2_368x194, &image_3_368x194, &image_4_368x194,
+    &image_5_368x194, &image_6_368x194, &image_7_368x194,
+};
+static lv_img_dsc_t pngs[IMAGES];
+
+// LV_IMG_CF_TRUE_COLOR_ALPHA to a PNG held by an LV_IMG_CF_RAW_ALPHA
+// descriptor, which LVGL hands to its PNG decoder
+static void encode(const lv_img_dsc_t *picture, lv_img_dsc_t *png)
+{
+    uint32_t pixels = picture->header.w * picture->header.h;
+    std::vector<uint8_t> rgba(pixels * 4);
+    for (uint32_t p = 0; p < pixels; p++) {
+        lv_color_t c;
+        memcpy(&c, picture->data + p * LV_IMG_PX_SIZE_ALPHA_BYTE, sizeof(c));
+        lv_color32_t c32;
+        c32.full = lv_color_to32(c);
+        rgba[p * 4] = c32.ch.red;
+        rgba[p * 4 + 1] = c32.ch.green;
+        rgba[p * 4 + 2] = c32.ch.blue;
+        rgba[p * 4 + 3] = picture->data[p * LV_IMG_PX_SIZE_ALPHA_BYTE + sizeof(c)];
+    }
+    unsigned char *out = NULL;
+    size_t size = 0;
+    CHECK(lodepng_encode32(&out, &size, &rgba[0], picture->header.w, picture->header.h) == 0);
+    memset(png, 0, sizeof(*png));
+    png->header.cf = LV_IMG_CF_RAW_ALPHA;
+    png->header.w = picture->header.w;
+    png->header.h = picture->header.h;
+    png->data = out;
+    png->data_size = size;
+}
+
+static uint64_t frameHash(LilyGo_HostDisplay &display)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint16_t y = 0; y < display.height(); y++) {
+        for (uint16_t x = 0; x < display.width(); x++) {
+            hash = (hash ^ display.getPixel(x, y)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// Returns ms per frame
+static double slideshow(LilyGo_HostDisplay &display, uint32_t frames, std::vector<uint64_t> &hashes)
+{
+    lv_obj_clean(lv_scr_act());
+    lv_obj_t *img = lv_img_create(lv_scr_act());
+    lv_obj_center(img);
+    hashes.clear();
+    uint64_t elapsed = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        lv_img_set_src(img, &pngs[f % IMAGES]);
+        uint64_t start = hostNanos();
+        lv_refr_now(NULL);
+        elapsed += hostNanos() - start;
+        hashes.push_back(frameHash(display));
+    }
+    return elapsed / 1e6 / frames;
+}
+
+// Three images in every frame, one zoomed and one rotated, the whole
+// screen redrawn each time
+static double threeImages(LilyGo_HostDisplay &display, uint32_t frames, std::vector<uint64_t> &hashes)
+{
+    lv_obj_clean(lv_scr_act());
+    for (int i = 0; i < 3; i++) {
+        lv_obj_t *img = lv_img_create(lv_scr_act());
+        lv_img_set_src(img, &pngs[i]);
+        lv_img_set_zoom(img, i == 1 ? 100 : 128);
+        lv_img_set_angle(img, i == 2 ? 150 : 0);
+        lv_obj_align(img, LV_ALIGN_CENTER, (i - 1) * display.width() / 3, 0);
+    }
+    hashes.clear();
+    uint64_t elapsed = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        lv_obj_invalidate(lv_scr_act());
+        uint64_t start = hostNanos();
+        lv_refr_now(NULL);
+        elapsed += hostNanos() - start;
+        hashes.push_back(frameHash(display));
+    }
+    return elapsed / 1e6 / frames;
+}
+
+static void printStats(const char *what, double msPerFrame, uint32_t frames)
+{
+    LvglImageCacheStats s = lvglImageCacheGetStats();
+    if (!s.budget) {
+        // LVGL decodes on every draw and the cache counts nothing
+        printf("%-30s %6.2f ms/frame\n", what, msPerFrame);
+        return;
+    }
+    printf("%-30s %6.2f ms/frame, %4.1f decodes/frame, %lu hits, %lu misses, %lu evictions, "
+           "%lu entries, %.2f MB kept (peak %.2f MB), %.1f ms decoding\n",
+           what, msPerFrame, (double)s.misses / frames, (unsigned long)s.hits, (unsigned long)s.misses,
+           (unsigned long)s.evictions, (unsigned long)s.entries, s.bytes / 1e6, s.peakBytes / 1e6,
+           s.decodeUs / 1e3);
+}
+
+static void compare(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b)
+{
+    CHECK(a.size() == b.size());
+    for (size_t f = 0; f < a.size(); f++) {
+        if (a[f] != b[f]) {
+            fprintf(stderr, "frame %lu differs\n", (unsigned long)f);
+            CHECK(false);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool full = argc > 1 && strcmp(argv[1], "full") == 0;
+    uint32_t frames = argc > 2 ? strtoul(argv[2], NULL, 0) : 70;
+    CHECK(frames >= IMAGES);
+
+    LilyGo_HostDisplay display(full ? 368 : 536, full ? 194 : 240, full);
+    beginLvglHelper(display);
+    size_t pngBytes = 0;
+    for (int i = 0; i < IMAGES; i++) {
+        encode(pictures[i], &pngs[i]);
+        pngBytes += pngs[i].data_size;
+    }
+    printf("%s: %d PNGs, %.2f MB encoded\n", full ? "368x194 shadow frame" : "536x240 partial refresh", IMAGES,
+           pngBytes / 1e6);
+
+    std::vector<uint64_t> uncached, cached;
+    size_t budget = lvglImageCacheSetBudget(0);
+    lvglImageCacheResetStats();
+    printStats("slideshow, no cache", slideshow(display, frames, uncached), frames);
+    lvglImageCacheSetBudget(budget);
+    lvglImageCacheResetStats();
+    printStats("slideshow, cached", slideshow(display, frames, cached), frames);
+    compare(uncached, cached);
+    LvglImageCacheStats s = lvglImageCacheGetStats();
+    // Each picture decoded once
+    CHECK(s.misses == IMAGES && s.entries == IMAGES && s.bytes <= s.budget);
+    uint32_t perImage = s.bytes / s.entries;
+
+    // Dropping a source decodes it again
+    lvglImageCacheInvalidate(&pngs[0]);
+    CHECK(lvglImageCacheGetStats().entries == IMAGES - 1);
+    lvglImageCacheResetStats();
+    slideshow(display, 1, cached);
+    CHECK(lvglImageCacheGetStats().misses == 1);
+
+    uint32_t few = frames / IMAGES;
+    lvglImageCacheSetBudget(0);
+    lvglImageCacheResetStats();
+    printStats("three images, no cache", threeImages(display, few, uncached), few);
+    // Room for two: images drawn this frame stay, so at most the three of
+    // them are decoded per frame, not one per area
+    lvglImageCacheSetBudget(perImage * 5 / 2);
+    lvglImageCacheResetStats();
+    printStats("three images, room for two", threeImages(display, few, cached), few);
+    compare(uncached, cached);
+    CHECK(lvglImageCacheGetStats().misses <= 3 * few);
+    lvglImageCacheSetBudget(budget);
+    lvglImageCacheInvalidate(NULL);
+    lvglImageCacheResetStats();
+    printStats("three images, room for all", threeImages(display, few, cached), few);
+    compare(uncached, cached);
+    CHECK(lvglImageCacheGetStats().misses == 3);
+
+    lvglImageCacheInvalidate(NULL);
+    CHECK(lvglImageCacheGetStats().entries == 0 && lvglImageCacheGetStats().bytes == 0);
+    lvglHelperSetTouchInterrupt(false);
+    printf("bench_image_cache: ok\n");
+    return 0;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file      nwLogo.c
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Stand-in for the startup logo Graphics/Gui.cpp shows, which is not in
+// the repository: a true-colour image of the same kind, filled in by
+// nwLogoFill() before the UI is built.
+
+#include "lvgl.h"
+
+#define LOGO_SIZE 128
+
+static uint8_t nwLogoMap[LOGO_SIZE * LOGO_SIZE * LV_COLOR_SIZE / 8];
+
+const lv_img_dsc_t nwLogo = {
+    .header.cf = LV_IMG_CF_TRUE_COLOR,
+    .header.always_zero = 0,
+    .header.reserved = 0,
+    .header.w = LOGO_SIZE,
+    .header.h = LOGO_SIZE,
+    .data_size = sizeof(nwLogoMap),
+    .data = nwLogoMap,
+};
+
+// A ring over a diagonal gradient, so scaling and fading it is real work
+void nwLogoFill(void)
+{
+    lv_color_t *pixels = (lv_color_t *)nwLogoMap;
+    for (int y = 0; y < LOGO_SIZE; y++) {
+        for (int x = 0; x < LOGO_SIZE; x++) {
+            int dx = x - LOGO_SIZE / 2;
+            int dy = y - LOGO_SIZE / 2;
+            int d2 = dx * dx + dy * dy;
+            int ring = d2 > (LOGO_SIZE * LOGO_SIZE) / 9 && d2 < (LOGO_SIZE * LOGO_SIZE) / 5;
+            pixels[y * LOGO_SIZE + x] = ring ? lv_color_white() : lv_color_make(x * 2, y * 2, 128);
+        }
+    }
+}
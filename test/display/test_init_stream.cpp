@@ -0,0 +1,46 @@
+/**
+ * @file      test_init_stream.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Unpacks each init stream DEFINE_INIT_STREAM builds and checks it command
+// for command against the lcd_cmd_t table it was packed from: the len byte
+// with its delay flags, the command byte and only the parameters it has.
+//
+//   test_init_stream
+
+#include <string.h>
+#include "initSequence.h"
+#include "HostTest.h"
+
+static void checkStream(const char *name, const lcd_init_stream_t &stream, const lcd_cmd_t *table, uint32_t count)
+{
+    const uint8_t *p = stream.data;
+    const uint8_t *end = p + stream.size;
+    uint32_t i = 0;
+    for (; p < end; i++) {
+        CHECK(i < count);
+        const lcd_cmd_t &c = table[i];
+        uint32_t params = c.len & LCD_CMD_PARAM_MASK;
+        CHECK(end - p >= 2 && (uint32_t)(end - p - 2) >= params);
+        CHECK(p[0] == c.len);
+        CHECK(p[1] == c.addr >> 8 && (c.addr & 0xFF) == 0);
+        CHECK(memcmp(p + 2, c.param, params) == 0);
+        p += 2 + params;
+    }
+    CHECK(p == end);
+    CHECK(i == count);
+    printf("%s: %lu commands in %lu bytes\n", name, (unsigned long)count, (unsigned long)stream.size);
+}
+
+int main()
+{
+    checkStream("sh8501", sh8501_init, sh8501_cmd, SH8501_INIT_SEQUENCE_LENGHT);
+    checkStream("rm67162", rm67162_init, rm67162_cmd, RM67162_INIT_SEQUENCE_LENGHT);
+    checkStream("rm690b0", rm690b0_init, rm690b0_cmd, RM690B0_INIT_SEQUENCE_LENGHT);
+    printf("test_init_stream: ok\n");
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file      test_lvgl_alloc.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Builds and draws a screen of widgets through the helper and prints what
+// LVGL keeps in each tier of lvglAlloc. Then checks which tier a block goes
+// to, hints, realloc across tiers, a full pool and the statistics, and
+// prints the cost of small allocations from the pool and the system heap.
+//
+// The host has one kind of memory, so the render time difference between
+// the pool and PSRAM only shows on the board (DISPLAY_BENCHMARK, built with
+// and without -DLVGL_ALLOC_POOL_SIZE=0).
+//
+//   test_lvgl_alloc [rounds]
+
+#include <string.h>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "lvglAlloc.h"
+#include "HostTest.h"
+
+static LvglAllocStats stats()
+{
+    LvglAllocStats s;
+    lvglAllocGetStats(&s);
+    return s;
+}
+
+static void testTiers()
+{
+    LvglAllocStats before = stats();
+    void *small = lvglAlloc(64);
+    void *large = lvglAlloc(LVGL_ALLOC_SMALL_MAX + 1);
+    CHECK(small && large);
+    LvglAllocStats after = stats();
+    CHECK(after.poolSize == LVGL_ALLOC_POOL_SIZE);
+    CHECK(after.poolAllocs == before.poolAllocs + 1 && after.psramAllocs == before.psramAllocs + 1);
+    CHECK(after.poolUsed >= before.poolUsed + 64 && after.psramUsed > before.psramUsed + LVGL_ALLOC_SMALL_MAX);
+
+    // Hints override the size
+    LvglAllocHint previous = lvglAllocSetHint(LVGL_ALLOC_PSRAM);
+    CHECK(previous == LVGL_ALLOC_AUTO);
+    void *hintedPsram = lvglAlloc(64);
+    lvglAllocSetHint(LVGL_ALLOC_INTERNAL);
+    void *hintedPool = lvglAlloc(LVGL_ALLOC_SMALL_MAX * 2);
+    CHECK(lvglAllocSetHint(LVGL_ALLOC_AUTO) == LVGL_ALLOC_INTERNAL);
+    LvglAllocStats hinted = stats();
+    CHECK(hinted.psramAllocs == after.psramAllocs + 1 && hinted.poolAllocs == after.poolAllocs + 1);
+
+    // A pool block that outgrows the pool moves to PSRAM with its contents
+    memset(small, 0x5A, 64);
+    uint8_t *grown = (uint8_t *)lvglRealloc(small, LVGL_ALLOC_SMALL_MAX * 4);
+    CHECK(grown);
+    for (int i = 0; i < 64; i++) {
+        CHECK(grown[i] == 0x5A);
+    }
+    LvglAllocStats moved = stats();
+    CHECK(moved.psramAllocs == hinted.psramAllocs + 1);
+    CHECK(moved.poolUsed < hinted.poolUsed);
+    // ... and one shrunk in PSRAM stays there
+    grown = (uint8_t *)lvglRealloc(grown, 32);
+    CHECK(grown && grown[31] == 0x5A);
+    CHECK(stats().poolAllocs == moved.poolAllocs);
+
+    lvglFree(grown);
+    lvglFree(large);
+    lvglFree(hintedPsram);
+    lvglFree(hintedPool);
+    lvglFree(NULL);
+    LvglAllocStats freed = stats();
+    CHECK(freed.poolUsed == before.poolUsed && freed.psramUsed == before.psramUsed);
+}
+
+// Once the pool is full small blocks fall back to PSRAM; freeing every
+// other block fragments it, freeing the rest joins it up again
+static void testFullPool()
+{
+    LvglAllocStats before = stats();
+    std::vector<void *> blocks;
+    while (stats().fallbacks == before.fallbacks) {
+        void *ptr = lvglAlloc(256);
+        CHECK(ptr);
+        blocks.push_back(ptr);
+    }
+    LvglAllocStats full = stats();
+    CHECK(full.psramAllocs == before.psramAllocs + 1);
+    CHECK(full.poolLargestFree < 256 && full.poolPeak >= full.poolUsed);
+    CHECK(blocks.size() > LVGL_ALLOC_POOL_SIZE / 256 / 2);
+
+    for (size_t i = 0; i + 1 < blocks.size(); i += 2) {
+        lvglFree(blocks[i]);
+        blocks[i] = NULL;
+    }
+    LvglAllocStats holes = stats();
+    CHECK(holes.poolFreeBlocks > 10 && holes.poolFragmentation > 50);
+    CHECK(holes.poolUsed < full.poolUsed);
+    printf("pool full after %lu blocks of 256 bytes; every other one freed: %lu bytes free in %lu blocks, "
+           "largest %lu, %u%% fragmented\n",
+           (unsigned long)blocks.size() - 1, (unsigned long)holes.poolFree, (unsigned long)holes.poolFreeBlocks,
+           (unsigned long)holes.poolLargestFree, holes.poolFragmentation);
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        lvglFree(blocks[i]);
+    }
+    LvglAllocStats empty = stats();
+    CHECK(empty.poolUsed == before.poolUsed && empty.psramUsed == before.psramUsed);
+    CHECK(empty.poolFreeBlocks <= before.poolFreeBlocks);
+}
+
+// Small blocks in LVGL's pattern: many live at once, freed out of order
+static double churn(LvglAllocHint hint, uint32_t rounds)
+{
+    LvglAllocHint previous = lvglAllocSetHint(hint);
+    void *live[64] = {NULL};
+    uint64_t seed = 7;
+    uint64_t start = hostNanos();
+    for (uint32_t i = 0; i < rounds; i++) {
+        uint32_t r = hostRandom(seed);
+        uint32_t slot = r % 64;
+        lvglFree(live[slot]);
+        live[slot] = lvglAlloc(16 + (r >> 8) % 240);
+    }
+    uint64_t elapsed = hostNanos() - start;
+    for (int i = 0; i < 64; i++) {
+        lvglFree(live[i]);
+    }
+    lvglAllocSetHint(previous);
+    return (double)elapsed / rounds;
+}
+
+static void printStats(const char *what)
+{
+    LvglAllocStats s = stats();
+    printf("%s: pool %lu/%lu bytes peak %lu, free %lu largest %lu, %u%% fragmented; psram %lu bytes peak %lu; "
+           "%lu pool, %lu psram allocations, %lu fallbacks\n",
+           what, (unsigned long)s.poolUsed, (unsigned long)s.poolSize, (unsigned long)s.poolPeak,
+           (unsigned long)s.poolFree, (unsigned long)s.poolLargestFree, s.poolFragmentation,
+           (unsigned long)s.psramUsed, (unsigned long)s.psramPeak, (unsigned long)s.poolAllocs,
+           (unsigned long)s.psramAllocs, (unsigned long)s.fallbacks);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t rounds = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    LilyGo_HostDisplay display(536, 240);
+    beginLvglHelper(display);
+    printStats("after lv_init");
+    lv_obj_t *tiles = lv_tileview_create(lv_scr_act());
+    for (int t = 0; t < 4; t++) {
+        lv_obj_t *tile = lv_tileview_add_tile(tiles, t, 0, LV_DIR_HOR);
+        lv_obj_set_flex_flow(tile, LV_FLEX_FLOW_ROW_WRAP);
+        for (int i = 0; i < 12; i++) {
+            lv_obj_t *button = lv_btn_create(tile);
+            lv_label_set_text_fmt(lv_label_create(button), "Tile %d #%d", t, i);
+        }
+        lv_slider_create(tile);
+        lv_chart_set_point_count(lv_chart_create(tile), 64);
+    }
+    for (int t = 0; t < 4; t++) {
+        lv_obj_set_tile_id(tiles, t, 0, LV_ANIM_OFF);
+        lv_refr_now(NULL);
+    }
+    printStats("four tiles of widgets drawn");
+    CHECK(stats().poolAllocs > 0);
+    lv_obj_del(tiles);
+    lv_refr_now(NULL);
+    printStats("tiles deleted");
+
+    testTiers();
+    testFullPool();
+
+    double pool = churn(LVGL_ALLOC_AUTO, rounds);
+    double heap = churn(LVGL_ALLOC_PSRAM, rounds);
+    printf("small block alloc+free: pool %.0f ns, system heap %.0f ns\n", pool, heap);
+
+    lvglHelperSetTouchInterrupt(false);
+    printf("test_lvgl_alloc: ok\n");
+    return 0;
+}
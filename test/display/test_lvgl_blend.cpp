@@ -0,0 +1,203 @@
+/**
+ * @file      test_lvgl_blend.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// The portable blend backend against lv_draw_sw_blend_basic(), to the bit:
+// random blends with offsets, clipping, masks, opa values and modes, then
+// every destination colour under each kernel. Prints Mpixel/s per
+// operation for both. Built twice, with LV_COLOR_16_SWAP 0 and 1.
+//
+//   test_lvgl_blend [blends] [benchmark rounds]
+
+#include <string.h>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "lvglBlend.h"
+#include "HostTest.h"
+
+static lv_draw_sw_ctx_t ctx;
+static uint64_t seed = 1;
+
+static uint32_t random(uint32_t range)
+{
+    return hostRandom(seed) % range;
+}
+
+// Opa values where LVGL's rounding has edges, or any other
+static lv_opa_t randomOpa()
+{
+    static const lv_opa_t edges[] = {0, 1, 2, 127, 128, 251, 252, 253, 254, 255};
+    return random(2) ? edges[random(sizeof(edges))] : (lv_opa_t)random(256);
+}
+
+static lv_color_t randomColor()
+{
+    lv_color_t c;
+    c.full = (uint16_t)random(3) == 0 ? (random(2) ? 0x0000 : 0xFFFF) : (uint16_t)random(0x10000);
+    return c;
+}
+
+// Runs `dsc` over `buffer` (covering `bufArea`, clipped to `clip`) once with
+// LVGL's code and once with the backend; true if they agree
+static bool blendBoth(std::vector<lv_color_t> &buffer, lv_area_t &bufArea, const lv_area_t &clip,
+                      const lv_draw_sw_blend_dsc_t &dsc, std::vector<lv_color_t> &expected)
+{
+    expected = buffer;
+    ctx.base_draw.buf_area = &bufArea;
+    ctx.base_draw.clip_area = &clip;
+
+    ctx.base_draw.buf = &expected[0];
+    lv_draw_sw_blend_basic(&ctx.base_draw, &dsc);
+
+    ctx.base_draw.buf = &buffer[0];
+    lvglBlendSetBackend(&lvglBlendPortable);
+    ctx.blend(&ctx.base_draw, &dsc);
+    lvglBlendSetBackend(NULL);
+    return memcmp(&buffer[0], &expected[0], buffer.size() * sizeof(lv_color_t)) == 0;
+}
+
+static void testRandom(uint32_t blends)
+{
+    static const lv_blend_mode_t modes[] = {LV_BLEND_MODE_NORMAL, LV_BLEND_MODE_NORMAL, LV_BLEND_MODE_ADDITIVE,
+                                            LV_BLEND_MODE_SUBTRACTIVE, LV_BLEND_MODE_MULTIPLY};
+    std::vector<lv_color_t> buffer, expected, src;
+    std::vector<lv_opa_t> mask;
+    for (uint32_t n = 0; n < blends; n++) {
+        lv_area_t bufArea;
+        bufArea.x1 = random(64);
+        bufArea.y1 = random(64);
+        bufArea.x2 = bufArea.x1 + random(70);
+        bufArea.y2 = bufArea.y1 + random(20);
+        lv_area_t clip;
+        clip.x1 = bufArea.x1 + random(4);
+        clip.y1 = bufArea.y1 + random(2);
+        clip.x2 = bufArea.x2 - random(4);
+        clip.y2 = bufArea.y2 - random(2);
+        lv_area_t blendArea;
+        blendArea.x1 = bufArea.x1 - 4 + random(lv_area_get_width(&bufArea) + 4);
+        blendArea.y1 = bufArea.y1 - 2 + random(lv_area_get_height(&bufArea) + 2);
+        blendArea.x2 = blendArea.x1 + random(80);
+        blendArea.y2 = blendArea.y1 + random(24);
+
+        buffer.resize(lv_area_get_size(&bufArea));
+        for (size_t i = 0; i < buffer.size(); i++) {
+            buffer[i] = randomColor();
+        }
+        size_t size = lv_area_get_size(&blendArea);
+        src.resize(size);
+        mask.resize(size);
+        // Masks come in runs, as along a shape's edge
+        lv_opa_t run = 0;
+        for (size_t i = 0; i < size; i++) {
+            src[i] = randomColor();
+            if (random(8) == 0) {
+                run = random(3) == 0 ? (lv_opa_t)random(256) : random(2) ? LV_OPA_COVER : LV_OPA_TRANSP;
+            }
+            mask[i] = run == LV_OPA_COVER || run == LV_OPA_TRANSP ? run : (lv_opa_t)random(256);
+        }
+
+        lv_draw_sw_blend_dsc_t dsc;
+        memset(&dsc, 0, sizeof(dsc));
+        dsc.blend_area = &blendArea;
+        dsc.mask_area = &blendArea;
+        dsc.color = randomColor();
+        dsc.opa = randomOpa();
+        dsc.blend_mode = modes[random(sizeof(modes) / sizeof(modes[0]))];
+        dsc.src_buf = random(2) ? &src[0] : NULL;
+        dsc.mask_buf = random(3) ? &mask[0] : NULL;
+        dsc.mask_res = dsc.mask_buf ? (random(8) ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER)
+                                    : LV_DRAW_MASK_RES_FULL_COVER;
+        if (!blendBoth(buffer, bufArea, clip, dsc, expected)) {
+            fprintf(stderr, "blend %lu differs: mode %d opa %u %s %s\n", (unsigned long)n, dsc.blend_mode, dsc.opa,
+                    dsc.src_buf ? "map" : "fill", dsc.mask_buf ? "masked" : "");
+            CHECK(false);
+        }
+    }
+    printf("%lu random blends match\n", (unsigned long)blends);
+}
+
+// Every RGB565 value as the destination, one per pixel of a 256x256 area,
+// under each kernel with the mask running through all 256 levels
+static void testEveryColor()
+{
+    lv_area_t area = {0, 0, 255, 255};
+    std::vector<lv_color_t> buffer(65536), background(65536), expected, src(65536);
+    std::vector<lv_opa_t> mask(65536);
+    for (uint32_t i = 0; i < 65536; i++) {
+        background[i].full = (uint16_t)i;
+        src[i].full = (uint16_t)(i * 40503u);
+        mask[i] = (lv_opa_t)(i * 7);
+    }
+    static const lv_opa_t opas[] = {1, 64, 127, 128, 200, 252, 255};
+    static const lv_blend_mode_t modes[] = {LV_BLEND_MODE_NORMAL, LV_BLEND_MODE_ADDITIVE,
+                                            LV_BLEND_MODE_SUBTRACTIVE, LV_BLEND_MODE_MULTIPLY};
+    static const uint16_t colors[] = {0x0000, 0xFFFF, 0x1234, 0xF81F, 0x07E0};
+    uint32_t sweeps = 0;
+    for (size_t o = 0; o < sizeof(opas); o++) {
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            for (int kind = 0; kind < 4; kind++) {
+                bool map = kind & 1, masked = kind & 2;
+                if (map && modes[m] != LV_BLEND_MODE_NORMAL) {
+                    continue;
+                }
+                for (size_t c = 0; c < (map ? 1 : sizeof(colors) / sizeof(colors[0])); c++) {
+                    lv_draw_sw_blend_dsc_t dsc;
+                    memset(&dsc, 0, sizeof(dsc));
+                    dsc.blend_area = &area;
+                    dsc.mask_area = &area;
+                    dsc.color.full = colors[c];
+                    dsc.opa = opas[o];
+                    dsc.blend_mode = modes[m];
+                    dsc.src_buf = map ? &src[0] : NULL;
+                    dsc.mask_buf = masked ? &mask[0] : NULL;
+                    dsc.mask_res = masked ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER;
+                    buffer = background;
+                    if (!blendBoth(buffer, area, area, dsc, expected)) {
+                        fprintf(stderr, "sweep differs: mode %d opa %u colour %04x %s %s\n", dsc.blend_mode,
+                                dsc.opa, colors[c], map ? "map" : "fill", masked ? "masked" : "");
+                        CHECK(false);
+                    }
+                    sweeps++;
+                }
+            }
+        }
+    }
+    printf("%lu sweeps over every destination colour match\n", (unsigned long)sweeps);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t blends = argc > 1 ? strtoul(argv[1], NULL, 0) : 200000;
+    uint32_t rounds = argc > 2 ? strtoul(argv[2], NULL, 0) : 200;
+
+    LilyGo_HostDisplay display(536, 240);
+    beginLvglHelper(display);
+    lv_disp_t *disp = lv_disp_get_default();
+    memset(&ctx, 0, sizeof(ctx));
+    lvglBlendInitCtx(disp->driver, &ctx.base_draw);
+    const LvglBlendBackend *installed = lvglBlendSetBackend(NULL);
+    _lv_refr_set_disp_refreshing(disp);
+
+    printf("LV_COLOR_16_SWAP %d\n", LV_COLOR_16_SWAP);
+    testRandom(blends);
+    testEveryColor();
+    _lv_refr_set_disp_refreshing(NULL);
+
+    for (int op = 0; op < LVGL_BLEND_OP_COUNT; op++) {
+        float lvgl = lvglBlendMeasure(NULL, (LvglBlendOp)op, 240, 60, rounds);
+        float portable = lvglBlendMeasure(&lvglBlendPortable, (LvglBlendOp)op, 240, 60, rounds);
+        CHECK(lvgl > 0 && portable > 0);
+        printf("%-14s lvgl %7.1f Mpixel/s, %s %7.1f Mpixel/s\n", lvglBlendOpName((LvglBlendOp)op), lvgl,
+               lvglBlendPortable.name, portable);
+    }
+
+    lvglBlendSetBackend(installed);
+    lvglHelperSetTouchInterrupt(false);
+    printf("test_lvgl_blend: ok\n");
+    return 0;
+}
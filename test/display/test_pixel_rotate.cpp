@@ -0,0 +1,155 @@
+/**
+ * @file      test_pixel_rotate.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// rotatePixels() against a pixel-at-a-time reference for every size up to
+// 40x40, each rotation, band split, stride, alignment and byte order; then
+// a 1.47" frame through it and through the loop pushColors() used to run,
+// in Mpixel/s.
+//
+//   test_pixel_rotate [frames]
+
+#include <string.h>
+#include <vector>
+#include "pixelRotate.h"
+#include "HostTest.h"
+
+static uint16_t referencePixel(const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height,
+                               uint8_t rotation, uint16_t row, uint16_t col)
+{
+    switch (rotation) {
+    case PIXEL_ROTATE_90:
+        return src[(height - 1 - col) * stride + row];
+    case PIXEL_ROTATE_180:
+        return src[(height - 1 - row) * stride + (width - 1 - col)];
+    case PIXEL_ROTATE_270:
+        return src[col * stride + (width - 1 - row)];
+    default:
+        return src[row * stride + col];
+    }
+}
+
+static void checkOne(const uint16_t *src, uint16_t stride, uint16_t width, uint16_t height, uint8_t rotation,
+                     uint16_t band, bool swapBytes, uint16_t *dst)
+{
+    uint16_t outWidth = rotatedWidth(width, height, rotation);
+    uint16_t outHeight = rotatedHeight(width, height, rotation);
+    for (uint16_t first = 0; first < outHeight; first += band) {
+        uint16_t rows = outHeight - first < band ? outHeight - first : band;
+        // A guard pixel after the band catches overruns
+        dst[rows * outWidth] = 0xdead;
+        rotatePixels(dst, src, stride, width, height, rotation, first, rows, swapBytes);
+        CHECK(dst[rows * outWidth] == 0xdead);
+        for (uint16_t r = 0; r < rows; r++) {
+            for (uint16_t c = 0; c < outWidth; c++) {
+                uint16_t want = referencePixel(src, stride, width, height, rotation, first + r, c);
+                if (swapBytes) {
+                    want = (uint16_t)((want >> 8) | (want << 8));
+                }
+                CHECK(dst[r * outWidth + c] == want);
+            }
+        }
+    }
+}
+
+static void testAgainstReference()
+{
+    const uint16_t limit = 40;
+    // One spare pixel in front of each buffer, to try odd addresses
+    std::vector<uint16_t> source((limit + 3) * limit + 2);
+    std::vector<uint16_t> output(limit * limit + 2);
+    for (size_t i = 0; i < source.size(); i++) {
+        source[i] = (uint16_t)(i * 2654435761u >> 7);
+    }
+    uint32_t cases = 0;
+    for (uint16_t width = 1; width <= limit; width++) {
+        for (uint16_t height = 1; height <= limit; height++) {
+            for (uint8_t rotation = 0; rotation < 4; rotation++) {
+                static const uint16_t bands[] = {1, 3, 16, 0xFFFF};
+                for (size_t b = 0; b < sizeof(bands) / sizeof(bands[0]); b++) {
+                    uint16_t pad = (uint16_t)((width + height + b) % 4);
+                    uint16_t srcShift = (uint16_t)(b & 1);
+                    uint16_t dstShift = (uint16_t)((width ^ height) & 1);
+                    checkOne(&source[srcShift], width + pad, width, height, rotation, bands[b], b == 2,
+                             &output[dstShift]);
+                    cases++;
+                }
+            }
+        }
+    }
+    printf("%lu rotations match the reference\n", (unsigned long)cases);
+}
+
+// What LilyGo_AMOLED::pushColors() did on the 1.47" board before
+// rotatePixels(): a 90 degree turn, one pixel at a time
+static void oldLoop(uint16_t *pBuffer, const uint16_t *p, uint16_t width, uint16_t hight)
+{
+    uint32_t cum = 0;
+    for (uint16_t j = 0; j < width; j++) {
+        for (uint16_t i = 0; i < hight; i++) {
+            pBuffer[cum] = ((uint16_t)p[width * (hight - i - 1) + j]);
+            cum++;
+        }
+    }
+}
+
+static void benchmark(uint32_t frames)
+{
+    // The 1.47" panel is 194 x 368 and the UI draws it turned, as 368 x 194
+    const uint16_t width = 368;
+    const uint16_t height = 194;
+    // Rows per band of the driver's 16 KB DMA buffers
+    const uint16_t band = 16384 / 2 / height;
+    std::vector<uint16_t> src((size_t)width * height);
+    std::vector<uint16_t> old((size_t)width * height);
+    std::vector<uint16_t> tiled((size_t)width * height);
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = (uint16_t)(i * 40503u);
+    }
+
+    uint64_t start = hostNanos();
+    for (uint32_t f = 0; f < frames; f++) {
+        oldLoop(&old[0], &src[0], width, height);
+    }
+    uint64_t oldNanos = hostNanos() - start;
+
+    start = hostNanos();
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint16_t first = 0; first < width; first += band) {
+            uint16_t rows = width - first < band ? width - first : band;
+            rotatePixels(&tiled[(size_t)first * height], &src[0], width, width, height, PIXEL_ROTATE_90, first,
+                         rows, false);
+        }
+    }
+    uint64_t tiledNanos = hostNanos() - start;
+    CHECK(memcmp(&old[0], &tiled[0], old.size() * 2) == 0);
+
+    start = hostNanos();
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint16_t first = 0; first < width; first += band) {
+            uint16_t rows = width - first < band ? width - first : band;
+            rotatePixels(&tiled[(size_t)first * height], &src[0], width, width, height, PIXEL_ROTATE_90, first,
+                         rows, true);
+        }
+    }
+    uint64_t swapNanos = hostNanos() - start;
+
+    double pixels = (double)width * height * frames;
+    printf("%ux%u, 90 degrees: old loop %.0f Mpixel/s, rotatePixels %.0f Mpixel/s (%.1fx), "
+           "with byte swap %.0f Mpixel/s\n",
+           width, height, pixels * 1000.0 / oldNanos, pixels * 1000.0 / tiledNanos,
+           (double)oldNanos / tiledNanos, pixels * 1000.0 / swapNanos);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000;
+    testAgainstReference();
+    benchmark(frames);
+    printf("test_pixel_rotate: ok\n");
+    return 0;
+}
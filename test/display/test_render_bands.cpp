@@ -0,0 +1,212 @@
+/**
+ * @file      test_render_bands.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// LVGL with LV_USE_REFR_BANDS: a four-tile tileview with text, shadows,
+// gradients, arcs, icons (rotated and translucent), a PNG, spans, a chart
+// and a colour wheel, played with 1, 2 and 4 bands. Every frame must hash
+// the same whatever the band count; prints LVGL's render time per frame
+// for each, which only drops with bands on a host with more than one CPU.
+// Configure with -DHOST_SANITIZE=thread to run the bands under
+// ThreadSanitizer.
+//
+//   test_render_bands [frames]
+
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "lvglBands.h"
+#include "lvglImageCache.h"
+#include "lvglGlyphCache.h"
+#include "HostTest.h"
+
+// lodepng.h declares its C++ API too when included from C++
+extern "C" unsigned lodepng_encode32(unsigned char **out, size_t *outsize, const unsigned char *image,
+                                     unsigned w, unsigned h);
+
+LV_IMG_DECLARE(icon_cpu);
+LV_IMG_DECLARE(icon_ram);
+LV_IMG_DECLARE(icon_battery);
+LV_IMG_DECLARE(icon_usb);
+
+static lv_img_dsc_t png;
+
+// icon_cpu as a PNG, for the decoder and the image cache
+static void encodeIcon()
+{
+    uint32_t pixels = icon_cpu.header.w * icon_cpu.header.h;
+    std::vector<uint8_t> rgba(pixels * 4);
+    for (uint32_t p = 0; p < pixels; p++) {
+        lv_color_t c;
+        memcpy(&c, icon_cpu.data + p * LV_IMG_PX_SIZE_ALPHA_BYTE, sizeof(c));
+        lv_color32_t c32;
+        c32.full = lv_color_to32(c);
+        rgba[p * 4] = c32.ch.red;
+        rgba[p * 4 + 1] = c32.ch.green;
+        rgba[p * 4 + 2] = c32.ch.blue;
+        rgba[p * 4 + 3] = icon_cpu.data[p * LV_IMG_PX_SIZE_ALPHA_BYTE + sizeof(c)];
+    }
+    unsigned char *out = NULL;
+    size_t size = 0;
+    CHECK(lodepng_encode32(&out, &size, &rgba[0], icon_cpu.header.w, icon_cpu.header.h) == 0);
+    png.header.cf = LV_IMG_CF_RAW_ALPHA;
+    png.header.w = icon_cpu.header.w;
+    png.header.h = icon_cpu.header.h;
+    png.data = out;
+    png.data_size = size;
+}
+
+static uint64_t frameHash(LilyGo_HostDisplay &display)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint16_t y = 0; y < display.height(); y++) {
+        for (uint16_t x = 0; x < display.width(); x++) {
+            hash = (hash ^ display.getPixel(x, y)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+static lv_obj_t *tileview;
+static lv_obj_t *clocks[4];
+static lv_obj_t *charts[4];
+static lv_chart_series_t *series[4];
+
+static void buildScreen()
+{
+    static const lv_img_dsc_t *icons[4] = {&icon_cpu, &icon_ram, &icon_battery, &icon_usb};
+    lv_obj_clean(lv_scr_act());
+    tileview = lv_tileview_create(lv_scr_act());
+    for (int i = 0; i < 4; i++) {
+        lv_obj_t *tile = lv_tileview_add_tile(tileview, i, 0, LV_DIR_HOR);
+        lv_obj_set_style_bg_color(tile, lv_color_hex(0x102030 * (i + 1)), 0);
+        lv_obj_set_style_bg_opa(tile, LV_OPA_COVER, 0);
+
+        lv_obj_t *spans = lv_spangroup_create(tile);
+        lv_obj_set_width(spans, 300);
+        lv_spangroup_set_mode(spans, LV_SPAN_MODE_BREAK);
+        lv_obj_align(spans, LV_ALIGN_TOP_MID, 0, 4);
+        for (int k = 0; k < 3; k++) {
+            lv_span_t *span = lv_spangroup_new_span(spans);
+            lv_span_set_text(span, k ? "spans across bands, " : "The quick brown fox ");
+            lv_style_set_text_color(&span->style, lv_color_hex(0x20FF40 * (k + 1)));
+        }
+
+        clocks[i] = lv_label_create(tile);
+        lv_obj_set_style_text_font(clocks[i], &lv_font_montserrat_48, 0);
+        lv_obj_align(clocks[i], LV_ALIGN_TOP_LEFT, 10, 40);
+
+        lv_obj_t *button = lv_btn_create(tile);
+        lv_obj_set_size(button, 140, 50);
+        lv_obj_align(button, LV_ALIGN_BOTTOM_MID, 0, -10);
+        lv_obj_set_style_shadow_width(button, 20, 0);
+        lv_obj_set_style_bg_grad_color(button, lv_color_hex(0xFF8000), 0);
+        lv_obj_set_style_bg_grad_dir(button, LV_GRAD_DIR_VER, 0);
+
+        lv_obj_t *arc = lv_arc_create(tile);
+        lv_obj_set_size(arc, 100, 100);
+        lv_obj_align(arc, LV_ALIGN_LEFT_MID, 20, 20);
+        lv_arc_set_value(arc, 30 + i * 20);
+
+        for (int k = 0; k < 4; k++) {
+            lv_obj_t *img = lv_img_create(tile);
+            lv_img_set_src(img, icons[(i + k) % 4]);
+            lv_obj_align(img, LV_ALIGN_RIGHT_MID, -10 - k * 70, -30);
+            lv_obj_set_style_img_opa(img, k == 3 ? LV_OPA_50 : LV_OPA_COVER, 0);
+            if (k == 2) {
+                lv_img_set_angle(img, 150);
+            }
+        }
+        lv_obj_t *img = lv_img_create(tile);
+        lv_img_set_src(img, &png);
+        lv_img_set_zoom(img, 300);
+        lv_obj_align(img, LV_ALIGN_CENTER, 0, 20);
+
+        lv_obj_t *glass = lv_obj_create(tile);
+        lv_obj_set_size(glass, 120, 60);
+        lv_obj_align(glass, LV_ALIGN_CENTER, 40, 30);
+        lv_obj_set_style_bg_opa(glass, LV_OPA_40, 0);
+        lv_obj_set_style_radius(glass, 15, 0);
+
+        charts[i] = lv_chart_create(tile);
+        lv_obj_set_size(charts[i], 100, 70);
+        lv_obj_align(charts[i], LV_ALIGN_BOTTOM_LEFT, 10, -10);
+        series[i] = lv_chart_add_series(charts[i], lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
+
+        lv_obj_t *wheel = lv_colorwheel_create(tile, true);
+        lv_obj_set_size(wheel, 90, 90);
+        lv_obj_align(wheel, LV_ALIGN_BOTTOM_RIGHT, -10, -10);
+    }
+}
+
+// Returns LVGL's mean render time per frame in microseconds
+static double play(LilyGo_HostDisplay &display, uint32_t frames, std::vector<uint64_t> &hashes)
+{
+    buildScreen();
+    lv_refr_now(NULL);
+    hashes.clear();
+    uint64_t renderUs = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        int tile = (f / 10) % 4;
+        if (f % 10 == 0) {
+            lv_obj_set_tile_id(tileview, tile, 0, LV_ANIM_OFF);
+        }
+        lv_label_set_text_fmt(clocks[tile], "12:%02lu", (unsigned long)(f % 60));
+        lv_chart_set_next_value(charts[tile], series[tile], (f * 37) % 100);
+        if (f % 5 == 0) {
+            lv_obj_invalidate(lv_scr_act());
+        }
+        lv_refr_now(NULL);
+        hashes.push_back(frameHash(display));
+        LvglFrameStats history[64];
+        uint16_t count = lvglHelperGetFrameHistory(history, 64);
+        CHECK(count > 0);
+        renderUs += history[count - 1].renderUs;
+    }
+    return (double)renderUs / frames;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 80;
+
+    LilyGo_HostDisplay display(536, 240);
+    beginLvglHelper(display);
+    encodeIcon();
+    printf("%u CPUs, %lu frames\n", std::thread::hardware_concurrency(), (unsigned long)frames);
+
+    std::vector<uint64_t> single, banded;
+    static const uint32_t counts[] = {1, 2, 4};
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        CHECK(lvglHelperSetRenderBands(counts[c]) == counts[c]);
+        lvglBandsResetStats();
+        double renderUs = play(display, frames, c ? banded : single);
+        LvglBandsStats stats = lvglBandsGetStats();
+        printf("%lu band(s): render %.1f us/frame, %lu parts in bands, %.1f ms waiting for the other bands\n",
+               (unsigned long)counts[c], renderUs, (unsigned long)stats.parts, stats.waitUs / 1e3);
+        if (c) {
+            CHECK(stats.parts > 0);
+            CHECK(banded.size() == single.size());
+            for (uint32_t f = 0; f < frames; f++) {
+                if (banded[f] != single[f]) {
+                    fprintf(stderr, "%lu bands: frame %lu differs\n", (unsigned long)counts[c], (unsigned long)f);
+                    CHECK(false);
+                }
+            }
+        }
+    }
+    LvglImageCacheStats images = lvglImageCacheGetStats();
+    LvglGlyphCacheStats glyphs = lvglGlyphCacheGetStats();
+    CHECK(images.hits > 0 && glyphs.hits > 0);
+
+    lvglHelperSetRenderBands(1);
+    lvglHelperSetTouchInterrupt(false);
+    printf("test_render_bands: ok\n");
+    return 0;
+}
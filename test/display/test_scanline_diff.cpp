@@ -0,0 +1,202 @@
+/**
+ * @file      test_scanline_diff.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// diffScanlines() and mergeScanlines() against a brute-force comparison,
+// then the LVGL helper's diff stage against pass-through: the same scripted
+// frames must leave the same pixels on the panel, for fewer bytes.
+//
+//   test_scanline_diff [partial | full] [frames]
+//
+// "partial" is the 1.91" panel with partial refresh, "full" the 1.47" one
+// that refreshes from a shadow frame.
+
+#include <string.h>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "scanlineDiff.h"
+#include "HostTest.h"
+
+static void testKernels()
+{
+    uint64_t seed = 3;
+    const uint16_t stride = 80;
+    std::vector<uint16_t> shadow(stride * 64);
+    std::vector<uint16_t> before;
+    std::vector<uint16_t> src;
+    std::vector<DiffSpan> spans(64);
+    std::vector<DiffRect> rects(64);
+    for (uint32_t round = 0; round < 20000; round++) {
+        uint16_t width = 1 + hostRandom(seed) % 72;
+        uint16_t height = 1 + hostRandom(seed) % 64;
+        uint16_t x0 = hostRandom(seed) % (stride - width + 1);
+        uint8_t align = (hostRandom(seed) & 1) ? 2 : 1;
+        for (size_t i = 0; i < shadow.size(); i++) {
+            shadow[i] = (uint16_t)hostRandom(seed);
+        }
+        before = shadow;
+        // The shadow's block, with a few pixels or rows changed
+        src.resize((size_t)width * height);
+        for (uint16_t y = 0; y < height; y++) {
+            memcpy(&src[(size_t)y * width], &shadow[(size_t)y * stride + x0], width * 2);
+        }
+        uint32_t changes = hostRandom(seed) % 8;
+        for (uint32_t c = 0; c < changes; c++) {
+            src[hostRandom(seed) % src.size()] ^= 1 + (hostRandom(seed) & 0x7FFF);
+        }
+
+        uint16_t changed = diffScanlines(&shadow[x0], stride, &src[0], width, height, &spans[0]);
+        uint16_t expected = 0;
+        for (uint16_t y = 0; y < height; y++) {
+            int first = -1, last = -1;
+            for (uint16_t x = 0; x < width; x++) {
+                if (src[(size_t)y * width + x] != before[(size_t)y * stride + x0 + x]) {
+                    first = first < 0 ? x : first;
+                    last = x;
+                }
+                // The shadow now holds the block, and nothing outside it moved
+                CHECK(shadow[(size_t)y * stride + x0 + x] == src[(size_t)y * width + x]);
+            }
+            for (uint16_t x = 0; x < stride; x++) {
+                if (x < x0 || x >= x0 + width) {
+                    CHECK(shadow[(size_t)y * stride + x] == before[(size_t)y * stride + x]);
+                }
+            }
+            if (first < 0) {
+                CHECK(spans[y].first > spans[y].last);
+            } else {
+                CHECK(spans[y].first == first && spans[y].last == last);
+                expected++;
+            }
+        }
+        CHECK(changed == expected);
+
+        // Every changed pixel is inside exactly one aligned rectangle
+        uint16_t count = mergeScanlines(&spans[0], width, height, align, &rects[0]);
+        CHECK(count <= (height + 1) / 2);
+        CHECK((count == 0) == (changed == 0));
+        for (uint16_t r = 0; r < count; r++) {
+            const DiffRect &rect = rects[r];
+            CHECK(rect.w > 0 && rect.h > 0 && rect.x + rect.w <= width && rect.y + rect.h <= height);
+            if (align == 2) {
+                CHECK(rect.x % 2 == 0 && (rect.w % 2 == 0 || rect.x + rect.w == width));
+                CHECK(rect.y % 2 == 0 && (rect.h % 2 == 0 || rect.y + rect.h == height));
+            }
+            for (uint16_t o = 0; o < r; o++) {
+                CHECK(rects[o].y + rects[o].h <= rect.y);
+            }
+        }
+        for (uint16_t y = 0; y < height; y++) {
+            for (uint16_t x = 0; x < width; x++) {
+                if (src[(size_t)y * width + x] == before[(size_t)y * stride + x0 + x]) {
+                    continue;
+                }
+                bool covered = false;
+                for (uint16_t r = 0; r < count; r++) {
+                    covered |= x >= rects[r].x && x < rects[r].x + rects[r].w && y >= rects[r].y &&
+                               y < rects[r].y + rects[r].h;
+                }
+                CHECK(covered);
+            }
+        }
+    }
+}
+
+static uint64_t frameHash(LilyGo_HostDisplay &display)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint16_t y = 0; y < display.height(); y++) {
+        for (uint16_t x = 0; x < display.width(); x++) {
+            hash = (hash ^ display.getPixel(x, y)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// A tileview with a label that keeps changing, a small object moving on the
+// top layer and a full-screen invalidation now and then: most rows of most
+// areas are left as they were
+static void playScene(LilyGo_HostDisplay &display, uint32_t frames, std::vector<uint64_t> &hashes)
+{
+    lv_obj_clean(lv_scr_act());
+    lv_obj_clean(lv_layer_top());
+    lv_obj_t *tileview = lv_tileview_create(lv_scr_act());
+    lv_obj_t *labels[4];
+    for (int i = 0; i < 4; i++) {
+        lv_obj_t *tile = lv_tileview_add_tile(tileview, i, 0, LV_DIR_HOR);
+        labels[i] = lv_label_create(tile);
+        lv_label_set_text_fmt(labels[i], "Tile %d", i);
+        lv_obj_center(labels[i]);
+        lv_obj_t *button = lv_btn_create(tile);
+        lv_obj_set_size(button, 100 + i * 30, 50);
+        lv_obj_align(button, LV_ALIGN_BOTTOM_MID, 0, -10);
+    }
+    lv_obj_t *dot = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(dot, 13, 9);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+
+    hashes.clear();
+    for (uint32_t f = 0; f < frames; f++) {
+        int tile = (f / 50) % 4;
+        if (f % 50 == 0) {
+            lv_obj_set_tile_id(tileview, tile, 0, LV_ANIM_OFF);
+        }
+        // Same text every other frame: redrawn, but nothing changes
+        lv_label_set_text_fmt(labels[tile], "Frame %lu", (unsigned long)(f / 2));
+        lv_obj_set_pos(dot, (f * 7) % 300, (f * 3) % 150);
+        if (f % 20 == 0) {
+            lv_obj_invalidate(lv_scr_act());
+        }
+        lv_refr_now(NULL);
+        hashes.push_back(frameHash(display));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool full = argc > 1 && strcmp(argv[1], "full") == 0;
+    uint32_t frames = argc > 2 ? strtoul(argv[2], NULL, 0) : 200;
+
+    testKernels();
+
+    LilyGo_HostDisplay display(full ? 368 : 536, full ? 194 : 240, full);
+    beginLvglHelper(display);
+    std::vector<uint64_t> passThrough, diffed;
+    lvglHelperSetScanlineDiff(false);
+    display.resetStats();
+    playScene(display, frames, passThrough);
+    uint64_t passBytes = display.stats().bytes;
+
+    CHECK(lvglHelperSetScanlineDiff(true));
+    LvglDiffStats before = lvglHelperGetDiffStats();
+    display.resetStats();
+    playScene(display, frames, diffed);
+    uint64_t diffBytes = display.stats().bytes;
+    LvglDiffStats after = lvglHelperGetDiffStats();
+
+    for (uint32_t f = 0; f < frames; f++) {
+        if (passThrough[f] != diffed[f]) {
+            fprintf(stderr, "frame %lu differs\n", (unsigned long)f);
+            return 1;
+        }
+    }
+    uint64_t rendered = after.renderedBytes - before.renderedBytes;
+    uint64_t sent = after.sentBytes - before.sentBytes;
+    printf("%s, %lu frames: same pixels; %.2f MB on the wire without the diff, %.2f MB with it; "
+           "%.2f MB rendered, %.2f MB sent, %lu of %lu areas unchanged\n",
+           full ? "368x194 shadow frame" : "536x240 partial refresh", (unsigned long)frames, passBytes / 1e6,
+           diffBytes / 1e6, rendered / 1e6, sent / 1e6, (unsigned long)(after.unchanged - before.unchanged),
+           (unsigned long)(after.areas - before.areas));
+    CHECK(sent < rendered);
+    CHECK(diffBytes < passBytes);
+
+    lvglHelperSetTouchInterrupt(false);
+    printf("test_scanline_diff: ok\n");
+    return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file      test_touch_queue.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// TouchQueue and touchQueueDrain() on their own, the queue between two
+// threads, then a scripted tap and jittery drag played through the LVGL
+// helper with the touch task and with polling. Both must give LVGL the
+// same presses, clicks and final point; the task must leave the
+// controller alone while nobody touches it.
+//
+//   test_touch_queue [pushes]
+
+#include <string.h>
+#include <unistd.h>
+#include <thread>
+#include <Arduino.h>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "touchQueue.h"
+#include "HostTest.h"
+
+static TouchSample sample(uint32_t timeMs, int16_t x, int16_t y, bool pressed)
+{
+    TouchSample s = {timeMs, x, y, pressed};
+    return s;
+}
+
+static void testQueue()
+{
+    TouchQueue queue;
+    TouchSample s;
+    CHECK(queue.empty() && !queue.pop(&s));
+    for (uint32_t i = 0; i < TOUCH_QUEUE_SIZE; i++) {
+        CHECK(queue.push(sample(i, i, 0, true)));
+    }
+    CHECK(!queue.push(sample(99, 0, 0, true)));
+    CHECK(queue.droppedCount() == 1);
+    for (uint32_t i = 0; i < TOUCH_QUEUE_SIZE; i++) {
+        CHECK(queue.pop(&s) && s.timeMs == i);
+    }
+    CHECK(queue.empty());
+}
+
+static void testDrain()
+{
+    TouchQueue queue;
+    TouchSample state = sample(0, 0, 0, false);
+    CHECK(!touchQueueDrain(queue, state, 2) && !state.pressed);
+
+    // The press on its own, with the moves after it waiting
+    queue.push(sample(10, 100, 100, true));
+    queue.push(sample(20, 101, 99, true));
+    queue.push(sample(30, 120, 100, true));
+    queue.push(sample(40, 140, 110, true));
+    CHECK(touchQueueDrain(queue, state, 2));
+    CHECK(state.pressed && state.x == 100 && state.y == 100 && state.timeMs == 10);
+    // The moves collapse into the newest
+    CHECK(!touchQueueDrain(queue, state, 2));
+    CHECK(state.x == 140 && state.y == 110 && state.timeMs == 40);
+
+    // Within the jitter of the reported point: nothing changes
+    queue.push(sample(50, 142, 108, true));
+    queue.push(sample(60, 138, 111, true));
+    CHECK(!touchQueueDrain(queue, state, 2));
+    CHECK(state.x == 140 && state.y == 110 && state.timeMs == 40);
+
+    // A release keeps the last pressed point; a press and release in one
+    // drain are both seen
+    queue.push(sample(70, 0, 0, false));
+    queue.push(sample(80, 50, 60, true));
+    queue.push(sample(90, 0, 0, false));
+    CHECK(touchQueueDrain(queue, state, 2));
+    CHECK(!state.pressed && state.x == 140 && state.y == 110);
+    CHECK(touchQueueDrain(queue, state, 2));
+    CHECK(state.pressed && state.x == 50 && state.y == 60);
+    CHECK(!touchQueueDrain(queue, state, 2));
+    CHECK(!state.pressed && state.x == 50 && state.y == 60 && state.timeMs == 90);
+}
+
+// Every sample arrives once and in order. The producer and the consumer
+// yield when the queue is full or empty.
+static void testThreads(uint32_t pushes)
+{
+    static TouchQueue queue;
+    std::thread producer([pushes]() {
+        for (uint32_t i = 1; i <= pushes; i++) {
+            while (!queue.push(sample(i, (int16_t)i, (int16_t)~i, true))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint32_t last = 0;
+    TouchSample s;
+    while (last < pushes) {
+        if (queue.pop(&s)) {
+            CHECK(s.timeMs == last + 1 && s.x == (int16_t)s.timeMs && s.y == (int16_t)~s.timeMs);
+            last = s.timeMs;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    CHECK(queue.empty());
+    printf("%lu samples across threads in order, queue full %lu times\n", (unsigned long)pushes,
+           (unsigned long)queue.droppedCount());
+}
+
+struct TouchResult {
+    uint32_t presses;
+    uint32_t clicks;
+    uint32_t firstPressMs;
+    lv_point_t last;
+    uint32_t idleReads;
+    uint32_t reads;
+};
+
+static TouchResult result;
+static uint32_t startMs;
+
+static void touchEvent(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_PRESSED:
+        if (!result.presses++) {
+            result.firstPressMs = millis() - startMs;
+        }
+        break;
+    case LV_EVENT_PRESSING:
+        lv_indev_get_point(lv_indev_get_act(), &result.last);
+        break;
+    case LV_EVENT_CLICKED:
+        result.clicks++;
+        break;
+    default:
+        break;
+    }
+}
+
+static HostTouchEvent touch(uint32_t timeMs, int16_t x, int16_t y, bool pressed)
+{
+    HostTouchEvent event = {timeMs, x, y, pressed};
+    return event;
+}
+
+// Idle for 500 ms, a tap, then a drag wandering a pixel either way. Written
+// once, as the touch task may still be reading it from the run before.
+static TouchResult play(LilyGo_HostDisplay &display, bool interrupt)
+{
+    static HostTouchEvent script[32];
+    static size_t n = 0;
+    if (!n) {
+        script[n++] = touch(0, 0, 0, false);
+        script[n++] = touch(500, 100, 100, true);
+        script[n++] = touch(560, 0, 0, false);
+        script[n++] = touch(900, 200, 120, true);
+        for (int i = 1; i <= 20; i++) {
+            script[n++] = touch((uint32_t)(900 + i * 10), (int16_t)(200 + i * 5 + (i & 1)),
+                                (int16_t)(120 + ((i & 2) ? 1 : 0)), true);
+        }
+        script[n++] = touch(1200, 0, 0, false);
+    }
+
+    CHECK(lvglHelperSetTouchInterrupt(interrupt) == interrupt);
+    lv_obj_clean(lv_scr_act());
+    lv_obj_t *target = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(target, display.width(), display.height());
+    lv_obj_clear_flag(target, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(target, touchEvent, LV_EVENT_ALL, NULL);
+    lv_timer_handler();
+
+    memset(&result, 0, sizeof(result));
+    display.resetStats();
+    display.setTouchScript(script, n);
+    startMs = millis();
+    while (millis() - startMs < 1500) {
+        lv_timer_handler();
+        usleep(2000);
+        if (millis() - startMs < 480) {
+            result.idleReads = display.stats().touchReads;
+        }
+    }
+    result.reads = display.stats().touchReads;
+    printf("%-9s press after %lu ms, %lu controller reads (%lu while idle), %lu presses, %lu clicks, "
+           "last point %d,%d\n",
+           interrupt ? "interrupt" : "polling", (unsigned long)(result.firstPressMs - 500),
+           (unsigned long)result.reads, (unsigned long)result.idleReads, (unsigned long)result.presses,
+           (unsigned long)result.clicks, result.last.x, result.last.y);
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t pushes = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    testQueue();
+    testDrain();
+    testThreads(pushes);
+
+    LilyGo_HostDisplay display(536, 240);
+    beginLvglHelper(display);
+    TouchResult interrupt = play(display, true);
+    TouchResult polling = play(display, false);
+    CHECK(lvglHelperGetTouchDropped() == 0);
+
+    CHECK(interrupt.presses == 2 && interrupt.clicks == 2);
+    CHECK(polling.presses == interrupt.presses && polling.clicks == interrupt.clicks);
+    CHECK(interrupt.last.x == polling.last.x && interrupt.last.y == polling.last.y);
+    CHECK(interrupt.last.x >= 295);
+    CHECK(interrupt.idleReads == 0 && polling.idleReads > 0);
+    CHECK(interrupt.firstPressMs >= 500 && interrupt.firstPressMs < 600);
+
+    lvglHelperSetTouchInterrupt(false);
+    printf("test_touch_queue: ok\n");
+    return 0;
+}
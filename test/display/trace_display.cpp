@@ -0,0 +1,138 @@
+/**
+ * @file      trace_display.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Records an animated screen through the LVGL helper on the 368x194 shadow
+// frame panel, with the stats overlay on, checks what the frame and
+// transfer history hold and writes it as a Chrome trace for
+// chrome://tracing or ui.perfetto.dev. Checks StatsRing with a writer and
+// a reader thread first.
+//
+//   trace_display [frames] [trace.json]
+
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LV_Helper.h"
+#include "LilyGo_HostDisplay.h"
+#include "statsRing.h"
+#include "HostTest.h"
+
+struct RingRecord {
+    uint32_t n;
+    uint32_t inverse;
+    uint64_t square;
+};
+
+// Readers never wait and never see a record half written: every one they
+// get is whole, and they come oldest first
+static void testStatsRing()
+{
+    static StatsRing<RingRecord, 16> ring;
+    const uint32_t total = 2000000;
+    std::atomic<bool> done(false);
+    std::thread writer([&]() {
+        for (uint32_t n = 1; n <= total; n++) {
+            RingRecord r = {n, ~n, (uint64_t)n * n};
+            ring.push(r);
+        }
+        done = true;
+    });
+    RingRecord out[16];
+    uint64_t copies = 0, records = 0;
+    while (!done.load()) {
+        uint16_t count = ring.copy(out, 16);
+        for (uint16_t i = 0; i < count; i++) {
+            CHECK(out[i].inverse == ~out[i].n && out[i].square == (uint64_t)out[i].n * out[i].n);
+            CHECK(i == 0 || out[i].n > out[i - 1].n);
+        }
+        copies++;
+        records += count;
+    }
+    writer.join();
+    CHECK(ring.total() == total);
+    CHECK(ring.copy(out, 16) == 16 && out[15].n == total && out[0].n == total - 15);
+    printf("StatsRing: %llu reads during %lu pushes, %llu whole records\n", (unsigned long long)copies,
+           (unsigned long)total, (unsigned long long)records);
+}
+
+static size_t countOf(const std::string &text, const char *what)
+{
+    size_t count = 0;
+    for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) {
+        count++;
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 120;
+    const char *path = argc > 2 ? argv[2] : "display_trace.json";
+
+    testStatsRing();
+
+    LilyGo_HostDisplay display(368, 194, true);
+    beginLvglHelper(display);
+    lvglHelperShowStats(true);
+    lv_obj_t *spinner = lv_spinner_create(lv_scr_act(), 1000, 60);
+    lv_obj_set_size(spinner, 100, 100);
+    lv_obj_center(spinner);
+    lv_obj_t *label = lv_label_create(lv_scr_act());
+    lv_obj_align(label, LV_ALIGN_TOP_LEFT, 10, 10);
+    for (uint32_t f = 0; f < frames; f++) {
+        lv_label_set_text_fmt(label, "Frame %lu", (unsigned long)f);
+        lv_timer_handler();
+        lv_refr_now(NULL);
+        usleep(2000);
+    }
+
+    std::vector<LvglFrameStats> history(256);
+    std::vector<DisplayFlushTiming> flushes(256);
+    history.resize(lvglHelperGetFrameHistory(&history[0], history.size()));
+    flushes.resize(lvglHelperGetFlushHistory(&flushes[0], flushes.size()));
+    CHECK(!history.empty() && !flushes.empty());
+    for (size_t i = 0; i < history.size(); i++) {
+        CHECK(history[i].pixels > 0 && history[i].areas > 0);
+        CHECK(history[i].latencyUs >= history[i].renderUs);
+        CHECK(i == 0 || (int32_t)(history[i].startUs - history[i - 1].startUs) >= 0);
+    }
+    for (size_t i = 0; i < flushes.size(); i++) {
+        CHECK(flushes[i].pixels > 0);
+    }
+    LvglPipelineStats stats = lvglHelperGetPipelineStats();
+    CHECK(stats.fps > 0 && stats.pixelsPerFlush > 0);
+    printf("%lu frames, %lu transfers recorded: %.1f fps, render %lu us, max latency %lu us, "
+           "%lu pixels, rotate %lu us and send %lu us per transfer, queue depth %u\n",
+           (unsigned long)history.size(), (unsigned long)flushes.size(), stats.fps,
+           (unsigned long)stats.renderUs, (unsigned long)stats.maxLatencyUs,
+           (unsigned long)stats.pixelsPerFlush, (unsigned long)stats.rotateUs, (unsigned long)stats.spiUs,
+           stats.maxQueueDepth);
+
+    CHECK(hostWriteChromeTrace(path));
+    lvglHelperSetTouchInterrupt(false);
+
+    // One render and one latency event per frame, one per transfer
+    FILE *f = fopen(path, "r");
+    CHECK(f);
+    std::string trace;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        trace.append(buffer, n);
+    }
+    fclose(f);
+    CHECK(trace.compare(0, 16, "{\"traceEvents\":[") == 0);
+    CHECK(trace.size() > 4 && trace.compare(trace.size() - 4, 4, "\n]}\n") == 0);
+    size_t events = countOf(trace, "\"ph\":\"X\"");
+    CHECK(events >= 2 * history.size() + flushes.size());
+    printf("wrote %s: %lu events\n", path, (unsigned long)events);
+    return 0;
+}
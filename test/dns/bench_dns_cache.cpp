@@ -0,0 +1,77 @@
+/**
+ * @file      bench_dns_cache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Replays a Zipf-distributed query trace against DnsCache the way the
+// server uses it: look up, and insert on a miss. Prints lookups per second
+// and the hit ratio.
+//
+//   bench_dns_cache [lookups] [distinct names] [capacity] [zipf exponent]
+
+#include <math.h>
+#include <algorithm>
+#include <string.h>
+#include <vector>
+#include "DnsCache.h"
+#include "HostTest.h"
+
+int main(int argc, char **argv)
+{
+    uint32_t lookups = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000000;
+    uint32_t names = argc > 2 ? strtoul(argv[2], NULL, 0) : 50000;
+    uint32_t capacity = argc > 3 ? strtoul(argv[3], NULL, 0) : DNS_CACHE_CAPACITY;
+    double exponent = argc > 4 ? atof(argv[4]) : 1.0;
+    CHECK(lookups > 0 && names > 0 && capacity > 0);
+
+    // Rank r is asked with weight 1 / r^exponent
+    std::vector<double> cdf(names);
+    double sum = 0;
+    for (uint32_t r = 0; r < names; r++) {
+        sum += 1.0 / pow(r + 1, exponent);
+        cdf[r] = sum;
+    }
+    std::vector<char> text((size_t)names * 32);
+    for (uint32_t r = 0; r < names; r++) {
+        snprintf(&text[(size_t)r * 32], 32, "n%lu.zipf.test", (unsigned long)r);
+    }
+    uint64_t seed = 1;
+    std::vector<uint32_t> trace(lookups);
+    for (uint32_t i = 0; i < lookups; i++) {
+        double u = (hostRandom(seed) / 4294967296.0) * sum;
+        trace[i] = (uint32_t)(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        if (trace[i] >= names) {
+            trace[i] = names - 1;
+        }
+    }
+
+    DnsCache cache;
+    CHECK(cache.begin(capacity));
+    DnsCacheAnswer answer;
+    uint32_t hits = 0;
+    uint64_t start = hostNanos();
+    for (uint32_t i = 0; i < lookups; i++) {
+        const char *name = &text[(size_t)trace[i] * 32];
+        // One simulated second per 1000 lookups, well inside the TTL
+        uint32_t now = i;
+        if (cache.lookup(name, now, answer)) {
+            CHECK(answer.addr == trace[i]);
+            hits++;
+        } else {
+            cache.insert(name, trace[i], 3600, now);
+        }
+    }
+    uint64_t elapsed = hostNanos() - start;
+
+    DnsCacheStats stats = cache.stats();
+    printf("%lu lookups over %lu names (zipf %.2f), capacity %lu: %.1f M lookups/s, %.1f ns each, "
+           "hit ratio %.1f%%, %lu evictions\n",
+           (unsigned long)lookups, (unsigned long)names, exponent, (unsigned long)capacity,
+           lookups * 1000.0 / elapsed, (double)elapsed / lookups, hits * 100.0 / lookups,
+           (unsigned long)stats.evictions);
+    CHECK(stats.hits == hits);
+    return 0;
+}
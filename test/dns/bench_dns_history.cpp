@@ -0,0 +1,138 @@
+/**
+ * @file      bench_dns_history.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Lookup latency of DnsHistory against the text log scan it replaced, at
+// each record count given. The card is a scratch directory on the host's
+// disk, so the scan here is far faster than on an SD card; the ratio is
+// what carries over.
+//
+//   bench_dns_history [records ...]
+
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "DnsHistory.h"
+#include "HostTest.h"
+
+static void nameOf(uint32_t n, char *name, size_t size)
+{
+    snprintf(name, size, "n%lu.history.test", (unsigned long)n);
+}
+
+// What a cache miss used to cost: every line of the text log read and
+// matched, the last match winning
+static bool scanTextLog(fs::FS &fs, const char *name, uint32_t &addr)
+{
+    File text = fs.open("/dnslog1.txt", FILE_READ);
+    if (!text) {
+        return false;
+    }
+    bool found = false;
+    char line[DNS_NAME_MAX_LENGTH + 64];
+    size_t length = strlen(name);
+    while (text.available()) {
+        size_t n = text.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[n] = '\0';
+        char *query = strstr(line, "Query: ");
+        if (query && strncmp(query + 7, name, length) == 0 && strncmp(query + 7 + length, " IP: ", 5) == 0) {
+            addr = (uint32_t)strtoul(query + 12 + length, NULL, 10);
+            found = true;
+        }
+    }
+    text.close();
+    return found;
+}
+
+static void run(const std::string &card, uint32_t records)
+{
+    fs::FS fs(card.c_str());
+    char name[64];
+
+    FILE *text = fopen((card + "/dnslog1.txt").c_str(), "w");
+    CHECK(text);
+    for (uint32_t n = 0; n < records; n++) {
+        nameOf(n, name, sizeof(name));
+        fprintf(text, "%lu Query: %s IP: %lu\n", (unsigned long)n, name, (unsigned long)n);
+    }
+    fclose(text);
+
+    DnsHistory history;
+    CHECK(history.begin(fs, records));
+    uint64_t start = hostNanos();
+    for (uint32_t n = 0; n < records; n++) {
+        nameOf(n, name, sizeof(name));
+        CHECK(history.record(name, n, n));
+        if ((n & 1023) == 1023) {
+            history.flush();
+        }
+    }
+    history.end();
+    uint64_t recordNanos = hostNanos() - start;
+
+    start = hostNanos();
+    CHECK(history.begin(fs, records));
+    uint64_t loadNanos = hostNanos() - start;
+    CHECK(history.size() == records);
+
+    const uint32_t lookups = 200000;
+    uint64_t seed = records;
+    std::vector<uint32_t> asked(lookups);
+    for (uint32_t i = 0; i < lookups; i++) {
+        asked[i] = hostRandom(seed) % records;
+    }
+    start = hostNanos();
+    for (uint32_t i = 0; i < lookups; i++) {
+        nameOf(asked[i], name, sizeof(name));
+        uint32_t addr;
+        CHECK(history.lookup(name, addr) && addr == asked[i]);
+    }
+    uint64_t lookupNanos = hostNanos() - start;
+    history.end();
+
+    // A few scans are enough at these sizes
+    const uint32_t scans = 5;
+    start = hostNanos();
+    for (uint32_t i = 0; i < scans; i++) {
+        nameOf(asked[i], name, sizeof(name));
+        uint32_t addr;
+        CHECK(scanTextLog(fs, name, addr) && addr == asked[i]);
+    }
+    uint64_t scanNanos = hostNanos() - start;
+
+    double indexed = (double)lookupNanos / lookups;
+    double scanned = (double)scanNanos / scans;
+    printf("%8lu records: lookup %.0f ns, text scan %.2f ms (%.0fx), record %.2f us each, begin %.1f ms\n",
+           (unsigned long)records, indexed, scanned / 1e6, scanned / indexed, recordNanos / 1e3 / records,
+           loadNanos / 1e6);
+
+    unlink((card + "/dnslog1.txt").c_str());
+    unlink((card + DNS_HISTORY_LOG_FILE).c_str());
+    unlink((card + DNS_HISTORY_INDEX_FILE).c_str());
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<uint32_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(strtoul(argv[i], NULL, 0));
+        CHECK(sizes.back() > 0);
+    }
+    if (sizes.empty()) {
+        sizes.push_back(10000);
+        sizes.push_back(100000);
+        sizes.push_back(1000000);
+    }
+    char dir[] = "/tmp/bench_dns_history.XXXXXX";
+    CHECK(mkdtemp(dir));
+    for (size_t i = 0; i < sizes.size(); i++) {
+        run(dir, sizes[i]);
+    }
+    rmdir(dir);
+    return 0;
+}
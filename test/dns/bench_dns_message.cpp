@@ -0,0 +1,104 @@
+/**
+ * @file      bench_dns_message.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Packets per second through DnsMessageView and DnsMessageWriter on one
+// core: parsing a query, parsing and walking a compressed answer, and
+// building the reply the server sends for a cache hit.
+//
+//   bench_dns_message [iterations]
+
+#include <string.h>
+#include "DnsMessage.h"
+#include "HostTest.h"
+
+static size_t buildQuery(uint8_t *packet, size_t size, uint16_t id)
+{
+    DnsMessageWriter writer(packet, size);
+    writer.begin(id, DNS_FLAG_RD);
+    writer.addQuestion("www.example.com", DNS_TYPE_A);
+    writer.addOpt();
+    return writer.finish();
+}
+
+static size_t buildAnswer(uint8_t *packet, size_t size)
+{
+    DnsMessageWriter writer(packet, size);
+    writer.begin(0x4321, DNS_FLAG_QR | DNS_FLAG_RD | DNS_FLAG_RA);
+    writer.addQuestion("www.example.com", DNS_TYPE_A);
+    writer.addCname(NULL, 300, "edge.example.net");
+    writer.addA("edge.example.net", 60, 0x0a0b0c0d);
+    writer.addA("edge.example.net", 60, 0x0a0b0c0e);
+    writer.addOpt();
+    return writer.finish();
+}
+
+static void report(const char *what, uint32_t iterations, uint64_t elapsed)
+{
+    printf("%-24s %.2f M packets/s, %.0f ns each\n", what, iterations * 1000.0 / elapsed,
+           (double)elapsed / iterations);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000000;
+    CHECK(iterations > 0);
+    uint8_t query[DNS_UDP_MAX_PAYLOAD];
+    uint8_t answer[DNS_UDP_MAX_PAYLOAD];
+    uint8_t response[DNS_UDP_MAX_PAYLOAD];
+    size_t queryLength = buildQuery(query, sizeof(query), 0x1234);
+    size_t answerLength = buildAnswer(answer, sizeof(answer));
+    CHECK(queryLength != 0 && answerLength != 0);
+
+    // Keeps the compiler from dropping the loops
+    uint32_t sink = 0;
+
+    uint64_t start = hostNanos();
+    for (uint32_t i = 0; i < iterations; i++) {
+        DnsMessageView message;
+        query[1] = (uint8_t)i;
+        CHECK(message.parse(query, queryLength));
+        DnsQuestion question;
+        CHECK(message.firstQuestion(question));
+        sink += question.name.hash() + message.ednsPayloadSize();
+    }
+    report("parse query:", iterations, hostNanos() - start);
+
+    start = hostNanos();
+    for (uint32_t i = 0; i < iterations; i++) {
+        DnsMessageView message;
+        answer[1] = (uint8_t)i;
+        CHECK(message.parse(answer, answerLength));
+        DnsRecordCursor cursor = message.records(DNS_SECTION_ANSWER);
+        DnsRecord record;
+        DnsName target;
+        uint32_t addr;
+        while (cursor.next(record)) {
+            if (record.a(addr)) {
+                sink += addr;
+            } else if (record.target(target)) {
+                sink += target.hash();
+            }
+        }
+    }
+    report("parse and walk answer:", iterations, hostNanos() - start);
+
+    DnsMessageView message;
+    CHECK(message.parse(query, queryLength));
+    start = hostNanos();
+    for (uint32_t i = 0; i < iterations; i++) {
+        DnsMessageWriter writer(response, sizeof(response));
+        CHECK(writer.beginResponse(message, DNS_RCODE_NOERROR));
+        writer.addA(NULL, 60, i);
+        writer.addOpt();
+        sink += writer.finish();
+    }
+    report("encode response:", iterations, hostNanos() - start);
+
+    printf("bench_dns_message: ok (%lu)\n", (unsigned long)sink);
+    return 0;
+}
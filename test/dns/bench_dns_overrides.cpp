@@ -0,0 +1,158 @@
+/**
+ * @file      bench_dns_overrides.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Builds an override table the way the sketch does and measures it against
+// the domainMappings[] array scan it replaced: ns per lookup and bytes per
+// entry.
+//
+//   bench_dns_overrides [entries] [lookups]
+//   bench_dns_overrides --file <overrides.txt>
+//
+// With --file it loads that list instead of a generated one and reports
+// what the board would keep of it, so a list can be checked before it goes
+// on the card.
+
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "DnsOverrides.h"
+#include "HostTest.h"
+
+// What findDomainIP() scanned
+struct DomainMapping {
+    const char *domainName;
+    IPAddress ipAddress;
+};
+
+static bool findDomainIP(const DomainMapping *mappings, size_t count, const char *domain, IPAddress &out)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (strcasecmp(domain, mappings[i].domainName) == 0) {
+            out = mappings[i].ipAddress;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void report(const char *path)
+{
+    std::string file(path);
+    size_t slash = file.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : file.substr(0, slash ? slash : 1);
+    fs::FS fs(dir.c_str());
+    DnsOverrides overrides;
+    uint64_t start = hostNanos();
+    CHECK(overrides.load(fs, ("/" + file.substr(slash == std::string::npos ? 0 : slash + 1)).c_str()));
+    uint64_t elapsed = hostNanos() - start;
+    printf("%s: %lu rules, %lu nodes, %lu lines too long, %lu bytes (%.1f per rule), loaded in %.1f ms\n", path,
+           (unsigned long)overrides.rules(), (unsigned long)overrides.nodes(), (unsigned long)overrides.skipped(),
+           (unsigned long)overrides.memoryUsed(),
+           overrides.rules() ? (double)overrides.memoryUsed() / overrides.rules() : 0.0, elapsed / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "--file") == 0) {
+        report(argv[2]);
+        return 0;
+    }
+    uint32_t entries = argc > 1 ? strtoul(argv[1], NULL, 0) : 100000;
+    uint32_t lookups = argc > 2 ? strtoul(argv[2], NULL, 0) : 1000000;
+    CHECK(entries > 0 && lookups > 0);
+
+    // A blocklist-shaped table: mostly hosts-style blocked names under a
+    // few thousand domains, some wildcards and some local addresses
+    char dir[] = "/tmp/bench_dns_overrides.XXXXXX";
+    CHECK(mkdtemp(dir));
+    std::string path = std::string(dir) + DNS_OVERRIDES_FILE;
+    FILE *file = fopen(path.c_str(), "w");
+    CHECK(file);
+    std::vector<std::string> names;
+    names.reserve(entries);
+    uint64_t seed = 1;
+    char name[96];
+    for (uint32_t i = 0; i < entries; i++) {
+        uint32_t domain = hostRandom(seed) % (entries / 16 + 1);
+        snprintf(name, sizeof(name), "h%lu.d%lu.%s", (unsigned long)i, (unsigned long)domain,
+                 (domain & 1) ? "com" : "net");
+        names.push_back(name);
+        switch (i % 10) {
+        case 0:
+            fprintf(file, "*.%s\n", name);
+            break;
+        case 1:
+            fprintf(file, "10.%lu.%lu.%lu %s\n", (unsigned long)(i >> 16 & 255), (unsigned long)(i >> 8 & 255),
+                    (unsigned long)(i & 255), name);
+            break;
+        default:
+            fprintf(file, "0.0.0.0 %s\n", name);
+            break;
+        }
+    }
+    fclose(file);
+
+    fs::FS fs(dir);
+    DnsOverrides overrides;
+    uint64_t start = hostNanos();
+    CHECK(overrides.load(fs));
+    uint64_t loadNanos = hostNanos() - start;
+    CHECK(overrides.rules() == entries);
+    unlink(path.c_str());
+    rmdir(dir);
+
+    std::vector<DomainMapping> mappings(entries);
+    size_t arrayBytes = sizeof(DomainMapping) * entries;
+    for (uint32_t i = 0; i < entries; i++) {
+        mappings[i].domainName = names[i].c_str();
+        mappings[i].ipAddress = IPAddress(i);
+        arrayBytes += names[i].size() + 1;
+    }
+
+    // Half the queries are for listed names, half for names under them or
+    // nowhere near them
+    std::vector<std::string> queries;
+    for (uint32_t i = 0; i < 4096; i++) {
+        uint32_t n = hostRandom(seed) % entries;
+        if (i & 1) {
+            queries.push_back(names[n]);
+        } else if (i & 2) {
+            queries.push_back("www." + names[n]);
+        } else {
+            snprintf(name, sizeof(name), "miss%lu.example.org", (unsigned long)n);
+            queries.push_back(name);
+        }
+    }
+    uint32_t matched = 0;
+    uint32_t addr;
+    start = hostNanos();
+    for (uint32_t i = 0; i < lookups; i++) {
+        matched += overrides.lookup(queries[i & 4095].c_str(), addr) != DNS_OVERRIDE_NONE;
+    }
+    uint64_t trieNanos = hostNanos() - start;
+
+    // The array is too slow for the full count
+    uint32_t scans = lookups / 1000 > 100 ? lookups / 1000 : 100;
+    uint32_t found = 0;
+    IPAddress ip;
+    start = hostNanos();
+    for (uint32_t i = 0; i < scans; i++) {
+        found += findDomainIP(&mappings[0], entries, queries[i & 4095].c_str(), ip);
+    }
+    uint64_t arrayNanos = hostNanos() - start;
+    CHECK(matched > 0 && found > 0);
+
+    printf("%lu entries: trie %.0f ns/lookup, %.1f bytes/entry, loaded in %.1f ms; "
+           "array %.0f ns/lookup, %.1f bytes/entry\n",
+           (unsigned long)entries, (double)trieNanos / lookups, (double)overrides.memoryUsed() / entries,
+           loadNanos / 1e6, (double)arrayNanos / scans, (double)arrayBytes / entries);
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file      dns_bench.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// The sketch's DNS server (LocalDNS.cpp, DNS_WORKER_COUNT workers) on
+// loopback port DNS_PORT, driven by DnsBench the way -DDNS_BENCHMARK does
+// on the board. The SD card is a scratch directory.
+//
+//   dns_bench [queries] [distinct names] [hot percent] [outstanding]
+//             [upstream loss percent] [upstream delay ms]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include "LocalDNS.h"
+#include "DnsBench.h"
+
+int main(int argc, char **argv)
+{
+    DnsBenchConfig config;
+    dnsBenchDefaults(config);
+    config.serverPort = DNS_PORT;
+    config.upstreamPort = DNS_PORT + 1;
+    if (argc > 1) config.queries = strtoul(argv[1], NULL, 0);
+    if (argc > 2) config.distinctNames = strtoul(argv[2], NULL, 0);
+    if (argc > 3) config.hotPercent = atoi(argv[3]);
+    if (argc > 4) config.outstanding = atoi(argv[4]);
+    if (argc > 5) config.upstreamLossPercent = atoi(argv[5]);
+    if (argc > 6) config.upstreamDelayMs = atoi(argv[6]);
+
+    char card[] = "/tmp/dns_bench.XXXXXX";
+    if (!mkdtemp(card)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    SD.setRoot(card);
+
+    setDnsUpstream(IPAddress(127, 0, 0, 1), config.upstreamPort);
+    if (!startDnsServer()) {
+        fprintf(stderr, "DNS server did not start on port %d\n", DNS_PORT);
+        return 1;
+    }
+
+    DnsBenchResult result;
+    bool ran = runDnsBenchmark(config, result);
+    stopDnsServer();
+    std::string cleanup = std::string("rm -rf ") + card;
+    if (system(cleanup.c_str()) != 0) {
+        fprintf(stderr, "could not remove %s\n", card);
+    }
+    if (!ran) {
+        fprintf(stderr, "could not open the benchmark sockets\n");
+        return 1;
+    }
+
+    char line[256];
+    formatDnsBenchResult(result, line, sizeof(line));
+    printf("[DNS bench] %d workers: %s\n", DNS_WORKER_COUNT, line);
+    // Lost upstream queries are retried or failed, so every client query
+    // gets an answer
+    return result.answered == result.sent && result.dropped == 0 ? 0 : 1;
+}
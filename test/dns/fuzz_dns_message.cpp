@@ -0,0 +1,220 @@
+/**
+ * @file      fuzz_dns_message.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// Fuzz target for DnsMessageView, the record decoders, the in-place edits
+// and DnsMessageWriter::beginResponse(). With -DHOST_FUZZ=ON and clang it
+// is a libFuzzer binary; otherwise main() below mutates a few seed packets
+// at random, which is what ctest runs. Either way, build with
+// -DHOST_SANITIZE=address,undefined to catch out-of-bounds reads.
+//
+//   fuzz_dns_message [iterations] [seed]
+
+#include <string.h>
+#include <vector>
+#include "DnsMessage.h"
+#include "DnsPlatform.h"
+#include "HostTest.h"
+
+static void walk(const DnsMessageView &message)
+{
+    char text[DNS_NAME_BUFFER_SIZE];
+    DnsQuestion question;
+    if (message.firstQuestion(question)) {
+        size_t n = question.name.toString(text, sizeof(text));
+        CHECK(n < sizeof(text));
+        // The view hashes the wire form the way dnsNameHash() hashes text,
+        // for names whose text is unambiguous: no NUL in a label, and no
+        // label ending in a dot that reads as the root
+        if (n > 0 && strlen(text) == n && text[n - 1] != '.') {
+            CHECK(question.name.hash() == dnsNameHash(text));
+            CHECK(question.name.equals(text));
+        }
+        CHECK(question.name.equals(question.name));
+    }
+    for (int section = DNS_SECTION_ANSWER; section <= DNS_SECTION_ADDITIONAL; section++) {
+        DnsRecordCursor cursor = message.records((DnsSection)section);
+        DnsRecord record;
+        while (cursor.next(record)) {
+            uint32_t addr;
+            uint8_t addr6[16];
+            uint16_t priority, weight, port;
+            DnsName target;
+            const uint8_t *data;
+            uint8_t length;
+            uint32_t minimum;
+            record.name.toString(text, sizeof(text));
+            record.a(addr);
+            record.aaaa(addr6);
+            if (record.target(target)) {
+                target.toString(text, sizeof(text));
+            }
+            if (record.srv(priority, weight, port, target)) {
+                target.toString(text, sizeof(text));
+            }
+            for (uint16_t i = 0; record.txt(i, data, length); i++) {
+                CHECK(data >= message.data() && data + length <= message.data() + message.length());
+            }
+            record.soaMinimum(minimum);
+        }
+    }
+    DnsRecord opt;
+    message.findOpt(opt);
+    uint16_t payload = message.ednsPayloadSize();
+    CHECK(payload == 0 || payload >= DNS_UDP_MAX_PAYLOAD);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > DNS_EDNS_MAX_PAYLOAD) {
+        return 0;
+    }
+    DnsMessageView message;
+    if (!message.parse(data, size)) {
+        return 0;
+    }
+    walk(message);
+
+    // Edits must leave a message the view still accepts
+    std::vector<uint8_t> copy(size + 16);
+    memcpy(copy.data(), data, size);
+    size_t length = dnsSetEdnsPayload(copy.data(), size, 1232);
+    DnsMessageView edited;
+    if (length != 0) {
+        CHECK(edited.parse(copy.data(), length));
+    }
+    // Only called on messages without one
+    DnsRecord opt;
+    memcpy(copy.data(), data, size);
+    length = message.findOpt(opt) ? 0 : dnsAppendOpt(copy.data(), size, copy.size(), 1232);
+    if (length != 0) {
+        CHECK(length <= copy.size());
+        CHECK(edited.parse(copy.data(), length));
+        CHECK(edited.ednsPayloadSize() == 1232);
+    }
+    memcpy(copy.data(), data, size);
+    length = dnsRemoveOpt(copy.data(), size);
+    if (length != 0) {
+        CHECK(edited.parse(copy.data(), length));
+    }
+
+    uint8_t response[DNS_UDP_MAX_PAYLOAD];
+    DnsMessageWriter writer(response, sizeof(response));
+    if (writer.beginResponse(message, DNS_RCODE_NOERROR)) {
+        writer.addA(NULL, 60, 0x0100007f);
+        writer.addOpt();
+        length = writer.finish();
+        if (length != 0) {
+            CHECK(length <= sizeof(response));
+            DnsMessageView reply;
+            CHECK(reply.parse(response, length));
+            walk(reply);
+        }
+    }
+    return 0;
+}
+
+#ifndef HOST_FUZZ
+
+// Seeds: a query with EDNS, and an answer with compression and every
+// decoded type
+static size_t seedQuery(uint8_t *packet, size_t size)
+{
+    DnsMessageWriter writer(packet, size);
+    writer.begin(0x1234, DNS_FLAG_RD);
+    writer.addQuestion("www.Example.com", DNS_TYPE_A);
+    writer.addOpt();
+    return writer.finish();
+}
+
+static size_t seedAnswer(uint8_t *packet, size_t size)
+{
+    static const uint8_t v6[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    static const uint8_t soa[] = {0, 0, 1, 2, 3, 4, 0, 0, 0, 60, 0, 0, 0, 60, 0, 0, 0, 60, 0, 0, 1, 44};
+    DnsMessageWriter writer(packet, size);
+    writer.begin(0x4321, DNS_FLAG_QR | DNS_FLAG_RD | DNS_FLAG_RA);
+    writer.addQuestion("www.example.com", DNS_TYPE_A);
+    writer.addCname(NULL, 300, "edge.example.net");
+    writer.addA("edge.example.net", 60, 0x0a0b0c0d);
+    writer.addAAAA("edge.example.net", 60, v6);
+    writer.addTxt("www.example.com", 60, "v=spf1 -all");
+    writer.addSrv("_sip._udp.example.com", 60, 10, 20, 5060, "sip.example.com", DNS_SECTION_AUTHORITY);
+    writer.addRecord("example.com", DNS_TYPE_SOA, DNS_CLASS_IN, 60, soa, sizeof(soa), DNS_SECTION_AUTHORITY);
+    writer.addOpt();
+    return writer.finish();
+}
+
+static void mutate(std::vector<uint8_t> &packet, uint64_t &state)
+{
+    uint32_t edits = 1 + hostRandom(state) % 4;
+    for (uint32_t e = 0; e < edits; e++) {
+        uint32_t r = hostRandom(state);
+        size_t at = packet.empty() ? 0 : r % packet.size();
+        switch ((r >> 16) % 6) {
+        case 0:
+            // Flip a bit
+            if (!packet.empty()) {
+                packet[at] ^= (uint8_t)(1 << ((r >> 8) & 7));
+            }
+            break;
+        case 1:
+            // Interesting byte: label lengths, pointers, counts
+            if (!packet.empty()) {
+                static const uint8_t bytes[] = {0x00, 0x01, 0x3f, 0x40, 0x7f, 0xc0, 0xc0, 0xff};
+                packet[at] = bytes[(r >> 8) & 7];
+            }
+            break;
+        case 2:
+            // Compression pointer to anywhere
+            if (packet.size() > 1) {
+                packet[at] = 0xc0 | ((r >> 8) & 0x3f);
+                packet[(at + 1) % packet.size()] = (uint8_t)hostRandom(state);
+            }
+            break;
+        case 3:
+            packet.resize(at);
+            break;
+        case 4:
+            packet.insert(packet.begin() + at, (uint8_t)(r >> 8));
+            break;
+        default:
+            // Section counts
+            if (packet.size() >= DNS_HEADER_LENGTH) {
+                packet[4 + ((r >> 8) % 8)] = (uint8_t)(r >> 12);
+            }
+            break;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    uint64_t state = argc > 2 ? strtoull(argv[2], NULL, 0) : 1;
+
+    uint8_t buffer[DNS_UDP_MAX_PAYLOAD];
+    std::vector<std::vector<uint8_t> > seeds;
+    size_t n = seedQuery(buffer, sizeof(buffer));
+    CHECK(n != 0);
+    seeds.push_back(std::vector<uint8_t>(buffer, buffer + n));
+    n = seedAnswer(buffer, sizeof(buffer));
+    CHECK(n != 0);
+    seeds.push_back(std::vector<uint8_t>(buffer, buffer + n));
+
+    uint32_t parsed = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        std::vector<uint8_t> packet = seeds[i % seeds.size()];
+        mutate(packet, state);
+        DnsMessageView message;
+        parsed += message.parse(packet.data(), packet.size());
+        LLVMFuzzerTestOneInput(packet.data(), packet.size());
+    }
+    printf("fuzz_dns_message: %lu mutated packets, %lu parsed\n", (unsigned long)iterations, (unsigned long)parsed);
+    return 0;
+}
+
+#endif // HOST_FUZZ
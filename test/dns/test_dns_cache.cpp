@@ -0,0 +1,164 @@
+/**
+ * @file      test_dns_cache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include <string.h>
+#include "DnsCache.h"
+#include "HostTest.h"
+
+static void nameOf(uint32_t n, char *name, size_t size)
+{
+    snprintf(name, size, "host%lu.example.test", (unsigned long)n);
+}
+
+static void testLookup()
+{
+    DnsCache cache;
+    CHECK(cache.begin(16));
+    DnsCacheAnswer answer;
+    CHECK(!cache.lookup("example.com", 0, answer));
+    CHECK(cache.insert("Example.COM.", 0x0100007f, 60, 0));
+    CHECK(cache.lookup("example.com", 1000, answer));
+    CHECK(answer.kind == DNS_CACHE_ADDRESS);
+    CHECK(answer.addr == 0x0100007f);
+    CHECK(answer.ttl == 59);
+    CHECK(!answer.stale);
+    CHECK(cache.size() == 1);
+
+    // Replaced in place
+    CHECK(cache.insert("example.com", 0x0200007f, 60, 0));
+    CHECK(cache.lookup("EXAMPLE.com.", 0, answer) && answer.addr == 0x0200007f);
+    CHECK(cache.size() == 1);
+
+    CHECK(cache.remove("example.com"));
+    CHECK(!cache.lookup("example.com", 0, answer));
+    CHECK(cache.size() == 0);
+}
+
+static void testExpiry()
+{
+    DnsCache cache;
+    CHECK(cache.begin(16));
+    DnsCacheAnswer answer;
+    CHECK(cache.insert("stale.test", 1, 1, 0));
+    // Clamped to the minimum TTL
+    CHECK(cache.lookup("stale.test", 0, answer) && answer.ttl == DNS_CACHE_MIN_TTL);
+    CHECK(cache.lookup("stale.test", DNS_CACHE_MIN_TTL * 1000, answer));
+    CHECK(answer.stale && answer.refresh && answer.ttl == DNS_CACHE_STALE_TTL);
+    CHECK(!cache.lookup("stale.test", (DNS_CACHE_MIN_TTL + DNS_CACHE_STALE_WINDOW) * 1000, answer));
+
+    // Negative answers are not served stale, and never displace an address
+    CHECK(cache.insertNegative("missing.test", DNS_CACHE_NXDOMAIN, 60, 0));
+    CHECK(cache.lookup("missing.test", 0, answer) && answer.kind == DNS_CACHE_NXDOMAIN);
+    CHECK(!cache.lookup("missing.test", 61 * 1000, answer));
+    CHECK(cache.insert("kept.test", 7, 60, 0));
+    cache.insertNegative("kept.test", DNS_CACHE_SERVFAIL, 30, 0);
+    CHECK(cache.lookup("kept.test", 0, answer) && answer.kind == DNS_CACHE_ADDRESS && answer.addr == 7);
+}
+
+// Entries go once they can no longer be served, so none lives long enough
+// for its 32-bit expiry time to come round again
+static void testSweep()
+{
+    DnsCache cache;
+    CHECK(cache.begin(8));
+    DnsCacheAnswer answer;
+    CHECK(cache.insert("address.test", 1, 60, 0));
+    CHECK(cache.insertNegative("negative.test", DNS_CACHE_NXDOMAIN, 60, 0));
+    CHECK(cache.sweep(59 * 1000, cache.capacity()) == 0);
+    CHECK(cache.sweep(60 * 1000, cache.capacity()) == 1);
+    CHECK(!cache.lookup("negative.test", 60 * 1000, answer));
+    CHECK(cache.lookup("address.test", 60 * 1000, answer) && answer.stale);
+    CHECK(cache.sweep((60 + DNS_CACHE_STALE_WINDOW) * 1000 - 1, cache.capacity()) == 0);
+    CHECK(cache.sweep((60 + DNS_CACHE_STALE_WINDOW) * 1000, cache.capacity()) == 1);
+    CHECK(cache.size() == 0);
+    // Without the sweep this would read as fresh for another ~24.8 days
+    CHECK(!cache.lookup("address.test", 60 * 1000 + 0x80000000u, answer));
+
+    // A small budget takes several calls to get round
+    for (uint32_t i = 0; i < 8; i++) {
+        char name[32];
+        nameOf(i, name, sizeof(name));
+        CHECK(cache.insertNegative(name, DNS_CACHE_NODATA, 5, 0));
+    }
+    uint32_t dropped = 0;
+    for (int call = 0; call < 4; call++) {
+        dropped += cache.sweep(5000, 2);
+    }
+    CHECK(dropped == 8 && cache.size() == 0);
+    for (uint32_t i = 0; i < 8; i++) {
+        char name[32];
+        nameOf(i, name, sizeof(name));
+        CHECK(!cache.lookup(name, 5000, answer));
+    }
+}
+
+// Once full, every insert evicts one entry and unlinks it from the index,
+// so the index never fills with slots of reused entries.
+static void testEviction()
+{
+    const uint32_t capacity = 64;
+    DnsCache cache;
+    CHECK(cache.begin(capacity));
+    DnsCacheAnswer answer;
+    char name[40];
+    const uint32_t total = capacity * 50;
+    for (uint32_t n = 0; n < total; n++) {
+        nameOf(n, name, sizeof(name));
+        CHECK(cache.insert(name, n, 300, 0));
+        // Just inserted, so it must be found, whatever was evicted for it
+        CHECK(cache.lookup(name, 0, answer) && answer.addr == n);
+        CHECK(cache.size() <= capacity);
+    }
+    CHECK(cache.size() == capacity);
+    DnsCacheStats stats = cache.stats();
+    CHECK(stats.inserts == total);
+    CHECK(stats.evictions == total - capacity);
+
+    // What is left maps to its own address, and removing it all empties
+    // the index
+    uint32_t found = 0;
+    for (uint32_t n = 0; n < total; n++) {
+        nameOf(n, name, sizeof(name));
+        if (cache.lookup(name, 0, answer)) {
+            CHECK(answer.addr == n);
+            CHECK(cache.remove(name));
+            found++;
+        }
+    }
+    CHECK(found == capacity);
+    CHECK(cache.size() == 0);
+}
+
+// Expired entries go before referenced ones
+static void testEvictsExpiredFirst()
+{
+    DnsCache cache;
+    CHECK(cache.begin(4));
+    DnsCacheAnswer answer;
+    CHECK(cache.insert("a.test", 1, 300, 0));
+    CHECK(cache.insertNegative("b.test", DNS_CACHE_NXDOMAIN, 5, 0));
+    CHECK(cache.insert("c.test", 3, 300, 0));
+    CHECK(cache.insert("d.test", 4, 300, 0));
+    CHECK(cache.lookup("a.test", 0, answer));
+    CHECK(cache.lookup("c.test", 0, answer));
+    CHECK(cache.lookup("d.test", 0, answer));
+    CHECK(cache.insert("e.test", 5, 300, 10000));
+    CHECK(!cache.lookup("b.test", 10000, answer));
+    CHECK(cache.lookup("a.test", 10000, answer) && answer.addr == 1);
+    CHECK(cache.lookup("e.test", 10000, answer) && answer.addr == 5);
+}
+
+int main()
+{
+    testLookup();
+    testExpiry();
+    testSweep();
+    testEviction();
+    testEvictsExpiredFirst();
+    printf("test_dns_cache: ok\n");
+    return 0;
+}
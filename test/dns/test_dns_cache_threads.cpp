@@ -0,0 +1,127 @@
+/**
+ * @file      test_dns_cache_threads.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// DnsCache shared the way the DNS workers share it: reader threads look up
+// while writer threads insert, replace and evict. Every hit must be an
+// answer some writer stored for that very name; a torn read the seqlock
+// let through would pair a name with another name's address. Prints
+// lookups per second for each reader count.
+//
+//   test_dns_cache_threads [lookups per reader] [writers]
+
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "DnsCache.h"
+#include "HostTest.h"
+
+// Few enough entries that writers keep evicting what readers look for
+#define NAMES       512
+#define CAPACITY    128
+
+static char names[NAMES][32];
+
+// The address a writer stores for name `n`: the name in the top half, a
+// version in the bottom one
+static uint32_t addressOf(uint32_t n, uint32_t version)
+{
+    return (n << 16) | (version & 0xFFFF);
+}
+
+static void writer(DnsCache *cache, uint32_t seed, std::atomic<bool> *stop)
+{
+    uint64_t state = seed;
+    uint32_t version = 0;
+    while (!stop->load(std::memory_order_relaxed)) {
+        uint32_t r = hostRandom(state);
+        uint32_t n = r % NAMES;
+        switch ((r >> 16) % 8) {
+        case 0:
+            cache->remove(names[n]);
+            break;
+        case 1:
+            cache->insertNegative(names[n], DNS_CACHE_NXDOMAIN, 30, 0);
+            break;
+        default:
+            cache->insert(names[n], addressOf(n, version++), 300, 0);
+            break;
+        }
+    }
+}
+
+static void reader(DnsCache *cache, uint32_t seed, uint32_t lookups, uint32_t *hits)
+{
+    uint64_t state = seed;
+    DnsCacheAnswer answer;
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < lookups; i++) {
+        uint32_t n = hostRandom(state) % NAMES;
+        if (cache->lookup(names[n], 0, answer)) {
+            if (answer.kind == DNS_CACHE_ADDRESS) {
+                CHECK(answer.addr >> 16 == n);
+                CHECK(answer.ttl <= 300);
+            } else {
+                CHECK(answer.kind == DNS_CACHE_NXDOMAIN);
+            }
+            found++;
+        }
+    }
+    *hits = found;
+}
+
+static void run(uint32_t readers, uint32_t writers, uint32_t lookups)
+{
+    DnsCache cache;
+    CHECK(cache.begin(CAPACITY));
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> writing;
+    for (uint32_t w = 0; w < writers; w++) {
+        writing.push_back(std::thread(writer, &cache, 100 + w, &stop));
+    }
+    std::vector<std::thread> reading;
+    std::vector<uint32_t> hits(readers);
+    uint64_t start = hostNanos();
+    for (uint32_t r = 0; r < readers; r++) {
+        reading.push_back(std::thread(reader, &cache, 1 + r, lookups, &hits[r]));
+    }
+    for (uint32_t r = 0; r < readers; r++) {
+        reading[r].join();
+    }
+    uint64_t elapsed = hostNanos() - start;
+    stop = true;
+    for (uint32_t w = 0; w < writers; w++) {
+        writing[w].join();
+    }
+
+    uint32_t found = 0;
+    for (uint32_t r = 0; r < readers; r++) {
+        found += hits[r];
+    }
+    DnsCacheStats stats = cache.stats();
+    CHECK(cache.size() <= CAPACITY);
+    CHECK(stats.hits + stats.negativeHits >= found);
+    printf("%lu readers, %lu writers: %.1f M lookups/s, hit ratio %.1f%%, %lu inserts, %lu evictions\n",
+           (unsigned long)readers, (unsigned long)writers, (double)readers * lookups * 1000.0 / elapsed,
+           found * 100.0 / ((double)readers * lookups), (unsigned long)stats.inserts,
+           (unsigned long)stats.evictions);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t lookups = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000000;
+    uint32_t writers = argc > 2 ? strtoul(argv[2], NULL, 0) : 1;
+    for (uint32_t n = 0; n < NAMES; n++) {
+        snprintf(names[n], sizeof(names[n]), "n%lu.threads.test", (unsigned long)n);
+    }
+    for (uint32_t readers = 1; readers <= 4; readers *= 2) {
+        run(readers, writers, lookups);
+    }
+    printf("test_dns_cache_threads: ok\n");
+    return 0;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file      test_dns_forwarder.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// DnsForwarder against a fake upstream on a loopback UDP socket: ID
+// rewriting, 0x20 case randomization, coalescing, spoofed answers, retries and timeouts, then a
+// load run with upstream loss.
+//
+//   test_dns_forwarder [load queries] [distinct names] [loss percent]
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <string>
+#include <vector>
+#include "DnsForwarder.h"
+#include "DnsMessage.h"
+#include "DnsPlatform.h"
+#include "HostTest.h"
+
+struct Answer {
+    DnsClient client;
+    uint16_t id;
+    uint8_t rcode;
+    uint32_t addr;
+    std::string name;
+};
+
+static std::vector<Answer> answers;
+
+static void onAnswer(const DnsClient &client, const uint8_t *response, size_t length, void *arg)
+{
+    (void)arg;
+    DnsMessageView message;
+    CHECK(message.parse(response, length));
+    Answer a;
+    a.client = client;
+    a.id = message.id();
+    a.rcode = message.rcode();
+    a.addr = 0;
+    DnsQuestion question;
+    char name[DNS_NAME_BUFFER_SIZE];
+    CHECK(message.firstQuestion(question) && question.name.toString(name, sizeof(name)));
+    a.name = name;
+    DnsRecordCursor cursor = message.records(DNS_SECTION_ANSWER);
+    DnsRecord record;
+    if (cursor.next(record)) {
+        record.a(a.addr);
+    }
+    answers.push_back(a);
+}
+
+// The fake upstream
+static int upstream = -1;
+static uint16_t upstreamPort;
+
+static void openUpstream()
+{
+    upstream = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(upstream >= 0);
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(upstream, (struct sockaddr *)&local, sizeof(local)) == 0);
+    socklen_t length = sizeof(local);
+    CHECK(getsockname(upstream, (struct sockaddr *)&local, &length) == 0);
+    upstreamPort = ntohs(local.sin_port);
+    fcntl(upstream, F_SETFL, fcntl(upstream, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static size_t query(uint8_t *packet, size_t size, uint16_t id, const char *name)
+{
+    DnsMessageWriter writer(packet, size);
+    writer.begin(id, DNS_FLAG_RD);
+    writer.addQuestion(name, DNS_TYPE_A);
+    return writer.finish();
+}
+
+// Next query upstream received, or 0 when there is none yet
+static size_t receiveUpstream(uint8_t *packet, size_t size, struct sockaddr_in &from)
+{
+    for (int i = 0; i < 100; i++) {
+        socklen_t length = sizeof(from);
+        ssize_t n = recvfrom(upstream, packet, size, 0, (struct sockaddr *)&from, &length);
+        if (n > 0) {
+            return (size_t)n;
+        }
+        if (i < 99) {
+            usleep(1000);
+        }
+    }
+    return 0;
+}
+
+// Answers `packet` with `addr`, with the question echoed
+static void answerUpstream(const uint8_t *packet, size_t length, const struct sockaddr_in &to, uint32_t addr)
+{
+    DnsMessageView message;
+    CHECK(message.parse(packet, length));
+    uint8_t response[512];
+    DnsMessageWriter writer(response, sizeof(response));
+    CHECK(writer.beginResponse(message, DNS_RCODE_NOERROR));
+    CHECK(writer.addA(NULL, 300, addr));
+    size_t n = writer.finish();
+    CHECK(sendto(upstream, response, n, 0, (const struct sockaddr *)&to, sizeof(to)) == (ssize_t)n);
+}
+
+static void pollUntil(DnsForwarder &forwarder, uint32_t now, size_t count)
+{
+    for (int i = 0; i < 1000 && answers.size() < count; i++) {
+        forwarder.poll(now);
+        usleep(100);
+    }
+}
+
+static DnsClient client(uint16_t port, uint16_t id)
+{
+    DnsClient c;
+    memset(&c, 0, sizeof(c));
+    c.addr = htonl(INADDR_LOOPBACK);
+    c.port = port;
+    c.id = id;
+    return c;
+}
+
+static void testRelay()
+{
+    DnsForwarder forwarder;
+    CHECK(forwarder.begin(htonl(INADDR_LOOPBACK), upstreamPort, onAnswer));
+    uint32_t now = dnsMillis();
+    uint8_t packet[512];
+    size_t length = query(packet, sizeof(packet), 0x1234, "Relay.Forwarder.test");
+
+    // Two clients asking the same question share one upstream request
+    answers.clear();
+    CHECK(forwarder.forward(client(1000, 0x1234), packet, length, now));
+    length = query(packet, sizeof(packet), 0x4321, "relay.forwarder.TEST");
+    CHECK(forwarder.forward(client(1001, 0x4321), packet, length, now));
+    CHECK(forwarder.pending() == 1);
+    CHECK(forwarder.stats().coalesced == 1);
+
+    struct sockaddr_in from;
+    uint8_t seen[512];
+    size_t n = receiveUpstream(seen, sizeof(seen), from);
+    CHECK(n == length);
+    uint16_t upstreamId = (seen[0] << 8) | seen[1];
+    CHECK(memcmp(seen + 2, packet + 2, 10) == 0);
+    CHECK(receiveUpstream(seen + n, sizeof(seen) - n, from) == 0);
+
+    // The name goes out in a case of its own
+    bool recased = false;
+    for (size_t i = 12; i < length; i++) {
+        CHECK(dnsToLower((char)seen[i]) == dnsToLower((char)packet[i]));
+        recased |= seen[i] != packet[i];
+    }
+    CHECK(recased);
+
+    // A different question under the right ID is ignored, and so is the
+    // same one in a case other than the one sent
+    uint8_t spoof[512];
+    size_t spoofLength = query(spoof, sizeof(spoof), upstreamId, "other.test");
+    answerUpstream(spoof, spoofLength, from, 0x0badbad0);
+    memcpy(spoof, seen, n);
+    for (size_t i = 12; i < n - 4; i++) {
+        spoof[i] = (uint8_t)dnsToLower((char)spoof[i]);
+    }
+    CHECK(memcmp(spoof, seen, n) != 0);
+    answerUpstream(spoof, n, from, 0x0badbad0);
+    forwarder.poll(now);
+    usleep(2000);
+    forwarder.poll(now);
+    CHECK(answers.empty());
+
+    answerUpstream(seen, n, from, 0x0a00000a);
+    pollUntil(forwarder, now, 2);
+    CHECK(answers.size() == 2);
+    CHECK(answers[0].client.port == 1000 && answers[0].id == 0x1234);
+    CHECK(answers[1].client.port == 1001 && answers[1].id == 0x4321);
+    CHECK(answers[0].rcode == DNS_RCODE_NOERROR && answers[0].addr == 0x0a00000a);
+    // In the spelling of the query that went upstream, not the random one
+    CHECK(answers[0].name == "Relay.Forwarder.test" && answers[1].name == "Relay.Forwarder.test");
+    CHECK(forwarder.pending() == 0);
+    forwarder.end();
+}
+
+static void testTimeout()
+{
+    DnsForwarder forwarder;
+    CHECK(forwarder.begin(htonl(INADDR_LOOPBACK), upstreamPort, onAnswer));
+    uint32_t now = dnsMillis();
+    uint8_t packet[512];
+    size_t length = query(packet, sizeof(packet), 0x0042, "silent.test");
+    answers.clear();
+    CHECK(forwarder.forward(client(2000, 0x0042), packet, length, now));
+
+    // The first try and each retry reach upstream, then the client gets a
+    // SERVFAIL for its own question
+    struct sockaddr_in from;
+    uint8_t seen[512];
+    CHECK(receiveUpstream(seen, sizeof(seen), from) == length);
+    for (int retry = 1; retry <= DNS_FORWARDER_RETRIES; retry++) {
+        now += DNS_FORWARDER_TIMEOUT_MS + DNS_WHEEL_TICK_MS;
+        forwarder.poll(now);
+        CHECK(receiveUpstream(seen, sizeof(seen), from) == length);
+        CHECK(answers.empty());
+    }
+    now += DNS_FORWARDER_TIMEOUT_MS + DNS_WHEEL_TICK_MS;
+    forwarder.poll(now);
+    CHECK(answers.size() == 1);
+    CHECK(answers[0].id == 0x0042 && answers[0].rcode == DNS_RCODE_SERVFAIL);
+    CHECK(forwarder.stats().retries == DNS_FORWARDER_RETRIES);
+    CHECK(forwarder.stats().timeouts == 1);
+    CHECK(forwarder.pending() == 0);
+
+    // end() fails whatever is still waiting
+    CHECK(forwarder.forward(client(2001, 0x0043), packet, length, now));
+    answers.clear();
+    forwarder.end();
+    CHECK(answers.size() == 1 && answers[0].rcode == DNS_RCODE_SERVFAIL);
+}
+
+// Keeps the pending table full of distinct and repeated names while the
+// fake upstream answers, dropping `loss` percent. Every client must get an
+// answer, the lost ones after a retry.
+static void testLoad(uint32_t total, uint32_t names, uint32_t loss)
+{
+    DnsForwarder forwarder;
+    CHECK(forwarder.begin(htonl(INADDR_LOOPBACK), upstreamPort, onAnswer));
+    answers.clear();
+    answers.reserve(total);
+    uint64_t seed = 7;
+    uint32_t sent = 0;
+    uint32_t lost = 0;
+    uint8_t packet[512];
+    uint64_t start = hostNanos();
+    // Virtual time, so a lost query is retried without waiting for real
+    uint32_t now = dnsMillis();
+    while (answers.size() < total) {
+        while (sent < total) {
+            char name[40];
+            snprintf(name, sizeof(name), "n%lu.load.test", (unsigned long)(hostRandom(seed) % names));
+            size_t length = query(packet, sizeof(packet), (uint16_t)sent, name);
+            if (!forwarder.forward(client(3000, (uint16_t)sent), packet, length, now)) {
+                break;
+            }
+            sent++;
+        }
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        ssize_t n;
+        bool idle = true;
+        while ((n = recvfrom(upstream, packet, sizeof(packet), 0, (struct sockaddr *)&from, &fromLength)) > 0) {
+            idle = false;
+            if (hostRandom(seed) % 100 < loss) {
+                lost++;
+            } else {
+                answerUpstream(packet, n, from, 0x01010101);
+            }
+            fromLength = sizeof(from);
+        }
+        forwarder.poll(now);
+        if (idle) {
+            now += DNS_WHEEL_TICK_MS;
+        }
+    }
+    uint64_t elapsed = hostNanos() - start;
+    const DnsForwarderStats &stats = forwarder.stats();
+    uint32_t failed = 0;
+    for (size_t i = 0; i < answers.size(); i++) {
+        failed += answers[i].rcode != DNS_RCODE_NOERROR;
+    }
+    printf("%lu queries over %lu names with %lu%% loss: %.0f queries/s, %lu upstream, %lu coalesced, "
+           "%lu retries, %lu timeouts\n",
+           (unsigned long)total, (unsigned long)names, (unsigned long)loss, total * 1e9 / elapsed,
+           (unsigned long)stats.forwarded, (unsigned long)stats.coalesced, (unsigned long)stats.retries,
+           (unsigned long)stats.timeouts);
+    CHECK(answers.size() == total);
+    CHECK(stats.forwarded + stats.coalesced == total);
+    CHECK(lost == 0 || stats.retries > 0);
+    // Only requests lost on every try fail
+    CHECK((failed == 0) == (stats.timeouts == 0));
+    forwarder.end();
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t total = argc > 1 ? strtoul(argv[1], NULL, 0) : 200000;
+    uint32_t names = argc > 2 ? strtoul(argv[2], NULL, 0) : 1000;
+    uint32_t loss = argc > 3 ? strtoul(argv[3], NULL, 0) : 1;
+    openUpstream();
+    testRelay();
+    testTimeout();
+    testLoad(total, names, loss);
+    close(upstream);
+    printf("test_dns_forwarder: ok\n");
+    return 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file      test_dns_history.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// DnsHistory on a scratch directory: lookups, reloading from the snapshot
+// and journal, a torn journal batch, a torn log tail, the text log
+// converter and a full table.
+
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include "DnsHistory.h"
+#include "HostTest.h"
+
+static std::string card;
+
+static std::string path(const char *file)
+{
+    return card + file;
+}
+
+static long fileSize(const char *file)
+{
+    FILE *f = fopen(path(file).c_str(), "rb");
+    if (!f) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static void copyFile(const char *from, const char *to)
+{
+    FILE *in = fopen(path(from).c_str(), "rb");
+    FILE *out = fopen(path(to).c_str(), "wb");
+    CHECK(in && out);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        CHECK(fwrite(buffer, 1, n, out) == n);
+    }
+    fclose(in);
+    fclose(out);
+}
+
+static void nameOf(const char *prefix, uint32_t n, char *name, size_t size)
+{
+    snprintf(name, size, "%s%lu.history.test", prefix, (unsigned long)n);
+}
+
+// How many of `prefix`0 .. `prefix`(total - 1) map to `base` + n
+static uint32_t countFound(DnsHistory &history, const char *prefix, uint32_t total, uint32_t base)
+{
+    char name[64];
+    uint32_t found = 0;
+    for (uint32_t n = 0; n < total; n++) {
+        nameOf(prefix, n, name, sizeof(name));
+        uint32_t addr;
+        found += history.lookup(name, addr) && addr == base + n;
+    }
+    return found;
+}
+
+static void clearCard()
+{
+    unlink(path(DNS_HISTORY_LOG_FILE).c_str());
+    unlink(path(DNS_HISTORY_INDEX_FILE).c_str());
+    unlink(path(DNS_HISTORY_TEMP_FILE).c_str());
+}
+
+static void testLookup(fs::FS &fs)
+{
+    clearCard();
+    DnsHistory history;
+    CHECK(history.begin(fs, 64));
+    uint32_t addr;
+    CHECK(!history.lookup("example.com", addr));
+    CHECK(history.record("Example.COM", 0x0100007f, 1));
+    CHECK(history.lookup("example.com.", addr) && addr == 0x0100007f);
+
+    // A repeat is not written again; a new address is
+    CHECK(history.record("example.com", 0x0100007f, 2));
+    CHECK(history.stats().appends == 1);
+    CHECK(history.record("example.com", 0x0200007f, 3));
+    CHECK(history.stats().appends == 2);
+    CHECK(history.lookup("example.com", addr) && addr == 0x0200007f);
+    CHECK(history.size() == 1);
+    CHECK(!history.record("", 1, 4));
+    history.end();
+
+    // Saved on end() and loaded again
+    CHECK(history.begin(fs, 64));
+    CHECK(history.lookup("example.com", addr) && addr == 0x0200007f);
+    CHECK(history.size() == 1);
+}
+
+// Several saves become journal batches after the snapshot. Records written
+// after the last batch are replayed from the log.
+static void testJournal(fs::FS &fs)
+{
+    clearCard();
+    const uint32_t rounds = 4;
+    const uint32_t perRound = DNS_HISTORY_SAVE_INTERVAL + 76;
+    const uint32_t unsaved = DNS_HISTORY_SAVE_INTERVAL / 2;
+    char name[64];
+    {
+        DnsHistory history;
+        CHECK(history.begin(fs, 16384));
+        long snapshot = fileSize(DNS_HISTORY_INDEX_FILE);
+        CHECK(snapshot > 0);
+        for (uint32_t r = 0; r < rounds; r++) {
+            for (uint32_t n = 0; n < perRound; n++) {
+                nameOf("r", r * perRound + n, name, sizeof(name));
+                CHECK(history.record(name, r * perRound + n, 0));
+            }
+            history.flush();
+            // A batch was appended, not a new snapshot
+            long size = fileSize(DNS_HISTORY_INDEX_FILE);
+            CHECK(size > snapshot);
+            snapshot = size;
+        }
+        for (uint32_t n = 0; n < unsaved; n++) {
+            nameOf("u", n, name, sizeof(name));
+            CHECK(history.record(name, n, 0));
+        }
+        history.flush();
+        CHECK(fileSize(DNS_HISTORY_INDEX_FILE) == snapshot);
+        // What the card holds if the power goes now, before end() saves
+        copyFile(DNS_HISTORY_INDEX_FILE, "/cut.idx");
+        history.end();
+        copyFile("/cut.idx", DNS_HISTORY_INDEX_FILE);
+        unlink(path("/cut.idx").c_str());
+    }
+
+    DnsHistory history;
+    CHECK(history.begin(fs, 16384));
+    CHECK(history.size() == rounds * perRound + unsaved);
+    CHECK(countFound(history, "r", rounds * perRound, 0) == rounds * perRound);
+    CHECK(countFound(history, "u", unsaved, 0) == unsaved);
+    history.end();
+
+    // Cut into the last batch: it is ignored and its records replayed
+    long size = fileSize(DNS_HISTORY_INDEX_FILE);
+    CHECK(truncate(path(DNS_HISTORY_INDEX_FILE).c_str(), size - 100) == 0);
+    CHECK(history.begin(fs, 16384));
+    CHECK(history.size() == rounds * perRound + unsaved);
+    CHECK(countFound(history, "r", rounds * perRound, 0) == rounds * perRound);
+    CHECK(countFound(history, "u", unsaved, 0) == unsaved);
+    history.end();
+
+    // Without an index it is rebuilt from the log
+    unlink(path(DNS_HISTORY_INDEX_FILE).c_str());
+    CHECK(history.begin(fs, 16384));
+    CHECK(history.size() == rounds * perRound + unsaved);
+    CHECK(countFound(history, "r", rounds * perRound, 0) == rounds * perRound);
+}
+
+// Half a record at the end of the log is dropped, and what comes after it
+// is appended where the last whole record ends
+static void testTornTail(fs::FS &fs)
+{
+    clearCard();
+    DnsHistory history;
+    CHECK(history.begin(fs, 256));
+    char name[64];
+    for (uint32_t n = 0; n < 100; n++) {
+        nameOf("t", n, name, sizeof(name));
+        CHECK(history.record(name, n, 0));
+    }
+    history.end();
+    long whole = fileSize(DNS_HISTORY_LOG_FILE);
+    FILE *log = fopen(path(DNS_HISTORY_LOG_FILE).c_str(), "ab");
+    CHECK(log);
+    static const uint8_t torn[] = {1, 0, 0, 0, 2, 0, 0, 0, 40, 0};
+    CHECK(fwrite(torn, 1, sizeof(torn), log) == sizeof(torn));
+    fclose(log);
+
+    CHECK(history.begin(fs, 256));
+    CHECK(history.size() == 100);
+    CHECK(countFound(history, "t", 100, 0) == 100);
+    CHECK(fileSize(DNS_HISTORY_LOG_FILE) <= whole);
+    CHECK(history.record("after.history.test", 7, 0));
+    history.end();
+
+    CHECK(history.begin(fs, 256));
+    uint32_t addr;
+    CHECK(history.lookup("after.history.test", addr) && addr == 7);
+    CHECK(countFound(history, "t", 100, 0) == 100);
+}
+
+static void testImport(fs::FS &fs)
+{
+    clearCard();
+    FILE *text = fopen(path("/dnslog1.txt").c_str(), "w");
+    CHECK(text);
+    fprintf(text, "1000 Query: one.example IP: 10.0.0.1\n");
+    fprintf(text, "not a query line\n");
+    fprintf(text, "1001 Query: two.example IP: 10.0.0.300\n");
+    fprintf(text, "1002 Query: Two.Example IP: 10.0.0.2\n");
+    fprintf(text, "1003 Query: one.example IP: 10.0.0.3\n");
+    fclose(text);
+
+    DnsHistory history;
+    CHECK(history.begin(fs, 64));
+    CHECK(history.importTextLog("/dnslog1.txt") == 3);
+    CHECK(history.importTextLog("/missing.txt") == 0);
+    uint32_t addr;
+    CHECK(history.lookup("one.example", addr) && addr == (10 | (3 << 24)));
+    CHECK(history.lookup("two.example", addr) && addr == (10 | (2 << 24)));
+    CHECK(history.size() == 2);
+    unlink(path("/dnslog1.txt").c_str());
+}
+
+static void testFull(fs::FS &fs)
+{
+    clearCard();
+    DnsHistory history;
+    CHECK(history.begin(fs, 8));
+    char name[64];
+    for (uint32_t n = 0; n < 8; n++) {
+        nameOf("f", n, name, sizeof(name));
+        CHECK(history.record(name, n, 0));
+    }
+    CHECK(!history.record("one.more.test", 1, 0));
+    CHECK(history.stats().full == 1);
+    // Known names still take new addresses
+    nameOf("f", 3, name, sizeof(name));
+    CHECK(history.record(name, 33, 0));
+    uint32_t addr;
+    CHECK(history.lookup(name, addr) && addr == 33);
+}
+
+int main()
+{
+    char dir[] = "/tmp/test_dns_history.XXXXXX";
+    CHECK(mkdtemp(dir));
+    card = dir;
+    fs::FS fs(dir);
+    testLookup(fs);
+    testJournal(fs);
+    testTornTail(fs);
+    testImport(fs);
+    testFull(fs);
+    clearCard();
+    rmdir(dir);
+    printf("test_dns_history: ok\n");
+    return 0;
+}
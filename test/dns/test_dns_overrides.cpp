@@ -0,0 +1,123 @@
+/**
+ * @file      test_dns_overrides.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// DnsOverrides: exact, wildcard and blocked rules and which one wins, and
+// loading the hosts-style file, over-long lines included.
+
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include "DnsOverrides.h"
+#include "HostTest.h"
+
+#define ADDR(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+static DnsOverrideResult lookup(const DnsOverrides &overrides, const char *name, uint32_t &addr)
+{
+    addr = 0xFFFFFFFF;
+    return overrides.lookup(name, addr);
+}
+
+static void testRules()
+{
+    DnsOverrides overrides;
+    uint32_t addr;
+    CHECK(lookup(overrides, "anything.test", addr) == DNS_OVERRIDE_NONE);
+
+    CHECK(overrides.add("nas.home", ADDR(192, 168, 1, 10)));
+    CHECK(overrides.add("*.nas.home", ADDR(192, 168, 1, 11)));
+    CHECK(overrides.add("*.ads.example", 0, true));
+    CHECK(overrides.add("good.ads.example", ADDR(10, 0, 0, 1)));
+    CHECK(overrides.add("*.deep.ads.example", ADDR(10, 0, 0, 2)));
+    CHECK(!overrides.add("", 1));
+    CHECK(!overrides.add(".leading.dot", 1));
+    CHECK(!overrides.add("empty..label", 1));
+    CHECK(overrides.rules() == 5);
+
+    CHECK(lookup(overrides, "nas.home", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(192, 168, 1, 10));
+    CHECK(lookup(overrides, "NAS.Home.", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(192, 168, 1, 10));
+    CHECK(lookup(overrides, "a.b.nas.home", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(192, 168, 1, 11));
+    CHECK(lookup(overrides, "home", addr) == DNS_OVERRIDE_NONE);
+    CHECK(lookup(overrides, "xnas.home", addr) == DNS_OVERRIDE_NONE);
+
+    // A wildcard covers names strictly below it
+    CHECK(lookup(overrides, "ads.example", addr) == DNS_OVERRIDE_NONE);
+    CHECK(lookup(overrides, "x.ads.example", addr) == DNS_OVERRIDE_BLOCKED);
+    // The exact rule wins, then the deepest wildcard
+    CHECK(lookup(overrides, "good.ads.example", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(10, 0, 0, 1));
+    CHECK(lookup(overrides, "x.good.ads.example", addr) == DNS_OVERRIDE_BLOCKED);
+    CHECK(lookup(overrides, "x.deep.ads.example", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(10, 0, 0, 2));
+    CHECK(lookup(overrides, "deep.ads.example", addr) == DNS_OVERRIDE_BLOCKED);
+
+    // Replacing a rule keeps the count and clears the block
+    CHECK(overrides.add("*.ads.example", ADDR(10, 0, 0, 3)));
+    CHECK(overrides.rules() == 5);
+    CHECK(lookup(overrides, "x.ads.example", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(10, 0, 0, 3));
+}
+
+static void testLoad(const std::string &card)
+{
+    FILE *file = fopen((card + DNS_OVERRIDES_FILE).c_str(), "w");
+    CHECK(file);
+    fprintf(file, "# local names\n");
+    fprintf(file, "192.168.1.10 nas.home *.nas.home   # and below\n");
+    fprintf(file, "0.0.0.0 tracker.example\r\n");
+    fprintf(file, "ads.example\n");
+    fprintf(file, "*.wild.example\n");
+    fprintf(file, "1.2.3.4.example\n");
+    fprintf(file, "10.0.0.300 bad.address\n");
+    // Longer than a line may be: the bare name at its end must not become
+    // a rule of its own
+    std::string longLine = "10.0.0.9 ";
+    while (longLine.size() < 600) {
+        longLine += "filler.example ";
+    }
+    longLine += "victim.example";
+    fprintf(file, "%s\n", longLine.c_str());
+    fprintf(file, "10.0.0.8 after.long.line");
+    fclose(file);
+
+    fs::FS fs(card.c_str());
+    DnsOverrides overrides;
+    CHECK(overrides.load(fs));
+    CHECK(overrides.skipped() == 1);
+    uint32_t addr;
+    CHECK(lookup(overrides, "nas.home", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(192, 168, 1, 10));
+    CHECK(lookup(overrides, "pc.nas.home", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(192, 168, 1, 10));
+    CHECK(lookup(overrides, "tracker.example", addr) == DNS_OVERRIDE_BLOCKED);
+    CHECK(lookup(overrides, "sub.tracker.example", addr) == DNS_OVERRIDE_NONE);
+    // A bare name blocks itself and everything below
+    CHECK(lookup(overrides, "ads.example", addr) == DNS_OVERRIDE_BLOCKED);
+    CHECK(lookup(overrides, "cdn.ads.example", addr) == DNS_OVERRIDE_BLOCKED);
+    CHECK(lookup(overrides, "wild.example", addr) == DNS_OVERRIDE_NONE);
+    CHECK(lookup(overrides, "x.wild.example", addr) == DNS_OVERRIDE_BLOCKED);
+    // Not a dotted quad, so a name
+    CHECK(lookup(overrides, "1.2.3.4.example", addr) == DNS_OVERRIDE_BLOCKED);
+    CHECK(lookup(overrides, "10.0.0.300", addr) == DNS_OVERRIDE_BLOCKED);
+    CHECK(lookup(overrides, "victim.example", addr) == DNS_OVERRIDE_NONE);
+    CHECK(lookup(overrides, "filler.example", addr) == DNS_OVERRIDE_NONE);
+    CHECK(lookup(overrides, "after.long.line", addr) == DNS_OVERRIDE_ADDRESS && addr == ADDR(10, 0, 0, 8));
+    CHECK(overrides.memoryUsed() > 0);
+
+    // Loading again starts over; a missing file leaves the table empty
+    unlink((card + DNS_OVERRIDES_FILE).c_str());
+    CHECK(overrides.load(fs));
+    CHECK(overrides.rules() == 0 && overrides.nodes() == 0);
+    CHECK(lookup(overrides, "nas.home", addr) == DNS_OVERRIDE_NONE);
+}
+
+int main()
+{
+    char dir[] = "/tmp/test_dns_overrides.XXXXXX";
+    CHECK(mkdtemp(dir));
+    testRules();
+    testLoad(dir);
+    rmdir(dir);
+    printf("test_dns_overrides: ok\n");
+    return 0;
+}
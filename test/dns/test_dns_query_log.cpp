@@ -0,0 +1,300 @@
+/**
+ * @file      test_dns_query_log.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// DnsLogRing on its own, full and with several producers overrunning one
+// consumer, then DnsQueryLog writing into a scratch directory through the
+// FS stand-in: writes end on sector boundaries unless flushed, files
+// rotate on line boundaries, end() writes out what is still queued, and
+// every record is either written or counted as dropped.
+//
+//   test_dns_query_log [records per producer]
+
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DnsLogRing.h"
+#include "DnsQueryLog.h"
+#include "HostTest.h"
+
+static void testRingFull()
+{
+    DnsLogRing ring;
+    CHECK(!ring.begin(6));
+    CHECK(ring.begin(8));
+    DnsLogRecord record;
+    CHECK(!ring.pop(record));
+    for (uint32_t i = 0; i < 8; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "r%lu.test", (unsigned long)i);
+        CHECK(ring.push(name, i, 100 + i));
+    }
+    CHECK(!ring.push("over.test", 0, 0));
+    CHECK(!ring.push("over.test", 0, 0));
+    CHECK(ring.dropped() == 2 && ring.size() == 8);
+
+    // First in, first out, and a pop makes room for exactly one more
+    CHECK(ring.pop(record));
+    CHECK(strcmp(record.name, "r0.test") == 0 && record.addr == 0 && record.timestamp == 100);
+    CHECK(ring.push("late.test", 8, 108));
+    CHECK(!ring.push("over.test", 0, 0));
+    CHECK(ring.dropped() == 3);
+    for (uint32_t i = 1; i <= 8; i++) {
+        CHECK(ring.pop(record) && record.addr == i);
+    }
+    CHECK(strcmp(record.name, "late.test") == 0);
+    CHECK(!ring.pop(record));
+
+    // Names past the limit are cut, not overrun
+    std::string longName(DNS_LOG_NAME_MAX + 20, 'x');
+    CHECK(ring.push(longName.c_str(), 1, 1));
+    CHECK(ring.pop(record) && record.nameLength == DNS_LOG_NAME_MAX && strlen(record.name) == DNS_LOG_NAME_MAX);
+}
+
+// Producers push faster than the consumer pops: every record is popped or
+// dropped, and each producer's records come out in the order it pushed them
+static void testRingOverrun(uint32_t perProducer)
+{
+    const int producers = 4;
+    DnsLogRing ring;
+    CHECK(ring.begin(64));
+    uint32_t accepted[producers] = {0};
+    std::atomic<int> running(producers);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.push_back(std::thread([&ring, &accepted, &running, p, perProducer]() {
+            for (uint32_t i = 0; i < perProducer; i++) {
+                char name[32];
+                snprintf(name, sizeof(name), "p%d.overrun.test", p);
+                accepted[p] += ring.push(name, i, (uint32_t)p);
+            }
+            running.fetch_sub(1);
+        }));
+    }
+    uint32_t popped = 0;
+    uint32_t last[producers];
+    bool seen[producers] = {false};
+    DnsLogRecord record;
+    for (;;) {
+        bool finished = running.load() == 0;
+        while (ring.pop(record)) {
+            int p = (int)record.timestamp;
+            CHECK(p >= 0 && p < producers);
+            CHECK(record.name[1] == '0' + p);
+            CHECK(!seen[p] || record.addr > last[p]);
+            seen[p] = true;
+            last[p] = record.addr;
+            popped++;
+        }
+        if (finished) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    uint32_t pushed = 0;
+    for (int p = 0; p < producers; p++) {
+        pushed += accepted[p];
+    }
+    printf("ring: %lu records, %lu popped, %lu dropped\n", (unsigned long)(perProducer * producers),
+           (unsigned long)popped, (unsigned long)ring.dropped());
+    CHECK(popped == pushed);
+    CHECK(pushed + ring.dropped() == perProducer * producers);
+}
+
+// File writes seen through the FS stand-in; a size of 0 is a flush
+struct WriteEvent {
+    size_t offset;
+    size_t size;
+};
+
+static std::mutex eventLock;
+static std::vector<WriteEvent> events;
+
+static void onWrite(size_t offset, size_t size)
+{
+    std::lock_guard<std::mutex> hold(eventLock);
+    WriteEvent e = {offset, size};
+    events.push_back(e);
+}
+
+static std::string scratchDir()
+{
+    char dir[] = "/tmp/test_dns_query_log.XXXXXX";
+    CHECK(mkdtemp(dir) != NULL);
+    return dir;
+}
+
+static void removeDir(const std::string &dir)
+{
+    std::string cleanup = "rm -rf " + dir;
+    CHECK(system(cleanup.c_str()) == 0);
+}
+
+static std::vector<std::string> readLines(fs::FS &card, int index)
+{
+    std::vector<std::string> lines;
+    char path[32];
+    dnsLogFileName(path, sizeof(path), index);
+    if (!card.exists(path)) {
+        return lines;
+    }
+    File file = card.open(path, FILE_READ);
+    std::string text;
+    int c;
+    while ((c = file.read()) >= 0) {
+        text += (char)c;
+    }
+    CHECK(text.size() <= DNS_LOG_MAX_FILE_SIZE);
+    CHECK(text.empty() || text[text.size() - 1] == '\n');
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+// Sequence number in the line's name, see logNumbered()
+static long lineNumber(const std::string &line)
+{
+    size_t at = line.find("Query: n");
+    CHECK(at != std::string::npos);
+    return strtol(line.c_str() + at + 8, NULL, 10);
+}
+
+// Logs until the ring takes it; each refusal counts as a drop
+static void logNumbered(DnsQueryLog &log, long n)
+{
+    char name[48];
+    snprintf(name, sizeof(name), "n%ld.query-log.example.test", n);
+    while (!log.log(name, 0x0100000a)) {
+        usleep(200);
+    }
+}
+
+static void testWriter()
+{
+    std::string dir = scratchDir();
+    fs::FS card(dir.c_str());
+    events.clear();
+    fs::setFileWriteHook(onWrite);
+    DnsQueryLog log;
+    CHECK(log.begin(card));
+
+    // Enough for several batches and more than the files kept hold
+    const long total = DNS_LOG_MAX_FILES * DNS_LOG_MAX_FILE_SIZE / 40;
+    for (long n = 0; n < total; n++) {
+        logNumbered(log, n);
+    }
+    log.end();
+    fs::setFileWriteHook(NULL);
+    DnsQueryLogStats stats = log.stats();
+    printf("writer: %lu written, %lu writes, %lu rotations, %lu errors\n", (unsigned long)stats.written,
+           (unsigned long)stats.writes, (unsigned long)stats.rotations, (unsigned long)stats.errors);
+    CHECK(stats.written == (uint32_t)total && stats.errors == 0);
+    CHECK(stats.rotations >= DNS_LOG_MAX_FILES);
+
+    // A write either ends on a sector boundary or is flushed straight after
+    for (size_t i = 0; i < events.size(); i++) {
+        const WriteEvent &e = events[i];
+        if (e.size == 0) {
+            continue;
+        }
+        bool flushed = i + 1 < events.size() && events[i + 1].size == 0;
+        CHECK(flushed || (e.offset + e.size) % DNS_LOG_SECTOR_SIZE == 0);
+        CHECK(e.offset + e.size <= DNS_LOG_MAX_FILE_SIZE);
+    }
+
+    // The newest DNS_LOG_MAX_FILES files, oldest first, hold the last
+    // records in order without a line split between files
+    long expect = -1;
+    for (int index = DNS_LOG_MAX_FILES - 1; index >= 0; index--) {
+        std::vector<std::string> lines = readLines(card, index);
+        CHECK(!lines.empty());
+        for (size_t i = 0; i < lines.size(); i++) {
+            long n = lineNumber(lines[i]);
+            CHECK(expect < 0 || n == expect);
+            expect = n + 1;
+        }
+    }
+    CHECK(expect == total);
+    char path[32];
+    dnsLogFileName(path, sizeof(path), DNS_LOG_MAX_FILES);
+    CHECK(!card.exists(path));
+    removeDir(dir);
+}
+
+// Records still in the ring or the batch reach the card when the log stops,
+// long before DNS_LOG_FLUSH_MS would have
+static void testFlushOnStop()
+{
+    std::string dir = scratchDir();
+    fs::FS card(dir.c_str());
+    DnsQueryLog log;
+    CHECK(log.begin(card));
+    for (long n = 0; n < 5; n++) {
+        logNumbered(log, n);
+    }
+    uint64_t start = hostNanos();
+    log.end();
+    CHECK(hostNanos() - start < DNS_LOG_FLUSH_MS * 1000000ULL);
+    std::vector<std::string> lines = readLines(card, 0);
+    CHECK(lines.size() == 5);
+    for (long n = 0; n < 5; n++) {
+        CHECK(lineNumber(lines[n]) == n);
+    }
+    CHECK(!log.log("after.test", 1));
+
+    // Appends to the file already there on the next start
+    CHECK(log.begin(card));
+    logNumbered(log, 5);
+    log.end();
+    lines = readLines(card, 0);
+    CHECK(lines.size() == 6 && lineNumber(lines[5]) == 5);
+    removeDir(dir);
+}
+
+// Logging as fast as it can: what the ring has no room for is counted, and
+// everything else is written
+static void testDropCounting(uint32_t total)
+{
+    std::string dir = scratchDir();
+    fs::FS card(dir.c_str());
+    DnsQueryLog log;
+    CHECK(log.begin(card));
+    uint32_t refused = 0;
+    for (uint32_t i = 0; i < total; i++) {
+        refused += !log.log("burst.query-log.example.test", i);
+    }
+    log.end();
+    DnsQueryLogStats stats = log.stats();
+    printf("burst: %lu records, %lu written, %lu dropped\n", (unsigned long)total,
+           (unsigned long)stats.written, (unsigned long)stats.dropped);
+    CHECK(stats.dropped == refused);
+    CHECK(stats.written + stats.dropped == total);
+    removeDir(dir);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t perProducer = argc > 1 ? strtoul(argv[1], NULL, 0) : 100000;
+    testRingFull();
+    testRingOverrun(perProducer);
+    testWriter();
+    testFlushOnStop();
+    testDropCounting(perProducer);
+    printf("test_dns_query_log: ok\n");
+    return 0;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file      test_dns_tcp_server.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// DnsTcpServer on loopback against plain blocking client sockets: length
+// framing split across and packed into segments, pipelining up to
+// DNS_TCP_MAX_PIPELINED with answers out of order, the idle timeout, and
+// what happens past DNS_TCP_MAX_CONNECTIONS clients.
+//
+//   test_dns_tcp_server [port]
+
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
+#include "DnsBufferPool.h"
+#include "DnsMessage.h"
+#include "DnsPlatform.h"
+#include "DnsTcpServer.h"
+#include "HostTest.h"
+
+struct Query {
+    DnsClient client;
+    std::vector<uint8_t> packet;
+};
+
+static std::vector<Query> queries;
+static uint16_t serverPort;
+
+static void onQuery(const DnsClient &client, const uint8_t *query, size_t length, void *arg)
+{
+    (void)arg;
+    Query q;
+    q.client = client;
+    q.packet.assign(query, query + length);
+    queries.push_back(q);
+}
+
+// Framed as it goes over TCP, behind its two byte length
+static size_t framedQuery(uint8_t *packet, size_t size, uint16_t id, const char *name)
+{
+    DnsMessageWriter writer(packet + 2, size - 2);
+    writer.begin(id, DNS_FLAG_RD);
+    writer.addQuestion(name, DNS_TYPE_A);
+    size_t length = writer.finish();
+    packet[0] = (uint8_t)(length >> 8);
+    packet[1] = (uint8_t)length;
+    return length + 2;
+}
+
+static int connectClient()
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(sock >= 0);
+    struct timeval timeout = {2, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    struct sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    to.sin_port = htons(serverPort);
+    CHECK(connect(sock, (struct sockaddr *)&to, sizeof(to)) == 0);
+    return sock;
+}
+
+static void sendAll(int sock, const uint8_t *data, size_t length)
+{
+    CHECK(send(sock, data, length, 0) == (ssize_t)length);
+}
+
+static bool readAll(int sock, uint8_t *data, size_t length)
+{
+    while (length > 0) {
+        ssize_t n = recv(sock, data, length, 0);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// ID of the next answer on the connection
+static uint16_t readAnswerId(int sock)
+{
+    uint8_t packet[512];
+    CHECK(readAll(sock, packet, 2));
+    size_t length = (packet[0] << 8) | packet[1];
+    CHECK(length >= 12 && length <= sizeof(packet));
+    CHECK(readAll(sock, packet, length));
+    DnsMessageView message;
+    CHECK(message.parse(packet, length));
+    CHECK(message.isResponse());
+    return message.id();
+}
+
+// The server closed the connection
+static bool closedByServer(int sock)
+{
+    uint8_t byte;
+    return recv(sock, &byte, 1, 0) <= 0;
+}
+
+// Polls until `count` queries have arrived and the client count settles
+static void pump(DnsTcpServer &server, uint32_t now, size_t count)
+{
+    for (int i = 0; i < 200; i++) {
+        server.poll(now);
+        if (queries.size() >= count && i >= 10) {
+            return;
+        }
+        usleep(500);
+    }
+}
+
+static bool answer(DnsTcpServer &server, const Query &q)
+{
+    DnsMessageView message;
+    CHECK(message.parse(q.packet.data(), q.packet.size()));
+    uint8_t response[512];
+    DnsMessageWriter writer(response, sizeof(response));
+    CHECK(writer.beginResponse(message, DNS_RCODE_NOERROR));
+    CHECK(writer.addA(NULL, 60, 0x0a000001));
+    return server.reply(q.client, response, writer.finish());
+}
+
+static void testFraming(DnsTcpServer &server)
+{
+    uint32_t now = dnsMillis();
+    queries.clear();
+    int sock = connectClient();
+    pump(server, now, 0);
+    CHECK(server.connections() == 1);
+
+    // The length prefix alone, then the rest with a second query behind it
+    uint8_t packet[512];
+    size_t first = framedQuery(packet, sizeof(packet), 0x0101, "first.test");
+    size_t second = framedQuery(packet + first, sizeof(packet) - first, 0x0202, "second.test");
+    sendAll(sock, packet, 1);
+    pump(server, now, 0);
+    CHECK(queries.empty());
+    sendAll(sock, packet + 1, first + second - 1);
+    pump(server, now, 2);
+    CHECK(queries.size() == 2);
+    CHECK(queries[0].client.id == 0x0101 && queries[1].client.id == 0x0202);
+    CHECK(queries[0].client.connection == queries[1].client.connection);
+    CHECK(queries[0].client.connection != 0);
+
+    // Answers go out as they are ready, not in query order
+    CHECK(answer(server, queries[1]));
+    CHECK(answer(server, queries[0]));
+    CHECK(readAnswerId(sock) == 0x0202);
+    CHECK(readAnswerId(sock) == 0x0101);
+
+    // A length too short for a header ends the connection
+    uint8_t runt[2] = {0, 5};
+    sendAll(sock, runt, sizeof(runt));
+    pump(server, now, 2);
+    CHECK(server.connections() == 0);
+    CHECK(closedByServer(sock));
+    CHECK(!answer(server, queries[0]));
+    close(sock);
+}
+
+static void testPipelining(DnsTcpServer &server)
+{
+    uint32_t now = dnsMillis();
+    queries.clear();
+    int sock = connectClient();
+
+    // More queries in one write than may be in flight
+    const int total = DNS_TCP_MAX_PIPELINED + 3;
+    uint8_t packet[2048];
+    size_t length = 0;
+    for (int i = 0; i < total; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "p%d.pipeline.test", i);
+        length += framedQuery(packet + length, sizeof(packet) - length, (uint16_t)(0x1000 + i), name);
+    }
+    CHECK(length <= 512);
+    sendAll(sock, packet, length);
+    pump(server, now, DNS_TCP_MAX_PIPELINED);
+    CHECK(queries.size() == DNS_TCP_MAX_PIPELINED);
+
+    // Each answer lets one more in
+    for (int answered = 0; answered < total; answered++) {
+        CHECK(answer(server, queries[answered]));
+        size_t expected = DNS_TCP_MAX_PIPELINED + answered + 1;
+        pump(server, now, expected < (size_t)total ? expected : total);
+        CHECK(queries.size() == (expected < (size_t)total ? expected : total));
+    }
+    CHECK(queries.size() == (size_t)total);
+    for (int i = 0; i < total; i++) {
+        CHECK(queries[i].client.id == 0x1000 + i);
+    }
+    uint32_t seen = 0;
+    for (int i = 0; i < total; i++) {
+        seen |= 1u << (readAnswerId(sock) - 0x1000);
+    }
+    CHECK(seen == (1u << total) - 1);
+    close(sock);
+    pump(server, now, total);
+    CHECK(server.connections() == 0);
+}
+
+static void testIdleTimeout(DnsTcpServer &server)
+{
+    uint32_t now = dnsMillis();
+    uint32_t closed = server.stats().idleClosed;
+    int sock = connectClient();
+    pump(server, now, 0);
+    CHECK(server.connections() == 1);
+    pump(server, now + DNS_TCP_IDLE_TIMEOUT_MS - 1, 0);
+    CHECK(server.connections() == 1);
+    pump(server, now + DNS_TCP_IDLE_TIMEOUT_MS, 0);
+    CHECK(server.connections() == 0);
+    CHECK(server.stats().idleClosed == closed + 1);
+    CHECK(closedByServer(sock));
+    close(sock);
+}
+
+static void testClientLimit(DnsTcpServer &server)
+{
+    uint32_t now = dnsMillis();
+    queries.clear();
+    uint32_t refused = server.stats().refused;
+
+    // Every slot taken by a client with a query in flight
+    int socks[DNS_TCP_MAX_CONNECTIONS];
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        socks[i] = connectClient();
+        uint8_t packet[512];
+        char name[32];
+        snprintf(name, sizeof(name), "c%d.limit.test", i);
+        sendAll(socks[i], packet, framedQuery(packet, sizeof(packet), (uint16_t)(0x2000 + i), name));
+        pump(server, now + i, i + 1);
+    }
+    CHECK(server.connections() == DNS_TCP_MAX_CONNECTIONS);
+    CHECK(queries.size() == DNS_TCP_MAX_CONNECTIONS);
+
+    // So one more is turned away
+    int extra = connectClient();
+    pump(server, now, queries.size());
+    CHECK(server.stats().refused == refused + 1);
+    CHECK(closedByServer(extra));
+    close(extra);
+
+    // Once a client has its answer it is the one that makes room
+    const int idle = 1;
+    CHECK(answer(server, queries[idle]));
+    CHECK(readAnswerId(socks[idle]) == 0x2000 + idle);
+    int late = connectClient();
+    pump(server, now, queries.size());
+    CHECK(server.connections() == DNS_TCP_MAX_CONNECTIONS);
+    CHECK(server.stats().refused == refused + 1);
+    CHECK(closedByServer(socks[idle]));
+
+    // The others still get their answers
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        if (i != idle) {
+            CHECK(answer(server, queries[i]));
+        }
+    }
+    for (int i = 0; i < DNS_TCP_MAX_CONNECTIONS; i++) {
+        if (i != idle) {
+            CHECK(readAnswerId(socks[i]) == 0x2000 + i);
+        }
+        close(socks[i]);
+    }
+    close(late);
+    pump(server, now, queries.size());
+    CHECK(server.connections() == 0);
+}
+
+int main(int argc, char **argv)
+{
+    serverPort = argc > 1 ? (uint16_t)strtoul(argv[1], NULL, 0) : 15393;
+    DnsBufferPool pool;
+    CHECK(pool.begin(DNS_TCP_MAX_CONNECTIONS * 2, 512));
+    DnsTcpServer server;
+    CHECK(server.begin(serverPort, pool, onQuery));
+    testFraming(server);
+    testPipelining(server);
+    testIdleTimeout(server);
+    testClientLimit(server);
+    server.end();
+    CHECK(pool.available() == pool.capacity());
+    printf("test_dns_tcp_server: ok\n");
+    return 0;
+}
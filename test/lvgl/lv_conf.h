@@ -0,0 +1,23 @@
+/**
+ * @file      lv_conf.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+
+// The sketch's LVGL configuration for host builds. HOST_REFR_BANDS turns on
+// LV_USE_REFR_BANDS, which ships off, for the band tests; HOST_COLOR_16_SWAP
+// turns on LV_COLOR_16_SWAP, the panel's byte order, for the blend tests.
+
+#include "../../src/lv_conf.h"
+
+#ifdef HOST_REFR_BANDS
+#undef LV_USE_REFR_BANDS
+#define LV_USE_REFR_BANDS 1
+#endif
+
+#ifdef HOST_COLOR_16_SWAP
+#undef LV_COLOR_16_SWAP
+#define LV_COLOR_16_SWAP 1
+#endif
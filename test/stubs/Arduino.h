@@ -0,0 +1,154 @@
+/**
+ * @file      Arduino.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the parts of the Arduino core the sketch uses. C files
+// see the clock only: LVGL reads millis() through LV_TICK_CUSTOM.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+
+#ifdef __cplusplus
+}
+
+#include <string>
+
+typedef uint8_t byte;
+
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char *s) : std::string(s ? s : "") {}
+    String(const std::string &s) : std::string(s) {}
+};
+
+class IPAddress
+{
+public:
+    IPAddress() : addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        bytes[0] = a;
+        bytes[1] = b;
+        bytes[2] = c;
+        bytes[3] = d;
+    }
+    // Network byte order, as in sockaddr_in, like the ESP32 core
+    IPAddress(uint32_t address) : addr(address) {}
+    operator uint32_t() const
+    {
+        return addr;
+    }
+    uint8_t operator[](int index) const
+    {
+        return bytes[index];
+    }
+    String toString() const
+    {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        return String(text);
+    }
+
+private:
+    union {
+        uint8_t bytes[4];
+        uint32_t addr;
+    };
+};
+
+// Serial goes to stdout
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud)
+    {
+        (void)baud;
+    }
+    void print(const char *s)
+    {
+        fputs(s, stdout);
+    }
+    void print(const String &s)
+    {
+        fputs(s.c_str(), stdout);
+    }
+    void print(const IPAddress &ip)
+    {
+        print(ip.toString());
+    }
+    void print(long n)
+    {
+        printf("%ld", n);
+    }
+    void print(unsigned long n)
+    {
+        printf("%lu", n);
+    }
+    void print(int n)
+    {
+        printf("%d", n);
+    }
+    void print(unsigned int n)
+    {
+        printf("%u", n);
+    }
+    template <typename T>
+    void println(const T &value)
+    {
+        print(value);
+        println();
+    }
+    void println()
+    {
+        fputs("\n", stdout);
+    }
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+static inline long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// Reports the board's ESP32-S3 with 16 MB flash and 8 MB PSRAM
+class EspClass
+{
+public:
+    const char *getChipModel()
+    {
+        return "ESP32-S3";
+    }
+    uint32_t getFlashChipSize()
+    {
+        return 16 * 1024 * 1024;
+    }
+    uint32_t getPsramSize()
+    {
+        return 8 * 1024 * 1024;
+    }
+};
+
+extern EspClass ESP;
+
+#endif // __cplusplus
@@ -0,0 +1,97 @@
+/**
+ * @file      FS.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the Arduino file system: paths are taken relative to a
+// directory on disk, and a File is a shared stdio stream.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ       "r"
+#define FILE_WRITE      "w"
+#define FILE_APPEND     "a"
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+namespace fs
+{
+
+// Called for every File::write() with the file's size before it and the
+// bytes written, and for every File::flush() with a size of 0, so tests can
+// see how writes line up with the card's sectors
+typedef void (*FileWriteHook)(size_t offset, size_t size);
+void setFileWriteHook(FileWriteHook hook);
+
+class File
+{
+public:
+    File() {}
+    explicit File(FILE *stream);
+
+    operator bool() const
+    {
+        return stream != NULL;
+    }
+    size_t size() const;
+    size_t position() const;
+    int available() const;
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    int read();
+    int peek();
+    size_t read(uint8_t *buffer, size_t size);
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+    void flush();
+    void close();
+
+private:
+    std::shared_ptr<FILE> stream;
+};
+
+class FS
+{
+public:
+    explicit FS(const char *root = ".") : root(root) {}
+
+    // Where paths start; the directory must exist
+    void setRoot(const char *path)
+    {
+        root = path;
+    }
+    const char *getRoot() const
+    {
+        return root.c_str();
+    }
+
+    File open(const char *path, const char *mode = FILE_READ);
+    bool exists(const char *path);
+    bool remove(const char *path);
+    bool rename(const char *from, const char *to);
+
+private:
+    std::string resolve(const char *path) const;
+
+    std::string root;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
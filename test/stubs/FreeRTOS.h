@@ -0,0 +1,40 @@
+/**
+ * @file      FreeRTOS.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the FreeRTOS calls the DNS server makes: each task is
+// a detached thread, and task notifications are a counter per task. A tick
+// is a millisecond, as on the board.
+
+#include <stdint.h>
+
+typedef struct HostTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdFAIL                  0
+#define pdPASS                  1
+#define portMAX_DELAY           0xffffffffu
+#define portNUM_PROCESSORS      2
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define tskIDLE_PRIORITY        0
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created);
+// Only a task deleting itself, which is all the sketch does
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t xPortGetCoreID();
@@ -0,0 +1,308 @@
+/**
+ * @file      HostArduino.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <FS.h>
+#include <SD.h>
+#include <WiFi.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+fs::SDFS SD;
+
+// The clock DnsPlatform.h reads off-target, so the DNS code can mix
+// millis() and dnsMillis() as it does on the board
+uint32_t millis(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL);
+}
+
+uint32_t micros(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000UL + ts.tv_nsec / 1000UL);
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+int HardwareSerial::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+/*
+ * Tasks
+ */
+
+// Never freed: a handle may still be notified after its task has gone, as
+// on the board until the TCB is reused. Listed in `tasks` so they stay
+// reachable and leak checkers leave them alone.
+struct HostTask {
+    TaskFunction_t code;
+    void *arg;
+    std::mutex lock;
+    std::condition_variable woken;
+    uint32_t notified;
+    HostTask *next;
+};
+
+static thread_local HostTask *currentTask = NULL;
+static std::mutex tasksLock;
+static HostTask *tasks = NULL;
+
+static HostTask *newTask()
+{
+    HostTask *task = new HostTask();
+    task->code = NULL;
+    task->arg = NULL;
+    task->notified = 0;
+    std::lock_guard<std::mutex> guard(tasksLock);
+    task->next = tasks;
+    tasks = task;
+    return task;
+}
+
+static HostTask *selfTask()
+{
+    if (!currentTask) {
+        currentTask = newTask();
+    }
+    return currentTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)core;
+    HostTask *task = newTask();
+    task->code = code;
+    task->arg = arg;
+    if (created) {
+        *created = task;
+    }
+    std::thread([task]() {
+        currentTask = task;
+        task->code(task->arg);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+    return xTaskCreatePinnedToCore(code, name, stackDepth, arg, priority, created, 0);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Returning from the task function ends the thread; nothing may run
+    // after vTaskDelete(NULL) in a task, so nothing is skipped.
+    (void)task;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    delay(ticks);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notified++;
+    task->woken.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+    HostTask *task = selfTask();
+    std::unique_lock<std::mutex> guard(task->lock);
+    if (ticks == portMAX_DELAY) {
+        task->woken.wait(guard, [task]() {
+            return task->notified != 0;
+        });
+    } else {
+        task->woken.wait_for(guard, std::chrono::milliseconds(ticks), [task]() {
+            return task->notified != 0;
+        });
+    }
+    uint32_t value = task->notified;
+    if (value != 0) {
+        task->notified = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xPortGetCoreID()
+{
+    return 0;
+}
+
+/*
+ * Files
+ */
+
+namespace fs
+{
+
+File::File(FILE *f)
+{
+    if (f) {
+        stream.reset(f, fclose);
+    }
+}
+
+size_t File::size() const
+{
+    if (!stream) {
+        return 0;
+    }
+    fflush(stream.get());
+    struct stat st;
+    return fstat(fileno(stream.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+size_t File::position() const
+{
+    return stream ? (size_t)ftell(stream.get()) : 0;
+}
+
+int File::available() const
+{
+    return stream ? (int)(size() - position()) : 0;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+    static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    return stream && fseek(stream.get(), pos, whence[mode]) == 0;
+}
+
+int File::read()
+{
+    return stream ? fgetc(stream.get()) : -1;
+}
+
+int File::peek()
+{
+    if (!stream) {
+        return -1;
+    }
+    int c = fgetc(stream.get());
+    if (c >= 0) {
+        ungetc(c, stream.get());
+    }
+    return c;
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+    return stream ? fread(buffer, 1, size, stream.get()) : 0;
+}
+
+size_t File::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+    size_t n = 0;
+    int c;
+    while (n < length && (c = read()) >= 0 && c != terminator) {
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+static FileWriteHook writeHook = NULL;
+
+void setFileWriteHook(FileWriteHook hook)
+{
+    writeHook = hook;
+}
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+    if (!stream) {
+        return 0;
+    }
+    size_t offset = writeHook ? this->size() : 0;
+    size_t n = fwrite(buffer, 1, size, stream.get());
+    if (writeHook) {
+        writeHook(offset, n);
+    }
+    return n;
+}
+
+void File::flush()
+{
+    if (stream) {
+        fflush(stream.get());
+        if (writeHook) {
+            writeHook(size(), 0);
+        }
+    }
+}
+
+void File::close()
+{
+    stream.reset();
+}
+
+std::string FS::resolve(const char *path) const
+{
+    return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+File FS::open(const char *path, const char *mode)
+{
+    return File(fopen(resolve(path).c_str(), mode));
+}
+
+bool FS::exists(const char *path)
+{
+    return access(resolve(path).c_str(), F_OK) == 0;
+}
+
+bool FS::remove(const char *path)
+{
+    return ::remove(resolve(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *from, const char *to)
+{
+    return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0;
+}
+
+bool SDFS::begin(uint8_t ssPin)
+{
+    (void)ssPin;
+    struct stat st;
+    mounted = stat(getRoot(), &st) == 0 && S_ISDIR(st.st_mode);
+    return mounted;
+}
+
+} // namespace fs
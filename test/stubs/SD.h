@@ -0,0 +1,50 @@
+/**
+ * @file      SD.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the SD card: a directory, see FS.h. It mounts when the
+// directory exists.
+
+#include <stdint.h>
+#include "FS.h"
+
+typedef enum {
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+
+namespace fs
+{
+
+class SDFS : public FS
+{
+public:
+    bool begin(uint8_t ssPin = 0);
+    void end()
+    {
+        mounted = false;
+    }
+    sdcard_type_t cardType() const
+    {
+        return mounted ? CARD_SDHC : CARD_NONE;
+    }
+    uint64_t cardSize() const
+    {
+        return mounted ? 16ULL * 1024 * 1024 * 1024 : 0;
+    }
+
+private:
+    bool mounted = false;
+};
+
+} // namespace fs
+
+extern fs::SDFS SD;
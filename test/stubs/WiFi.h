@@ -0,0 +1,51 @@
+/**
+ * @file      WiFi.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the station interface: always connected, on loopback.
+
+#include <Arduino.h>
+
+class WiFiClass
+{
+public:
+    bool isConnected()
+    {
+        return true;
+    }
+    IPAddress localIP()
+    {
+        return IPAddress(127, 0, 0, 1);
+    }
+    String macAddress()
+    {
+        return "00:00:00:00:00:00";
+    }
+    String SSID()
+    {
+        return "host";
+    }
+    String psk()
+    {
+        return "";
+    }
+    bool disconnect()
+    {
+        return true;
+    }
+    bool beginSmartConfig()
+    {
+        return false;
+    }
+    bool stopSmartConfig()
+    {
+        return true;
+    }
+};
+
+extern WiFiClass WiFi;
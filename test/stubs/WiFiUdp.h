@@ -0,0 +1,11 @@
+/**
+ * @file      WiFiUdp.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in: the DNS server uses sockets, not WiFiUDP.
+#include <WiFi.h>
@@ -0,0 +1,36 @@
+/**
+ * @file      Adafruit_NeoPixel.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the status LED: remembers the colour, drives nothing.
+
+#include <Arduino.h>
+
+class Adafruit_NeoPixel
+{
+public:
+    Adafruit_NeoPixel() : color(0), brightness(255) {}
+
+    void setPixelColor(uint16_t n, uint32_t c)
+    {
+        (void)n;
+        color = c;
+    }
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    void setBrightness(uint8_t level)
+    {
+        brightness = level;
+    }
+    void show() {}
+
+    uint32_t color;
+    uint8_t brightness;
+};
@@ -0,0 +1,58 @@
+/**
+ * @file      LilyGo_AMOLED.h
+ * @license   MIT
+ * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2026-10-17
+ *
+ */
+#pragma once
+
+// Host stand-in for the board class, with what Graphics/Gui.cpp asks of
+// it: a 1.91" board without SD, PMU or light sensor, so the UI takes the
+// same branches as on one.
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+typedef struct __BoardsConfigure {
+    const void *sd;
+    const void *pmu;
+    const void *sensor;
+} BoardsConfigure_t;
+
+class LilyGo_HostBoard
+{
+public:
+    LilyGo_HostBoard() : brightness(255) {}
+
+    void setBrightness(uint8_t level)
+    {
+        brightness = level;
+    }
+    uint8_t getBrightness()
+    {
+        return brightness;
+    }
+    const BoardsConfigure_t *getBoarsdConfigure()
+    {
+        static const BoardsConfigure_t board = {NULL, NULL, NULL};
+        return &board;
+    }
+    uint16_t getBattVoltage()
+    {
+        return 0;
+    }
+    uint16_t getVbusVoltage()
+    {
+        return 5000;
+    }
+    float getLux()
+    {
+        return 0;
+    }
+
+private:
+    uint8_t brightness;
+};
+
+#define LilyGo_Class LilyGo_HostBoard